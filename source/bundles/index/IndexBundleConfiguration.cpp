@@ -14,8 +14,15 @@ IndexBundleConfiguration::IndexBundleConfiguration(const std::string& collection
     , bUnigramSearchMode_(false)
     , indexMultilangGranularity_(la::FIELD_LEVEL)
     , isAutoRebuild_(false)
+    , indexThreadNum_(0)
     , enable_parallel_searching_(false)
+    , enable_dynamic_pruning_(false)
+    , enable_block_max_wand_(false)
     , enable_forceget_doc_(false)
+    , searchCacheMemory_(0)
+    , staleCacheInterval_(0)
+    , groupSampleDocNum_(0)
+    , masterSearchCacheMemory_(0)
     , isMasterAggregator_(false)
     , isWorkerNode_(false)
     , encoding_(izenelib::util::UString::UNKNOWN)
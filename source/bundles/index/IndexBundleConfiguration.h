@@ -149,12 +149,28 @@ public:
     /// @brief whether perform rebuild collection automatically
     bool isAutoRebuild_;
 
+    /// @brief the number of threads preparing the SCD documents,
+    ///        0 means the number of hardware threads
+    size_t indexThreadNum_;
+
+    /// @brief the properties stored and compressed together in
+    ///        DocumentManager, the other properties are stored separately
+    std::vector<std::vector<std::string> > storedPropertyGroups_;
+
     /// @brief whether trigger Question Answering mode
     bool bTriggerQA_;
 
     /// @brief whether the parallel searching
     bool enable_parallel_searching_;
 
+    /// @brief whether feed the top-K threshold back into doc iterators,
+    ///        then the total count of search result is approximate, as
+    ///        the pruned docs are not counted
+    bool enable_dynamic_pruning_;
+
+    /// @brief whether skip posting blocks by their max scores in WAND query
+    bool enable_block_max_wand_;
+
     /// @brief force get document even if it has been deleted
     bool enable_forceget_doc_;
 
@@ -170,12 +186,27 @@ public:
     /// @brief refresh interval of search cache
     time_t refreshCacheInterval_;
 
+    /// @brief max bytes of searchmanager cache, 0 for no limit
+    size_t searchCacheMemory_;
+
+    /// @brief seconds a stale search cache entry could still be returned
+    ///        while it is refreshed in background, 0 to disable
+    time_t staleCacheInterval_;
+
+    /// @brief if more docs than this number are to count for a group
+    ///        property, only this number of sampled docs are counted,
+    ///        0 for counting all docs
+    int groupSampleDocNum_;
+
     /// @brief filter cache number
     size_t filterCacheNum_;
 
     /// @brief master search cache number
     size_t masterSearchCacheNum_;
 
+    /// @brief max bytes of master search cache, 0 for no limit
+    size_t masterSearchCacheMemory_;
+
     /// @brief top results number
     size_t topKNum_;
 
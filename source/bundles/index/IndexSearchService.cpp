@@ -17,6 +17,7 @@ IndexSearchService::IndexSearchService(IndexBundleConfiguration* config)
     : bundleConfig_(config)
     , searchMerger_(NULL)
     , searchCache_(new SearchCache(bundleConfig_->masterSearchCacheNum_,
+                                    bundleConfig_->masterSearchCacheMemory_,
                                     bundleConfig_->refreshCacheInterval_,
                                     bundleConfig_->refreshSearchCache_))
 {
@@ -40,7 +41,7 @@ const IndexBundleConfiguration* IndexSearchService::getBundleConfig()
 void IndexSearchService::OnUpdateSearchCache()
 {
     LOG(INFO) << "clearing master search cache.";
-    searchCache_->clear();
+    searchCache_->nextGeneration();
 }
 
 bool IndexSearchService::getSearchResult(
@@ -54,8 +54,12 @@ const std::string DOCID("DOCID");
 const std::string DATE("DATE");
 const size_t UPDATE_BUFFER_CAPACITY = 8192;
 //PropertyConfig tempPropertyConfig;
-const std::size_t INDEX_THREAD = 1;
-const std::size_t INDEX_THREAD_QUEUE = UPDATE_BUFFER_CAPACITY*10;
+/** the max number of threads preparing SCD docs if not configured */
+const std::size_t MAX_INDEX_THREAD = 16;
+/** the max number of SCD docs waiting in the queue of each thread */
+const std::size_t INDEX_THREAD_QUEUE = UPDATE_BUFFER_CAPACITY;
+/** the max number of docs prepared ahead of the commit stage */
+const uint64_t COMMIT_WINDOW = UPDATE_BUFFER_CAPACITY * 4;
 
 }
 
@@ -72,6 +76,10 @@ IndexWorker::IndexWorker(
     , numUpdatedDocs_(0)
     , totalSCDSizeSinceLastBackup_(0)
     , distribute_req_hooker_(DistributeRequestHooker::get())
+    , dispatchSeq_(0)
+    , takeSeq_(0)
+    , commitSeq_(0)
+    , isCommitting_(false)
 {
     bool hasDateInConfig = false;
     const IndexBundleSchema& indexSchema = bundleConfig_->indexSchema_;
@@ -104,15 +112,24 @@ IndexWorker::IndexWorker(
     scd_writer_->SetFlushLimit(500);
     scheduleOptimizeTask();
 
-    index_thread_status_ = new bool[INDEX_THREAD];
-    asynchronousTasks_.resize(INDEX_THREAD);
-    for(size_t i = 0; i < INDEX_THREAD; ++i)
+    std::size_t indexThreadNum = bundleConfig_->indexThreadNum_;
+    if (indexThreadNum == 0)
+    {
+        indexThreadNum = std::min<std::size_t>(
+            boost::thread::hardware_concurrency(), MAX_INDEX_THREAD);
+    }
+    indexThreadNum = std::max<std::size_t>(indexThreadNum, 1);
+    LOG(INFO) << "index thread num: " << indexThreadNum;
+
+    asynchronousTasks_.resize(indexThreadNum);
+    for(size_t i = 0; i < indexThreadNum; ++i)
     {
         asynchronousTasks_[i] = new izenelib::util::concurrent_queue<IndexDocInfo>(INDEX_THREAD_QUEUE);
         boost::thread* worker_thread = new boost::thread(boost::bind(&IndexWorker::indexSCDDocFunc, this, i));
         index_thread_workers_.push_back(worker_thread);
     }
-    updateBuffer_.resize(INDEX_THREAD);
+    // the commit stage runs in one thread at a time, so only one buffer
+    updateBuffer_.resize(1);
     is_real_time_ = false;
 }
 
@@ -131,7 +148,6 @@ IndexWorker::~IndexWorker()
         delete index_thread_workers_[i];
         delete asynchronousTasks_[i];
     }
-    delete[] index_thread_status_;
 }
 
 void IndexWorker::HookDistributeRequestForIndex(int hooktype, const std::string& reqdata, bool& result)
@@ -1262,65 +1278,141 @@ bool IndexWorker::doBuildCollection_(
     return true;
 }
 
-static void setIndexThreadStatus(bool* status)
-{
-    *status = true;
-}
-
 void IndexWorker::indexSCDDocFunc(int workerid)
 {
-    Document document;
-    Document old_rtype_doc;
-
     try{
 
     while (true)
     {
         IndexDocInfo workerdata;
-        index_thread_status_[workerid] = false;
-
-        asynchronousTasks_[workerid]->pop(workerdata,
-            boost::bind(&setIndexThreadStatus, index_thread_status_ + workerid));
+        asynchronousTasks_[workerid]->pop(workerdata);
+        boost::this_thread::interruption_point();
 
         if (!workerdata.docptr && (workerdata.scdType == NOT_SCD))
-        {
-            flushUpdateBuffer_(workerid);
-            index_thread_status_[workerid] = false;
-            boost::this_thread::interruption_point();
             continue;
-        }
-        boost::this_thread::interruption_point();
 
-        time_t new_timestamp = workerdata.timestamp;
-        document.clear();
-        old_rtype_doc.clear();
+        {
+            // bound the memory of docs prepared ahead of the commit stage
+            boost::mutex::scoped_lock lock(commitMutex_);
+            while (workerdata.seq >= commitSeq_ + COMMIT_WINDOW)
+            {
+                commitCond_.wait(lock);
+            }
+        }
 
-        if (!prepareDocument_(*(workerdata.docptr), document, old_rtype_doc,
-                workerdata.oldDocId, workerdata.newDocId,
-                new_timestamp, workerdata.updateType, workerdata.scdType))
-            continue;
+        PreparedDocPtr preparedDoc(new PreparedDocInfo);
+        preparedDoc->oldDocId = workerdata.oldDocId;
+        preparedDoc->scdType = workerdata.scdType;
+        preparedDoc->updateType = workerdata.updateType;
+        preparedDoc->timestamp = workerdata.timestamp;
 
-        if (workerdata.scdType == INSERT_SCD || workerdata.oldDocId == 0)
+        if (!prepareDocument_(*(workerdata.docptr), preparedDoc->document,
+                preparedDoc->oldRTypeDoc, workerdata.oldDocId, workerdata.newDocId,
+                preparedDoc->timestamp, workerdata.updateType, workerdata.scdType))
         {
-            insertDoc_(workerid, document, new_timestamp);
+            preparedDoc.reset();
         }
-        else
+        else if (preparedDoc->scdType == INSERT_SCD || preparedDoc->oldDocId == 0 ||
+                 preparedDoc->updateType == INSERT)
         {
-            if (!updateDoc_(workerid, workerdata.oldDocId, document, old_rtype_doc, new_timestamp, workerdata.updateType))
-                continue;
-            ++numUpdatedDocs_;
+            // analyze the new doc here, only the ordered insert is left to commit
+            inc_supported_index_manager_.prepareInsertDocument(preparedDoc->document);
         }
+
+        commitPreparedDoc_(workerdata.seq, preparedDoc);
     }
 
     } catch (const boost::thread_interrupted& e)
     {
-        index_thread_status_[workerid] = false;
         asynchronousTasks_[workerid]->clear();
-        flushUpdateBuffer_(workerid);
+        {
+            boost::mutex::scoped_lock lock(commitMutex_);
+            while (isCommitting_)
+            {
+                commitCond_.wait(lock);
+            }
+            flushUpdateBuffer_(0);
+        }
         LOG(INFO) << "index thread worker exited : " << workerid;
     }
 }
 
+void IndexWorker::commitPreparedDoc_(uint64_t seq, const PreparedDocPtr& preparedDoc)
+{
+    boost::mutex::scoped_lock lock(commitMutex_);
+    commitBuffer_[seq] = preparedDoc;
+
+    // the other thread would commit this doc
+    if (isCommitting_)
+        return;
+
+    isCommitting_ = true;
+    std::vector<PreparedDocPtr> commitDocs;
+
+    try{
+
+    while (true)
+    {
+        // take the consecutive docs, so that they are committed in SCD order
+        commitDocs.clear();
+        std::map<uint64_t, PreparedDocPtr>::iterator it = commitBuffer_.begin();
+        while (it != commitBuffer_.end() && it->first == takeSeq_)
+        {
+            commitDocs.push_back(it->second);
+            commitBuffer_.erase(it++);
+            ++takeSeq_;
+        }
+
+        if (commitDocs.empty())
+            break;
+
+        // let the other threads continue preparing docs while committing
+        lock.unlock();
+        for (std::size_t i = 0; i < commitDocs.size(); ++i)
+        {
+            PreparedDocInfo* doc = commitDocs[i].get();
+            if (!doc)
+                continue;
+
+            if (doc->scdType == INSERT_SCD || doc->oldDocId == 0)
+            {
+                insertDoc_(0, doc->document, doc->timestamp);
+            }
+            else if (updateDoc_(0, doc->oldDocId, doc->document, doc->oldRTypeDoc,
+                    doc->timestamp, doc->updateType))
+            {
+                ++numUpdatedDocs_;
+            }
+        }
+        lock.lock();
+
+        commitSeq_ += commitDocs.size();
+        commitCond_.notify_all();
+    }
+
+    } catch (...)
+    {
+        if (!lock.owns_lock())
+            lock.lock();
+        isCommitting_ = false;
+        commitCond_.notify_all();
+        throw;
+    }
+
+    isCommitting_ = false;
+    commitCond_.notify_all();
+}
+
+void IndexWorker::waitCommitFinish_()
+{
+    boost::mutex::scoped_lock lock(commitMutex_);
+    while (commitSeq_ < dispatchSeq_ || isCommitting_)
+    {
+        commitCond_.wait(lock);
+    }
+    flushUpdateBuffer_(0);
+}
+
 bool IndexWorker::insertOrUpdateSCD_(
         ScdParser& parser,
         SCD_TYPE scdType,
@@ -1431,7 +1523,7 @@ bool IndexWorker::insertOrUpdateSCD_(
         else // multi-index;
         {
             asynchronousTasks_[workerid]->push(IndexDocInfo(docptr, oldId, docId,
-                    scdType, updateType, timestamp));
+                    scdType, updateType, timestamp, dispatchSeq_++));
         }
         if (!source.empty())
         {
@@ -1448,21 +1540,7 @@ bool IndexWorker::insertOrUpdateSCD_(
     }
     else
     {
-        for (size_t i = 0; i < asynchronousTasks_.size(); ++i)
-        {
-            asynchronousTasks_[i]->push(IndexDocInfo());
-        }
-        // wait flush finish.
-        for (size_t i = 0; i < asynchronousTasks_.size(); ++i)
-        {
-            while(!updateBuffer_[i].empty() || !asynchronousTasks_[i]->empty() ||
-                index_thread_status_[i])
-            {
-                sleep(2);
-                //LOG(INFO) << "index thread still buffering ... ";
-            }
-        }
-        sleep(1);
+        waitCommitFinish_();
         LOG(INFO) << "scd finished index for all thread.";
     }
     return true;
@@ -2003,7 +2081,10 @@ bool IndexWorker::prepareDocument_(
                     document.property(fieldStr).swap(propData);
                 }
                 if (updateType == RTYPE)
+                {
+                    boost::mutex::scoped_lock lock(rtypeDocidProsMutex_);
                     documentManager_->RtypeDocidPros_.insert(fieldStr);
+                }
                 break;
 
             case DATETIME_PROPERTY_TYPE:
@@ -2024,7 +2105,10 @@ bool IndexWorker::prepareDocument_(
                     document.property(fieldStr).swap(propData);
                 }
                 if (updateType == RTYPE)
+                {
+                    boost::mutex::scoped_lock lock(rtypeDocidProsMutex_);
                     documentManager_->RtypeDocidPros_.insert(fieldStr);
+                }
                 break;
 
             default:
@@ -28,7 +28,10 @@
 
 #include <boost/shared_ptr.hpp>
 #include <boost/tuple/tuple.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
 #include <util/concurrent_queue.h>
+#include <map>
 //#include <boost/atomic.hpp>
 
 namespace sf1r
@@ -243,6 +246,19 @@ private:
     void lazyOptimizeIndex(int calltype);
     void indexSCDDocFunc(int workerid);
 
+    struct PreparedDocInfo;
+    typedef boost::shared_ptr<PreparedDocInfo> PreparedDocPtr;
+
+    /**
+     * the commit stage of the SCD indexing pipeline, the documents prepared
+     * by the worker threads are committed in the order of @p seq.
+     * @param preparedDoc the prepared document, NULL if it is skipped
+     */
+    void commitPreparedDoc_(uint64_t seq, const PreparedDocPtr& preparedDoc);
+
+    /** wait until the documents dispatched to worker threads are all committed */
+    void waitCommitFinish_();
+
 private:
     IndexBundleConfiguration* bundleConfig_;
     MiningTaskService* miningTaskService_;
@@ -292,21 +308,51 @@ private:
         SCD_TYPE scdType;
         UpdateType updateType;
         time_t timestamp;
+        uint64_t seq; /// the order of the doc in SCD files
         IndexDocInfo()
-            : scdType(NOT_SCD), timestamp(0)
+            : scdType(NOT_SCD), timestamp(0), seq(0)
         {
         }
         IndexDocInfo(SCDDocPtr i_doc, docid_t i_oid, docid_t i_nid,
-            const SCD_TYPE& i_scdType, const UpdateType& i_updatetype, const time_t& i_time)
+            const SCD_TYPE& i_scdType, const UpdateType& i_updatetype, const time_t& i_time,
+            uint64_t i_seq)
             : docptr(i_doc), oldDocId(i_oid), newDocId(i_nid),
-            scdType(i_scdType), updateType(i_updatetype), timestamp(i_time)
+            scdType(i_scdType), updateType(i_updatetype), timestamp(i_time), seq(i_seq)
         {
         }
     };
 
+    struct PreparedDocInfo
+    {
+        Document document;
+        Document oldRTypeDoc;
+        docid_t oldDocId;
+        SCD_TYPE scdType;
+        UpdateType updateType;
+        time_t timestamp;
+    };
+
+    /// the worker threads preparing the documents, the docs with the same
+    /// DOCID go to the same worker, so that they are prepared in SCD order.
     std::vector<izenelib::util::concurrent_queue<IndexDocInfo>* > asynchronousTasks_;
     std::vector<boost::thread*> index_thread_workers_;
-    bool* index_thread_status_;
+
+    /// the seq of next doc dispatched to worker threads
+    uint64_t dispatchSeq_;
+    /// the seq of next doc to take from @c commitBuffer_
+    uint64_t takeSeq_;
+    /// the number of docs committed into DocumentManager and index
+    uint64_t commitSeq_;
+    /// the prepared docs waiting for the previous ones to commit
+    std::map<uint64_t, PreparedDocPtr> commitBuffer_;
+    /// only one thread commits the docs at a time
+    bool isCommitting_;
+    boost::mutex commitMutex_;
+    boost::condition_variable commitCond_;
+
+    /// protect DocumentManager::RtypeDocidPros_ among the worker threads
+    boost::mutex rtypeDocidProsMutex_;
+
     bool is_real_time_;
     boost::shared_ptr<ShardingStrategy> sharding_strategy_;
     boost::shared_ptr<ScdSharder> scdSharder_;
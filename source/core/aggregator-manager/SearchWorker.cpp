@@ -23,14 +23,18 @@
 #include <query-manager/QueryTypeDef.h>
 #include <search-manager/GeoHashEncoder.h>
 
+#include <boost/bind.hpp>
+
 namespace sf1r
 {
 
 SearchWorker::SearchWorker(IndexBundleConfiguration* bundleConfig)
     : bundleConfig_(bundleConfig)
     , searchCache_(new SearchCache(bundleConfig_->searchCacheNum_,
+                                    bundleConfig_->searchCacheMemory_,
                                     bundleConfig_->refreshCacheInterval_,
-                                    bundleConfig_->refreshSearchCache_))
+                                    bundleConfig_->refreshSearchCache_,
+                                    bundleConfig_->staleCacheInterval_))
     , queryPruneFactory_(new QueryPruneFactory())
 {
     ///LA can only be got from a pool because it is not thread safe
@@ -42,6 +46,12 @@ SearchWorker::SearchWorker(IndexBundleConfiguration* bundleConfig)
     analysisInfo_.tokenizerNameList_.insert("tok_unite");
 }
 
+SearchWorker::~SearchWorker()
+{
+    // the refreshing tasks call this instance
+    searchCache_->waitRefresh();
+}
+
 void SearchWorker::HookDistributeRequestForSearch(int hooktype, const std::string& reqdata, bool& result)
 {
     MasterManagerBase::get()->pushWriteReq(reqdata, "api_from_shard");
@@ -204,54 +214,63 @@ bool SearchWorker::doLocalSearch(const KeywordSearchActionItem& actionItem, Keyw
     QueryIdentity identity;
     makeQueryIdentity(identity, actionItem, resultItem.distSearchInfo_.option_, topKStart);
 
-    if (!searchCache_->get(identity, resultItem))
-    {
-        STOP_PROFILER( cacheoverhead )
+    bool isCached = false;
+    const bool isSucc = searchCache_->get(identity, resultItem,
+            boost::bind(&SearchWorker::loadSearchResult_, this,
+                        actionItem, identity, resultItem.distSearchInfo_, _1),
+            isCached);
 
-        if (! getSearchResult_(actionItem, resultItem, identity, false))
-            return false;
-
-        resultItem.rawQueryString_ = actionItem.env_.queryString_;
-
-        if (!resultItem.topKDocs_.empty() && actionItem.searchingMode_.mode_ != SearchingMode::AD_INDEX)
-            searchManager_->topKReranker_.rerank(actionItem, resultItem);
-
-        if (resultItem.topKDocs_.empty())
-            return true;
+    STOP_PROFILER( cacheoverhead )
 
+    if (!isSucc)
+        return false;
 
-        if (! getSummaryMiningResult_(actionItem, resultItem, false))
-            return false;
+    // the result is loaded with summary
+    if (!isCached)
+        return true;
 
-        START_PROFILER( cacheoverhead )
-        if (searchCache_)
-            searchCache_->set(identity, resultItem);
-        STOP_PROFILER( cacheoverhead )
-    }
-    else
+    if (actionItem.searchingMode_.mode_ == SearchingMode::AD_INDEX)
     {
-        STOP_PROFILER( cacheoverhead );
-
-        if (actionItem.searchingMode_.mode_ == SearchingMode::AD_INDEX)
+        if (miningManager_->getAdIndexManager())
         {
-            if (miningManager_->getAdIndexManager())
-            {
-                resultItem.topKDocs_.swap(resultItem.adCachedTopKDocs_);
-                miningManager_->getAdIndexManager()->rankAndSelect(
-                    std::vector<std::pair<std::string, std::string> >(),
-                    resultItem.topKDocs_, resultItem.topKRankScoreList_, resultItem.totalCount_);
-            }
+            resultItem.topKDocs_.swap(resultItem.adCachedTopKDocs_);
+            miningManager_->getAdIndexManager()->rankAndSelect(
+                std::vector<std::pair<std::string, std::string> >(),
+                resultItem.topKDocs_, resultItem.topKRankScoreList_, resultItem.totalCount_);
         }
-        resultItem.setStartCount(actionItem.pageInfo_);
-        resultItem.adjustStartCount(topKStart);
-
-        if (! getSummaryResult_(actionItem, resultItem, false))
-            return false;
     }
+    resultItem.setStartCount(actionItem.pageInfo_);
+    resultItem.adjustStartCount(topKStart);
+
+    if (! getSummaryResult_(actionItem, resultItem, false))
+        return false;
 
     return true;
 }
 
+bool SearchWorker::loadSearchResult_(
+        const KeywordSearchActionItem& actionItem,
+        QueryIdentity identity,
+        const DistKeywordSearchInfo& distSearchInfo,
+        KeywordSearchResult& resultItem)
+{
+    // it might be called in background to refresh the stale cache
+    resultItem.distSearchInfo_ = distSearchInfo;
+
+    if (! getSearchResult_(actionItem, resultItem, identity, false))
+        return false;
+
+    resultItem.rawQueryString_ = actionItem.env_.queryString_;
+
+    if (!resultItem.topKDocs_.empty() && actionItem.searchingMode_.mode_ != SearchingMode::AD_INDEX)
+        searchManager_->topKReranker_.rerank(actionItem, resultItem);
+
+    if (resultItem.topKDocs_.empty())
+        return true;
+
+    return getSummaryMiningResult_(actionItem, resultItem, false);
+}
+
 void SearchWorker::clickGroupLabel(const ClickGroupLabelActionItem& actionItem, bool& result)
 {
     result = miningManager_->clickGroupLabel(
@@ -588,10 +607,12 @@ bool SearchWorker::getSearchResult_(
     actionOperation.getRawQueryTermIdList(resultItem.queryTermIdList_);
 
     DLOG(INFO) << "Total count: " << resultItem.totalCount_ << endl;
+    DLOG(INFO) << "Pruned count: " << resultItem.prunedCount_ << endl;
     DLOG(INFO) << "Top K count: " << resultItem.topKDocs_.size() << endl;
     DLOG(INFO) << "Page Count: " << resultItem.count_ << endl;
 
     cout << "Total count: " << resultItem.totalCount_ << endl;
+    cout << "Pruned count: " << resultItem.prunedCount_ << endl;
     cout << "Top K count: " << resultItem.topKDocs_.size() << endl;
     cout << "Page Count: " << resultItem.count_ << endl;
 
@@ -892,7 +913,7 @@ void SearchWorker::reset_all_property_cache()
 
 void SearchWorker::clearSearchCache()
 {
-    searchCache_->clear();
+    searchCache_->nextGeneration();
     LOG(INFO) << "notify master to clear cache.";
     if (bundleConfig_->isWorkerNode())
     {
@@ -41,6 +41,8 @@ class SearchWorker : public net::aggregator::BindCallProxyBase<SearchWorker>
 public:
     SearchWorker(IndexBundleConfiguration* bundleConfig);
 
+    ~SearchWorker();
+
     typedef std::vector<std::pair<uint32_t, izenelib::util::UString> > LabelListT;
     typedef std::vector<std::pair<izenelib::util::UString, std::vector<izenelib::util::UString> > > LabelListWithSimT;
 
@@ -100,6 +102,7 @@ public:
 
     void clearSearchCache();
 
+    /// invalidate the cached filter bitmaps after the index is updated
     void clearFilterCache();
 
     uint32_t getDocNum();
@@ -131,6 +134,15 @@ private:
             KeywordSearchResult& resultItem,
             bool isDistributedSearch = true);
 
+    /**
+     * load the result of local search on cache miss.
+     */
+    bool loadSearchResult_(
+            const KeywordSearchActionItem& actionItem,
+            QueryIdentity identity,
+            const DistKeywordSearchInfo& distSearchInfo,
+            KeywordSearchResult& resultItem);
+
     bool getSummaryResult_(
             const KeywordSearchActionItem& actionItem,
             KeywordSearchResult& resultItem,
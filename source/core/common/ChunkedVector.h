@@ -0,0 +1,154 @@
+/**
+ * @file ChunkedVector.h
+ * @brief a vector stored in fixed-size chunks, the chunks are shared by
+ *        the copies, and a chunk is copied only when it is modified.
+ * @date Created 2013-07-26
+ *
+ * It is used by the tables copied by TableSwapper, so that the writer
+ * only copies the chunks it modifies, and appends new ones, instead of
+ * copying the whole table of reader.
+ *
+ * The elements in the same chunk are contiguous in memory, all the chunks
+ * except the last one are full.
+ */
+
+#ifndef SF1R_CHUNKED_VECTOR_H
+#define SF1R_CHUNKED_VECTOR_H
+
+#include <boost/shared_ptr.hpp>
+#include <vector>
+#include <algorithm>
+
+namespace sf1r
+{
+
+template <typename T, std::size_t ChunkBits = 16>
+class ChunkedVector
+{
+public:
+    typedef T value_type;
+
+    /// the number of elements in each chunk
+    static const std::size_t kChunkSize = std::size_t(1) << ChunkBits;
+
+    static const std::size_t kChunkMask = kChunkSize - 1;
+
+    ChunkedVector() : size_(0) {}
+
+    explicit ChunkedVector(std::size_t num, const T& value = T())
+        : size_(0)
+    {
+        resize(num, value);
+    }
+
+    std::size_t size() const { return size_; }
+
+    bool empty() const { return size_ == 0; }
+
+    const T& operator[](std::size_t pos) const
+    {
+        return (*chunks_[pos >> ChunkBits])[pos & kChunkMask];
+    }
+
+    /**
+     * get the element to modify, its chunk is copied if it is shared.
+     */
+    T& at(std::size_t pos)
+    {
+        return mutableChunk_(pos >> ChunkBits)[pos & kChunkMask];
+    }
+
+    void set(std::size_t pos, const T& value)
+    {
+        at(pos) = value;
+    }
+
+    void push_back(const T& value)
+    {
+        if ((size_ & kChunkMask) == 0)
+        {
+            chunks_.push_back(ChunkPtr(new Chunk));
+            chunks_.back()->reserve(kChunkSize);
+        }
+
+        mutableChunk_(chunks_.size() - 1).push_back(value);
+        ++size_;
+    }
+
+    void resize(std::size_t num, const T& value = T())
+    {
+        if (num < size_)
+        {
+            shrink_(num);
+            return;
+        }
+
+        while (size_ < num)
+        {
+            if ((size_ & kChunkMask) == 0)
+            {
+                chunks_.push_back(ChunkPtr(new Chunk));
+            }
+
+            Chunk& chunk = mutableChunk_(chunks_.size() - 1);
+            const std::size_t chunkNum = std::min(num - size_, kChunkSize - chunk.size());
+            chunk.resize(chunk.size() + chunkNum, value);
+            size_ += chunkNum;
+        }
+    }
+
+    void clear()
+    {
+        chunks_.clear();
+        size_ = 0;
+    }
+
+    void swap(ChunkedVector& other)
+    {
+        chunks_.swap(other.chunks_);
+        std::swap(size_, other.size_);
+    }
+
+    std::size_t chunkNum() const { return chunks_.size(); }
+
+    /** the elements in the chunk at @p index */
+    const std::vector<T>& chunk(std::size_t index) const { return *chunks_[index]; }
+
+private:
+    typedef std::vector<T> Chunk;
+    typedef boost::shared_ptr<Chunk> ChunkPtr;
+
+    Chunk& mutableChunk_(std::size_t index)
+    {
+        ChunkPtr& chunk = chunks_[index];
+        if (!chunk.unique())
+        {
+            ChunkPtr copy(new Chunk);
+            copy->reserve(kChunkSize);
+            copy->assign(chunk->begin(), chunk->end());
+            chunk.swap(copy);
+        }
+        return *chunk;
+    }
+
+    void shrink_(std::size_t num)
+    {
+        chunks_.resize((num + kChunkMask) >> ChunkBits);
+        size_ = num;
+
+        const std::size_t lastNum = num & kChunkMask;
+        if (lastNum > 0)
+        {
+            mutableChunk_(chunks_.size() - 1).resize(lastNum);
+        }
+    }
+
+private:
+    std::vector<ChunkPtr> chunks_;
+
+    std::size_t size_;
+};
+
+} // namespace sf1r
+
+#endif // SF1R_CHUNKED_VECTOR_H
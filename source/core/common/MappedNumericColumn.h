@@ -0,0 +1,375 @@
+/**
+ * @file MappedNumericColumn.h
+ * @brief a column of numeric values, the values saved in file are mapped
+ *        into memory instead of being read, and the values appended after
+ *        that are kept in a delta vector.
+ * @date Created 2013-07-24
+ *
+ * The file is mapped privately, so that the pages are loaded on demand
+ * and shared with page cache until they are modified, and the file is
+ * never changed except in save(). The values mapped are modified in
+ * chunks of @c kChunkSize, when the column is saved into the file it maps,
+ * only the modified chunks and the delta are written, then the file is
+ * mapped again to take over the delta.
+ *
+ * The file layout is the same as the one of NumericPropertyTable:
+ * the value count as std::size_t, followed by the values.
+ */
+
+#ifndef SF1R_MAPPED_NUMERIC_COLUMN_H
+#define SF1R_MAPPED_NUMERIC_COLUMN_H
+
+#include <glog/logging.h>
+#include <boost/noncopyable.hpp>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <algorithm>
+
+namespace sf1r
+{
+
+template <typename T>
+class MappedNumericColumn : private boost::noncopyable
+{
+public:
+    /// the bytes of the value count at file beginning
+    static const std::size_t kHeaderSize = sizeof(std::size_t);
+
+    /// the values in each chunk, whose modification is tracked as a whole
+    static const std::size_t kChunkSize = 4096 / sizeof(T);
+
+    MappedNumericColumn(std::size_t size, const T& value)
+        : map_(NULL)
+        , mapLength_(0)
+        , base_(NULL)
+        , baseSize_(0)
+        , fileSize_(0)
+        , delta_(size, value)
+    {
+    }
+
+    ~MappedNumericColumn()
+    {
+        unmap_();
+    }
+
+    /**
+     * map the values in file @p path.
+     * @return false if the file is not found or invalid, in this case,
+     *         the column is not changed.
+     */
+    bool open(const std::string& path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd == -1)
+            return false;
+
+        struct stat st;
+        std::size_t fileSize = 0;
+        if (::fstat(fd, &st) == -1 ||
+            static_cast<std::size_t>(st.st_size) < kHeaderSize ||
+            ::pread(fd, &fileSize, kHeaderSize, 0) != static_cast<ssize_t>(kHeaderSize) ||
+            kHeaderSize + fileSize * sizeof(T) > static_cast<std::size_t>(st.st_size))
+        {
+            LOG(ERROR) << "invalid numeric column file " << path;
+            ::close(fd);
+            return false;
+        }
+
+        void* map = NULL;
+        const std::size_t mapLength = kHeaderSize + fileSize * sizeof(T);
+        if (fileSize > 0)
+        {
+            map = ::mmap(NULL, mapLength, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if (map == MAP_FAILED)
+            {
+                PLOG(ERROR) << "failed to map numeric column file " << path;
+                ::close(fd);
+                return false;
+            }
+        }
+        ::close(fd);
+
+        unmap_();
+        map_ = map;
+        mapLength_ = map ? mapLength : 0;
+        base_ = map ? reinterpret_cast<T*>(static_cast<char*>(map) + kHeaderSize) : NULL;
+        baseSize_ = fileSize;
+        fileSize_ = fileSize;
+        std::vector<T>().swap(delta_);
+        std::vector<bool>((fileSize + kChunkSize - 1) / kChunkSize).swap(dirtyChunks_);
+        path_ = path;
+
+        return true;
+    }
+
+    /**
+     * save the values into file @p path, if it is the file mapped, only
+     * the modified chunks and the delta are written.
+     */
+    bool save(const std::string& path)
+    {
+        if (path != path_)
+            return saveAll_(path);
+
+        int fd = ::open(path.c_str(), O_WRONLY);
+        if (fd == -1)
+            return saveAll_(path);
+
+        bool result = writeDirtyChunks_(fd);
+
+        if (result && !delta_.empty())
+        {
+            result = write_(fd, &delta_[0], delta_.size(),
+                            kHeaderSize + baseSize_ * sizeof(T));
+        }
+
+        // the count is written at last, so the values appended are
+        // ignored if it failed in the middle
+        const std::size_t newSize = size();
+        if (result)
+        {
+            result = ::pwrite(fd, &newSize, kHeaderSize, 0) ==
+                static_cast<ssize_t>(kHeaderSize);
+        }
+
+        if (result && newSize < fileSize_)
+        {
+            result = ::ftruncate(fd, kHeaderSize + newSize * sizeof(T)) == 0;
+        }
+
+        ::close(fd);
+
+        if (!result)
+        {
+            PLOG(ERROR) << "failed to save numeric column file " << path;
+            return false;
+        }
+
+        return open(path);
+    }
+
+    std::size_t size() const
+    {
+        return baseSize_ + delta_.size();
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    const T& operator[](std::size_t pos) const
+    {
+        return pos < baseSize_ ? base_[pos] : delta_[pos - baseSize_];
+    }
+
+    void set(std::size_t pos, const T& value)
+    {
+        if (pos < baseSize_)
+        {
+            base_[pos] = value;
+            dirtyChunks_[pos / kChunkSize] = true;
+        }
+        else
+        {
+            delta_[pos - baseSize_] = value;
+        }
+    }
+
+    void resize(std::size_t size, const T& value)
+    {
+        if (size > baseSize_)
+        {
+            delta_.resize(size - baseSize_, value);
+            return;
+        }
+
+        std::vector<T>().swap(delta_);
+        baseSize_ = size;
+    }
+
+    /**
+     * release the memory reserved by the delta.
+     */
+    void shrink()
+    {
+        std::vector<T>(delta_).swap(delta_);
+    }
+
+    /**
+     * whether all the values are in one array.
+     */
+    bool isContiguous() const
+    {
+        return baseSize_ == 0 || delta_.empty();
+    }
+
+    /**
+     * @return the array of all the values, or NULL if the values are not
+     *         in one array.
+     */
+    T* data()
+    {
+        if (baseSize_ == 0)
+            return delta_.empty() ? NULL : &delta_[0];
+
+        return delta_.empty() ? base_ : NULL;
+    }
+
+    const T* data() const
+    {
+        return const_cast<MappedNumericColumn*>(this)->data();
+    }
+
+    /** the values mapped from file */
+    const T* baseData() const { return base_; }
+
+    std::size_t baseSize() const { return baseSize_; }
+
+    /** the values appended after file is mapped */
+    const T* deltaData() const { return delta_.empty() ? NULL : &delta_[0]; }
+
+    std::size_t deltaSize() const { return delta_.size(); }
+
+private:
+    void unmap_()
+    {
+        if (map_)
+        {
+            ::munmap(map_, mapLength_);
+            map_ = NULL;
+            mapLength_ = 0;
+        }
+        base_ = NULL;
+        baseSize_ = 0;
+    }
+
+    /**
+     * write into a temporary file and rename it, as @p path might be
+     * mapped, truncating it would invalidate the mapped pages.
+     */
+    bool saveAll_(const std::string& path)
+    {
+        const std::string tempPath = path + ".tmp";
+        {
+            std::ofstream ofs(tempPath.c_str(), std::ios::binary | std::ios::trunc);
+            if (!ofs)
+            {
+                LOG(ERROR) << "failed to create numeric column file " << tempPath;
+                return false;
+            }
+
+            const std::size_t len = size();
+            ofs.write(reinterpret_cast<const char*>(&len), kHeaderSize);
+            if (baseSize_ > 0)
+            {
+                ofs.write(reinterpret_cast<const char*>(base_), baseSize_ * sizeof(T));
+            }
+            if (!delta_.empty())
+            {
+                ofs.write(reinterpret_cast<const char*>(&delta_[0]), delta_.size() * sizeof(T));
+            }
+
+            if (!ofs)
+            {
+                LOG(ERROR) << "failed to write numeric column file " << tempPath;
+                return false;
+            }
+        }
+
+        if (::rename(tempPath.c_str(), path.c_str()) != 0)
+        {
+            PLOG(ERROR) << "failed to rename " << tempPath << " to " << path;
+            return false;
+        }
+
+        return open(path);
+    }
+
+    /**
+     * write the modified chunks of @c base_, the adjacent ones are written
+     * in one call.
+     */
+    bool writeDirtyChunks_(int fd) const
+    {
+        const std::size_t chunkNum =
+            std::min(dirtyChunks_.size(), (baseSize_ + kChunkSize - 1) / kChunkSize);
+
+        std::size_t chunk = 0;
+        while (chunk < chunkNum)
+        {
+            if (!dirtyChunks_[chunk])
+            {
+                ++chunk;
+                continue;
+            }
+
+            std::size_t endChunk = chunk + 1;
+            while (endChunk < chunkNum && dirtyChunks_[endChunk])
+            {
+                ++endChunk;
+            }
+
+            const std::size_t begin = chunk * kChunkSize;
+            const std::size_t end = std::min(endChunk * kChunkSize, baseSize_);
+            if (!write_(fd, base_ + begin, end - begin, kHeaderSize + begin * sizeof(T)))
+                return false;
+
+            chunk = endChunk;
+        }
+        return true;
+    }
+
+    static bool write_(int fd, const T* values, std::size_t num, off_t offset)
+    {
+        const char* buf = reinterpret_cast<const char*>(values);
+        std::size_t len = num * sizeof(T);
+
+        while (len > 0)
+        {
+            ssize_t n = ::pwrite(fd, buf, len, offset);
+            if (n <= 0)
+                return false;
+
+            buf += n;
+            len -= n;
+            offset += n;
+        }
+        return true;
+    }
+
+private:
+    void* map_;
+
+    std::size_t mapLength_;
+
+    /// the values mapped from file
+    T* base_;
+
+    std::size_t baseSize_;
+
+    /// the value count in file
+    std::size_t fileSize_;
+
+    /// the values appended after @c base_
+    std::vector<T> delta_;
+
+    /// whether any value in each chunk of @c base_ is modified
+    std::vector<bool> dirtyChunks_;
+
+    /// the file mapped
+    std::string path_;
+};
+
+} // namespace sf1r
+
+#endif // SF1R_MAPPED_NUMERIC_COLUMN_H
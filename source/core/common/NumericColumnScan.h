@@ -0,0 +1,394 @@
+/**
+ * @file NumericColumnScan.h
+ * @brief kernels to evaluate a range predicate over a numeric column,
+ *        the result is written as bitmap words, one bit for each value.
+ * @date Created 2013-07-10
+ *
+ * The AVX2 and SSE2 versions are selected at compile time according to
+ * the target flags (the project is built with -march=native), the scalar
+ * version is used for the other types and for the tail of the column.
+ */
+
+#ifndef SF1R_NUMERIC_COLUMN_SCAN_H
+#define SF1R_NUMERIC_COLUMN_SCAN_H
+
+#include <boost/cstdint.hpp>
+#include <cstddef>
+#include <cmath>
+#include <limits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace sf1r
+{
+namespace column_scan
+{
+
+typedef uint64_t WordT;
+
+const std::size_t kWordBitNum = sizeof(WordT) << 3;
+
+/**
+ * set bit (i - begin) of @p words if @c lower <= data[i] <= upper,
+ * for i in [begin, end), @p begin must be a multiple of kWordBitNum,
+ * and @p words should be zero-filled.
+ * @return the number of values matched
+ */
+template <typename T>
+inline std::size_t scanRangeScalar(
+    const T* data,
+    std::size_t begin,
+    std::size_t end,
+    T lower,
+    T upper,
+    WordT* words)
+{
+    std::size_t matchNum = 0;
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        if (lower <= data[i] && data[i] <= upper)
+        {
+            const std::size_t bit = i - begin;
+            words[bit / kWordBitNum] |= WordT(1) << (bit % kWordBitNum);
+            ++matchNum;
+        }
+    }
+    return matchNum;
+}
+
+/**
+ * the SIMD kernel for one word, that is kWordBitNum values from @p data,
+ * the generic version falls back to the scalar loop.
+ */
+template <typename T>
+struct WordKernel
+{
+    static WordT scan(const T* data, T lower, T upper)
+    {
+        WordT word = 0;
+        for (std::size_t i = 0; i < kWordBitNum; ++i)
+        {
+            if (lower <= data[i] && data[i] <= upper)
+                word |= WordT(1) << i;
+        }
+        return word;
+    }
+};
+
+#if defined(__AVX2__)
+
+template <>
+struct WordKernel<int32_t>
+{
+    static WordT scan(const int32_t* data, int32_t lower, int32_t upper)
+    {
+        const __m256i lo = _mm256_set1_epi32(lower);
+        const __m256i hi = _mm256_set1_epi32(upper);
+        WordT word = 0;
+        for (std::size_t i = 0; i < kWordBitNum; i += 8)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            // out of range if v < lower or v > upper
+            __m256i out = _mm256_or_si256(_mm256_cmpgt_epi32(lo, v),
+                                          _mm256_cmpgt_epi32(v, hi));
+            WordT mask = _mm256_movemask_ps(_mm256_castsi256_ps(out));
+            word |= (~mask & 0xFF) << i;
+        }
+        return word;
+    }
+};
+
+template <>
+struct WordKernel<int64_t>
+{
+    static WordT scan(const int64_t* data, int64_t lower, int64_t upper)
+    {
+        const __m256i lo = _mm256_set1_epi64x(lower);
+        const __m256i hi = _mm256_set1_epi64x(upper);
+        WordT word = 0;
+        for (std::size_t i = 0; i < kWordBitNum; i += 4)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            __m256i out = _mm256_or_si256(_mm256_cmpgt_epi64(lo, v),
+                                          _mm256_cmpgt_epi64(v, hi));
+            WordT mask = _mm256_movemask_pd(_mm256_castsi256_pd(out));
+            word |= (~mask & 0xF) << i;
+        }
+        return word;
+    }
+};
+
+template <>
+struct WordKernel<float>
+{
+    static WordT scan(const float* data, float lower, float upper)
+    {
+        const __m256 lo = _mm256_set1_ps(lower);
+        const __m256 hi = _mm256_set1_ps(upper);
+        WordT word = 0;
+        for (std::size_t i = 0; i < kWordBitNum; i += 8)
+        {
+            __m256 v = _mm256_loadu_ps(data + i);
+            __m256 in = _mm256_and_ps(_mm256_cmp_ps(v, lo, _CMP_GE_OQ),
+                                      _mm256_cmp_ps(v, hi, _CMP_LE_OQ));
+            word |= WordT(_mm256_movemask_ps(in)) << i;
+        }
+        return word;
+    }
+};
+
+template <>
+struct WordKernel<double>
+{
+    static WordT scan(const double* data, double lower, double upper)
+    {
+        const __m256d lo = _mm256_set1_pd(lower);
+        const __m256d hi = _mm256_set1_pd(upper);
+        WordT word = 0;
+        for (std::size_t i = 0; i < kWordBitNum; i += 4)
+        {
+            __m256d v = _mm256_loadu_pd(data + i);
+            __m256d in = _mm256_and_pd(_mm256_cmp_pd(v, lo, _CMP_GE_OQ),
+                                       _mm256_cmp_pd(v, hi, _CMP_LE_OQ));
+            word |= WordT(_mm256_movemask_pd(in)) << i;
+        }
+        return word;
+    }
+};
+
+#elif defined(__SSE2__)
+
+template <>
+struct WordKernel<int32_t>
+{
+    static WordT scan(const int32_t* data, int32_t lower, int32_t upper)
+    {
+        const __m128i lo = _mm_set1_epi32(lower);
+        const __m128i hi = _mm_set1_epi32(upper);
+        WordT word = 0;
+        for (std::size_t i = 0; i < kWordBitNum; i += 4)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            __m128i out = _mm_or_si128(_mm_cmpgt_epi32(lo, v),
+                                       _mm_cmpgt_epi32(v, hi));
+            WordT mask = _mm_movemask_ps(_mm_castsi128_ps(out));
+            word |= (~mask & 0xF) << i;
+        }
+        return word;
+    }
+};
+
+template <>
+struct WordKernel<float>
+{
+    static WordT scan(const float* data, float lower, float upper)
+    {
+        const __m128 lo = _mm_set1_ps(lower);
+        const __m128 hi = _mm_set1_ps(upper);
+        WordT word = 0;
+        for (std::size_t i = 0; i < kWordBitNum; i += 4)
+        {
+            __m128 v = _mm_loadu_ps(data + i);
+            __m128 in = _mm_and_ps(_mm_cmpge_ps(v, lo), _mm_cmple_ps(v, hi));
+            word |= WordT(_mm_movemask_ps(in)) << i;
+        }
+        return word;
+    }
+};
+
+template <>
+struct WordKernel<double>
+{
+    static WordT scan(const double* data, double lower, double upper)
+    {
+        const __m128d lo = _mm_set1_pd(lower);
+        const __m128d hi = _mm_set1_pd(upper);
+        WordT word = 0;
+        for (std::size_t i = 0; i < kWordBitNum; i += 2)
+        {
+            __m128d v = _mm_loadu_pd(data + i);
+            __m128d in = _mm_and_pd(_mm_cmpge_pd(v, lo), _mm_cmple_pd(v, hi));
+            word |= WordT(_mm_movemask_pd(in)) << i;
+        }
+        return word;
+    }
+};
+
+#endif
+
+/**
+ * convert the bounds given as double to the inclusive bounds of type T.
+ */
+template <typename T, bool isInteger = std::numeric_limits<T>::is_integer>
+struct BoundConverter
+{
+    /// @return false if no T value is greater than (or equal to) @p x
+    static bool lower(double x, bool inclusive, T& out)
+    {
+        const double maxValue = static_cast<double>(std::numeric_limits<T>::max());
+        const double minValue = static_cast<double>(std::numeric_limits<T>::min());
+
+        double c = std::ceil(x);
+        if (!inclusive && c == x)
+            c += 1;
+
+        if (c > maxValue)
+            return false;
+
+        out = c <= minValue ? std::numeric_limits<T>::min() :
+              c == maxValue ? std::numeric_limits<T>::max() : static_cast<T>(c);
+        return true;
+    }
+
+    /// @return false if no T value is less than (or equal to) @p x
+    static bool upper(double x, bool inclusive, T& out)
+    {
+        const double maxValue = static_cast<double>(std::numeric_limits<T>::max());
+        const double minValue = static_cast<double>(std::numeric_limits<T>::min());
+
+        double f = std::floor(x);
+        if (!inclusive && f == x)
+            f -= 1;
+
+        if (f < minValue)
+            return false;
+
+        out = f >= maxValue ? std::numeric_limits<T>::max() :
+              f == minValue ? std::numeric_limits<T>::min() : static_cast<T>(f);
+        return true;
+    }
+
+    static T prev(T x) { return x - 1; }
+
+    static T next(T x) { return x + 1; }
+};
+
+template <typename T>
+struct BoundConverter<T, false>
+{
+    static bool lower(double x, bool inclusive, T& out)
+    {
+        out = static_cast<T>(x);
+        if (!inclusive)
+            out = std::nextafter(out, std::numeric_limits<T>::infinity());
+        return true;
+    }
+
+    static bool upper(double x, bool inclusive, T& out)
+    {
+        out = static_cast<T>(x);
+        if (!inclusive)
+            out = std::nextafter(out, -std::numeric_limits<T>::infinity());
+
+        // the values stored are always finite
+        if (out > std::numeric_limits<T>::max())
+            out = std::numeric_limits<T>::max();
+        return true;
+    }
+
+    static T prev(T x)
+    {
+        return std::nextafter(x, -std::numeric_limits<T>::infinity());
+    }
+
+    static T next(T x)
+    {
+        return std::nextafter(x, std::numeric_limits<T>::infinity());
+    }
+};
+
+/**
+ * convert the range given as double to the inclusive range [lower, upper]
+ * of type T, which excludes @p invalidValue.
+ * @return false if the range could not be represented in this way,
+ *         such as the @p invalidValue lies inside the range.
+ */
+template <typename T>
+inline bool toInclusiveRange(
+    double lowerBound,
+    bool includeLower,
+    double upperBound,
+    bool includeUpper,
+    T invalidValue,
+    T& lower,
+    T& upper)
+{
+    if (!BoundConverter<T>::lower(lowerBound, includeLower, lower) ||
+        !BoundConverter<T>::upper(upperBound, includeUpper, upper))
+    {
+        // an empty range
+        lower = 1;
+        upper = 0;
+        return true;
+    }
+
+    if (invalidValue < lower || upper < invalidValue)
+        return true;
+
+    if (invalidValue == upper && lower < upper)
+    {
+        upper = BoundConverter<T>::prev(upper);
+        return true;
+    }
+
+    if (invalidValue == lower && lower < upper)
+    {
+        lower = BoundConverter<T>::next(lower);
+        return true;
+    }
+
+    if (lower == upper)
+    {
+        lower = 1;
+        upper = 0;
+        return true;
+    }
+
+    return false;
+}
+
+inline std::size_t popCount(WordT word)
+{
+    return __builtin_popcountll(word);
+}
+
+/**
+ * set bit i of @p words if @c lower <= data[i] <= upper, for i in [0, num),
+ * @p words should have at least round_up(num / kWordBitNum) elements,
+ * which are zero-filled.
+ * @return the number of values matched
+ */
+template <typename T>
+inline std::size_t scanRange(
+    const T* data,
+    std::size_t num,
+    T lower,
+    T upper,
+    WordT* words)
+{
+    if (upper < lower)
+        return 0;
+
+    const std::size_t fullWordNum = num / kWordBitNum;
+    std::size_t matchNum = 0;
+
+    for (std::size_t w = 0; w < fullWordNum; ++w)
+    {
+        WordT word = WordKernel<T>::scan(data + w * kWordBitNum, lower, upper);
+        words[w] = word;
+        matchNum += popCount(word);
+    }
+
+    matchNum += scanRangeScalar(data, fullWordNum * kWordBitNum, num,
+                                lower, upper, words + fullWordNum);
+    return matchNum;
+}
+
+} // namespace column_scan
+} // namespace sf1r
+
+#endif // SF1R_NUMERIC_COLUMN_SCAN_H
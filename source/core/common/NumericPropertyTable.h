@@ -2,6 +2,8 @@
 #define SF1R_COMMON_NUMERIC_PROPERTY_TABLE_H
 
 #include "NumericPropertyTableBase.h"
+#include "NumericColumnScan.h"
+#include "MappedNumericColumn.h"
 #include <util/modp_numtoa.h>
 
 #include <boost/lexical_cast.hpp>
@@ -87,11 +89,15 @@ public:
     {
     }
 
+    /**
+     * the values in file are mapped instead of being read, so that the
+     * table is available at once.
+     */
     void init(const std::string& path)
     {
+        ScopedWriteLock lock(mutex_);
         path_ = path;
-        std::ifstream ifs(path_.c_str());
-        if (ifs) load_(ifs);
+        data_.open(path_);
     }
 
     void resize(std::size_t size)
@@ -106,14 +112,17 @@ public:
         return data_.size();
     }
 
+    /**
+     * only the modified values and the values appended are written.
+     */
     void flush()
     {
         if (!dirty_) return;
         dirty_ = false;
-        std::vector<T>(data_).swap(data_);
+        ScopedWriteLock lock(mutex_);
+        data_.shrink();
         if (path_.empty()) return;
-        std::ofstream ofs(path_.c_str());
-        if (ofs) save_(ofs);
+        data_.save(path_);
     }
 
     bool isValid(std::size_t pos, bool isLock) const
@@ -193,10 +202,9 @@ public:
     {
         ScopedReadBoolLock lock(mutex_, isLock);
 
-        typename std::vector<T>::const_iterator minIter = std::min_element(
-            data_.begin(), data_.end(), InvalidGreat<T>(invalidValue_));
+        const T* minIter = findExtreme_(InvalidGreat<T>(invalidValue_));
 
-        if (minIter == data_.end() || *minIter == invalidValue_)
+        if (minIter == NULL || *minIter == invalidValue_)
             return false;
 
         minValue = static_cast<float>(*minIter);
@@ -207,10 +215,9 @@ public:
     {
         ScopedReadBoolLock lock(mutex_, isLock);
 
-        typename std::vector<T>::const_iterator maxIter = std::max_element(
-            data_.begin(), data_.end(), InvalidLess<T>(invalidValue_));
+        const T* maxIter = findExtreme_(InvalidLess<T>(invalidValue_), true);
 
-        if (maxIter == data_.end() || *maxIter == invalidValue_)
+        if (maxIter == NULL || *maxIter == invalidValue_)
             return false;
 
         maxValue = static_cast<float>(*maxIter);
@@ -227,19 +234,17 @@ public:
         return true;
     }
 
+    /**
+     * @return NULL if the values appended are not flushed yet, as they are
+     *         not contiguous with the values mapped.
+     */
     void* getValueList()
     {
-        if (!data_.empty())
-            return static_cast<void*>(&data_[0]);
-        else
-            return NULL;
+        return static_cast<void*>(data_.data());
     }
     const void* getValueList() const
     {
-        if (!data_.empty())
-            return static_cast<const void*>(&data_[0]);
-        else
-            return NULL;
+        return static_cast<const void*>(data_.data());
     }
 
     void setInt32Value(std::size_t pos, const int32_t& value)
@@ -252,7 +257,7 @@ public:
         }
 
         ScopedReadBoolLock lock(mutex_, true);
-        data_[pos] = static_cast<T>(value);
+        data_.set(pos, static_cast<T>(value));
         dirty_ = true;
     }
     void setFloatValue(std::size_t pos, const float& value)
@@ -265,7 +270,7 @@ public:
         }
 
         ScopedReadBoolLock lock(mutex_, true);
-        data_[pos] = static_cast<T>(value);
+        data_.set(pos, static_cast<T>(value));
         dirty_ = true;
     }
     void setInt64Value(std::size_t pos, const int64_t& value)
@@ -278,7 +283,7 @@ public:
         }
 
         ScopedReadBoolLock lock(mutex_, true);
-        data_[pos] = static_cast<T>(value);
+        data_.set(pos, static_cast<T>(value));
         dirty_ = true;
     }
     void setDoubleValue(std::size_t pos, const double& value)
@@ -291,7 +296,7 @@ public:
         }
 
         ScopedReadBoolLock lock(mutex_, true);
-        data_[pos] = static_cast<T>(value);
+        data_.set(pos, static_cast<T>(value));
         dirty_ = true;
     }
     bool setStringValue(std::size_t pos, const std::string& value)
@@ -306,7 +311,7 @@ public:
         ScopedReadBoolLock lock(mutex_, true);
         try
         {
-            data_[pos] = boost::lexical_cast<T>(value);
+            data_.set(pos, boost::lexical_cast<T>(value));
             dirty_ = true;
         }
         catch (const boost::bad_lexical_cast &)
@@ -326,7 +331,7 @@ public:
         }
 
         ScopedReadBoolLock lock(mutex_, true);
-        data_[pos] = value;
+        data_.set(pos, value);
         dirty_ = true;
     }
 
@@ -339,7 +344,7 @@ public:
         if (to >= data_.size())
             data_.resize(to + 1, invalidValue_);
 
-        data_[to] = data_[from];
+        data_.set(to, data_[from]);
         dirty_ = true;
     }
 
@@ -355,39 +360,95 @@ public:
         return 0;
     }
 
+    bool scanRange(
+        double lower, bool includeLower,
+        double upper, bool includeUpper,
+        std::vector<uint64_t>& words,
+        std::size_t& matchNum,
+        bool isLock = true) const
+    {
+        T lowerValue, upperValue;
+        if (!column_scan::toInclusiveRange(lower, includeLower,
+                                           upper, includeUpper,
+                                           invalidValue_,
+                                           lowerValue, upperValue))
+        {
+            return false;
+        }
+
+        ScopedReadBoolLock lock(mutex_, isLock);
+        const std::size_t num = data_.size();
+        words.assign((num + column_scan::kWordBitNum - 1) / column_scan::kWordBitNum, 0);
+        matchNum = 0;
+
+        const std::size_t baseNum = data_.baseSize();
+        if (baseNum > 0)
+        {
+            matchNum = column_scan::scanRange(data_.baseData(), baseNum,
+                                              lowerValue, upperValue,
+                                              &words[0]);
+        }
+
+        // the values appended are not aligned to words
+        const T* delta = data_.deltaData();
+        for (std::size_t i = 0; i < data_.deltaSize(); ++i)
+        {
+            if (lowerValue <= delta[i] && delta[i] <= upperValue)
+            {
+                const std::size_t bit = baseNum + i;
+                words[bit / column_scan::kWordBitNum] |=
+                    column_scan::WordT(1) << (bit % column_scan::kWordBitNum);
+                ++matchNum;
+            }
+        }
+        return true;
+    }
+
     void clearValue(std::size_t pos)
     {
         ScopedWriteLock lock(mutex_);
         if (pos < data_.size())
         {
-            data_[pos] = invalidValue_;
+            data_.set(pos, invalidValue_);
             dirty_ = true;
         }
     }
 
 protected:
-    void load_(std::istream& is)
-    {
-        ScopedWriteLock lock(mutex_);
-        std::size_t len = 0;
-        is.read((char*)&len, sizeof(len));
-        data_.resize(len);
-        is.read((char*)&data_[0], sizeof(T) * len);
-    }
+    /**
+     * @return the first element in both the values mapped and appended,
+     *         which is not ordered after any other one by @p comp,
+     *         or the last such element if @p isLast is true.
+     */
+    template <class Compare>
+    const T* findExtreme_(Compare comp, bool isLast = false) const
+    {
+        const T* result = NULL;
+        const T* segments[2] = {data_.baseData(), data_.deltaData()};
+        const std::size_t sizes[2] = {data_.baseSize(), data_.deltaSize()};
+
+        for (int i = 0; i < 2; ++i)
+        {
+            if (sizes[i] == 0)
+                continue;
 
-    void save_(std::ostream& os) const
-    {
-        ScopedReadLock lock(mutex_);
-        std::size_t len = data_.size();
-        os.write((const char*)&len, sizeof(len));
-        os.write((const char*)&data_[0], sizeof(T) * len);
+            const T* end = segments[i] + sizes[i];
+            const T* it = isLast ? std::max_element(segments[i], end, comp) :
+                                   std::min_element(segments[i], end, comp);
+
+            if (result == NULL || (isLast ? !comp(*it, *result) : comp(*it, *result)))
+            {
+                result = it;
+            }
+        }
+        return result;
     }
 
 protected:
     bool dirty_;
     T invalidValue_;
     std::string path_;
-    std::vector<T> data_;
+    MappedNumericColumn<T> data_;
 };
 
 template <>
@@ -453,9 +514,10 @@ inline bool NumericPropertyTable<int8_t>::setStringValue(std::size_t pos, const
             data_.resize(pos + 1, invalidValue_);
     }
 
+    ScopedReadBoolLock lock(mutex_, true);
     try
     {
-        data_[pos] = boost::numeric_cast<int8_t>(boost::lexical_cast<int32_t>(value));
+        data_.set(pos, boost::numeric_cast<int8_t>(boost::lexical_cast<int32_t>(value)));
         dirty_ = true;
     }
     catch (const boost::bad_lexical_cast &)
@@ -4,6 +4,7 @@
 #include "type_defs.h"
 #include "PropSharedLock.h"
 #include <boost/thread/shared_mutex.hpp>
+#include <vector>
 
 namespace sf1r
 {
@@ -53,6 +54,20 @@ public:
 
     virtual void copyValue(std::size_t from, std::size_t to) = 0;
     virtual int compareValues(std::size_t lhs, std::size_t rhs, bool isLock = true) const = 0;
+
+    /**
+     * scan the whole column, set bit i of @p words if value i is valid and
+     * lies in the range from @p lower to @p upper, each bound is excluded
+     * if @p includeLower or @p includeUpper is false.
+     * @param matchNum the number of values matched
+     * @return false if the range could not be evaluated by column scan
+     */
+    virtual bool scanRange(
+        double lower, bool includeLower,
+        double upper, bool includeUpper,
+        std::vector<uint64_t>& words,
+        std::size_t& matchNum,
+        bool isLock = true) const { return false; }
     virtual void clearValue(std::size_t pos) = 0;
 
 protected:
@@ -13,7 +13,10 @@
 #include <memory.h>
 #include <vector>
 #include <limits>
+#include <map>
+#include <algorithm>
 #include <glog/logging.h>
+#include <boost/next_prior.hpp>
 
 #include "PropSharedLock.h"
 
@@ -22,19 +25,53 @@
 namespace sf1r
 {
 
+/**
+ * When sorting is enabled, each doc's value is represented by its ordinal
+ * in the sorted dictionary of distinct values, so that the docs are
+ * compared by integers. The ordinals are assigned with gaps, so that a
+ * new value is inserted between its neighbours. When there is no gap left,
+ * only the values in the smallest enclosing ordinal range that is sparse
+ * enough are reassigned, which keeps the clustered inserts cheap.
+ *
+ * The docs keep the id of their value instead of its ordinal, so the
+ * ordinals are reassigned without touching the docs.
+ */
 class RTypeStringPropTable : public PropSharedLock
 {
-    typedef std::vector<std::string> RTypeVector;
+public:
+    typedef uint32_t ordinal_t;
+
+    /// the ordinal of the docs without value
+    enum { kInvalidOrdinal = 0 };
+
+private:
+    /// the id of each distinct value, 0 for no value
+    typedef uint32_t valueid_t;
+
+    enum { kInvalidValueId = 0 };
+
+    /// mapping from the distinct value to its id
+    typedef std::map<std::string, valueid_t> ValueMap;
+
+    /// the value id of each doc
+    typedef std::vector<valueid_t> ValueIdTable;
+
+    enum { kOrdinalBitNum = 32 };
+
+    /// how much sparser each ordinal range must be than the half of it
+    /// to reassign the values in it, in percentage
+    enum { kRelabelDensityPercent = 120 };
+
 public:
     RTypeStringPropTable(PropertyDataType type)
         : type_(type)
         , data_(new Lux::IO::Array(Lux::IO::NONCLUSTER))
         , sortEnabled_(false)
         , maxDocId_(0)
-        , invalidValue_("")
     {
         data_->set_noncluster_params(Lux::IO::Linked);
         data_->set_lock_type(Lux::IO::LOCK_THREAD);
+        clearValues_();
     }
 
     ~RTypeStringPropTable()
@@ -61,7 +98,7 @@ public:
 
     void enableSort()
     {
-        ScopedWriteBoolLock(mutex_, true);
+        ScopedWriteLock lock(mutex_);
         if (sortEnabled_)
             return;
         sortEnabled_ = true;
@@ -140,6 +177,14 @@ public:
 
     bool delRTypeString(const unsigned int docId)
     {
+        {
+            ScopedWriteLock lock(mutex_);
+            if (docId < valueIds_.size())
+            {
+                releaseValue_(valueIds_[docId]);
+                valueIds_[docId] = kInvalidValueId;
+            }
+        }
         return data_->del(docId);
     }
 
@@ -153,11 +198,13 @@ public:
             ScopedWriteBoolLock lock(mutex_, true);
             if (sortEnabled_)
             {
-                if (docId >= dataInMem_.size())
+                if (docId >= valueIds_.size())
                 {
-                    dataInMem_.resize(docId+1, invalidValue_);
+                    valueIds_.resize(docId+1, kInvalidValueId);
                 }
-                dataInMem_[docId]=rtype_value;
+                const valueid_t oldId = valueIds_[docId];
+                valueIds_[docId] = acquireValue_(rtype_value);
+                releaseValue_(oldId);
             }
             if (docId > maxDocId_)
             {
@@ -187,36 +234,257 @@ public:
         {
             return -1;
         }
-        const std::string lv = dataInMem_[lhs];
-        if (lv == invalidValue_) return -1;
-        const std::string rv = dataInMem_[rhs];
-        if (rv == invalidValue_) return 1;
+        const ordinal_t lv = valueOrdinals_[valueIds_[lhs]];
+        if (lv == kInvalidOrdinal) return -1;
+        const ordinal_t rv = valueOrdinals_[valueIds_[rhs]];
+        if (rv == kInvalidOrdinal) return 1;
         if (lv < rv ) return -1;
         if (lv > rv ) return 1;
         return 0;
     }
+
+    /**
+     * the number of distinct values used by the docs.
+     */
+    std::size_t dictSize() const
+    {
+        return valueMap_.size();
+    }
+
 private:
+    /**
+     * load the values, first each distinct value is given an id in the
+     * order of docs, then the ordinals are assigned in the order of values.
+     */
     void load_()
     {
-        dataInMem_.clear();
-        dataInMem_.resize(maxDocId_+1, invalidValue_);
+        clearValues_();
+        ValueIdTable(maxDocId_+1, kInvalidValueId).swap(valueIds_);
+
         for (unsigned int docId = 0; docId <= maxDocId_; ++docId)
         {
             std::string value;
             if (getRTypeString(docId, value))
             {
-                dataInMem_[docId]=value;
+                valueIds_[docId] = addValue_(value);
+            }
+        }
+
+        assignOrdinals_(valueMap_.begin(), valueMap_.end(),
+                        kInvalidOrdinal, getOrdinalStep_(valueMap_.size()));
+
+        LOG(INFO) << "loaded sort ordinals of " << path_
+                  << ", doc num: " << valueIds_.size()
+                  << ", distinct value num: " << valueMap_.size();
+    }
+
+    void clearValues_()
+    {
+        valueMap_.clear();
+        valueIters_.assign(1, valueMap_.end());
+        valueOrdinals_.assign(1, kInvalidOrdinal);
+        useCounts_.assign(1, 0);
+        freeIds_.clear();
+    }
+
+    /**
+     * add @p value if it is new, and increase its use count.
+     * @return the value id
+     */
+    valueid_t addValue_(const std::string& value)
+    {
+        ValueMap::iterator it = valueMap_.lower_bound(value);
+        if (it != valueMap_.end() && it->first == value)
+        {
+            ++useCounts_[it->second];
+            return it->second;
+        }
+
+        valueid_t id = valueIters_.size();
+        if (freeIds_.empty())
+        {
+            valueIters_.push_back(valueMap_.end());
+            valueOrdinals_.push_back(kInvalidOrdinal);
+            useCounts_.push_back(0);
+        }
+        else
+        {
+            id = freeIds_.back();
+            freeIds_.pop_back();
+        }
+
+        it = valueMap_.insert(it, ValueMap::value_type(value, id));
+        valueIters_[id] = it;
+        valueOrdinals_[id] = kInvalidOrdinal;
+        useCounts_[id] = 1;
+        return id;
+    }
+
+    /**
+     * add @p value, if it is new, it is given an ordinal between its
+     * neighbours.
+     * @return the value id
+     */
+    valueid_t acquireValue_(const std::string& value)
+    {
+        const valueid_t id = addValue_(value);
+        if (useCounts_[id] > 1)
+            return id;
+
+        const ValueMap::iterator it = valueIters_[id];
+        const uint64_t prevOrdinal = (it == valueMap_.begin()) ?
+            kInvalidOrdinal : getOrdinal_(boost::prior(it));
+        const ValueMap::iterator next = boost::next(it);
+        uint64_t ordinal = prevOrdinal;
+
+        if (next == valueMap_.end())
+        {
+            // leave the same gap for the values appended in order
+            const uint64_t room = std::numeric_limits<ordinal_t>::max() - prevOrdinal;
+            ordinal += std::min<uint64_t>(getOrdinalStep_(valueMap_.size()), room / 2);
+        }
+        else
+        {
+            ordinal += (getOrdinal_(next) - prevOrdinal) / 2;
+        }
+
+        if (ordinal == prevOrdinal)
+        {
+            relabel_(it, prevOrdinal);
+        }
+        else
+        {
+            valueOrdinals_[id] = ordinal;
+        }
+        return id;
+    }
+
+    /**
+     * decrease the use count of value @p id, the value is removed when it
+     * is not used by any doc, so that its ordinal is free for reuse.
+     */
+    void releaseValue_(valueid_t id)
+    {
+        if (id == kInvalidValueId || --useCounts_[id] > 0)
+            return;
+
+        valueMap_.erase(valueIters_[id]);
+        valueIters_[id] = valueMap_.end();
+        valueOrdinals_[id] = kInvalidOrdinal;
+        freeIds_.push_back(id);
+    }
+
+    ordinal_t getOrdinal_(ValueMap::const_iterator it) const
+    {
+        return valueOrdinals_[it->second];
+    }
+
+    /**
+     * give the new value @p it an ordinal, when there is no gap after
+     * @p prevOrdinal.
+     *
+     * The ordinal ranges containing @p prevOrdinal are tried from the
+     * smallest one, each range is twice as large as the previous one, and
+     * it must be sparser by @c kRelabelDensityPercent. The values in the first
+     * range sparse enough are reassigned evenly in it. In this way, the
+     * amortized number of values reassigned for each insert is O(log^2 n).
+     * The values are all reassigned if none of the ranges is sparse enough.
+     */
+    void relabel_(ValueMap::iterator it, uint64_t prevOrdinal)
+    {
+        ValueMap::iterator first = it;
+        ValueMap::iterator last = boost::next(it);
+        std::size_t count = 1;
+        double threshold = 1;
+
+        for (int level = 1; level <= kOrdinalBitNum; ++level)
+        {
+            const uint64_t lower = std::max<uint64_t>(
+                (prevOrdinal >> level) << level, kInvalidOrdinal + 1);
+            const uint64_t upper = std::min<uint64_t>(
+                (((prevOrdinal >> level) + 1) << level) - 1,
+                std::numeric_limits<ordinal_t>::max());
+
+            while (first != valueMap_.begin() &&
+                   getOrdinal_(boost::prior(first)) >= lower)
+            {
+                --first;
+                ++count;
             }
+            while (last != valueMap_.end() &&
+                   getOrdinal_(last) <= upper)
+            {
+                ++last;
+                ++count;
+            }
+
+            const uint64_t span = upper - lower + 1;
+            threshold *= kRelabelDensityPercent / 100.0;
+            if (count * threshold < span)
+            {
+                assignOrdinals_(first, last, lower - 1, span / (count + 1));
+                return;
+            }
+        }
+
+        assignOrdinals_(valueMap_.begin(), valueMap_.end(),
+                        kInvalidOrdinal, getOrdinalStep_(valueMap_.size()));
+
+        LOG(INFO) << "rebuilt sort ordinals of " << path_
+                  << ", distinct value num: " << valueMap_.size();
+    }
+
+    /**
+     * assign the ordinals to the values in [@p first, @p last) one by one,
+     * starting from @p base + @p step.
+     */
+    void assignOrdinals_(
+        ValueMap::const_iterator first,
+        ValueMap::const_iterator last,
+        ordinal_t base,
+        ordinal_t step)
+    {
+        ordinal_t ordinal = base;
+        for (ValueMap::const_iterator it = first; it != last; ++it)
+        {
+            ordinal += step;
+            valueOrdinals_[it->second] = ordinal;
         }
     }
+
+    /**
+     * the gap between the neighbour ordinals when they are assigned,
+     * half of the ordinal space is left for the values appended.
+     */
+    static ordinal_t getOrdinalStep_(std::size_t valueNum)
+    {
+        const ordinal_t maxOrdinal = std::numeric_limits<ordinal_t>::max();
+        return std::max<ordinal_t>(maxOrdinal / 2 / (valueNum + 1), 1);
+    }
+
 protected:
     PropertyDataType type_;
     std::string path_;
     Lux::IO::Array* data_;
-    RTypeVector dataInMem_;
+    ValueMap valueMap_;
+
+    /// the value id of each doc
+    ValueIdTable valueIds_;
+
+    /// the position in @c valueMap_ of each value id
+    std::vector<ValueMap::iterator> valueIters_;
+
+    /// the ordinal of each value id
+    std::vector<ordinal_t> valueOrdinals_;
+
+    /// the number of docs using each value id
+    std::vector<uint32_t> useCounts_;
+
+    /// the ids of the values removed, for reuse
+    std::vector<valueid_t> freeIds_;
+
     bool sortEnabled_;
     unsigned int maxDocId_;
-    std::string invalidValue_;
 };
 
 }
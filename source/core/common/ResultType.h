@@ -92,7 +92,7 @@ public:
 
     KeywordSearchResult()
         : encodingType_(izenelib::util::UString::UTF_8)
-        , totalCount_(0), docsInPage_(0), topKDocs_(0), adCachedTopKDocs_(0)
+        , totalCount_(0), prunedCount_(0), docsInPage_(0), topKDocs_(0), adCachedTopKDocs_(0)
         , topKRankScoreList_(0), topKCustomRankScoreList_(0)
         , start_(0), count_(0)
         , timeStamp_(0), TOP_K_NUM(0)
@@ -121,6 +121,7 @@ public:
         }
         ss << endl;
         ss << "totalCount_        : " << totalCount_ << endl;
+        ss << "prunedCount_       : " << prunedCount_ << endl;
         ss << "docsInPage         : " << docsInPage_.size() << endl;
         ss << "topKDocs_          : " << topKDocs_.size() << endl;
         for (size_t i = 0; i < topKDocs_.size(); i ++)
@@ -272,9 +273,15 @@ public:
 
     std::vector<termid_t> queryTermIdList_;
 
-    /// Total number of result documents
+    /// Total number of result documents, when the doc iterator is pruned
+    /// by the top-K threshold, it is only a lower bound, as the skipped
+    /// docs are not counted
     std::size_t totalCount_;
 
+    /// Number of postings skipped by dynamic pruning, it is only used in
+    /// the local search log, so it is not serialized
+    std::size_t prunedCount_;
+
     std::map<std::string,uint32_t> counterResults_;
 
     std::vector<docid_t> docsInPage_;
@@ -422,6 +429,7 @@ public:
         analyzedQuery_.swap(other.analyzedQuery_);
         queryTermIdList_.swap(other.queryTermIdList_);
         swap(totalCount_, other.totalCount_);
+        swap(prunedCount_, other.prunedCount_);
         counterResults_.swap(other.counterResults_);
         docsInPage_.swap(other.docsInPage_);
         topKDocs_.swap(other.topKDocs_);
@@ -0,0 +1,504 @@
+#include "SearchCache.h"
+
+#include <util/izene_serialization.h>
+#include <glog/logging.h>
+#include <boost/bind.hpp>
+
+namespace sf1r
+{
+
+namespace
+{
+/// an entry is not cached if it takes more than 1/MIN_ENTRY_NUM of the
+/// max bytes, so that a few large results would not evict all the others
+const std::size_t MIN_ENTRY_NUM = 16;
+
+/// the threads to refresh the stale entries
+const std::size_t REFRESH_THREAD_NUM = 1;
+
+/// the max number of refreshing tasks waiting in queue
+const std::size_t MAX_PENDING_REFRESH = 64;
+
+/// the max seconds to wait for the result loaded by another request,
+/// after that, the request loads the result by itself
+const int MAX_LOADING_WAIT = 10;
+
+/// the bytes of each entry except the key and value
+const std::size_t ENTRY_OVERHEAD = 128;
+
+/// the bytes of each group or attribute item except its text
+const std::size_t REP_ITEM_OVERHEAD = 48;
+
+template <typename T>
+inline std::size_t vectorBytes(const std::vector<T>& v)
+{
+    return v.size() * sizeof(T);
+}
+
+inline std::size_t ustrBytes(const izenelib::util::UString& ustr)
+{
+    return ustr.length() * sizeof(izenelib::util::UString::CharT);
+}
+
+std::size_t repItemBytes(const std::list<faceted::OntologyRepItem>& items)
+{
+    std::size_t bytes = 0;
+    for (std::list<faceted::OntologyRepItem>::const_iterator it = items.begin();
+         it != items.end(); ++it)
+    {
+        bytes += REP_ITEM_OVERHEAD + ustrBytes(it->text);
+    }
+    return bytes;
+}
+
+/**
+ * estimate the bytes of @p value from its container sizes, it is cheaper
+ * than serializing the whole result on each insert.
+ * The summary texts are not counted, as they are kept out of cache.
+ */
+std::size_t estimateBytes(const KeywordSearchResult& value)
+{
+    std::size_t bytes = sizeof(KeywordSearchResult);
+
+    bytes += value.rawQueryString_.size();
+    bytes += value.pruneQueryString_.size();
+    bytes += value.collectionName_.size();
+    bytes += ustrBytes(value.analyzedQuery_);
+
+    bytes += vectorBytes(value.queryTermIdList_);
+    bytes += vectorBytes(value.docsInPage_);
+    bytes += vectorBytes(value.topKDocs_);
+    bytes += vectorBytes(value.adCachedTopKDocs_);
+    bytes += vectorBytes(value.topKWorkerIds_);
+    bytes += vectorBytes(value.topKtids_);
+    bytes += vectorBytes(value.topKRankScoreList_);
+    bytes += vectorBytes(value.topKCustomRankScoreList_);
+    bytes += vectorBytes(value.topKGeoDistanceList_);
+    bytes += vectorBytes(value.pageOffsetList_);
+    bytes += vectorBytes(value.numberOfDuplicatedDocs_);
+    bytes += vectorBytes(value.numberOfSimilarDocs_);
+    bytes += vectorBytes(value.rqScore_);
+
+    for (std::map<std::string, uint32_t>::const_iterator it = value.counterResults_.begin();
+         it != value.counterResults_.end(); ++it)
+    {
+        bytes += it->first.size() + sizeof(uint32_t);
+    }
+
+    for (std::size_t i = 0; i < value.propertyQueryTermList_.size(); ++i)
+    {
+        const std::vector<izenelib::util::UString>& terms = value.propertyQueryTermList_[i];
+        for (std::size_t j = 0; j < terms.size(); ++j)
+        {
+            bytes += ustrBytes(terms[j]);
+        }
+    }
+
+    for (std::size_t i = 0; i < value.docCategories_.size(); ++i)
+    {
+        const std::vector<PropertyValue::PropertyValueStrType>& categories = value.docCategories_[i];
+        for (std::size_t j = 0; j < categories.size(); ++j)
+        {
+            bytes += categories[j].size();
+        }
+    }
+
+    for (std::deque<izenelib::util::UString>::const_iterator it = value.relatedQueryList_.begin();
+         it != value.relatedQueryList_.end(); ++it)
+    {
+        bytes += ustrBytes(*it);
+    }
+
+    // the numeric groups have been converted into string groups by
+    // GroupRep::toOntologyRepItemList() in makeValue_()
+    bytes += repItemBytes(value.groupRep_.stringGroupRep_);
+    bytes += repItemBytes(value.attrRep_.item_list);
+
+    for (faceted::GroupParam::GroupLabelScoreMap::const_iterator it = value.autoSelectGroupLabels_.begin();
+         it != value.autoSelectGroupLabels_.end(); ++it)
+    {
+        bytes += it->first.size() + it->second.size() * REP_ITEM_OVERHEAD;
+    }
+
+    return bytes;
+}
+
+void copyValue(const KeywordSearchResult& value, KeywordSearchResult& result)
+{
+    KeywordSearchResult copy(value);
+    result.swap(copy);
+}
+}
+
+SearchCache::SearchCache(
+    unsigned cacheSize,
+    std::size_t maxBytes,
+    time_t refreshInterval,
+    bool refreshAll,
+    time_t staleInterval)
+    : maxNum_(cacheSize)
+    , maxBytes_(maxBytes)
+    , refreshInterval_(refreshInterval)
+    , refreshAll_(refreshAll)
+    , staleInterval_(staleInterval)
+    , generation_(0)
+    , generationTime_(std::time(NULL))
+    , hitCount_(0)
+    , staleHitCount_(0)
+    , missCount_(0)
+    , coalescedCount_(0)
+    , refreshPool_(staleInterval > 0 ? REFRESH_THREAD_NUM : 0)
+{
+}
+
+SearchCache::~SearchCache()
+{
+    waitRefresh();
+}
+
+bool SearchCache::get(const key_type& key, value_type& result)
+{
+    if (result.distSearchInfo_.nodeType_ == DistKeywordSearchInfo::NODE_WORKER)
+        return false;
+
+    value_ptr value;
+    if (find_(getStore_(key), key, makeKey_(key), value) != ENTRY_VALID)
+    {
+        ++missCount_;
+        return false;
+    }
+
+    ++hitCount_;
+    copyValue(*value, result);
+    return true;
+}
+
+bool SearchCache::get(
+    const key_type& key,
+    value_type& result,
+    const loader_type& loader,
+    bool& isCached)
+{
+    isCached = false;
+    if (result.distSearchInfo_.nodeType_ == DistKeywordSearchInfo::NODE_WORKER)
+        return loader(result);
+
+    Store& store = getStore_(key);
+    const std::string cacheKey = makeKey_(key);
+    value_ptr value;
+    const EntryState state = find_(store, key, cacheKey, value);
+
+    if (state == ENTRY_VALID)
+    {
+        ++hitCount_;
+        copyValue(*value, result);
+        isCached = true;
+        return true;
+    }
+
+    LoadingPtr loading;
+    {
+        boost::unique_lock<boost::mutex> lock(loadingMutex_);
+        LoadingMap::iterator it = loadingMap_.find(cacheKey);
+
+        if (state == ENTRY_STALE)
+        {
+            if (it == loadingMap_.end() &&
+                refreshPool_.pending() < MAX_PENDING_REFRESH)
+            {
+                loading.reset(new Loading);
+                loadingMap_[cacheKey] = loading;
+                refreshPool_.schedule(boost::bind(&SearchCache::refresh_, this,
+                                                  &store, cacheKey, loader, loading));
+            }
+        }
+        else if (it == loadingMap_.end())
+        {
+            loading.reset(new Loading);
+            loadingMap_[cacheKey] = loading;
+            lock.unlock();
+
+            return load_(store, cacheKey, loader, loading, result);
+        }
+        else
+        {
+            loading = it->second;
+            const boost::system_time timeout = boost::get_system_time() +
+                boost::posix_time::seconds(MAX_LOADING_WAIT);
+
+            while (!loading->isDone)
+            {
+                if (!loading->cond.timed_wait(lock, timeout))
+                    break;
+            }
+            value = loading->value;
+        }
+    }
+
+    if (state == ENTRY_STALE)
+    {
+        ++staleHitCount_;
+        copyValue(*value, result);
+        isCached = true;
+        return true;
+    }
+
+    if (value)
+    {
+        ++coalescedCount_;
+        copyValue(*value, result);
+        isCached = true;
+        return true;
+    }
+
+    // the other loading failed or timed out
+    ++missCount_;
+    return loader(result);
+}
+
+void SearchCache::set(const key_type& key, value_type& result)
+{
+    if (result.distSearchInfo_.nodeType_ == DistKeywordSearchInfo::NODE_WORKER)
+        return;
+
+    insert_(getStore_(key), makeKey_(key), makeValue_(result), generation_.load());
+}
+
+void SearchCache::nextGeneration()
+{
+    generationTime_ = std::time(NULL);
+    ++generation_;
+
+    LOG(INFO) << "the search cache is invalidated, hit: " << hitCount()
+              << ", stale hit: " << staleHitCount()
+              << ", miss: " << missCount()
+              << ", coalesced: " << coalescedCount();
+}
+
+void SearchCache::clear()
+{
+    Store* stores[] = {&store_, &specialStore_};
+    for (std::size_t i = 0; i < sizeof(stores) / sizeof(stores[0]); ++i)
+    {
+        boost::mutex::scoped_lock lock(stores[i]->mutex);
+        stores[i]->entries.clear();
+        stores[i]->entryMap.clear();
+        stores[i]->totalBytes = 0;
+    }
+}
+
+void SearchCache::waitRefresh()
+{
+    refreshPool_.wait();
+}
+
+std::string SearchCache::makeKey_(const key_type& key)
+{
+    char* buf = NULL;
+    std::size_t len = 0;
+    izenelib::util::izene_serialization<key_type> izs(key);
+    izs.write_image(buf, len);
+
+    return std::string(buf, len);
+}
+
+SearchCache::EntryState SearchCache::find_(
+    Store& store,
+    const key_type& key,
+    const std::string& cacheKey,
+    value_ptr& value)
+{
+    uint64_t generation = 0;
+    {
+        boost::mutex::scoped_lock lock(store.mutex);
+        Store::EntryMap::iterator it = store.entryMap.find(cacheKey);
+        if (it == store.entryMap.end())
+            return ENTRY_NOT_FOUND;
+
+        store.entries.splice(store.entries.begin(), store.entries, it->second);
+        value = it->second->value;
+        generation = it->second->generation;
+    }
+
+    std::time_t staleTime = 0;
+    if (generation != generation_.load())
+    {
+        staleTime = generationTime_.load();
+    }
+    else if (needRefresh_(key, value->timeStamp_))
+    {
+        staleTime = value->timeStamp_ + refreshInterval_;
+    }
+    else
+    {
+        return ENTRY_VALID;
+    }
+
+    if (staleInterval_ > 0 && std::time(NULL) - staleTime <= staleInterval_)
+        return ENTRY_STALE;
+
+    return ENTRY_NOT_FOUND;
+}
+
+SearchCache::value_ptr SearchCache::makeValue_(value_type& result)
+{
+    result.timeStamp_ = std::time(NULL);
+    result.groupRep_.toOntologyRepItemList();
+
+    // Temporarily store the summary results to keep them out of cache
+    std::vector<std::vector<PropertyValue::PropertyValueStrType> > fullText, snippetText, rawText;
+
+    fullText.swap(result.fullTextOfDocumentInPage_);
+    snippetText.swap(result.snippetTextOfDocumentInPage_);
+    rawText.swap(result.rawTextOfSummaryInPage_);
+
+    value_ptr value(new value_type(result));
+
+    fullText.swap(result.fullTextOfDocumentInPage_);
+    snippetText.swap(result.snippetTextOfDocumentInPage_);
+    rawText.swap(result.rawTextOfSummaryInPage_);
+
+    return value;
+}
+
+void SearchCache::insert_(
+    Store& store,
+    const std::string& key,
+    const value_ptr& value,
+    uint64_t generation)
+{
+    if (maxNum_ == 0)
+        return;
+
+    std::size_t bytes = key.size() + ENTRY_OVERHEAD;
+    if (maxBytes_ > 0)
+    {
+        bytes += estimateBytes(*value);
+
+        if (bytes > maxBytes_ / MIN_ENTRY_NUM)
+            return;
+    }
+
+    boost::mutex::scoped_lock lock(store.mutex);
+    Store::EntryMap::iterator it = store.entryMap.find(key);
+    if (it != store.entryMap.end())
+    {
+        store.totalBytes -= it->second->bytes;
+        store.entries.erase(it->second);
+        store.entryMap.erase(it);
+    }
+
+    evict_(store, maxNum_ - 1, maxBytes_ > 0 ? maxBytes_ - bytes : 0);
+
+    Entry entry;
+    entry.key = key;
+    entry.value = value;
+    entry.generation = generation;
+    entry.bytes = bytes;
+
+    store.entries.push_front(entry);
+    store.entryMap[key] = store.entries.begin();
+    store.totalBytes += bytes;
+}
+
+void SearchCache::evict_(Store& store, std::size_t num, std::size_t bytes)
+{
+    while (!store.entries.empty() &&
+           (store.entries.size() > num ||
+            (maxBytes_ > 0 && store.totalBytes > bytes)))
+    {
+        const Entry& entry = store.entries.back();
+        store.totalBytes -= entry.bytes;
+        store.entryMap.erase(entry.key);
+        store.entries.pop_back();
+    }
+}
+
+bool SearchCache::load_(
+    Store& store,
+    const std::string& key,
+    const loader_type& loader,
+    const LoadingPtr& loading,
+    value_type& result)
+{
+    ++missCount_;
+    const uint64_t generation = generation_.load();
+    bool isLoaded = false;
+
+    try
+    {
+        isLoaded = loader(result);
+    }
+    catch (...)
+    {
+        finishLoading_(key, loading, value_ptr());
+        throw;
+    }
+
+    value_ptr value;
+    if (isLoaded)
+    {
+        value = makeValue_(result);
+        insert_(store, key, value, generation);
+    }
+
+    finishLoading_(key, loading, value);
+    return isLoaded;
+}
+
+void SearchCache::refresh_(
+    Store* store,
+    const std::string& key,
+    loader_type loader,
+    LoadingPtr loading)
+{
+    const uint64_t generation = generation_.load();
+    value_type result;
+    value_ptr value;
+
+    try
+    {
+        if (loader(result))
+        {
+            value = makeValue_(result);
+            insert_(*store, key, value, generation);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        LOG(ERROR) << "exception in refreshing search cache: " << e.what();
+    }
+
+    finishLoading_(key, loading, value);
+}
+
+void SearchCache::finishLoading_(
+    const std::string& key,
+    const LoadingPtr& loading,
+    const value_ptr& value)
+{
+    boost::mutex::scoped_lock lock(loadingMutex_);
+
+    loading->isDone = true;
+    loading->value = value;
+
+    LoadingMap::iterator it = loadingMap_.find(key);
+    if (it != loadingMap_.end() && it->second == loading)
+    {
+        loadingMap_.erase(it);
+    }
+
+    loading->cond.notify_all();
+}
+
+bool SearchCache::needRefresh_(const key_type& key, const std::time_t& timestamp) const
+{
+    bool check = refreshAll_ || key.isRandomRank;
+
+    if (check)
+        return (std::time(NULL) - timestamp) > refreshInterval_;
+    else
+        return false;
+}
+
+} // namespace sf1r
@@ -5,15 +5,36 @@
  * @author Ian Yang
  * @date Created <2009-09-30 09:31:29>
  * @date Updated <2010-03-24 15:43:04>
+ * @date Updated <2013-07-29> invalidate the entries by index generation,
+ *       serve the stale entries while they are refreshed in background,
+ *       coalesce the concurrent misses, and bound the cache by bytes.
+ *
+ * When the index is updated, nextGeneration() makes all the entries stale
+ * instead of removing them. If the stale interval is configured, a stale
+ * entry is still returned in that interval after the update, and only one
+ * background task reloads it. The concurrent misses of the same key wait
+ * for the first one to load the result.
+ *
+ * The size of each entry is estimated from its container sizes, the least
+ * recently used entries are evicted when either the entry number or the
+ * total bytes exceeds the limit.
  */
 #include "ResultType.h" // KeywordSearchResult
 #include <query-manager/QueryIdentity.h>
 #include <mining-manager/group-manager/ontology_rep.h>
-#include <cache/IzeneCache.h>
-#include <cache/concurrent_cache.hpp>
 
-#include <vector>
-#include <deque>
+#include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/threadpool.hpp>
+
+#include <string>
+#include <list>
+#include <ctime>
 
 namespace sf1r
 {
@@ -23,113 +44,213 @@ class SearchCache
 public:
     typedef QueryIdentity key_type;
     typedef KeywordSearchResult value_type;
-    //typedef izenelib::cache::IzeneCache<
-    //    key_type,
-    //    value_type,
-    //    izenelib::util::ReadWriteLock,
-    //    izenelib::cache::RDE_HASH,
-    //    izenelib::cache::LRLFU
-    //> cache_type;
-    typedef izenelib::concurrent_cache::ConcurrentCache<key_type, value_type> cache_type;
-
-    explicit SearchCache(unsigned cacheSize, time_t refreshInterval = 60*60, bool refreshAll = false)
-        : cache_(cacheSize, izenelib::cache::LRLFU), special_cache_(cacheSize, izenelib::cache::LRLFU)
-        , refreshInterval_(refreshInterval)
-        , refreshAll_(refreshAll)
-    {
-    }
 
     /**
-     * Cannot be \c const becuase \c IzeneCache::getValue is not const.
+     * load the result on cache miss.
+     * @return false if failed to load
+     */
+    typedef boost::function<bool(value_type&)> loader_type;
+
+    /**
+     * @param cacheSize the max number of entries
+     * @param maxBytes the max total bytes of entries, 0 for no limit
+     * @param refreshInterval the seconds an entry of random rank is valid
+     * @param refreshAll whether @p refreshInterval applies to all entries
+     * @param staleInterval the seconds a stale entry is still returned
+     *        while it is refreshed, 0 to never return stale entries
+     */
+    SearchCache(
+        unsigned cacheSize,
+        std::size_t maxBytes = 0,
+        time_t refreshInterval = 60*60,
+        bool refreshAll = false,
+        time_t staleInterval = 0);
+
+    ~SearchCache();
+
+    /**
+     * get the valid entry of @p key.
+     * @return true if found
+     */
+    bool get(const key_type& key, value_type& result);
+
+    /**
+     * get the entry of @p key, or call @p loader to load it on miss.
+     * @param isCached true if @p result is got from cache, the summary
+     *        texts are not included; false if it is loaded by @p loader,
+     *        it is also inserted into cache.
+     * @return false if @p loader fails
+     */
+    bool get(
+        const key_type& key,
+        value_type& result,
+        const loader_type& loader,
+        bool& isCached);
+
+    void set(const key_type& key, value_type& result);
+
+    /**
+     * make all the entries stale, it is called when the index is updated.
+     */
+    void nextGeneration();
+
+    /**
+     * remove all the entries.
      */
-    bool get(const key_type& key,
-             value_type& result)
+    void clear();
+
+    /**
+     * wait for the background refreshing tasks to finish.
+     */
+    void waitRefresh();
+
+    std::size_t hitCount() const { return hitCount_.load(); }
+
+    std::size_t staleHitCount() const { return staleHitCount_.load(); }
+
+    std::size_t missCount() const { return missCount_.load(); }
+
+    std::size_t coalescedCount() const { return coalescedCount_.load(); }
+
+private:
+    typedef boost::shared_ptr<const value_type> value_ptr;
+
+    struct Entry
     {
-        if (result.distSearchInfo_.nodeType_ == DistKeywordSearchInfo::NODE_WORKER)
-            return false;
-
-        value_type value;
-        cache_type* pcache = &cache_;
-        if (IsSpecialSearch(key))
-        {
-            pcache = &special_cache_;
-        }
-        if ((*pcache).get(key, value))
-        {
-            if (!needRefresh(key, value.timeStamp_))
-            {
-                result.swap(value);
-                return true;
-            }
-        }
-
-        return false;
-    }
+        std::string key;
+        value_ptr value;
+        uint64_t generation;
+        std::size_t bytes;
+    };
 
-    void set(const key_type& key,
-             value_type& result)
+    /**
+     * the entries in LRU order, the most recent one is at front.
+     */
+    struct Store
     {
-        if (result.distSearchInfo_.nodeType_ == DistKeywordSearchInfo::NODE_WORKER)
-            return;
+        typedef std::list<Entry> EntryList;
+        typedef boost::unordered_map<std::string, EntryList::iterator> EntryMap;
+
+        boost::mutex mutex;
+        EntryList entries;
+        EntryMap entryMap;
+        std::size_t totalBytes;
 
-        result.timeStamp_ = std::time(NULL);
-        result.groupRep_.toOntologyRepItemList();
+        Store() : totalBytes(0) {}
+    };
 
-        // Temporarily store the summary results to keep them out of cache
-        std::vector<std::vector<PropertyValue::PropertyValueStrType> > fullText, snippetText, rawText;
+    /**
+     * the loading of a key, its result is shared by the requests waiting
+     * for it.
+     */
+    struct Loading
+    {
+        boost::condition_variable cond;
+        bool isDone;
+        value_ptr value;
 
-        fullText.swap(result.fullTextOfDocumentInPage_);
-        snippetText.swap(result.snippetTextOfDocumentInPage_);
-        rawText.swap(result.rawTextOfSummaryInPage_);
-        cache_type* pcache = &cache_;
-        if (IsSpecialSearch(key))
-        {
-            pcache = &special_cache_;
-        }
+        Loading() : isDone(false) {}
+    };
+    typedef boost::shared_ptr<Loading> LoadingPtr;
+    typedef boost::unordered_map<std::string, LoadingPtr> LoadingMap;
 
-        (*pcache).insert(key, result);
+    enum EntryState
+    {
+        ENTRY_NOT_FOUND = 0,
+        ENTRY_VALID,
+        ENTRY_STALE
+    };
 
-        fullText.swap(result.fullTextOfDocumentInPage_);
-        snippetText.swap(result.snippetTextOfDocumentInPage_);
-        rawText.swap(result.rawTextOfSummaryInPage_);
-    }
+    static std::string makeKey_(const key_type& key);
 
-    void clear()
+    /**
+     * for the search which may consume a lot time, we treat it as special
+     * and cache in the special store.
+     */
+    Store& getStore_(const key_type& key)
     {
-        cache_.clear();
-        special_cache_.clear();
+        return key.query == "*" ? specialStore_ : store_;
     }
 
-private:
+    EntryState find_(
+        Store& store,
+        const key_type& key,
+        const std::string& cacheKey,
+        value_ptr& value);
+
+    /**
+     * the copy of @p result to cache, the summary texts are excluded.
+     */
+    value_ptr makeValue_(value_type& result);
+
+    void insert_(
+        Store& store,
+        const std::string& key,
+        const value_ptr& value,
+        uint64_t generation);
+
+    void evict_(Store& store, std::size_t num, std::size_t bytes);
+
+    /**
+     * load the result by @p loader in this thread, the requests waiting
+     * for @p loading would get it.
+     */
+    bool load_(
+        Store& store,
+        const std::string& key,
+        const loader_type& loader,
+        const LoadingPtr& loading,
+        value_type& result);
+
+    /**
+     * the task to reload a stale entry in background.
+     */
+    void refresh_(
+        Store* store,
+        const std::string& key,
+        loader_type loader,
+        LoadingPtr loading);
+
+    void finishLoading_(
+        const std::string& key,
+        const LoadingPtr& loading,
+        const value_ptr& value);
+
     /**
      * For keys with static values, we need not to refresh cache;
      * but for those with volatile values, we need to refresh cache periodically.
      * @return true if need refresh, or false;
      */
-    bool needRefresh(const key_type& key, const std::time_t& timestamp)
-    {
-        bool check = refreshAll_ || key.isRandomRank;
+    bool needRefresh_(const key_type& key, const std::time_t& timestamp) const;
 
-        if (check)
-            return (std::time(NULL) - timestamp) > refreshInterval_;
-        else
-            return false;
-    }
+private:
+    Store store_;
+    Store specialStore_;
 
-    // for the search which may consume a lot time, we treat it as special and cache in the special cache.
-    bool IsSpecialSearch(const key_type& key)
-    {
-        return key.query == "*";
-    }
+    const std::size_t maxNum_;
+    const std::size_t maxBytes_;
+    const time_t refreshInterval_; // seconds
+    const bool refreshAll_;
+    const time_t staleInterval_; // seconds
 
-private:
+    boost::atomic<uint64_t> generation_;
+
+    /// when the last generation began
+    boost::atomic<std::time_t> generationTime_;
+
+    /// the keys being loaded
+    LoadingMap loadingMap_;
+    boost::mutex loadingMutex_;
+
+    boost::atomic<std::size_t> hitCount_;
+    boost::atomic<std::size_t> staleHitCount_;
+    boost::atomic<std::size_t> missCount_;
+    boost::atomic<std::size_t> coalescedCount_;
 
-    cache_type cache_;
-    cache_type special_cache_;
-    time_t refreshInterval_; // seconds
-    bool refreshAll_;
+    /// it is destructed at first to wait for the tasks using above members
+    boost::threadpool::pool refreshPool_;
 };
 
 } // namespace sf1r
 
-#endif // CORE_SEARCH_MANAGER_SEARCH_CACHE_H
+#endif // CORE_COMMON_SEARCH_CACHE_H
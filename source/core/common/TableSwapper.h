@@ -19,6 +19,10 @@ struct TableSwapper
 
     TableSwapper(Table& r) : reader(r) {}
 
+    /**
+     * the tables of doc ids are stored in ChunkedVector, so the copy
+     * shares the chunks with reader, until they are modified by writer.
+     */
     void copy(std::size_t newSize)
     {
         writer = reader;
@@ -0,0 +1,41 @@
+#ifndef SF1R_GEO_INDEX_CONFIG_H_
+#define SF1R_GEO_INDEX_CONFIG_H_
+
+#include <string>
+#include <boost/serialization/access.hpp>
+
+namespace sf1r
+{
+
+/**
+ * @brief The configuration for <GeoIndex>.
+ */
+class GeoIndexConfig
+{
+public:
+    bool isEnable;
+
+    /// the property of geo location
+    std::string property;
+
+    /// the geohash length of each cell
+    std::size_t precision;
+
+    GeoIndexConfig() : isEnable(false), precision(6)
+    {}
+
+private:
+    friend class boost::serialization::access;
+
+    template <typename Archive>
+    void serialize(Archive & ar, const unsigned int version)
+    {
+        ar & isEnable;
+        ar & property;
+        ar & precision;
+    }
+};
+
+} // namespace sf1r
+
+#endif // SF1R_GEO_INDEX_CONFIG_H_
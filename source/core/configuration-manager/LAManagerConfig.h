@@ -36,6 +36,9 @@ public:
 
     LAManagerConfig()
             : bUseCache_(false)
+            , searchLAMaxNum_(64)
+            , searchLAWaitTime_(100)
+            , queryCacheSize_(10000)
     {}
 
     ~LAManagerConfig() {}
@@ -185,6 +188,12 @@ public:
     unsigned int updateDictInterval_;
     /// @brief
     bool bUseCache_;
+    /// @brief the max number of LAs for searching of each analysis, 0 for no limit
+    unsigned int searchLAMaxNum_;
+    /// @brief milliseconds to wait for a search LA when all of them are in use
+    unsigned int searchLAWaitTime_;
+    /// @brief the max number of query analysis results cached, 0 to disable the cache
+    unsigned int queryCacheSize_;
 };
 
 
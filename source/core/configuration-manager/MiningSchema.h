@@ -7,6 +7,7 @@
 #include "SuffixMatchConfig.h"
 #include "ZambeziConfig.h"
 #include "AdIndexConfig.h"
+#include "GeoIndexConfig.h"
 
 #include <stdint.h>
 #include <string>
@@ -51,6 +52,8 @@ public:
     ZambeziConfig zambezi_config;
 
     AdIndexConfig ad_index_config;
+
+    GeoIndexConfig geo_index_config;
 };
 
 } // namespace
@@ -0,0 +1,45 @@
+#ifndef QUERY_LOG_WRITER_CONFIG_H_
+#define QUERY_LOG_WRITER_CONFIG_H_
+
+#include <stdint.h>
+
+namespace sf1r
+{
+
+/**
+ * the attributes of <LogConnection> to write the user queries
+ * asynchronously.
+ */
+struct QueryLogWriterConfig
+{
+public:
+    /// the max number of queries waiting to be written,
+    /// 0 to write them synchronously in the request thread
+    uint32_t queueSize;
+
+    /// the max number of queries written in one insert
+    uint32_t batchSize;
+
+    /// the milliseconds to wait before writing a partial batch
+    uint32_t flushInterval;
+
+    /// when the queue is full, true to wait in the request thread,
+    /// false to drop the query
+    bool isBlockOnFull;
+
+    QueryLogWriterConfig(
+        uint32_t queue_size = 65536,
+        uint32_t batch_size = 256,
+        uint32_t flush_interval = 1000,
+        bool is_block_on_full = false
+    )
+        : queueSize(queue_size)
+        , batchSize(batch_size)
+        , flushInterval(flush_interval)
+        , isBlockOnFull(is_block_on_full)
+    {}
+};
+
+} // namespace sf1r
+
+#endif //QUERY_LOG_WRITER_CONFIG_H_
@@ -5,6 +5,7 @@
 #include <stdint.h>
 #include <string>
 #include <boost/serialization/access.hpp>
+#include <boost/serialization/version.hpp>
 
 namespace sf1r
 {
@@ -78,12 +79,18 @@ public:
         : suffix_match_enable(false)
         , product_forward_enable(false)
         , suffix_groupcounter_topk(10000)
+        , build_thread_num(1)
+        , build_memory_limit(0)
     {
     }
 
     bool suffix_match_enable;
     bool product_forward_enable;
     int32_t suffix_groupcounter_topk;
+    /// the max number of fm-indexes built in parallel, 0 for hardware threads
+    uint32_t build_thread_num;
+    /// the max bytes of building fm-indexes in parallel, 0 for no limit
+    uint64_t build_memory_limit;
     std::vector<std::string> suffix_match_properties;
     std::string suffix_match_tokenize_dicpath;
     std::vector<std::string> group_filter_properties;
@@ -113,9 +120,18 @@ private:
         ar & searchable_properties;
         ar & virtual_property;
         ar & normalizer_config;
+
+        // appended in version 1, so that the older archives still load
+        if (version > 0)
+        {
+            ar & build_thread_num;
+            ar & build_memory_limit;
+        }
     }
 };
 
 }
 
+BOOST_CLASS_VERSION(sf1r::SuffixMatchConfig, 1)
+
 #endif
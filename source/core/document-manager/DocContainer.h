@@ -9,32 +9,83 @@
 
 #include <boost/filesystem.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/archive/xml_oarchive.hpp>
 #include <boost/archive/xml_iarchive.hpp>
 #include <boost/archive/archive_exception.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/string.hpp>
 #include <boost/scoped_array.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/locks.hpp>
 
 #include <compression/compressor.h>
 
+#include <glog/logging.h>
+
 namespace sf1r
 {
 
+/**
+ * The stored fields of documents.
+ *
+ * In the columnar layout, the properties are stored in separate columns, a
+ * column is a Lux array holding the compressed properties of one property
+ * group. A property not configured in any group has a column of its own,
+ * and its sentence blocks (the ".blocks" property) are stored with it, as
+ * they are always read together for snippets. So reading a property only
+ * decompresses the bytes of its group.
+ *
+ * The collections created before the columnar layout keep the whole
+ * document in one array, they are still readable, and could be converted
+ * by DocContainerMigrateTool.
+ */
 class DocContainer
 {
     typedef Lux::IO::Array containerType;
+    typedef boost::shared_ptr<containerType> containerPtrType;
 
 public:
-    DocContainer(const std::string&path)
+    typedef std::vector<std::vector<std::string> > PropertyGroups;
+
+    /**
+     * @param propertyGroups the properties stored in the same column, they
+     *        only take effect on the properties not stored yet.
+     */
+    DocContainer(const std::string&path,
+                 const PropertyGroups& propertyGroups = PropertyGroups())
         : path_(path)
         , fileName_(path + "DocumentPropertyTable")
         , maxDocIdDb_(path + "MaxDocID.xml")
+        , columnDb_(path + "DocumentPropertyColumns.xml")
         , containerPtr_(NULL)
         , maxDocID_(0)
+        , isColumnar_(false)
     {
-        containerPtr_ = new containerType(Lux::IO::NONCLUSTER);
-        containerPtr_->set_noncluster_params(Lux::IO::Linked);
-        containerPtr_->set_lock_type(Lux::IO::LOCK_THREAD);
         restoreMaxDocDb_();
+
+        // the columnar layout for new collections, the old collections keep
+        // the layout until migrated
+        isColumnar_ = !isLegacyLayout_();
+
+        if (isColumnar_)
+        {
+            for (std::size_t i = 0; i < propertyGroups.size(); ++i)
+            {
+                const std::vector<std::string>& group = propertyGroups[i];
+                for (std::size_t j = 0; j < group.size(); ++j)
+                {
+                    configGroupMap_[group[j]] = i;
+                }
+            }
+            propertyGroups_ = propertyGroups;
+        }
+        else
+        {
+            containerPtr_ = createContainer_();
+        }
     }
 
     ~DocContainer()
@@ -44,19 +95,227 @@ public:
             containerPtr_->close();
             delete containerPtr_;
         }
+        for (std::size_t i = 0; i < columns_.size(); ++i)
+        {
+            columns_[i]->close();
+        }
     }
 
     bool open()
+    {
+        if (isColumnar_)
+            return openColumns_();
+
+        return openContainer_(containerPtr_, fileName_);
+    }
+
+    bool isColumnar() const
+    {
+        return isColumnar_;
+    }
+
+    std::size_t getColumnNum()
+    {
+        boost::shared_lock<boost::shared_mutex> guard(column_mutex_);
+        return columns_.size();
+    }
+
+    bool insert(const unsigned int docId, const Document& doc)
+    {
+        CREATE_SCOPED_PROFILER(insert_document, "Index:SIAProcess", "Indexer : insert_document")
+        {
+            boost::unique_lock<boost::shared_mutex> guard(shared_mutex_);
+            maxDocID_ = docId>maxDocID_? docId:maxDocID_;
+        }
+
+        if (isColumnar_)
+            return putColumns_(docId, doc);
+
+        return putImage_(containerPtr_, docId, doc);
+    }
+
+    bool get(const unsigned int docId, Document& doc)
+    {
+        //CREATE_SCOPED_PROFILER(get_document, "Index:SIAProcess", "Indexer : get_document")
+        {
+            boost::shared_lock<boost::shared_mutex> guard(shared_mutex_);
+            if (docId > maxDocID_ )
+            {
+                return false;
+            }
+        }
+
+        if (isColumnar_)
+        {
+            std::vector<containerPtrType> columns;
+            {
+                boost::shared_lock<boost::shared_mutex> guard(column_mutex_);
+                columns = columns_;
+            }
+            return getColumns_(docId, columns, doc);
+        }
+
+        return getImage_(containerPtr_, docId, doc);
+    }
+
+    /**
+     * get the properties in @p propertyNames, in the columnar layout, only
+     * their columns are read, the other properties in the same columns may
+     * also be returned in @p doc.
+     */
+    bool get(const unsigned int docId,
+             const std::vector<std::string>& propertyNames,
+             Document& doc)
+    {
+        if (!isColumnar_)
+            return get(docId, doc);
+
+        {
+            boost::shared_lock<boost::shared_mutex> guard(shared_mutex_);
+            if (docId > maxDocID_ )
+                return false;
+        }
+
+        std::vector<containerPtrType> columns;
+        {
+            boost::shared_lock<boost::shared_mutex> guard(column_mutex_);
+            std::vector<bool> isSelected(columns_.size(), false);
+            for (std::size_t i = 0; i < propertyNames.size(); ++i)
+            {
+                std::size_t column = findColumn_(propertyNames[i]);
+                if (column != NOT_FOUND_COLUMN && !isSelected[column])
+                {
+                    isSelected[column] = true;
+                    columns.push_back(columns_[column]);
+                }
+            }
+        }
+
+        if (getColumns_(docId, columns, doc))
+            return true;
+
+        // the doc exists without these properties
+        return exist(docId);
+    }
+
+    bool exist(const unsigned int docId)
+    {
+        {
+            boost::shared_lock<boost::shared_mutex> guard(shared_mutex_);
+            if (docId > maxDocID_ )
+                return false;
+        }
+        containerType* container = baseContainer_();
+        if (!container)
+            return false;
+
+        Lux::IO::data_t *val_p = NULL;
+        bool ret = container->get(docId, &val_p, Lux::IO::SYSTEM);
+        container->clean_data(val_p);
+        return ret;
+    }
+
+    bool del(const unsigned int docId)
+    {
+        {
+            boost::shared_lock<boost::shared_mutex> guard(shared_mutex_);
+            if (docId > maxDocID_ )
+                return false;
+        }
+
+        if (!isColumnar_)
+            return containerPtr_->del(docId);
+
+        std::vector<containerPtrType> columns;
+        {
+            boost::shared_lock<boost::shared_mutex> guard(column_mutex_);
+            columns = columns_;
+        }
+        if (columns.empty())
+            return false;
+
+        bool ret = columns[0]->del(docId);
+        for (std::size_t i = 1; i < columns.size(); ++i)
+        {
+            columns[i]->del(docId);
+        }
+        return ret;
+    }
+
+    bool update(const unsigned int docId, const Document& doc)
+    {
+        {
+            boost::shared_lock<boost::shared_mutex> guard(shared_mutex_);
+            if (docId > maxDocID_)
+                return false;
+        }
+
+        if (isColumnar_)
+            return putColumns_(docId, doc);
+
+        return putImage_(containerPtr_, docId, doc);
+    }
+
+    docid_t getMaxDocId()
+    {
+        boost::shared_lock<boost::shared_mutex> guard(shared_mutex_);
+        return maxDocID_;
+    }
+
+    void flush()
+    {
+        saveMaxDocDb_();
+    }
+
+private:
+    static const std::size_t NOT_FOUND_COLUMN = static_cast<std::size_t>(-1);
+
+    /**
+     * the collection is in the layout before columns, if it has no column
+     * descriptor, but has the Lux files of the document table (Lux appends
+     * suffixes to the file name), or has stored some docs.
+     */
+    bool isLegacyLayout_() const
+    {
+        if (boost::filesystem::exists(columnDb_))
+            return false;
+
+        if (maxDocID_ > 0)
+            return true;
+
+        if (!boost::filesystem::is_directory(path_))
+            return false;
+
+        const std::string tablePrefix =
+            boost::filesystem::path(fileName_).filename().string();
+        for (boost::filesystem::directory_iterator it(path_), itEnd;
+             it != itEnd; ++it)
+        {
+            if (boost::starts_with(it->path().filename().string(), tablePrefix))
+                return true;
+        }
+        return false;
+    }
+
+    static containerType* createContainer_()
+    {
+        containerType* container = new containerType(Lux::IO::NONCLUSTER);
+        container->set_noncluster_params(Lux::IO::Linked);
+        container->set_lock_type(Lux::IO::LOCK_THREAD);
+        return container;
+    }
+
+    static bool openContainer_(containerType* container, const std::string& fileName)
     {
         try
         {
-            if ( !boost::filesystem::exists(fileName_) )
+            if ( !boost::filesystem::exists(fileName) )
             {
-                containerPtr_->open(fileName_.c_str(), Lux::IO::DB_CREAT);
+                container->open(fileName.c_str(), Lux::IO::DB_CREAT);
             }
             else
             {
-                containerPtr_->open(fileName_.c_str(), Lux::IO::DB_RDWR);
+                container->open(fileName.c_str(), Lux::IO::DB_RDWR);
             }
         }
         catch (...)
@@ -64,17 +323,22 @@ public:
             return false;
         }
         return true;
+    }
+
+    /** the container storing the max doc id, and indicating the doc exists */
+    containerType* baseContainer_()
+    {
+        if (!isColumnar_)
+            return containerPtr_;
 
+        boost::shared_lock<boost::shared_mutex> guard(column_mutex_);
+        return columns_.empty() ? NULL : columns_[0].get();
     }
 
-    bool insert(const unsigned int docId, const Document& doc)
+    bool putImage_(containerType* container, const unsigned int docId, const Document& doc)
     {
-        CREATE_SCOPED_PROFILER(insert_document, "Index:SIAProcess", "Indexer : insert_document")
         CREATE_PROFILER(proDocumentCompression, "Index:SIAProcess", "Indexer : DocumentCompression")
-        {
-            boost::unique_lock<boost::shared_mutex> guard(shared_mutex_);
-            maxDocID_ = docId>maxDocID_? docId:maxDocID_;
-        }
+
         izenelib::util::izene_serialization<Document> izs(doc);
         char* src;
         size_t srcLen;
@@ -96,25 +360,17 @@ public:
             return false;
         STOP_PROFILER( proDocumentCompression )
 
-        bool ret = containerPtr_->put(docId, destPtr.get(), destLen + sizeof(uint32_t), Lux::IO::OVERWRITE);
+        bool ret = container->put(docId, destPtr.get(), destLen + sizeof(uint32_t), Lux::IO::OVERWRITE);
         return ret;
     }
 
-    bool get(const unsigned int docId, Document& doc)
+    bool getImage_(containerType* container, const unsigned int docId, Document& doc)
     {
-        //CREATE_SCOPED_PROFILER(get_document, "Index:SIAProcess", "Indexer : get_document")
         //CREATE_PROFILER(proDocumentDecompression, "Index:SIAProcess", "Indexer : DocumentDecompression")
-        {
-            boost::shared_lock<boost::shared_mutex> guard(shared_mutex_);
-            if (docId > maxDocID_ )
-            {
-                return false;
-            }
-        }
         Lux::IO::data_t *val_p = NULL;
-        if (!containerPtr_->get(docId, &val_p, Lux::IO::SYSTEM))
+        if (!container->get(docId, &val_p, Lux::IO::SYSTEM))
         {
-            containerPtr_->clean_data(val_p);
+            container->clean_data(val_p);
             return false;
         }
         int nsz=0;
@@ -123,7 +379,7 @@ public:
 
         if ( val_p->size - sizeof(uint32_t) == 0 )
         {
-            containerPtr_->clean_data(val_p);
+            container->clean_data(val_p);
             return false;
         }
 
@@ -134,7 +390,7 @@ public:
         if (!re)
         {
             delete[] p;
-            containerPtr_->clean_data(val_p);
+            container->clean_data(val_p);
             return false;
         }
 
@@ -144,95 +400,277 @@ public:
         izenelib::util::izene_deserialization<Document> izd((char*)p, nsz);
         izd.read_image(doc);
         delete[] p;
-        containerPtr_->clean_data(val_p);
+        container->clean_data(val_p);
         return true;
     }
 
-    bool exist(const unsigned int docId)
+    bool putColumns_(const unsigned int docId, const Document& doc)
     {
+        std::vector<Document> columnDocs;
+        std::vector<containerPtrType> columns;
         {
-            boost::shared_lock<boost::shared_mutex> guard(shared_mutex_);
-            if (docId > maxDocID_ )
-                return false;
+            boost::shared_lock<boost::shared_mutex> guard(column_mutex_);
+            columnDocs.resize(columns_.size());
+            if (!splitColumns_(doc, columnDocs))
+            {
+                guard.unlock();
+
+                // create the columns for the new properties
+                boost::unique_lock<boost::shared_mutex> writeGuard(column_mutex_);
+                for (Document::property_const_iterator it = doc.propertyBegin();
+                        it != doc.propertyEnd(); ++it)
+                {
+                    if (findColumn_(it->first) == NOT_FOUND_COLUMN &&
+                        !createColumn_(it->first))
+                    {
+                        return false;
+                    }
+                }
+                columnDocs.clear();
+                columnDocs.resize(columns_.size());
+                splitColumns_(doc, columnDocs);
+                columns = columns_;
+            }
+            else
+            {
+                columns = columns_;
+            }
+        }
+
+        // the base column is always written to indicate the doc exists
+        columnDocs[0].setId(docId);
+        bool ret = putImage_(columns[0].get(), docId, columnDocs[0]);
+
+        for (std::size_t i = 1; i < columns.size(); ++i)
+        {
+            if (columnDocs[i].getPropertySize() == 0)
+            {
+                // remove the value of previous version
+                columns[i]->del(docId);
+                continue;
+            }
+            columnDocs[i].setId(docId);
+            ret = putImage_(columns[i].get(), docId, columnDocs[i]) && ret;
         }
-        Lux::IO::data_t *val_p = NULL;
-        bool ret = containerPtr_->get(docId, &val_p, Lux::IO::SYSTEM);
-        containerPtr_->clean_data(val_p);
         return ret;
     }
 
-    bool del(const unsigned int docId)
+    /**
+     * split the properties of @p doc into @p columnDocs.
+     * @return false if any property has no column yet.
+     */
+    bool splitColumns_(const Document& doc, std::vector<Document>& columnDocs) const
     {
+        for (Document::property_const_iterator it = doc.propertyBegin();
+                it != doc.propertyEnd(); ++it)
         {
-            boost::shared_lock<boost::shared_mutex> guard(shared_mutex_);
-            if (docId > maxDocID_ )
+            std::size_t column = findColumn_(it->first);
+            if (column == NOT_FOUND_COLUMN)
                 return false;
+
+            columnDocs[column].property(it->first) = it->second;
         }
-        return containerPtr_->del(docId);
+        return true;
     }
 
-    bool update(const unsigned int docId, const Document& doc)
+    bool getColumns_(const unsigned int docId,
+                     const std::vector<containerPtrType>& columns,
+                     Document& doc)
     {
+        doc.clear();
+        doc.setId(docId);
+
+        bool isFound = false;
+        Document columnDoc;
+        for (std::size_t i = 0; i < columns.size(); ++i)
         {
-            boost::shared_lock<boost::shared_mutex> guard(shared_mutex_);
-            if (docId > maxDocID_)
-                return false;
+            if (!getImage_(columns[i].get(), docId, columnDoc))
+                continue;
+
+            isFound = true;
+            for (Document::property_const_iterator it = columnDoc.propertyBegin();
+                    it != columnDoc.propertyEnd(); ++it)
+            {
+                doc.property(it->first) = it->second;
+            }
         }
+        return isFound;
+    }
 
-        izenelib::util::izene_serialization<Document> izs(doc);
-        char* src;
-        size_t srcLen;
-        izs.write_image(src, srcLen);
+    /** the caller should hold @c column_mutex_ */
+    std::size_t findColumn_(const std::string& propertyName) const
+    {
+        boost::unordered_map<std::string, std::size_t>::const_iterator it =
+            columnMap_.find(propertyName);
 
-        const size_t allocSize = compressor_.compressBound(srcLen);
-        size_t destLen = 0;
-        boost::scoped_array<unsigned char> destPtr(new unsigned char[allocSize + sizeof(uint32_t)]);
-        *reinterpret_cast<uint32_t*>(destPtr.get()) = srcLen;
+        if (it == columnMap_.end())
+            return NOT_FOUND_COLUMN;
+
+        return it->second;
+    }
+
+    /** the caller should hold the write lock of @c column_mutex_ */
+    bool createColumn_(const std::string& propertyName)
+    {
+        // the sentence blocks are stored with its property
+        static const std::string kBlockSuffix(".blocks");
+        std::string baseName = propertyName;
+        if (boost::algorithm::ends_with(propertyName, kBlockSuffix))
+        {
+            baseName.erase(baseName.size() - kBlockSuffix.size());
+
+            std::size_t column = findColumn_(baseName);
+            if (column != NOT_FOUND_COLUMN)
+            {
+                columnMap_[propertyName] = column;
+                columnProperties_[column].push_back(propertyName);
+                return saveColumnDb_();
+            }
+        }
+
+        std::vector<std::string> properties;
+        boost::unordered_map<std::string, std::size_t>::const_iterator groupIt =
+            configGroupMap_.find(baseName);
+        if (groupIt != configGroupMap_.end())
+        {
+            const std::vector<std::string>& group = propertyGroups_[groupIt->second];
+            for (std::size_t i = 0; i < group.size(); ++i)
+            {
+                if (findColumn_(group[i]) == NOT_FOUND_COLUMN)
+                    properties.push_back(group[i]);
+            }
+        }
+        else
+        {
+            properties.push_back(baseName);
+        }
 
-        if ( srcLen == 0)
+        if (baseName != propertyName)
         {
+            properties.push_back(propertyName);
+        }
+
+        if (!addColumn_(properties))
+            return false;
+
+        return saveColumnDb_();
+    }
+
+    bool addColumn_(const std::vector<std::string>& properties)
+    {
+        const std::size_t column = columns_.size();
+        const std::string fileName = path_ + "DocumentPropertyColumn" +
+            boost::lexical_cast<std::string>(column);
+
+        containerPtrType container(createContainer_());
+        if (!openContainer_(container.get(), fileName))
+        {
+            LOG(ERROR) << "failed to open column file: " << fileName;
             return false;
         }
-        bool re = compressor_.compress((const unsigned char*)src, srcLen, destPtr.get() + sizeof(uint32_t), destLen);
-        if (!re || destLen > allocSize)
+
+        columns_.push_back(container);
+        columnProperties_.resize(column + 1);
+        for (std::size_t i = 0; i < properties.size(); ++i)
+        {
+            columnMap_[properties[i]] = column;
+            columnProperties_[column].push_back(properties[i]);
+        }
+        return true;
+    }
+
+    bool openColumns_()
+    {
+        boost::unique_lock<boost::shared_mutex> guard(column_mutex_);
+
+        PropertyGroups columnProperties;
+        if (!restoreColumnDb_(columnProperties))
             return false;
 
-        bool ret = containerPtr_->put(docId, destPtr.get(), destLen + sizeof(uint32_t), Lux::IO::OVERWRITE);
-        return ret;
+        // the base column
+        if (columnProperties.empty())
+        {
+            columnProperties.push_back(std::vector<std::string>(1, "DOCID"));
+        }
+
+        for (std::size_t i = 0; i < columnProperties.size(); ++i)
+        {
+            if (!addColumn_(columnProperties[i]))
+                return false;
+        }
+
+        return saveColumnDb_();
     }
 
-    docid_t getMaxDocId()
+    bool saveColumnDb_()
     {
-        boost::shared_lock<boost::shared_mutex> guard(shared_mutex_);
-        return maxDocID_;
+        try
+        {
+            std::ofstream ofs(columnDb_.c_str());
+            if (ofs)
+            {
+                boost::archive::xml_oarchive oa(ofs);
+                oa << boost::serialization::make_nvp(
+                    "Columns", columnProperties_
+                );
+            }
+            return ofs;
+        }
+        catch (boost::archive::archive_exception& e)
+        {
+            return false;
+        }
     }
 
-    void flush()
+    bool restoreColumnDb_(PropertyGroups& columnProperties)
     {
-        saveMaxDocDb_();
+        if (!boost::filesystem::exists(columnDb_))
+            return true;
+
+        try
+        {
+            std::ifstream ifs(columnDb_.c_str());
+            if (ifs)
+            {
+                boost::archive::xml_iarchive ia(ifs);
+                ia >> boost::serialization::make_nvp(
+                    "Columns", columnProperties
+                );
+            }
+            return ifs;
+        }
+        catch (boost::archive::archive_exception& e)
+        {
+            LOG(ERROR) << "failed to load column file: " << columnDb_
+                       << ", " << e.what();
+            return false;
+        }
     }
 
-private:
     bool saveMaxDocDb_()
     {
+        containerType* container = baseContainer_();
+        if (!container)
+            return false;
+
         boost::unique_lock<boost::shared_mutex> guard(shared_mutex_);
         try
         {
             ///Not Used. Array[0] could be used to store maxDocID since all doc ids start from 1
             bool need_update_db = true;
             Lux::IO::data_t *val_p = NULL;
-            if (containerPtr_->get(0, &val_p, Lux::IO::SYSTEM))
+            if (container->get(0, &val_p, Lux::IO::SYSTEM))
             {
                 if ( val_p->size == sizeof(maxDocID_) )
                 {
                     need_update_db = maxDocID_ != *((docid_t*)val_p->data);
                 }
             }
-            containerPtr_->clean_data(val_p);
+            container->clean_data(val_p);
 
             if (need_update_db)
             {
-                containerPtr_->put(0, &maxDocID_, sizeof(unsigned int), Lux::IO::OVERWRITE);
+                container->put(0, &maxDocID_, sizeof(unsigned int), Lux::IO::OVERWRITE);
             }
             std::ofstream ofs(maxDocIdDb_.c_str());
             if (ofs)
@@ -276,10 +714,32 @@ private:
     std::string path_;
     std::string fileName_;
     std::string maxDocIdDb_;
+    std::string columnDb_;
     containerType* containerPtr_;
     docid_t maxDocID_;
     DocumentCompressor compressor_;
     boost::shared_mutex shared_mutex_;
+
+    /// whether in the columnar layout
+    bool isColumnar_;
+
+    /// the column files, the first one is the base column
+    std::vector<containerPtrType> columns_;
+
+    /// the properties stored in each column
+    PropertyGroups columnProperties_;
+
+    /// map from property name to column index
+    boost::unordered_map<std::string, std::size_t> columnMap_;
+
+    /// the configured property groups
+    PropertyGroups propertyGroups_;
+
+    /// map from property name to the index of @c propertyGroups_
+    boost::unordered_map<std::string, std::size_t> configGroupMap_;
+
+    /// protect the columns above
+    boost::shared_mutex column_mutex_;
 };
 
 }
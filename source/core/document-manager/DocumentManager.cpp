@@ -28,6 +28,8 @@
 #include <boost/serialization/vector.hpp>
 #include <boost/archive/archive_exception.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/bind.hpp>
+#include <algorithm>
 
 #include <protect/RestrictMacro.h>
 
@@ -43,22 +45,114 @@ namespace
 {
 const std::string DOCID("DOCID");
 const std::string DATE("DATE");
+
+/// the max number of threads to process one page
+const std::size_t MAX_PAGE_THREAD_NUM = 8;
+
+/// the pages with fewer docs are processed in the calling thread only
+const std::size_t MIN_PARALLEL_DOC_NUM = 8;
+
+/// each thread processes at least this number of docs
+const std::size_t MIN_DOC_NUM_PER_JOB = 4;
+
+/// compares the positions in a doc id list by their doc ids
+struct DocIdPositionLess
+{
+    const std::vector<docid_t>& docIds_;
+
+    explicit DocIdPositionLess(const std::vector<docid_t>& docIds)
+        : docIds_(docIds) {}
+
+    bool operator()(std::size_t i, std::size_t j) const
+    {
+        return docIds_[i] < docIds_[j];
+    }
+};
+
+/// the positions of @p docIds, sorted by doc id to read the docs sequentially
+void sortByDocId(const std::vector<docid_t>& docIds, std::vector<std::size_t>& positions)
+{
+    std::sort(positions.begin(), positions.end(), DocIdPositionLess(docIds));
+}
 }
 
+struct DocumentManager::RawTextPage
+{
+    RawTextPage(
+            const std::vector<docid_t>& docIds,
+            const std::string& propertyName,
+            const std::vector<izenelib::util::UString>& terms)
+        : docIdList(docIds)
+        , queryTerms(terms)
+        , summaryOn(false)
+        , numSentences(1)
+        , option(0)
+        , snippetLength(0)
+        , fetchOrder(docIds.size())
+        , isFetched(docIds.size(), 0)
+        , fullTextList(docIds.size())
+        , offsetsList(docIds.size())
+        , snippetList(docIds.size())
+        , rawSummaryList(docIds.size())
+    {
+        textProperties.push_back(propertyName);
+        textProperties.push_back(propertyName + PROPERTY_BLOCK_SUFFIX);
+
+        for (std::size_t i = 0; i < fetchOrder.size(); ++i)
+        {
+            fetchOrder[i] = i;
+        }
+        sortByDocId(docIdList, fetchOrder);
+    }
+
+    const std::vector<docid_t>& docIdList;
+    const std::vector<izenelib::util::UString>& queryTerms;
+
+    /// the text property and its sentence blocks
+    std::vector<std::string> textProperties;
+
+    bool summaryOn;
+    unsigned int numSentences;
+    unsigned int option;
+    unsigned int snippetLength;
+
+    /// the positions in @c docIdList, sorted by doc id
+    std::vector<std::size_t> fetchOrder;
+
+    /// whether both the text and its sentence blocks are read
+    std::vector<char> isFetched;
+
+    std::vector<Document::doc_prop_value_strtype> fullTextList;
+    std::vector<std::vector<CharacterOffset> > offsetsList;
+    std::vector<Document::doc_prop_value_strtype> snippetList;
+    std::vector<Document::doc_prop_value_strtype> rawSummaryList;
+};
+
 DocumentManager::DocumentManager(
         const std::string& path,
         const IndexBundleSchema& indexSchema,
         const izenelib::util::UString::EncodingType encodingType,
-        size_t documentCacheNum)
+        size_t documentCacheNum,
+        const std::vector<std::vector<std::string> >& storedPropertyGroups)
     : path_(path)
     , delfilter_count_(0)
     , documentCache_(100)
     , indexSchema_(indexSchema)
     , encodingType_(encodingType)
     , maxSnippetLength_(200)
+    , pageThreadNum_(std::min<std::size_t>(boost::thread::hardware_concurrency(),
+                                           MAX_PAGE_THREAD_NUM))
 {
-    propertyValueTable_ = new DocContainer(path);
-    propertyValueTable_->open();
+    if (pageThreadNum_ > 1)
+    {
+        pageThreadPool_.size_controller().resize(pageThreadNum_);
+    }
+
+    propertyValueTable_ = new DocContainer(path, storedPropertyGroups);
+    if (!propertyValueTable_->open())
+    {
+        LOG(ERROR) << "failed to open document property table in " << path;
+    }
     //buildPropertyIdMapper_();
     restorePropertyLengthDb_();
     loadDelFilter_();
@@ -297,6 +391,14 @@ bool DocumentManager::getPropertyValue(
     {
         result = doc.property(*realPropertyName);
     }
+    else if (propertyValueTable_->isColumnar())
+    {
+        // the partial doc is not put into documentCache_
+        if (isDeleted(docId) || !propertyValueTable_->get(docId,
+                std::vector<std::string>(1, *realPropertyName), doc))
+            return false;
+        result = doc.property(*realPropertyName);
+    }
     else
     {
         if (getDocument(docId, doc) == false)
@@ -309,12 +411,72 @@ bool DocumentManager::getPropertyValue(
     return true;
 }
 
+bool DocumentManager::getColumnProperties_(
+        docid_t docId,
+        const std::vector<std::string>& propertyNames,
+        Document& document)
+{
+    if (!propertyValueTable_->isColumnar())
+        return false;
+
+    for (std::vector<std::string>::const_iterator it = propertyNames.begin();
+            it != propertyNames.end(); ++it)
+    {
+        if (propertyAliasMap_.find(*it) != propertyAliasMap_.end() ||
+            numericPropertyTables_.find(*it) != numericPropertyTables_.end() ||
+            rtype_string_proptable_.find(*it) != rtype_string_proptable_.end())
+            return false;
+    }
+
+    return !isDeleted(docId) &&
+           propertyValueTable_->get(docId, propertyNames, document);
+}
+
 bool DocumentManager::getDocument(docid_t docId, Document& document, bool forceget)
 {
     CREATE_SCOPED_PROFILER ( getDocument, "DocumentManager", "DocumentManager::getDocument");
     return (forceget || !isDeleted(docId)) && propertyValueTable_->get(docId, document);
 }
 
+bool DocumentManager::getDocumentProperties(
+        docid_t docId,
+        const std::vector<std::string>& propertyNames,
+        Document& document)
+{
+    std::vector<std::string> storedNames;
+    std::vector<std::string> rtypeNames;
+    for (std::vector<std::string>::const_iterator it = propertyNames.begin();
+            it != propertyNames.end(); ++it)
+    {
+        if (numericPropertyTables_.find(*it) != numericPropertyTables_.end() ||
+            rtype_string_proptable_.find(*it) != rtype_string_proptable_.end())
+            rtypeNames.push_back(*it);
+        else
+            storedNames.push_back(*it);
+    }
+
+    Document doc;
+    if (isDeleted(docId) || !propertyValueTable_->get(docId, storedNames, doc))
+        return false;
+
+    for (std::vector<std::string>::const_iterator it = rtypeNames.begin();
+            it != rtypeNames.end(); ++it)
+    {
+        std::string tempStr;
+        NumericPropertyTableMap::const_iterator numericIt = numericPropertyTables_.find(*it);
+        RTypeStringPropTableMap::const_iterator stringIt = rtype_string_proptable_.find(*it);
+        if (numericIt != numericPropertyTables_.end()
+                ? numericIt->second->getStringValue(docId, tempStr)
+                : stringIt->second->getRTypeString(docId, tempStr))
+        {
+            doc.property(*it) = str_to_propstr(tempStr, encodingType_);
+        }
+    }
+
+    document = doc;
+    return true;
+}
+
 void DocumentManager::getRTypePropertiesForDocument(docid_t docId, Document& document)
 {
     for (NumericPropertyTableMap::const_iterator it = numericPropertyTables_.begin();
@@ -361,14 +523,104 @@ bool DocumentManager::getDocuments(
         bool forceget)
 {
     docs.resize(ids.size());
-    bool ret = true;
+
+    std::vector<std::size_t> missList;
     for (size_t i=0; i<ids.size(); i++)
     {
-        ret &= getDocumentByCache(ids[i], docs[i], forceget);
+        if (!documentCache_.getValue(ids[i], docs[i]))
+            missList.push_back(i);
+    }
+
+    if (missList.empty())
+        return true;
+
+    sortByDocId(ids, missList);
+    std::vector<char> isFound(missList.size(), 0);
+    runPageJobs_(missList.size(),
+                 boost::bind(&DocumentManager::fetchDocuments_, this,
+                             boost::cref(ids), boost::cref(missList), forceget,
+                             boost::ref(docs), boost::ref(isFound), _1, _2));
+
+    bool ret = true;
+    for (size_t i=0; i<missList.size(); i++)
+    {
+        const std::size_t pos = missList[i];
+        if (isFound[i])
+            documentCache_.insertValue(ids[pos], docs[pos]);
+        else
+            ret = false;
     }
     return ret;
 }
 
+void DocumentManager::fetchDocuments_(
+        const std::vector<unsigned int>& ids,
+        const std::vector<std::size_t>& missList,
+        bool forceget,
+        std::vector<Document>& docs,
+        std::vector<char>& isFound,
+        std::size_t begin,
+        std::size_t end)
+{
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        const std::size_t pos = missList[i];
+        const docid_t docId = ids[pos];
+        isFound[i] = (forceget || !isDeleted(docId)) &&
+                     propertyValueTable_->get(docId, docs[pos]);
+    }
+}
+
+void DocumentManager::runPageJobs_(std::size_t docNum, const PageJob& job)
+{
+    if (docNum < MIN_PARALLEL_DOC_NUM || pageThreadNum_ <= 1)
+    {
+        job(0, docNum);
+        return;
+    }
+
+    const std::size_t jobNum = std::min(pageThreadNum_,
+        (docNum + MIN_DOC_NUM_PER_JOB - 1) / MIN_DOC_NUM_PER_JOB);
+    const std::size_t docNumPerJob = (docNum + jobNum - 1) / jobNum;
+
+    // the first range is processed in the calling thread
+    boost::detail::atomic_count finishedJobs(0);
+    std::size_t scheduledJobs = 0;
+    for (std::size_t begin = docNumPerJob; begin < docNum; begin += docNumPerJob)
+    {
+        const std::size_t end = std::min(begin + docNumPerJob, docNum);
+        pageThreadPool_.schedule(
+            boost::bind(&DocumentManager::runPageJob_, this,
+                        boost::cref(job), begin, end, &finishedJobs));
+        ++scheduledJobs;
+    }
+
+    runPageJob_(job, 0, docNumPerJob, NULL);
+    pageThreadPool_.wait(finishedJobs, scheduledJobs);
+}
+
+void DocumentManager::runPageJob_(
+        const PageJob& job,
+        std::size_t begin,
+        std::size_t end,
+        boost::detail::atomic_count* finishedJobs)
+{
+    try
+    {
+        job(begin, end);
+    }
+    catch (const std::exception& e)
+    {
+        LOG(ERROR) << "exception in processing docs [" << begin << ", "
+                   << end << "): " << e.what();
+    }
+
+    if (finishedJobs)
+    {
+        ++(*finishedJobs);
+    }
+}
+
 docid_t DocumentManager::getMaxDocId() const
 {
     return propertyValueTable_->getMaxDocId();
@@ -558,67 +810,119 @@ bool DocumentManager::getRawTextOfDocuments(
 {
     try
     {
-        unsigned int docListSize = docIdList.size();
-        std::vector<Document::doc_prop_value_strtype> snippetList(docListSize);
-        std::vector<Document::doc_prop_value_strtype> rawSummaryList(docListSize);
-        std::vector<Document::doc_prop_value_strtype> fullTextList(docListSize);
-
-        Document::doc_prop_value_strtype rawText; // raw text
-        izenelib::util::UString rawUText; // raw text
-        Document::doc_prop_value_strtype result; // output variable to store return value
-        izenelib::util::UString resultU;
-
-        bool ret = false;
-        for (unsigned int listId = 0; listId != docListSize; ++listId)
+        RawTextPage page(docIdList, propertyName, queryTerms);
+        page.summaryOn = summaryOn;
+        page.numSentences = summaryNum <= 0 ? 1 : summaryNum;
+        page.option = option;
+        page.snippetLength = getDisplayLength_(propertyName);
+
+        // read all the texts of the page in the order of doc id first,
+        // then generate their snippets and summaries
+        const std::size_t docListSize = docIdList.size();
+        runPageJobs_(docListSize, boost::bind(&DocumentManager::fetchRawTexts_,
+                                              this, &page, _1, _2));
+
+        const bool ret = std::find(page.isFetched.begin(), page.isFetched.end(), 1)
+                         != page.isFetched.end();
+        if (ret)
         {
-            docid_t docId = docIdList[listId];
-            result.clear();
-            resultU.clear();
+            runPageJobs_(docListSize, boost::bind(&DocumentManager::processRawTexts_,
+                                                  this, &page, _1, _2));
+        }
 
-            if (!getPropertyValue(docId, propertyName, rawText))
-                continue;
+        outSnippetList.swap(page.snippetList);
+        outFullTextList.swap(page.fullTextList);
+        if (summaryOn)
+            outRawSummaryList.swap(page.rawSummaryList);
 
-            rawUText = propstr_to_ustr(rawText, encodingType_);
-            fullTextList[listId] = rawText;
+        return ret;
+    }
+    catch (std::exception& e)
+    {
+        return false;
+    }
+}
 
-            std::string sentenceProperty = propertyName + PROPERTY_BLOCK_SUFFIX;
-            std::vector<CharacterOffset> sentenceOffsets;
-            if (!getPropertyValue(docId, sentenceProperty, sentenceOffsets))
-                continue;
+void DocumentManager::fetchRawTexts_(
+        RawTextPage* page,
+        std::size_t begin,
+        std::size_t end)
+{
+    const std::string& propertyName = page->textProperties[0];
+    const std::string& sentenceProperty = page->textProperties[1];
+    Document::doc_prop_value_strtype rawText;
+    Document columnDoc;
+
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        const std::size_t listId = page->fetchOrder[i];
+        const docid_t docId = page->docIdList[listId];
 
-            ret = true;
+        // read the text and its sentence blocks in one column
+        const bool isColumnRead = getColumnProperties_(docId, page->textProperties, columnDoc);
 
-            maxSnippetLength_ = getDisplayLength_(propertyName);
-            processOptionForRawText(option, queryTerms, rawUText,
-                                    sentenceOffsets, resultU);
+        if (isColumnRead ? !columnDoc.getProperty(propertyName, rawText)
+                         : !getPropertyValue(docId, propertyName, rawText))
+            continue;
 
-            result = ustr_to_propstr(resultU);
-            if (result.size() > 0)
-                snippetList[listId] = result;
-            else
-                snippetList[listId] = rawText;
+        page->fullTextList[listId] = rawText;
 
-            //process only if summary is ON
-            unsigned int numSentences = summaryNum <= 0 ? 1 : summaryNum;
-            if (summaryOn)
-            {
-                izenelib::util::UString summary;
-                getSummary(rawUText, sentenceOffsets, numSentences,
-                           option, queryTerms, summary);
+        std::vector<CharacterOffset>& sentenceOffsets = page->offsetsList[listId];
+        if (isColumnRead)
+        {
+            Document::property_const_iterator it = columnDoc.findProperty(sentenceProperty);
+            if (it == columnDoc.propertyEnd())
+                continue;
 
-                rawSummaryList[listId] = ustr_to_propstr(summary);
-            }
+            const std::vector<CharacterOffset>* offsets =
+                izenelib::get<std::vector<CharacterOffset> >(&it->second);
+            if (!offsets)
+                continue;
+            sentenceOffsets = *offsets;
         }
-        outSnippetList.swap(snippetList);
-        outFullTextList.swap(fullTextList);
-        if (summaryOn)
-            outRawSummaryList.swap(rawSummaryList);
+        else if (!getPropertyValue(docId, sentenceProperty, sentenceOffsets))
+            continue;
 
-        return ret;
+        page->isFetched[listId] = 1;
     }
-    catch (std::exception& e)
+}
+
+void DocumentManager::processRawTexts_(
+        RawTextPage* page,
+        std::size_t begin,
+        std::size_t end)
+{
+    izenelib::util::UString rawUText;
+    izenelib::util::UString resultU;
+
+    for (std::size_t listId = begin; listId < end; ++listId)
     {
-        return false;
+        if (!page->isFetched[listId])
+            continue;
+
+        const Document::doc_prop_value_strtype& rawText = page->fullTextList[listId];
+        const std::vector<CharacterOffset>& sentenceOffsets = page->offsetsList[listId];
+        rawUText = propstr_to_ustr(rawText, encodingType_);
+        resultU.clear();
+
+        processOptionForRawText(page->option, page->queryTerms, rawUText,
+                                sentenceOffsets, page->snippetLength, resultU);
+
+        Document::doc_prop_value_strtype result = ustr_to_propstr(resultU);
+        if (result.size() > 0)
+            page->snippetList[listId].swap(result);
+        else
+            page->snippetList[listId] = rawText;
+
+        //process only if summary is ON
+        if (page->summaryOn)
+        {
+            izenelib::util::UString summary;
+            getSummary(rawUText, sentenceOffsets, page->numSentences,
+                       page->option, page->queryTerms, summary);
+
+            page->rawSummaryList[listId] = ustr_to_propstr(summary);
+        }
     }
 }
 
@@ -673,10 +977,9 @@ bool DocumentManager::getRawTextOfOneDocument(
         }
     }
 
-    maxSnippetLength_ = getDisplayLength_(propertyName);
     izenelib::util::UString tempustr;
     processOptionForRawText(option, queryTerms, propstr_to_ustr(rawText), sentenceOffsets,
-                            tempustr);
+                            getDisplayLength_(propertyName), tempustr);
 
     outSnippet = ustr_to_propstr(tempustr);
     //put raw text to outSnippet if it is empty
@@ -692,6 +995,7 @@ bool DocumentManager::processOptionForRawText(
         const std::vector<izenelib::util::UString>& queryTerms,
         const izenelib::util::UString& rawText,
         const std::vector<CharacterOffset>& sentenceOffsets,
+        unsigned int snippetLength,
         izenelib::util::UString& result)
 {
     switch (option)
@@ -706,12 +1010,12 @@ bool DocumentManager::processOptionForRawText(
 
     case X_SNIPPET:
         snippetGenerator_->getSnippet(rawText, sentenceOffsets, queryTerms,
-                                      maxSnippetLength_, false, encodingType_, result);
+                                      snippetLength, false, encodingType_, result);
         break;
 
     case O_SNIPPET:
         snippetGenerator_->getSnippet(rawText, sentenceOffsets, queryTerms,
-                                      maxSnippetLength_, true, encodingType_, result);
+                                      snippetLength, true, encodingType_, result);
         break;
     }
     return true;
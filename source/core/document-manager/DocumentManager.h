@@ -33,6 +33,8 @@
 
 #include <boost/thread.hpp>
 #include <boost/dynamic_bitset.hpp>
+#include <boost/function.hpp>
+#include <boost/threadpool.hpp>
 
 namespace ilplib
 {
@@ -76,12 +78,16 @@ public:
      *
      * @param path working directory, all disk files should reside here
      * @param propertyConfigs property specification read from config file.
+     * @param storedPropertyGroups the properties stored and compressed
+     *        together, the other properties are stored separately.
      */
     DocumentManager(
             const std::string& path,
             const IndexBundleSchema& indexSchema,
             izenelib::util::UString::EncodingType encondingType,
-            size_t documentCacheNum = 20000);
+            size_t documentCacheNum = 20000,
+            const std::vector<std::vector<std::string> >& storedPropertyGroups =
+                std::vector<std::vector<std::string> >());
 
     void setZambeziConfig(const ZambeziConfig& zambeziConfig);
     /**
@@ -154,6 +160,24 @@ public:
      */
     bool getDocument(docid_t docId, Document& document, bool forceget = false);
 
+    /**
+     * @brief gets the properties @p propertyNames of one document, including
+     *        the RType properties. In the columnar layout, only the columns
+     *        of these properties are decoded, otherwise the whole document
+     *        is read.
+     * @param[out] document it is not touched if returning \c false
+     * @return \c true if the document existed.
+     */
+    bool getDocumentProperties(
+            docid_t docId,
+            const std::vector<std::string>& propertyNames,
+            Document& document);
+
+    /**
+     * @brief gets the documents of one page, the docs not in cache are read
+     *        in the order of doc id, and in parallel for a large page.
+     * @return \c true if all the documents are found.
+     */
     bool getDocuments(
             const std::vector<unsigned int>& ids,
             vector<Document>& docs,
@@ -318,6 +342,55 @@ private:
      */
     bool restorePropertyLengthDb_();
 
+    /**
+     * @brief gets the properties stored in columns, only their columns are
+     *        decompressed.
+     * @return \c false if the doc is not found, or the storage is not
+     *         columnar, or any property is not stored in columns, such as
+     *         the RType and alias properties.
+     */
+    bool getColumnProperties_(
+            docid_t docId,
+            const std::vector<std::string>& propertyNames,
+            Document& document);
+
+    /// a job processes the docs in the range [begin, end) of one page
+    typedef boost::function<void(std::size_t, std::size_t)> PageJob;
+
+    /**
+     * @brief splits the @p docNum docs of one page into ranges, and runs
+     *        @p job on them in @c pageThreadPool_, it returns after all the
+     *        ranges are processed. A small page is processed in the calling
+     *        thread only.
+     */
+    void runPageJobs_(std::size_t docNum, const PageJob& job);
+
+    void runPageJob_(
+            const PageJob& job,
+            std::size_t begin,
+            std::size_t end,
+            boost::detail::atomic_count* finishedJobs);
+
+    /**
+     * @brief reads the docs at positions @p missList[begin, end) of @p ids,
+     *        @p missList is sorted by doc id.
+     */
+    void fetchDocuments_(
+            const std::vector<unsigned int>& ids,
+            const std::vector<std::size_t>& missList,
+            bool forceget,
+            std::vector<Document>& docs,
+            std::vector<char>& isFound,
+            std::size_t begin,
+            std::size_t end);
+
+    /// the texts, snippets and summaries of one page in getRawTextOfDocuments
+    struct RawTextPage;
+
+    void fetchRawTexts_(RawTextPage* page, std::size_t begin, std::size_t end);
+
+    void processRawTexts_(RawTextPage* page, std::size_t begin, std::size_t end);
+
     /**
      * @brief process options for summary, snippet and highlight for getRawText
      *        interfaces defined above.
@@ -328,6 +401,7 @@ private:
      *                done depending upon option
      * @param sentenceOffsets offset pairs corresponding to rawtext for generating
      *                        sentence pairs for both summary and snippet
+     * @param snippetLength the max length of snippet
      * @param[out] result holds processed text, would either be highlighted text,
      *              highlighted snippet text, snippet text or rawtext itself.
      * @return returns true when option is processed correctly
@@ -337,6 +411,7 @@ private:
             const std::vector<izenelib::util::UString>& queryTerms,
             const izenelib::util::UString& rawText,
             const std::vector<CharacterOffset>& sentenceOffsets,
+            unsigned int snippetLength,
             izenelib::util::UString& result);
 
     /**
@@ -415,7 +490,7 @@ private:
     /// @brief maps property name to the display Length
     boost::unordered_map<std::string, unsigned int> displayLengthMap_;
 
-    /// @brief display length from the configuration to limit the length of snippets
+    /// @brief the default display length, if it is not configured in property
     unsigned int maxSnippetLength_;
 
     /// @brief used for calling snippet generation submanager to generate snippet
@@ -426,6 +501,11 @@ private:
 
     boost::shared_mutex shared_mutex_;
 
+    /// @brief the threads to read and process the docs of one page
+    boost::threadpool::pool pageThreadPool_;
+
+    std::size_t pageThreadNum_;
+
 private:
     static const std::string INDEX_FILE;
     static const std::string ACL_FILE;
@@ -49,31 +49,56 @@ bool TextSummarizationSubManager::getOffsetPairs(
     std::vector<std::vector<TermId> > sentenceListInTermId;
     std::vector<std::pair<CharacterOffset, CharacterOffset> > sentencesOffsetPairs;
 
-    UString sentence;
-    CharacterOffset startPos = 0;
+    if (!tokenizer_.get())
+    {
+        tokenizer_.reset(new la::Tokenizer);
+    }
+    la::Tokenizer& tokenizer = *tokenizer_;
+
+    // langIdAnalyzer_ and idManager_ are not reentrant, so only they are
+    // called under the lock, while the sentences are tokenized in parallel
     {
         boost::mutex::scoped_lock guard(mutex_);
+        CharacterOffset startPos = 0;
         while (std::size_t len = langIdAnalyzer_->sentenceLength(textBody, startPos))
         {
-            sentence.assign(textBody, startPos, len);
+            sentencesOffsetPairs.push_back(make_pair(startPos, startPos+len));
+            startPos += len;
+        }
+    }
 
-            /// Replace the old inefficient API to the new one. - Wei, 2010.08.25
-            TermId id;
-            sentenceListInTermId.push_back(vector<TermId>());
-            vector<TermId>& sentenceIds = sentenceListInTermId.back();
+    UString sentence;
+    std::vector<UString> tokens;
+    std::vector<std::size_t> sentenceEnds;
+    for (std::size_t i = 0; i < sentencesOffsetPairs.size(); ++i)
+    {
+        const CharacterOffset startPos = sentencesOffsetPairs[i].first;
+        sentence.assign(textBody, startPos, sentencesOffsetPairs[i].second - startPos);
 
-            tokenizer_.tokenize(sentence);
-            while (tokenizer_.nextToken())
+        tokenizer.tokenize(sentence);
+        while (tokenizer.nextToken())
+        {
+            if (!tokenizer.isDelimiter())
             {
-                if (!tokenizer_.isDelimiter())
-                {
-                    idManager_->getTermIdByTermString(izenelib::util::UString(tokenizer_.getToken(), tokenizer_.getLength()), id);
-                    sentenceIds.push_back(id);
-                }
+                tokens.push_back(izenelib::util::UString(tokenizer.getToken(), tokenizer.getLength()));
             }
+        }
+        sentenceEnds.push_back(tokens.size());
+    }
 
-            sentencesOffsetPairs.push_back(make_pair(startPos, startPos+len));
-            startPos += len;
+    sentenceListInTermId.resize(sentencesOffsetPairs.size());
+    {
+        boost::mutex::scoped_lock guard(mutex_);
+        std::size_t tokenIndex = 0;
+        for (std::size_t i = 0; i < sentenceEnds.size(); ++i)
+        {
+            /// Replace the old inefficient API to the new one. - Wei, 2010.08.25
+            vector<TermId>& sentenceIds = sentenceListInTermId[i];
+            sentenceIds.resize(sentenceEnds[i] - tokenIndex);
+            for (std::size_t j = 0; j < sentenceIds.size(); ++j, ++tokenIndex)
+            {
+                idManager_->getTermIdByTermString(tokens[tokenIndex], sentenceIds[j]);
+            }
         }
     }
     //initialize first value to be 0 by default
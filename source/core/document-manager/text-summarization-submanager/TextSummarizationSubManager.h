@@ -20,6 +20,7 @@
 #include <util/ustring/UString.h>
 #include <la/tokenizer/Tokenizer.h>
 #include <la/util/UStringUtil.h>
+#include <boost/thread/tss.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/locks.hpp>
 #include <vector>
@@ -75,7 +76,11 @@ public:
     ///until charoffset could be got from LAManager
     boost::shared_ptr<izenelib::ir::idmanager::IDManager> idManager_;
 
-    la::Tokenizer tokenizer_;
+    /// each indexing thread has its own tokenizer, so that the documents
+    /// could be summarized in parallel
+    boost::thread_specific_ptr<la::Tokenizer> tokenizer_;
+
+    /// serialize the calls to langIdAnalyzer_ and idManager_
     boost::mutex mutex_;
 };
 
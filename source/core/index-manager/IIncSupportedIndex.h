@@ -34,6 +34,10 @@ public:
     virtual void preProcessForAPI() = 0;
     virtual void postProcessForAPI() = 0;
 
+    // Analyze the new doc before insertDocument() is called on it, so that
+    // the analysis could run in multiple threads, the default does nothing.
+    virtual void prepareInsertDocument(const Document& doc) {}
+
     virtual bool insertDocument(const Document& doc, time_t timestamp) = 0;
     virtual bool updateDocument(const Document& olddoc, const Document& old_rtype_doc,
         const Document& newdoc, int updateType, time_t timestamp) = 0;
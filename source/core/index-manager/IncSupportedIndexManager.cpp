@@ -79,6 +79,12 @@ void IncSupportedIndexManager::postProcessForAPI()
         inc_index_list_[i]->postProcessForAPI();
 }
 
+void IncSupportedIndexManager::prepareInsertDocument(const Document& doc)
+{
+    for (size_t i = 0; i< inc_index_list_.size(); ++i)
+        inc_index_list_[i]->prepareInsertDocument(doc);
+}
+
 //all insertDocument is realtime ...
 bool IncSupportedIndexManager::insertDocument(const Document& doc, time_t timestamp)
 {
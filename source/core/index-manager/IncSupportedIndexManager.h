@@ -31,6 +31,7 @@ public:
     void postProcessForAPI();
     void setDocumentManager(boost::shared_ptr<DocumentManager>& documentManager);
 
+    void prepareInsertDocument(const Document& doc);
     bool insertDocument(const Document& doc, time_t timestamp);
     bool updateDocument(const Document& olddoc, const Document& old_rtype_doc,
         const Document& newdoc, int updateType, time_t timestamp);
@@ -349,12 +349,17 @@ void InvertedIndexManager::preBuildFromSCD(std::size_t total_filesize)
         deletebinlog();
         setIndexMode("default");
     }
+
+    clearPreparedDocs_();
 }
 
 void InvertedIndexManager::postBuildFromSCD(time_t timestamp)
 {
     if (index_mode_selector_)
         index_mode_selector_->TryCommit();
+
+    // the docs failed to insert
+    clearPreparedDocs_();
 }
 
 void InvertedIndexManager::preMining()
@@ -1079,13 +1084,47 @@ bool InvertedIndexManager::prepareIndexDocumentForUpdate(const Document& olddoc,
     return true;
 }
 
+void InvertedIndexManager::prepareInsertDocument(const Document& newdoc)
+{
+    IndexerDocumentPtr indexdoc(new IndexerDocument);
+    prepareIndexDocumentForInsert(newdoc, bundleConfig_->indexSchema_, *indexdoc);
+
+    boost::mutex::scoped_lock lock(preparedDocsMutex_);
+    preparedDocs_[newdoc.getId()] = indexdoc;
+}
+
 bool InvertedIndexManager::insertDocument(const Document& newdoc, time_t timestamp)
 {
-    IndexerDocument indexdoc;
-    prepareIndexDocumentForInsert(newdoc, bundleConfig_->indexSchema_, indexdoc);
+    IndexerDocumentPtr indexdoc = takePreparedDoc_(newdoc.getId());
+    if (!indexdoc)
+    {
+        indexdoc.reset(new IndexerDocument);
+        prepareIndexDocumentForInsert(newdoc, bundleConfig_->indexSchema_, *indexdoc);
+    }
 
-    prepareIndexRTypeProperties_(newdoc.getId(), bundleConfig_->indexSchema_, indexdoc);
-    return izenelib::ir::indexmanager::Indexer::insertDocument(indexdoc);
+    // the rtype values are read from DocumentManager, after the doc is inserted
+    prepareIndexRTypeProperties_(newdoc.getId(), bundleConfig_->indexSchema_, *indexdoc);
+    return izenelib::ir::indexmanager::Indexer::insertDocument(*indexdoc);
+}
+
+InvertedIndexManager::IndexerDocumentPtr InvertedIndexManager::takePreparedDoc_(docid_t docId)
+{
+    IndexerDocumentPtr indexdoc;
+    boost::mutex::scoped_lock lock(preparedDocsMutex_);
+
+    boost::unordered_map<docid_t, IndexerDocumentPtr>::iterator it = preparedDocs_.find(docId);
+    if (it != preparedDocs_.end())
+    {
+        indexdoc.swap(it->second);
+        preparedDocs_.erase(it);
+    }
+    return indexdoc;
+}
+
+void InvertedIndexManager::clearPreparedDocs_()
+{
+    boost::mutex::scoped_lock lock(preparedDocsMutex_);
+    preparedDocs_.clear();
 }
 
 bool InvertedIndexManager::updateDocument(const Document& olddoc, const Document& old_rtype_doc, const Document& newdoc,
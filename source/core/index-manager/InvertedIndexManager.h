@@ -26,6 +26,8 @@
 #include <boost/tuple/tuple.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/enable_shared_from_this.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/thread/mutex.hpp>
 #include "IIncSupportedIndex.h"
 
 namespace sf1r
@@ -141,14 +143,18 @@ public:
     virtual void preProcessForAPI();
     virtual void postProcessForAPI();
 
+    ///Analyze the string and numeric properties of the new doc, it is thread-safe
+    virtual void prepareInsertDocument(const Document& doc);
     virtual bool insertDocument(const Document& doc, time_t timestamp);
     virtual bool updateDocument(const Document& olddoc, const Document& old_rtype_doc, const Document& newdoc, int updateType, time_t timestamp);
     virtual void removeDocument(docid_t docid, time_t timestamp);
 
     void getDocsByPropertyValue(const std::string& property, const PropertyType& value, std::vector<docid_t>& idlist, uint16_t max_return = 10000);
 
-private:
+    ///Convert the filter value to the type used in BTree index, @p property should be in upper case
     static void convertData(const std::string& property, const PropertyValue& in, PropertyType& out);
+
+private:
     bool makeForwardIndex_(
             docid_t docId,
             const Document::doc_prop_value_strtype& text,
@@ -195,6 +201,13 @@ private:
         const Document& newdoc,
         IndexerDocument& indexDocument);
 
+    typedef boost::shared_ptr<IndexerDocument> IndexerDocumentPtr;
+
+    /// take the doc analyzed by prepareInsertDocument(), NULL if not found
+    IndexerDocumentPtr takePreparedDoc_(docid_t docId);
+
+    void clearPreparedDocs_();
+
 private:
     // update type, newdoc, olddoc, newindexdoc, oldindexdoc.
     boost::shared_ptr<IndexModeSelector> index_mode_selector_;
@@ -206,6 +219,10 @@ private:
     boost::shared_ptr<izenelib::ir::idmanager::IDManager> idManager_;
     PropertyConfig dateProperty_;
 
+    /// the new docs analyzed but not inserted yet, key: doc id
+    boost::unordered_map<docid_t, IndexerDocumentPtr> preparedDocs_;
+    boost::mutex preparedDocsMutex_;
+
     friend class IndexBundleActivator;
     //friend class ProductBundleActivator;
 };
@@ -7,6 +7,7 @@
 ///     - 2009.07.09 Merged some interfaces into one by dohyun Yun.
 
 #include "LAManager.h"
+#include "QueryAnalysisCache.h"
 
 #include <la/dict/PlainDictionary.h>
 #include <util/profiler/ProfilerGroup.h>
@@ -23,6 +24,14 @@ using namespace la;
 namespace sf1r
 {
 
+namespace
+{
+/// the modes in the key of query analysis cache
+const char CACHE_MODE_TERM_LIST = 'T';
+const char CACHE_MODE_EXPANDED_QUERY = 'E';
+const char CACHE_MODE_EXPANDED_SYNONYM = 'S';
+}
+
 LAManager::LAManager(bool isMultiThreadEnv)
         : isMultiThreadEnv_(isMultiThreadEnv)
 {
@@ -45,6 +54,17 @@ bool LAManager::getTermList(
         const AnalysisInfo& analysisInfo,
         la::TermList& termList)
 {
+    QueryAnalysisCache* cache = QueryAnalysisCache::get();
+    QueryAnalysisCache::key_type cacheKey;
+    uint64_t cacheGeneration = 0;
+    if (cache->isEnabled())
+    {
+        cacheKey = QueryAnalysisCache::makeKey(analysisInfo, text, CACHE_MODE_TERM_LIST);
+        cacheGeneration = cache->generation();
+        if (cache->getTermList(cacheKey, termList))
+            return true;
+    }
+
     LA * pLA = NULL;
 
     pLA = isMultiThreadEnv_ ? laPool_->popSearchLA(analysisInfo) :
@@ -68,6 +88,9 @@ bool LAManager::getTermList(
     if (isMultiThreadEnv_)
         laPool_->pushSearchLA(analysisInfo, pLA);
 
+    if (cache->isEnabled())
+        cache->setTermList(cacheKey, cacheGeneration, termList);
+
     return true;
 }
 
@@ -78,6 +101,18 @@ bool LAManager::getExpandedQuery(
         bool isSynonymInclude,
         izenelib::util::UString& expQuery)
 {
+    QueryAnalysisCache* cache = QueryAnalysisCache::get();
+    QueryAnalysisCache::key_type cacheKey;
+    uint64_t cacheGeneration = 0;
+    if (cache->isEnabled())
+    {
+        cacheKey = QueryAnalysisCache::makeKey(analysisInfo, text,
+            isSynonymInclude ? CACHE_MODE_EXPANDED_SYNONYM : CACHE_MODE_EXPANDED_QUERY);
+        cacheGeneration = cache->generation();
+        if (cache->getExpandedQuery(cacheKey, expQuery))
+            return true;
+    }
+
     LA * pLA = NULL;
     pLA = isMultiThreadEnv_ ? laPool_->popSearchLA(analysisInfo) :
           laPool_->topSearchLA(analysisInfo);
@@ -129,6 +164,9 @@ bool LAManager::getExpandedQuery(
     if (isMultiThreadEnv_)
         laPool_->pushSearchLA(analysisInfo, pLA);
 
+    if (cache->isEnabled())
+        cache->setExpandedQuery(cacheKey, cacheGeneration, expQuery);
+
     return true;
 }
 
@@ -5,6 +5,7 @@
 
 #include <boost/tokenizer.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/bind.hpp>
 
 using namespace std;
 using namespace la;
@@ -18,17 +19,6 @@ typedef boost::tokenizer <boost::char_separator<char>,
 const boost::char_separator<char> COMMA_SEP(",");
 const boost::char_separator<char> SEMICOLON_SEP(";");
 
-void poolsize( const unordered_map<sf1r::AnalysisInfo, deque<LA*> > & pool )
-{
-    unordered_map<sf1r::AnalysisInfo, deque<LA*> >::const_iterator it;
-
-    for( it = pool.begin(); it != pool.end(); it++ )
-    {
-        cout << it->first.analyzerId_ << ":" << it->second.size() << endl;
-    }
-}
-
-
 void setOptions( const std::string & option, EnglishAnalyzer * ka, bool outputLog = true )
 {
     const char* o = option.c_str();
@@ -393,17 +383,7 @@ namespace sf1r
 
     LAPool::~LAPool()
     {
-        unordered_map<AnalysisInfo, deque<LA*> >::iterator it;
-        deque<LA*>::iterator la_it;
-
-        for( it = laSearchPool_.begin(); it != laSearchPool_.end(); it++ )
-        {
-            for( la_it = it->second.begin(); la_it != it->second.end(); la_it++ )
-            {
-                if( *la_it != NULL )
-                    delete *la_it;
-            }
-        }
+        laSearchPool_.clear();
 
         boost::unordered_map<AnalysisInfo, la::LA*>::iterator it2;
 
@@ -457,9 +437,11 @@ namespace sf1r
 
         AnalysisInfoVec analysisInfoVec;
         laManagerConfig.getAnalysisPairList( analysisInfoVec );
-        deque<LA*> laQueue;
         LA * pLA = NULL;
 
+        const std::size_t searchLAMaxNum = laManagerConfig.searchLAMaxNum_;
+        const std::size_t searchLAWaitTime = laManagerConfig.searchLAWaitTime_;
+
 
         // 1. create default LA which performs only Tokenizing
 
@@ -467,15 +449,19 @@ namespace sf1r
 
         if( laSearchPool_.find(dummy) == laSearchPool_.end() )
         {
+            boost::shared_ptr<SearchLAPool> searchPool(new SearchLAPool(
+                boost::bind(&LAPool::createDefaultLA, this),
+                searchLAMaxNum, searchLAWaitTime));
+
             for( unsigned int i = 0; i < LA_THREAD_NUM; i++ )
             {
                 if( (pLA = createDefaultLA()) == NULL )
                 {
                     return false;
                 }
-                laQueue.push_back( pLA );
+                searchPool->add( pLA );
             }
-            laSearchPool_.insert( make_pair(dummy, laQueue) );
+            laSearchPool_.insert( make_pair(dummy, searchPool) );
         }
 
         if( laIndexMap_.find(dummy) == laIndexMap_.end() )
@@ -493,10 +479,12 @@ namespace sf1r
         AnalysisInfoVec::const_iterator it;
         for( it = analysisInfoVec.begin(); it != analysisInfoVec.end(); it++)
         {
-            laQueue.clear();
-
             if( laSearchPool_.find(*it) == laSearchPool_.end() )
             {
+                boost::shared_ptr<SearchLAPool> searchPool(new SearchLAPool(
+                    boost::bind(&LAPool::createSearchLA_, this, *it),
+                    searchLAMaxNum, searchLAWaitTime));
+
                 // create LA for searching
                 for( unsigned int i = 0; i < LA_THREAD_NUM; i++ )
                 {
@@ -506,9 +494,9 @@ namespace sf1r
                     {
                         return false;
                     }
-                    laQueue.push_back( pLA );
+                    searchPool->add( pLA );
                 }
-                laSearchPool_.insert( make_pair(*it, laQueue) );
+                laSearchPool_.insert( make_pair(*it, searchPool) );
             }
 
             if( laIndexMap_.find(*it) == laIndexMap_.end() )
@@ -1096,64 +1084,67 @@ namespace sf1r
         }
     }
 
-    LA * LAPool::popSearchLA(const AnalysisInfo & analysisInfo )
+    LA * LAPool::createSearchLA_( const AnalysisInfo & analysisInfo )
     {
-        ScopedWriteLock<ReadWriteLock> swl( lock_ );
+        boost::mutex::scoped_lock lock( createSearchLAMutex_ );
+        return createLA( analysisInfo, false, false );
+    }
 
-        unordered_map<AnalysisInfo, deque<LA*> >::iterator it = laSearchPool_.find(analysisInfo);
+    LA * LAPool::popSearchLA(const AnalysisInfo & analysisInfo )
+    {
+        unordered_map<AnalysisInfo, boost::shared_ptr<SearchLAPool> >::iterator it =
+            laSearchPool_.find(analysisInfo);
         if(it == laSearchPool_.end())
         {
             return NULL;
         }
 
-        if( it->second.empty() )
-        {
-            // create new instance when Pool is empty
-            return createLA( analysisInfo, false, false );
-            //return NULL;
-        }
-
-        LA * temp = it->second.front();
-        it->second.pop_front();
-
-        return temp;
+        return it->second->pop();
     } //end - popSearchLA(const AnalysisInfo & analysisInfo )
 
 
 
     void LAPool::pushSearchLA(const AnalysisInfo & analysisInfo, LA * laThread )
     {
-        ScopedWriteLock<ReadWriteLock> swl( lock_ );
-
-        unordered_map<AnalysisInfo, deque<LA*> >::iterator it = laSearchPool_.find(analysisInfo);
-
-        // DO NOT limit the Pool size
-        // the pool is already full. wrong release() call
-        /*if( it->second.size() == LA_THREAD_NUM )
+        unordered_map<AnalysisInfo, boost::shared_ptr<SearchLAPool> >::iterator it =
+            laSearchPool_.find(analysisInfo);
+        if(it == laSearchPool_.end())
         {
             delete laThread;
             return;
-        }*/
+        }
 
-        it->second.push_back( laThread );
+        it->second->push( laThread );
     } // end  - pushSearchLA(const AnalysisInfo & analysisInfo, LA * laThread )
 
 
     LA * LAPool::topSearchLA(const AnalysisInfo & analysisInfo )
     {
-        unordered_map<AnalysisInfo, deque<LA*> >::iterator it = laSearchPool_.find(analysisInfo);
+        unordered_map<AnalysisInfo, boost::shared_ptr<SearchLAPool> >::iterator it =
+            laSearchPool_.find(analysisInfo);
         if(it == laSearchPool_.end())
         {
             return NULL;
         }
 
-        if( it->second.empty() )
-            return NULL;
-
-        return it->second.front();
+        return it->second->top();
     } //end - topSearchLA(const AnalysisInfo & analysisInfo )
 
 
+    void LAPool::getSearchLAStats( SearchLAPoolStats & stats ) const
+    {
+        stats = SearchLAPoolStats();
+
+        unordered_map<AnalysisInfo, boost::shared_ptr<SearchLAPool> >::const_iterator it;
+        for( it = laSearchPool_.begin(); it != laSearchPool_.end(); it++ )
+        {
+            SearchLAPoolStats poolStats;
+            it->second->getStats( poolStats );
+            stats += poolStats;
+        }
+    }
+
+
     bool LAPool::getLAConfigUnit( const string & laConfigId, LAConfigUnit & laConfigUnit ) const
     {
         std::map<std::string, LAConfigUnit>::const_iterator it = laConfigUnitMap_.find( laConfigId );
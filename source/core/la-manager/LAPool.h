@@ -2,6 +2,7 @@
 #define _LA_Pool_
 
 #include "AnalysisInformation.h"
+#include "SearchLAPool.h"
 #include <configuration-manager/LAManagerConfig.h>
 
 #include <la/LA.h>          // la-manager library
@@ -10,6 +11,8 @@
 #include <util/singleton.h>
 
 #include <boost/unordered_map.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include <deque>
 #include <map>
@@ -117,6 +120,11 @@ namespace sf1r
 
             bool getLAConfigUnit( const string & laConfigId, LAConfigUnit & laConfigUnit ) const;
 
+            ///
+            /// @brief get the stats of the search LAs of all analyses
+            ///
+            void getSearchLAStats( SearchLAPoolStats & stats ) const;
+
             void set_kma_path(const std::string& path)
             {
               kma_path_ = path;
@@ -155,9 +163,17 @@ namespace sf1r
             boost::unordered_map<AnalysisInfo, la::LA*> laIndexMap_;
 
             ///
-            /// @brief Holds the map of LAs for searching, has a pool(deque) for multithread
+            /// @brief Holds the map of LAs for searching, has a pool for multithread,
+            /// the map is only modified in init()
             ///
-            boost::unordered_map<AnalysisInfo, std::deque<la::LA*> > laSearchPool_;
+            boost::unordered_map<AnalysisInfo, boost::shared_ptr<SearchLAPool> > laSearchPool_;
+
+            ///
+            /// @brief the search LAs are created one at a time when the pool is empty
+            ///
+            la::LA* createSearchLA_( const AnalysisInfo & analysisInfo );
+
+            boost::mutex createSearchLAMutex_;
 
             /// @brief  LA unit ID mapped to its configuration
             std::map<std::string, LAConfigUnit> laConfigUnitMap_;
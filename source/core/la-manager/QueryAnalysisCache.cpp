@@ -0,0 +1,180 @@
+#include "QueryAnalysisCache.h"
+
+#include <util/singleton.h>
+#include <glog/logging.h>
+#include <boost/functional/hash.hpp>
+#include <algorithm>
+#include <cctype>
+
+namespace sf1r
+{
+
+namespace
+{
+/// the max number of shards
+const std::size_t MAX_SHARD_NUM = 16;
+
+/// separate the fields in key
+const char KEY_DELIMITER = '\x01';
+
+/**
+ * trim the whitespaces at both ends and collapse each run of inner
+ * whitespaces into one space.
+ */
+void appendNormalized(const std::string& str, std::string& result)
+{
+    bool isSpace = false;
+    for (std::string::const_iterator it = str.begin(); it != str.end(); ++it)
+    {
+        if (std::isspace(static_cast<unsigned char>(*it)))
+        {
+            isSpace = true;
+            continue;
+        }
+
+        if (isSpace && !result.empty() && result[result.size()-1] != KEY_DELIMITER)
+        {
+            result += ' ';
+        }
+        isSpace = false;
+        result += *it;
+    }
+}
+}
+
+QueryAnalysisCache* QueryAnalysisCache::get()
+{
+    return izenelib::util::Singleton<QueryAnalysisCache>::get();
+}
+
+QueryAnalysisCache::QueryAnalysisCache()
+    : maxAge_(0)
+    , generation_(0)
+    , hitCount_(0)
+    , missCount_(0)
+{
+}
+
+void QueryAnalysisCache::init(std::size_t capacity, unsigned int maxAge)
+{
+    shards_.clear();
+    maxAge_ = maxAge;
+
+    if (capacity == 0)
+    {
+        LOG(INFO) << "the query analysis cache is disabled";
+        return;
+    }
+
+    const std::size_t shardNum = std::min(capacity, MAX_SHARD_NUM);
+    const std::size_t shardCapacity = (capacity + shardNum - 1) / shardNum;
+    for (std::size_t i = 0; i < shardNum; ++i)
+    {
+        shards_.push_back(boost::shared_ptr<cache_type>(new cache_type(shardCapacity)));
+    }
+
+    LOG(INFO) << "the query analysis cache capacity: " << capacity
+              << ", shard num: " << shardNum
+              << ", max age: " << maxAge << "s";
+}
+
+QueryAnalysisCache::key_type QueryAnalysisCache::makeKey(
+    const AnalysisInfo& analysisInfo,
+    const izenelib::util::UString& text,
+    char mode)
+{
+    key_type key;
+    key += mode;
+    key += analysisInfo.analyzerId_;
+    key += KEY_DELIMITER;
+
+    for (std::set<std::string>::const_iterator it = analysisInfo.tokenizerNameList_.begin();
+         it != analysisInfo.tokenizerNameList_.end(); ++it)
+    {
+        key += *it;
+        key += KEY_DELIMITER;
+    }
+    key += KEY_DELIMITER;
+
+    std::string str;
+    text.convertString(str, izenelib::util::UString::UTF_8);
+    appendNormalized(str, key);
+
+    return key;
+}
+
+bool QueryAnalysisCache::getTermList(const key_type& key, la::TermList& termList)
+{
+    Entry entry;
+    if (!get_(key, entry) || !entry.termList)
+        return false;
+
+    termList = *entry.termList;
+    return true;
+}
+
+void QueryAnalysisCache::setTermList(const key_type& key, uint64_t generation, const la::TermList& termList)
+{
+    Entry entry;
+    entry.termList.reset(new la::TermList(termList));
+    set_(key, generation, entry);
+}
+
+bool QueryAnalysisCache::getExpandedQuery(const key_type& key, izenelib::util::UString& expQuery)
+{
+    Entry entry;
+    if (!get_(key, entry) || !entry.expQuery)
+        return false;
+
+    expQuery = *entry.expQuery;
+    return true;
+}
+
+void QueryAnalysisCache::setExpandedQuery(const key_type& key, uint64_t generation, const izenelib::util::UString& expQuery)
+{
+    Entry entry;
+    entry.expQuery.reset(new izenelib::util::UString(expQuery));
+    set_(key, generation, entry);
+}
+
+void QueryAnalysisCache::clear()
+{
+    // the stale entries would be evicted by the new ones
+    ++generation_;
+
+    LOG(INFO) << "the query analysis cache is invalidated, hit: " << hitCount()
+              << ", miss: " << missCount();
+}
+
+bool QueryAnalysisCache::get_(const key_type& key, Entry& entry)
+{
+    if (shards_.empty())
+        return false;
+
+    cache_type& shard = *shards_[boost::hash_value(key) % shards_.size()];
+    if (shard.getValueNoInsert(key, entry) &&
+        entry.generation == generation_.load() &&
+        (maxAge_ == 0 || std::time(NULL) - entry.createTime < static_cast<std::time_t>(maxAge_)))
+    {
+        ++hitCount_;
+        return true;
+    }
+
+    ++missCount_;
+    return false;
+}
+
+void QueryAnalysisCache::set_(const key_type& key, uint64_t generation, Entry& entry)
+{
+    // the text was analyzed before the dictionaries were reloaded
+    if (shards_.empty() || generation != generation_.load())
+        return;
+
+    entry.generation = generation;
+    entry.createTime = std::time(NULL);
+
+    cache_type& shard = *shards_[boost::hash_value(key) % shards_.size()];
+    shard.updateValue(key, entry);
+}
+
+} // namespace sf1r
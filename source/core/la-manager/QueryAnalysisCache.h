@@ -0,0 +1,117 @@
+/**
+ * @file QueryAnalysisCache.h
+ * @brief cache the analysis results of the search queries.
+ *
+ * The entries are kept in the LRU caches of several shards, the shard is
+ * chosen by the hash of key, so that the search threads seldom contend on
+ * the same lock. All the entries are invalidated by clear(), which is
+ * called when the dictionaries are reloaded.
+ */
+
+#ifndef SF1R_QUERY_ANALYSIS_CACHE_H
+#define SF1R_QUERY_ANALYSIS_CACHE_H
+
+#include "AnalysisInformation.h"
+
+#include <la/LA.h>
+#include <util/ustring/UString.h>
+#include <cache/IzeneCache.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/atomic.hpp>
+#include <string>
+#include <vector>
+#include <ctime>
+
+namespace sf1r
+{
+
+class QueryAnalysisCache
+{
+public:
+    typedef std::string key_type;
+
+    static QueryAnalysisCache* get();
+
+    QueryAnalysisCache();
+
+    /**
+     * it should be called before searching.
+     * @param capacity the max number of entries, 0 to disable the cache
+     * @param maxAge the seconds an entry is valid, 0 for no limit
+     */
+    void init(std::size_t capacity, unsigned int maxAge);
+
+    bool isEnabled() const { return !shards_.empty(); }
+
+    /**
+     * the key of @p text analyzed by @p analysisInfo, @p mode distinguishes
+     * the analysis functions, such as with or without synonyms.
+     */
+    static key_type makeKey(
+        const AnalysisInfo& analysisInfo,
+        const izenelib::util::UString& text,
+        char mode);
+
+    /**
+     * the generation of the entries, it should be got before analyzing
+     * the text, and passed to setTermList() or setExpandedQuery(), so that
+     * the result analyzed by the dictionaries before clear() is not stored
+     * as a valid entry.
+     */
+    uint64_t generation() const { return generation_.load(); }
+
+    bool getTermList(const key_type& key, la::TermList& termList);
+
+    void setTermList(const key_type& key, uint64_t generation, const la::TermList& termList);
+
+    bool getExpandedQuery(const key_type& key, izenelib::util::UString& expQuery);
+
+    void setExpandedQuery(const key_type& key, uint64_t generation, const izenelib::util::UString& expQuery);
+
+    /**
+     * invalidate all the entries.
+     */
+    void clear();
+
+    std::size_t hitCount() const { return hitCount_.load(); }
+
+    std::size_t missCount() const { return missCount_.load(); }
+
+private:
+    struct Entry
+    {
+        uint64_t generation;
+        std::time_t createTime;
+        boost::shared_ptr<const la::TermList> termList;
+        boost::shared_ptr<const izenelib::util::UString> expQuery;
+
+        Entry() : generation(0), createTime(0) {}
+    };
+
+    bool get_(const key_type& key, Entry& entry);
+
+    void set_(const key_type& key, uint64_t generation, Entry& entry);
+
+    typedef izenelib::cache::IzeneCache<
+        key_type,
+        Entry,
+        izenelib::util::ReadWriteLock,
+        izenelib::cache::RDE_HASH,
+        izenelib::cache::LRU
+    > cache_type;
+
+    std::vector<boost::shared_ptr<cache_type> > shards_;
+
+    unsigned int maxAge_;
+
+    boost::atomic<uint64_t> generation_;
+
+    boost::atomic<std::size_t> hitCount_;
+
+    boost::atomic<std::size_t> missCount_;
+};
+
+} // namespace sf1r
+
+#endif // SF1R_QUERY_ANALYSIS_CACHE_H
@@ -0,0 +1,229 @@
+#include "SearchLAPool.h"
+
+#include <la/LA.h>
+
+#include <glog/logging.h>
+#include <boost/thread/thread.hpp>
+#include <boost/functional/hash.hpp>
+#include <algorithm>
+
+namespace sf1r
+{
+
+namespace
+{
+/// the max number of shards in each pool
+const std::size_t MAX_SHARD_NUM = 16;
+}
+
+SearchLAPool::SearchLAPool(
+    const CreateFunc& createFunc,
+    std::size_t maxNum,
+    std::size_t waitMs)
+    : createFunc_(createFunc)
+    , maxNum_(maxNum)
+    , waitMs_(waitMs)
+    , shardNum_(std::min<std::size_t>(boost::thread::hardware_concurrency(), MAX_SHARD_NUM))
+    , poolNum_(0)
+    , waiterNum_(0)
+    , tempInUse_(0)
+    , hitNum_(0)
+    , missNum_(0)
+    , createNum_(0)
+    , waitNum_(0)
+    , tempNum_(0)
+{
+    if (maxNum_ > 0)
+    {
+        shardNum_ = std::min(shardNum_, maxNum_);
+    }
+    shardNum_ = std::max<std::size_t>(shardNum_, 1);
+    shards_.reset(new Shard[shardNum_]);
+}
+
+SearchLAPool::~SearchLAPool()
+{
+    for (std::size_t i = 0; i < shardNum_; ++i)
+    {
+        std::vector<la::LA*>& laList = shards_[i].laList;
+        for (std::vector<la::LA*>::iterator it = laList.begin();
+             it != laList.end(); ++it)
+        {
+            delete *it;
+        }
+    }
+}
+
+void SearchLAPool::add(la::LA* la)
+{
+    if (!la)
+        return;
+
+    ++poolNum_;
+    Shard& shard = shards_[poolNum_.load() % shardNum_];
+    boost::mutex::scoped_lock lock(shard.mutex);
+    shard.laList.push_back(la);
+}
+
+la::LA* SearchLAPool::pop()
+{
+    la::LA* la = popShards_(getShardId_());
+    if (la)
+    {
+        ++hitNum_;
+        return la;
+    }
+
+    ++missNum_;
+    la = createInPool_();
+    if (la)
+        return la;
+
+    return waitForPush_();
+}
+
+void SearchLAPool::push(la::LA* la)
+{
+    if (!la || deleteTemp_(la))
+        return;
+
+    {
+        Shard& shard = shards_[getShardId_()];
+        boost::mutex::scoped_lock lock(shard.mutex);
+        shard.laList.push_back(la);
+    }
+
+    if (waiterNum_.load() > 0)
+    {
+        boost::mutex::scoped_lock lock(waitMutex_);
+        waitCond_.notify_one();
+    }
+}
+
+la::LA* SearchLAPool::top()
+{
+    for (std::size_t i = 0; i < shardNum_; ++i)
+    {
+        Shard& shard = shards_[i];
+        boost::mutex::scoped_lock lock(shard.mutex);
+        if (!shard.laList.empty())
+            return shard.laList.back();
+    }
+    return NULL;
+}
+
+void SearchLAPool::getStats(SearchLAPoolStats& stats) const
+{
+    stats.hitNum = hitNum_.load();
+    stats.missNum = missNum_.load();
+    stats.createNum = createNum_.load();
+    stats.waitNum = waitNum_.load();
+    stats.tempNum = tempNum_.load();
+}
+
+std::size_t SearchLAPool::getShardId_() const
+{
+    boost::hash<boost::thread::id> hasher;
+    return hasher(boost::this_thread::get_id()) % shardNum_;
+}
+
+la::LA* SearchLAPool::popShards_(std::size_t shardId)
+{
+    for (std::size_t i = 0; i < shardNum_; ++i)
+    {
+        Shard& shard = shards_[(shardId + i) % shardNum_];
+        boost::mutex::scoped_lock lock(shard.mutex);
+        if (!shard.laList.empty())
+        {
+            la::LA* la = shard.laList.back();
+            shard.laList.pop_back();
+            return la;
+        }
+    }
+    return NULL;
+}
+
+la::LA* SearchLAPool::createInPool_()
+{
+    const std::size_t poolNum = ++poolNum_;
+    if (maxNum_ > 0 && poolNum > maxNum_)
+    {
+        --poolNum_;
+        return NULL;
+    }
+
+    la::LA* la = createFunc_();
+    if (!la)
+    {
+        --poolNum_;
+        LOG(ERROR) << "failed to create LA for searching";
+        return NULL;
+    }
+
+    ++createNum_;
+    return la;
+}
+
+la::LA* SearchLAPool::waitForPush_()
+{
+    ++waitNum_;
+
+    {
+        boost::mutex::scoped_lock lock(waitMutex_);
+        ++waiterNum_;
+
+        const boost::system_time deadline = boost::get_system_time() +
+            boost::posix_time::milliseconds(waitMs_);
+        la::LA* la = popShards_(getShardId_());
+        while (!la && waitCond_.timed_wait(lock, deadline))
+        {
+            la = popShards_(getShardId_());
+        }
+        if (!la)
+        {
+            // the last chance after timeout
+            la = popShards_(getShardId_());
+        }
+
+        --waiterNum_;
+        if (la)
+            return la;
+    }
+
+    la::LA* la = createFunc_();
+    if (!la)
+    {
+        LOG(ERROR) << "failed to create temporary LA for searching";
+        return NULL;
+    }
+
+    const std::size_t tempNum = ++tempNum_;
+    if (tempNum % 1000 == 1)
+    {
+        LOG(WARNING) << "all the " << maxNum_ << " LAs are in use, temporary LA "
+                     << "is created, total temporary LA num: " << tempNum;
+    }
+
+    boost::mutex::scoped_lock lock(waitMutex_);
+    tempSet_.insert(la);
+    ++tempInUse_;
+    return la;
+}
+
+bool SearchLAPool::deleteTemp_(la::LA* la)
+{
+    if (tempInUse_.load() == 0)
+        return false;
+
+    {
+        boost::mutex::scoped_lock lock(waitMutex_);
+        if (tempSet_.erase(la) == 0)
+            return false;
+        --tempInUse_;
+    }
+
+    delete la;
+    return true;
+}
+
+} // namespace sf1r
@@ -0,0 +1,157 @@
+/**
+ * @file SearchLAPool.h
+ * @brief the pool of LA instances of one analysis for searching.
+ *
+ * The LAs are kept in shards, each thread pops and pushes in its own shard
+ * first, so that the threads seldom contend on the same lock. The number
+ * of LAs in pool is limited, when all of them are in use, the thread waits
+ * for one returned, if timeout, a temporary LA is created for it, which is
+ * deleted when returned.
+ */
+
+#ifndef SF1R_SEARCH_LA_POOL_H
+#define SF1R_SEARCH_LA_POOL_H
+
+#include <boost/function.hpp>
+#include <boost/atomic.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/unordered_set.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <vector>
+
+namespace la
+{
+class LA;
+}
+
+namespace sf1r
+{
+
+struct SearchLAPoolStats
+{
+    /// the number of LAs popped from pool
+    std::size_t hitNum;
+
+    /// the number of pops when the pool is empty
+    std::size_t missNum;
+
+    /// the number of LAs created and kept in pool
+    std::size_t createNum;
+
+    /// the number of pops waiting for an LA returned
+    std::size_t waitNum;
+
+    /// the number of temporary LAs created after waiting timeout
+    std::size_t tempNum;
+
+    SearchLAPoolStats()
+        : hitNum(0), missNum(0), createNum(0), waitNum(0), tempNum(0)
+    {}
+
+    SearchLAPoolStats& operator+=(const SearchLAPoolStats& other)
+    {
+        hitNum += other.hitNum;
+        missNum += other.missNum;
+        createNum += other.createNum;
+        waitNum += other.waitNum;
+        tempNum += other.tempNum;
+        return *this;
+    }
+};
+
+class SearchLAPool
+{
+public:
+    typedef boost::function<la::LA*()> CreateFunc;
+
+    /**
+     * @param createFunc it is called to create a new LA
+     * @param maxNum the max number of LAs in pool, 0 for no limit
+     * @param waitMs the milliseconds to wait for an LA returned when
+     *        @p maxNum LAs are all in use
+     */
+    SearchLAPool(
+        const CreateFunc& createFunc,
+        std::size_t maxNum,
+        std::size_t waitMs);
+
+    ~SearchLAPool();
+
+    /**
+     * add an LA created in advance, it is owned by the pool.
+     */
+    void add(la::LA* la);
+
+    /**
+     * get an LA, which should be returned by push() after use.
+     * @return NULL if failed to create a new LA
+     */
+    la::LA* pop();
+
+    void push(la::LA* la);
+
+    /**
+     * get an LA without removing it from the pool, it is only used when the
+     * entire running environment is single-thread.
+     */
+    la::LA* top();
+
+    void getStats(SearchLAPoolStats& stats) const;
+
+private:
+    std::size_t getShardId_() const;
+
+    /** pop from the shards, starting from @p shardId */
+    la::LA* popShards_(std::size_t shardId);
+
+    /** reserve one place in pool and create an LA */
+    la::LA* createInPool_();
+
+    la::LA* waitForPush_();
+
+    /** @return true if @p la is a temporary LA and deleted */
+    bool deleteTemp_(la::LA* la);
+
+private:
+    const CreateFunc createFunc_;
+
+    const std::size_t maxNum_;
+
+    const std::size_t waitMs_;
+
+    struct Shard
+    {
+        boost::mutex mutex;
+        std::vector<la::LA*> laList;
+    };
+
+    std::size_t shardNum_;
+
+    boost::scoped_array<Shard> shards_;
+
+    /// the number of LAs owned by pool, including the ones in use
+    boost::atomic<std::size_t> poolNum_;
+
+    /// the threads waiting for an LA returned
+    boost::atomic<std::size_t> waiterNum_;
+
+    boost::mutex waitMutex_;
+
+    boost::condition_variable waitCond_;
+
+    /// the temporary LAs in use, guarded by @c waitMutex_
+    boost::unordered_set<la::LA*> tempSet_;
+
+    boost::atomic<std::size_t> tempInUse_;
+
+    boost::atomic<std::size_t> hitNum_;
+    boost::atomic<std::size_t> missNum_;
+    boost::atomic<std::size_t> createNum_;
+    boost::atomic<std::size_t> waitNum_;
+    boost::atomic<std::size_t> tempNum_;
+};
+
+} // namespace sf1r
+
+#endif // SF1R_SEARCH_LA_POOL_H
@@ -0,0 +1,201 @@
+#include "QueryLogWriter.h"
+#include "UserQuery.h"
+#include "RDbConnection.h"
+
+#include <glog/logging.h>
+#include <algorithm>
+
+namespace sf1r
+{
+
+namespace
+{
+/// the milliseconds to wait in the request thread when the queue is full
+const int BLOCK_WAIT_MS = 1;
+}
+
+QueryLogWriter::QueryLogWriter()
+    : queueDepth_(0)
+    , droppedCount_(0)
+    , writtenCount_(0)
+    , isRunning_(false)
+{
+}
+
+QueryLogWriter::~QueryLogWriter()
+{
+    stop();
+
+    if (queue_)
+    {
+        UserQuery* query = NULL;
+        while (queue_->pop(query))
+        {
+            delete query;
+        }
+    }
+}
+
+void QueryLogWriter::start(const QueryLogWriterConfig& config)
+{
+    if (isRunning_.load())
+        return;
+
+    config_ = config;
+    config_.batchSize = std::max<uint32_t>(config_.batchSize, 1);
+
+    if (config_.queueSize == 0)
+    {
+        LOG(INFO) << "the user queries are written synchronously";
+        return;
+    }
+
+    queue_.reset(new QueueType(config_.queueSize));
+    isRunning_.store(true);
+    flushThread_ = boost::thread(&QueryLogWriter::flushLoop_, this);
+
+    LOG(INFO) << "start writing the user queries in background, queue size: "
+              << config_.queueSize << ", batch size: " << config_.batchSize
+              << ", flush interval: " << config_.flushInterval << "ms, "
+              << (config_.isBlockOnFull ? "block" : "drop") << " on full";
+}
+
+void QueryLogWriter::stop()
+{
+    if (!isRunning_.exchange(false))
+        return;
+
+    {
+        boost::mutex::scoped_lock lock(wakeMutex_);
+        wakeCond_.notify_all();
+    }
+    flushThread_.join();
+
+    // the queries pushed after the thread exits
+    flush_();
+
+    LOG(INFO) << "stop writing the user queries, written: " << writtenCount()
+              << ", dropped: " << droppedCount();
+}
+
+bool QueryLogWriter::write(const UserQuery& query)
+{
+    if (!isRunning_.load())
+    {
+        UserQuery queryLog(query);
+        queryLog.save();
+        ++writtenCount_;
+        return true;
+    }
+
+    UserQuery* queryPtr = new UserQuery(query);
+    if (push_(queryPtr))
+        return true;
+
+    delete queryPtr;
+    ++droppedCount_;
+    return false;
+}
+
+bool QueryLogWriter::push_(UserQuery* query)
+{
+    while (!queue_->bounded_push(query))
+    {
+        if (!config_.isBlockOnFull || !isRunning_.load())
+            return false;
+
+        boost::this_thread::sleep(boost::posix_time::milliseconds(BLOCK_WAIT_MS));
+    }
+
+    if (++queueDepth_ % config_.batchSize == 0)
+    {
+        wakeCond_.notify_one();
+    }
+    return true;
+}
+
+void QueryLogWriter::flushLoop_()
+{
+    const boost::posix_time::milliseconds interval(config_.flushInterval);
+    std::size_t lastDropped = 0;
+
+    while (isRunning_.load())
+    {
+        if (queueDepth_.load() < config_.batchSize)
+        {
+            boost::mutex::scoped_lock lock(wakeMutex_);
+            wakeCond_.timed_wait(lock, interval);
+        }
+
+        flush_();
+
+        const std::size_t dropped = droppedCount();
+        if (dropped != lastDropped)
+        {
+            LOG(WARNING) << "the user query queue is full, dropped: "
+                         << dropped - lastDropped << ", total dropped: "
+                         << dropped;
+            lastDropped = dropped;
+        }
+    }
+}
+
+std::size_t QueryLogWriter::flush_()
+{
+    std::size_t totalNum = 0;
+    std::vector<UserQuery> batch;
+    batch.reserve(config_.batchSize);
+
+    UserQuery* query = NULL;
+    while (queue_->pop(query))
+    {
+        batch.push_back(*query);
+        delete query;
+        --queueDepth_;
+
+        if (batch.size() == config_.batchSize)
+        {
+            totalNum += batch.size();
+            writeBatch_(batch);
+        }
+    }
+
+    totalNum += batch.size();
+    writeBatch_(batch);
+    return totalNum;
+}
+
+void QueryLogWriter::writeBatch_(std::vector<UserQuery>& batch)
+{
+    if (batch.empty())
+        return;
+
+    try
+    {
+        if (RDbConnection::instance().logServer())
+        {
+            for (std::size_t i = 0; i < batch.size(); ++i)
+            {
+                batch[i].save_to_logserver();
+            }
+            writtenCount_ += batch.size();
+        }
+        else if (UserQuery::saveBatch(batch))
+        {
+            writtenCount_ += batch.size();
+        }
+        else
+        {
+            LOG(ERROR) << "failed to insert " << batch.size() << " user queries";
+        }
+    }
+    catch (const std::exception& e)
+    {
+        LOG(ERROR) << "exception in writing " << batch.size()
+                   << " user queries: " << e.what();
+    }
+
+    batch.clear();
+}
+
+} // namespace sf1r
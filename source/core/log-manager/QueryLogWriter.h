@@ -0,0 +1,94 @@
+/**
+ * @file QueryLogWriter.h
+ * @brief write the user queries into the log database in background.
+ *
+ * The request threads push the queries into a bounded lock-free queue, a
+ * background thread takes them out and writes each batch in one multi-row
+ * insert, or sends them to the log server.
+ */
+
+#ifndef SF1R_QUERY_LOG_WRITER_H
+#define SF1R_QUERY_LOG_WRITER_H
+
+#include "LogManagerSingleton.h"
+#include <configuration-manager/QueryLogWriterConfig.h>
+
+#include <boost/lockfree/queue.hpp>
+#include <boost/atomic.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <vector>
+
+namespace sf1r
+{
+class UserQuery;
+
+class QueryLogWriter : public LogManagerSingleton<QueryLogWriter>
+{
+public:
+    QueryLogWriter();
+
+    ~QueryLogWriter();
+
+    /**
+     * start the background thread, before it is started, or if
+     * @c config.queueSize is zero, the queries are written synchronously.
+     */
+    void start(const QueryLogWriterConfig& config);
+
+    /**
+     * stop the background thread, the queries in queue are written before
+     * it returns.
+     */
+    void stop();
+
+    /**
+     * @return false if the queue is full and @p query is dropped.
+     */
+    bool write(const UserQuery& query);
+
+    /// the number of queries waiting to be written
+    std::size_t queueDepth() const { return queueDepth_.load(); }
+
+    /// the number of queries dropped as the queue is full
+    std::size_t droppedCount() const { return droppedCount_.load(); }
+
+    /// the number of queries written
+    std::size_t writtenCount() const { return writtenCount_.load(); }
+
+private:
+    bool push_(UserQuery* query);
+
+    void flushLoop_();
+
+    /**
+     * write the queries in queue in batches.
+     * @return the number of queries taken out from queue
+     */
+    std::size_t flush_();
+
+    void writeBatch_(std::vector<UserQuery>& batch);
+
+private:
+    QueryLogWriterConfig config_;
+
+    typedef boost::lockfree::queue<UserQuery*> QueueType;
+    boost::scoped_ptr<QueueType> queue_;
+
+    boost::atomic<std::size_t> queueDepth_;
+    boost::atomic<std::size_t> droppedCount_;
+    boost::atomic<std::size_t> writtenCount_;
+
+    boost::atomic<bool> isRunning_;
+    boost::thread flushThread_;
+
+    /// used to wake up the flush thread when a batch is full
+    boost::mutex wakeMutex_;
+    boost::condition_variable wakeCond_;
+};
+
+} // namespace sf1r
+
+#endif // SF1R_QUERY_LOG_WRITER_H
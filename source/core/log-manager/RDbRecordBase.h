@@ -67,13 +67,12 @@ void createTable()
 }
 
 template <typename RDbRecordType>
-void save( RDbRecordType & record )
+void appendRecordValues( RDbRecordType & record, std::ostream & sql )
 {
     std::map<std::string, std::string> rawdata;
     record.save(rawdata);
 
-    std::stringstream sql;
-    sql << "insert into " << RDbRecordType::TableName << " values(";
+    sql << "(";
     for ( int i=0 ; i<RDbRecordType::EoC; i++ )
     {
         if( rawdata.find(RDbRecordType::ColumnName[i]) == rawdata.end() ) {
@@ -86,10 +85,40 @@ void save( RDbRecordType & record )
             sql << ", ";
         }
     }
-    sql << ");";
+    sql << ")";
+}
+
+template <typename RDbRecordType>
+void save( RDbRecordType & record )
+{
+    std::stringstream sql;
+    sql << "insert into " << RDbRecordType::TableName << " values";
+    appendRecordValues(record, sql);
+    sql << ";";
     RDbConnection::instance().exec(sql.str());
 }
 
+/// insert all the @p records in one statement
+template <typename RDbRecordType>
+bool saveBatch( std::vector<RDbRecordType> & records )
+{
+    if ( records.empty() )
+        return true;
+
+    std::stringstream sql;
+    sql << "insert into " << RDbRecordType::TableName << " values";
+    for ( std::size_t i=0 ; i<records.size(); i++ )
+    {
+        if ( i != 0 )
+        {
+            sql << ", ";
+        }
+        appendRecordValues(records[i], sql);
+    }
+    sql << ";";
+    return RDbConnection::instance().exec(sql.str());
+}
+
 template <typename RDbRecordType>
 static bool find(const std::string & select,
                  const std::string & conditions,
@@ -176,6 +205,10 @@ static bool del_record(const std::string & conditions)
             ::sf1r::save(*this); \
     }\
     \
+    static bool saveBatch(std::vector<ClassName> & records) { \
+        return ::sf1r::saveBatch(records); \
+    }\
+    \
     static bool del_record(const std::string & conditions) {\
         return ::sf1r::del_record<ClassName>(conditions); \
     }
@@ -4,7 +4,6 @@
 #include <common/QueryNormalizer.h>
 #include "MiningManager.h"
 #include "MiningTaskBuilder.h"
-#include "MultiThreadMiningTaskBuilder.h"
 #include "MiningTask.h"
 
 #include "group-manager/GroupManager.h"
@@ -39,6 +38,8 @@
 #include <index-manager/zambezi-manager/ZambeziManager.h>
 
 #include "ad-index-manager/AdIndexManager.h"
+#include "geo-index/GeoHashIndex.h"
+#include "geo-index/GeoHashMiningTask.h"
 
 #include <search-manager/SearchManager.h>
 #include <search-manager/NumericPropertyTableBuilderImpl.h>
@@ -185,8 +186,8 @@ MiningManager::MiningManager(
     , suffixMatchManager_(NULL)
     , productTokenizer_(NULL)
     , adIndexManager_(NULL)
+    , geoHashIndex_(NULL)
     , miningTaskBuilder_(NULL)
-    , multiThreadMiningTaskBuilder_(NULL)
     , hasDeletedDocDuringMining_(false)
 {
 }
@@ -194,8 +195,8 @@ MiningManager::MiningManager(
 MiningManager::~MiningManager()
 {
     if (adIndexManager_) delete adIndexManager_;
-    if (multiThreadMiningTaskBuilder_) delete multiThreadMiningTaskBuilder_;
     if (miningTaskBuilder_) delete miningTaskBuilder_;
+    if (geoHashIndex_) delete geoHashIndex_;
     if (productRankerFactory_) delete productRankerFactory_;
     if (productScorerFactory_) delete productScorerFactory_;
     if (groupLabelKnowledge_) delete groupLabelKnowledge_;
@@ -269,10 +270,10 @@ bool MiningManager::open()
             mining_schema_.attr_enable ||
             mining_schema_.product_ranking_config.isEnable ||
             mining_schema_.zambezi_config.isEnable ||
-            mining_schema_.ad_index_config.isEnable)
+            mining_schema_.ad_index_config.isEnable ||
+            mining_schema_.geo_index_config.isEnable)
         {
-            miningTaskBuilder_ = new MiningTaskBuilder( document_manager_);
-            multiThreadMiningTaskBuilder_ = new MultiThreadMiningTaskBuilder(
+            miningTaskBuilder_ = new MiningTaskBuilder(
                 document_manager_, miningConfig_.mining_task_param.threadNum);
         }
 
@@ -398,6 +399,9 @@ bool MiningManager::open()
                 suffix_match_path_, document_manager_,
                 groupManager_, attrManager_, numericTableBuilder_,
                 fuzzyNormalizer);
+            suffixMatchManager_->setBuildOptions(
+                mining_schema_.suffixmatch_schema.build_thread_num,
+                mining_schema_.suffixmatch_schema.build_memory_limit);
             VirtualConfig virtualProperty;
             suffixMatchManager_->addFMIndexProperties(mining_schema_.suffixmatch_schema.searchable_properties, virtualProperty, FMIndexManager::LESS_DV);
             suffixMatchManager_->addFMIndexProperties(mining_schema_.suffixmatch_schema.suffix_match_properties, 
@@ -440,6 +444,10 @@ bool MiningManager::open()
             LOG(ERROR) << "init AdIndexManager fail"<<endl;
             return false;
         }
+
+        if (!initGeoHashIndex_(mining_schema_.geo_index_config))
+            return false;
+
         /** product rank */
         const ProductRankingConfig& rankConfig =
             mining_schema_.product_ranking_config;
@@ -546,12 +554,6 @@ void MiningManager::DoContinue()
 
 bool MiningManager::DOMiningTask(int64_t timestamp)
 {
-
-    if (multiThreadMiningTaskBuilder_)
-    {
-        multiThreadMiningTaskBuilder_->buildCollection(timestamp);
-    }
-
     if (miningTaskBuilder_)
     {
         miningTaskBuilder_->buildCollection(timestamp);
@@ -1534,6 +1536,32 @@ bool MiningManager::initAdIndexManager_(AdIndexConfig& adIndexConfig)
     return true;
 }
 
+bool MiningManager::initGeoHashIndex_(const GeoIndexConfig& geoIndexConfig)
+{
+    if (!geoIndexConfig.isEnable)
+        return true;
+
+    const bfs::path parentDir(collectionDataPath_);
+    const bfs::path geoIndexDir(parentDir / "geo_index");
+    bfs::create_directories(geoIndexDir);
+
+    if (geoHashIndex_) delete geoHashIndex_;
+
+    geoHashIndex_ = new GeoHashIndex(geoIndexDir.string(),
+                                     geoIndexConfig.property,
+                                     geoIndexConfig.precision);
+
+    if (!geoHashIndex_->open())
+    {
+        LOG(ERROR) << "open " << geoIndexDir << " failed";
+        return false;
+    }
+
+    miningTaskBuilder_->addTask(
+        new GeoHashMiningTask(document_manager_, numericTableBuilder_, *geoHashIndex_));
+    return true;
+}
+
 const std::string& MiningManager::getOfferItemCountPropName_() const
 {
     const ProductRankingConfig& rankConfig =
@@ -84,12 +84,12 @@ class ProductForwardManager;
 class ProductRankerFactory;
 class SuffixMatchManager;
 class MiningTaskBuilder;
-class MultiThreadMiningTaskBuilder;
 class GroupLabelKnowledge;
 class NumericPropertyTableBuilder;
 class RTypeStringPropTableBuilder;
 class ZambeziManager;
 class AdIndexManager;
+class GeoHashIndex;
 class ProductTokenizer;
 
 namespace faceted
@@ -352,6 +352,11 @@ public:
         return adIndexManager_;
     }
 
+    const GeoHashIndex* GetGeoHashIndex() const
+    {
+        return geoHashIndex_;
+    }
+
     ProductTokenizer* getProductTokenizer()
     {
         return productTokenizer_;
@@ -408,6 +413,8 @@ private:
 
     bool initAdIndexManager_(AdIndexConfig& adIndexConfig);
 
+    bool initGeoHashIndex_(const GeoIndexConfig& geoIndexConfig);
+
     const std::string& getOfferItemCountPropName_() const;
 
 public:
@@ -495,12 +502,12 @@ private:
     /** AdIndexManager */
     AdIndexManager* adIndexManager_;
 
+    /** GeoHashIndex */
+    GeoHashIndex* geoHashIndex_;
+
     /** MiningTaskBuilder */
     MiningTaskBuilder* miningTaskBuilder_;
 
-    /** MultiThreadMiningTaskBuilder */
-    MultiThreadMiningTaskBuilder* multiThreadMiningTaskBuilder_;
-
     izenelib::util::CronExpression cronExpression_;
 
     static bool startSynonym_;
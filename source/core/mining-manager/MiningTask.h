@@ -8,6 +8,8 @@
 
 #include <document-manager/Document.h>
 #include <common/inttypes.h>
+#include <string>
+#include <vector>
 
 //this is for each proprety....
 namespace sf1r
@@ -26,6 +28,15 @@ public:
 
     virtual docid_t getLastDocId() = 0;
 
+    /**
+     * get the properties read in buildDocument(), only these properties are
+     * decoded from the document storage.
+     * @return false if the whole document is needed, which is the default.
+     */
+    virtual bool getNeededProperties(std::vector<std::string>& propNames) const
+    {
+        return false;
+    }
 };
 }
 
@@ -1,12 +1,29 @@
 #include "MiningTaskBuilder.h"
 #include <document-manager/DocumentManager.h>
 #include <glog/logging.h>
+#include <boost/bind.hpp>
+#include <algorithm>
+#include <iostream>
+#include <set>
 #include <vector>
 
+namespace
+{
+/**
+ * the number of docs decoded in one batch, two batches are kept in memory,
+ * one is being built while the other one is being decoded.
+ */
+const sf1r::docid_t BATCH_DOC_NUM = 8192;
+}
+
 namespace sf1r
 {
-MiningTaskBuilder::MiningTaskBuilder(boost::shared_ptr<DocumentManager> document_manager)
+MiningTaskBuilder::MiningTaskBuilder(
+    boost::shared_ptr<DocumentManager> document_manager,
+    std::size_t threadNum)
     : document_manager_(document_manager)
+    , threadNum_(std::max<std::size_t>(threadNum, 1))
+    , isProjected_(true)
 {
 }
 
@@ -20,62 +37,75 @@ MiningTaskBuilder::~MiningTaskBuilder()
 
 bool MiningTaskBuilder::buildCollection(int64_t timestamp)
 {
-    docid_t MaxDocid = document_manager_->getMaxDocId();
-
+    const docid_t MaxDocid = document_manager_->getMaxDocId();
     docid_t min_last_docid = MaxDocid;
 
-    std::vector<bool> taskFlag(taskList_.size(), true);
-
-    size_t false_count = 0;
+    taskFlag_.assign(taskList_.size(), false);
+    size_t buildNum = 0;
     for (size_t i = 0; i < taskList_.size(); ++i)
     {
-        if (!taskList_[i]->preProcess(timestamp))
+        if (taskList_[i]->preProcess(timestamp))
         {
-            taskFlag[i] = false;
-            ++false_count;
+            taskFlag_[i] = true;
+            ++buildNum;
+            min_last_docid = std::min(min_last_docid, taskList_[i]->getLastDocId());
         }
     }
 
-    if (false_count == taskList_.size()) 
+    if (buildNum == 0)
     {
         LOG (INFO) << "No build Collection...";
         return true;
     }
-    for (size_t i = 0; i < taskList_.size(); ++i)
-    {
-        min_last_docid = std::min(min_last_docid, taskList_[i]->getLastDocId());
-    }
+
+    prepareTasks_();
 
     LOG(INFO) << "begin build Collection, from docid " << min_last_docid
-              << " to " << MaxDocid;
+              << " to " << MaxDocid << ", task num: " << buildNum
+              << ", thread num: " << threadNum_
+              << ", decoded properties: "
+              << (isProjected_ ? neededProperties_.size() : 0)
+              << (isProjected_ ? "" : " (all)");
+
+    DocBatch batches[2];
+    std::size_t current = 0;
 
-    for (uint32_t docid = min_last_docid; docid <= MaxDocid; ++docid)
+    if (min_last_docid <= MaxDocid)
     {
-        Document doc;
-        if (docid % 10000 == 0)
-        {
-            std::cout << "\rinserting doc id: " << docid << "\t" << std::flush;
-        }
+        boost::thread_group threads;
+        startDecodeBatch_(min_last_docid, MaxDocid, batches[current], threads);
+        threads.join_all();
+    }
 
-        if (document_manager_->getDocument(docid, doc))
-        {
-            document_manager_->getRTypePropertiesForDocument(docid, doc);
-        }
+    for (docid_t startDocId = min_last_docid; startDocId <= MaxDocid; )
+    {
+        const DocBatch& batch = batches[current];
+        const docid_t nextDocId = startDocId + batch.docs.size();
 
-        for (size_t i = 0; i < taskList_.size(); ++i)
+        // decode the next batch while building the current one
+        boost::thread_group threads;
+        if (nextDocId <= MaxDocid && nextDocId > startDocId)
         {
-            if (taskFlag[i])
-            {
-                if (docid < taskList_[i]->getLastDocId()) continue;
-                taskList_[i]->buildDocument(docid, doc);
-            }
+            startDecodeBatch_(nextDocId, MaxDocid, batches[1 - current], threads);
         }
+
+        buildTasks_(batch);
+        threads.join_all();
+
+        std::cout << "\rbuilding doc id: " << nextDocId - 1 << "\t" << std::flush;
+
+        if (nextDocId <= startDocId)
+            break;
+
+        startDocId = nextDocId;
+        current = 1 - current;
     }
+    std::cout << std::endl;
 
     LOG(INFO) << "build Collection end";
     for (size_t i = 0; i < taskList_.size(); ++i)
     {
-        if (taskFlag[i])
+        if (taskFlag_[i])
         {
             taskList_[i]->postProcess();
         }
@@ -95,4 +125,93 @@ void MiningTaskBuilder::addTask(MiningTask* miningTask)
         LOG(INFO) << "ONE MiningTask IS ERORR";
     }
 }
+
+void MiningTaskBuilder::prepareTasks_()
+{
+    buildTasks_.clear();
+    isProjected_ = true;
+
+    std::set<std::string> propSet;
+    for (size_t i = 0; i < taskList_.size(); ++i)
+    {
+        if (!taskFlag_[i])
+            continue;
+
+        buildTasks_.push_back(i);
+
+        std::vector<std::string> propNames;
+        if (taskList_[i]->getNeededProperties(propNames))
+            propSet.insert(propNames.begin(), propNames.end());
+        else
+            isProjected_ = false;
+    }
+
+    neededProperties_.assign(propSet.begin(), propSet.end());
+}
+
+void MiningTaskBuilder::startDecodeBatch_(
+    docid_t startDocId,
+    docid_t endDocId,
+    DocBatch& batch,
+    boost::thread_group& threads)
+{
+    const std::size_t docNum = std::min(endDocId - startDocId + 1, BATCH_DOC_NUM);
+    batch.startDocId = startDocId;
+    batch.docs.clear();
+    batch.docs.resize(docNum);
+
+    // each thread decodes a continuous range of docs
+    const std::size_t docNumPerThread = (docNum + threadNum_ - 1) / threadNum_;
+    for (std::size_t begin = 0; begin < docNum; begin += docNumPerThread)
+    {
+        const std::size_t end = std::min(begin + docNumPerThread, docNum);
+        threads.create_thread(
+            boost::bind(&MiningTaskBuilder::decodeDocs_, this,
+                        &batch, begin, end));
+    }
+}
+
+void MiningTaskBuilder::decodeDocs_(
+    DocBatch* batch,
+    std::size_t begin,
+    std::size_t end)
+{
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        const docid_t docId = batch->startDocId + i;
+        Document& doc = batch->docs[i];
+
+        if (isProjected_)
+        {
+            document_manager_->getDocumentProperties(docId, neededProperties_, doc);
+        }
+        else if (document_manager_->getDocument(docId, doc))
+        {
+            document_manager_->getRTypePropertiesForDocument(docId, doc);
+        }
+    }
+}
+
+void MiningTaskBuilder::buildTasks_(const DocBatch& batch)
+{
+    for (std::size_t i = 0; i < batch.docs.size(); ++i)
+    {
+        const docid_t docId = batch.startDocId + i;
+        const Document& doc = batch.docs[i];
+
+        for (std::vector<std::size_t>::const_iterator it = buildTasks_.begin();
+             it != buildTasks_.end(); ++it)
+        {
+            if (isTaskBuild_(*it, docId))
+            {
+                taskList_[*it]->buildDocument(docId, doc);
+            }
+        }
+    }
+}
+
+bool MiningTaskBuilder::isTaskBuild_(std::size_t taskId, docid_t docId) const
+{
+    return docId >= taskList_[taskId]->getLastDocId();
+}
 }
@@ -2,30 +2,85 @@
 /// @file MiningTask.h
 /// @author hongliang.zhao@b5m.com
 /// @date Created 2012.11.28
+/// @date Updated 2013-07-24 scan the documents once for all the tasks, the
+///       documents are decoded in multi-threads.
 ///
 #ifndef SOURCE_CORE_MINING_MANAGER_MININGTASKBUILDER_H_
 #define SOURCE_CORE_MINING_MANAGER_MININGTASKBUILDER_H_
 
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
 #include "MiningTask.h"
 
+#include <string>
+#include <vector>
+
 namespace sf1r
 {
 class DocumentManager;
 
+/**
+ * It scans the documents once for all the mining tasks. The documents are
+ * decoded in batches by @c threadNum threads, each batch is decoded while
+ * the previous batch is built by the tasks in the order of doc id, as the
+ * tasks are not thread-safe. Only the properties needed by the tasks are
+ * decoded.
+ */
 class MiningTaskBuilder
 {
 public:
-    explicit MiningTaskBuilder(boost::shared_ptr<DocumentManager> document_manager);
+    MiningTaskBuilder(
+        boost::shared_ptr<DocumentManager> document_manager,
+        std::size_t threadNum = 1);
+
     ~MiningTaskBuilder();
 
     bool buildCollection(int64_t timestamp);
     void addTask(MiningTask*);
 
+private:
+    /** the docs in range [startDocId, startDocId + docs.size()) */
+    struct DocBatch
+    {
+        docid_t startDocId;
+        std::vector<Document> docs;
+    };
+
+    /** collect the tasks to build and the properties they need */
+    void prepareTasks_();
+
+    /** start decoding the docs in [startDocId, endDocId] into @p batch */
+    void startDecodeBatch_(
+        docid_t startDocId,
+        docid_t endDocId,
+        DocBatch& batch,
+        boost::thread_group& threads);
+
+    void decodeDocs_(
+        DocBatch* batch,
+        std::size_t begin,
+        std::size_t end);
+
+    /** build the tasks with the docs in @p batch, in the order of doc id */
+    void buildTasks_(const DocBatch& batch);
+
+    bool isTaskBuild_(std::size_t taskId, docid_t docId) const;
+
 private:
     std::vector<MiningTask*> taskList_;
     boost::shared_ptr<DocumentManager> document_manager_;
 
+    const std::size_t threadNum_;
+
+    std::vector<bool> taskFlag_; // true for build, false for not build
+
+    /// the tasks to build in this run
+    std::vector<std::size_t> buildTasks_;
+
+    /// false if some task needs the whole document
+    bool isProjected_;
+
+    std::vector<std::string> neededProperties_;
 };
 }
 
@@ -32,6 +32,12 @@ public:
     bool buildDocument(docid_t docID, const Document& doc);
     docid_t getLastDocId();
 
+    bool getNeededProperties(std::vector<std::string>& propNames) const
+    {
+        propNames.push_back(propName_);
+        return true;
+    }
+
 private:
     sf1r::DocumentManager& documentManager_;
     const std::string propName_;
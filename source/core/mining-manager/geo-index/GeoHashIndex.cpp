@@ -0,0 +1,355 @@
+#include "GeoHashIndex.h"
+#include "../util/fcontainer_febird.h"
+#include <search-manager/GeoHashEncoder.h>
+#include <glog/logging.h>
+#include <algorithm>
+#include <iterator>
+#include <cmath>
+#include <cstring>
+
+using namespace sf1r;
+
+namespace
+{
+const char* FILE_NAME = "geohash.bin";
+
+const char* BASE32_TABLE = "0123456789bcdefghjkmnpqrstuvwxyz";
+
+/// the max number of cells covering a query
+const std::size_t MAX_CELL_NUM = 256;
+
+/// the index is not used if it returns more than this ratio of all docs,
+/// as it is cheaper to check the distance of each doc then
+const double MAX_CANDIDATE_RATIO = 0.25;
+
+/// the meters of one degree on the meridian
+const double METERS_PER_DEGREE = 6378137.0 * M_PI / 180.0;
+
+/**
+ * the interleaved bits of @p lonIndex and @p latIndex, in the same order
+ * of geohash, that is, the first bit is from longitude.
+ */
+GeoHashIndex::code_t interleave(
+    GeoHashIndex::code_t lonIndex,
+    GeoHashIndex::code_t latIndex,
+    std::size_t bitNum)
+{
+    GeoHashIndex::code_t code = 0;
+    std::size_t lonBit = (bitNum + 1) / 2;
+    std::size_t latBit = bitNum / 2;
+
+    for (std::size_t i = 0; i < bitNum; ++i)
+    {
+        code <<= 1;
+        if (i % 2 == 0)
+            code |= (lonIndex >> --lonBit) & 1;
+        else
+            code |= (latIndex >> --latBit) & 1;
+    }
+    return code;
+}
+
+/**
+ * the index of the cell containing @p value, where [min, max] is divided
+ * into 2^bitNum cells.
+ */
+GeoHashIndex::code_t cellIndex(double value, double min, double max, std::size_t bitNum)
+{
+    const GeoHashIndex::code_t cellNum = GeoHashIndex::code_t(1) << bitNum;
+    const double pos = (value - min) / (max - min) * cellNum;
+
+    if (pos <= 0)
+        return 0;
+
+    return std::min(static_cast<GeoHashIndex::code_t>(pos), cellNum - 1);
+}
+}
+
+const GeoHashIndex::code_t GeoHashIndex::kInvalidCode = static_cast<code_t>(-1);
+const std::size_t GeoHashIndex::kMaxPrecision;
+
+GeoHashIndex::GeoHashIndex(
+    const std::string& dirPath,
+    const std::string& propName,
+    std::size_t precision)
+    : dirPath_(dirPath)
+    , propName_(propName)
+    , precision_(std::max<std::size_t>(1, std::min(precision, kMaxPrecision)))
+{
+}
+
+bool GeoHashIndex::open()
+{
+    ScopedWriteLock lock(mutex_);
+
+    if (!load_container_febird(dirPath_, FILE_NAME, docCodes_))
+        return false;
+
+    cellDocs_.clear();
+    for (std::size_t docId = 1; docId < docCodes_.size(); ++docId)
+    {
+        insertCell_(docId, docCodes_[docId]);
+    }
+
+    LOG(INFO) << "geohash index of property " << propName_
+              << ", precision: " << precision_
+              << ", doc num: " << lastDocId_()
+              << ", cell num: " << cellDocs_.size();
+    return true;
+}
+
+bool GeoHashIndex::flush()
+{
+    ScopedReadLock lock(mutex_);
+
+    return save_container_febird(dirPath_, FILE_NAME, docCodes_);
+}
+
+docid_t GeoHashIndex::getLastDocId() const
+{
+    ScopedReadLock lock(mutex_);
+
+    return lastDocId_();
+}
+
+void GeoHashIndex::append(const std::vector<code_t>& codes)
+{
+    ScopedWriteLock lock(mutex_);
+
+    if (docCodes_.empty())
+    {
+        docCodes_.push_back(kInvalidCode);
+    }
+
+    for (std::vector<code_t>::const_iterator it = codes.begin();
+         it != codes.end(); ++it)
+    {
+        const docid_t docId = docCodes_.size();
+        docCodes_.push_back(*it);
+        insertCell_(docId, *it);
+    }
+}
+
+GeoHashIndex::code_t GeoHashIndex::getCode(docid_t docId) const
+{
+    ScopedReadLock lock(mutex_);
+
+    return docId < docCodes_.size() ? docCodes_[docId] : kInvalidCode;
+}
+
+void GeoHashIndex::update(const CodeUpdates& updates)
+{
+    ScopedWriteLock lock(mutex_);
+
+    for (CodeUpdates::const_iterator it = updates.begin();
+         it != updates.end(); ++it)
+    {
+        const docid_t docId = it->first;
+        if (docId == 0 || docId >= docCodes_.size())
+            continue;
+
+        code_t& code = docCodes_[docId];
+        if (code == it->second)
+            continue;
+
+        removeCell_(docId, code);
+        code = it->second;
+        insertCell_(docId, code);
+    }
+}
+
+GeoHashIndex::code_t GeoHashIndex::encode(double longitude, double latitude)
+{
+    GeoHashEncoder encoder;
+    const std::string hash = encoder.Encoder(longitude, latitude, kMaxPrecision);
+
+    if (hash.size() != kMaxPrecision)
+        return kInvalidCode;
+
+    code_t code = 0;
+    for (std::size_t i = 0; i < hash.size(); ++i)
+    {
+        const char* pos = std::strchr(BASE32_TABLE, hash[i]);
+        code = (code << 5) | (pos - BASE32_TABLE);
+    }
+    return code;
+}
+
+bool GeoHashIndex::getDocsInRadius(
+    double longitude,
+    double latitude,
+    double radius,
+    std::vector<docid_t>& docIds) const
+{
+    if (radius <= 0 || std::abs(longitude) > 180.0 || std::abs(latitude) > 90.0)
+        return false;
+
+    const double latDelta = radius / METERS_PER_DEGREE;
+    const double maxAbsLat = std::abs(latitude) + latDelta;
+    const double minLat = std::max(latitude - latDelta, -90.0);
+    const double maxLat = std::min(latitude + latDelta, 90.0);
+
+    // the circle covers a pole, or it is too wide
+    if (maxAbsLat >= 90.0)
+        return getDocsInBox(-180.0, minLat, 180.0, maxLat, docIds);
+
+    const double lonDelta = latDelta / std::cos(maxAbsLat * M_PI / 180.0);
+    if (lonDelta >= 180.0)
+        return getDocsInBox(-180.0, minLat, 180.0, maxLat, docIds);
+
+    const double minLon = longitude - lonDelta;
+    const double maxLon = longitude + lonDelta;
+
+    // the box crosses the 180th meridian
+    if (minLon < -180.0 || maxLon > 180.0)
+    {
+        std::vector<docid_t> westDocs;
+        std::vector<docid_t> eastDocs;
+
+        if (!getDocsInBox(-180.0, minLat, maxLon - (maxLon > 180.0 ? 360.0 : 0),
+                          maxLat, westDocs) ||
+            !getDocsInBox(minLon + (minLon < -180.0 ? 360.0 : 0), minLat, 180.0,
+                          maxLat, eastDocs))
+            return false;
+
+        docIds.clear();
+        std::set_union(westDocs.begin(), westDocs.end(),
+                       eastDocs.begin(), eastDocs.end(),
+                       std::back_inserter(docIds));
+        return true;
+    }
+
+    return getDocsInBox(minLon, minLat, maxLon, maxLat, docIds);
+}
+
+bool GeoHashIndex::getDocsInBox(
+    double minLongitude,
+    double minLatitude,
+    double maxLongitude,
+    double maxLatitude,
+    std::vector<docid_t>& docIds) const
+{
+    if (minLongitude > maxLongitude || minLatitude > maxLatitude)
+        return false;
+
+    std::size_t precision = precision_;
+    std::vector<code_t> cells;
+    while (!getCoverCells(minLongitude, minLatitude, maxLongitude, maxLatitude,
+                          precision, MAX_CELL_NUM, cells))
+    {
+        if (--precision == 0)
+            return false;
+    }
+
+    const std::size_t shift = (precision_ - precision) * 5;
+
+    ScopedReadLock lock(mutex_);
+
+    typedef std::pair<CellDocsMap::const_iterator, CellDocsMap::const_iterator> Range;
+    std::vector<Range> ranges;
+    std::size_t docNum = 0;
+
+    for (std::vector<code_t>::const_iterator it = cells.begin();
+         it != cells.end(); ++it)
+    {
+        Range range(cellDocs_.lower_bound(*it << shift),
+                    cellDocs_.lower_bound((*it + 1) << shift));
+
+        for (CellDocsMap::const_iterator cellIt = range.first;
+             cellIt != range.second; ++cellIt)
+        {
+            docNum += cellIt->second.size();
+        }
+        ranges.push_back(range);
+    }
+
+    if (docNum > lastDocId_() * MAX_CANDIDATE_RATIO)
+        return false;
+
+    docIds.clear();
+    docIds.reserve(docNum);
+
+    for (std::vector<Range>::const_iterator it = ranges.begin();
+         it != ranges.end(); ++it)
+    {
+        for (CellDocsMap::const_iterator cellIt = it->first;
+             cellIt != it->second; ++cellIt)
+        {
+            docIds.insert(docIds.end(), cellIt->second.begin(), cellIt->second.end());
+        }
+    }
+
+    // each doc is in only one cell
+    std::sort(docIds.begin(), docIds.end());
+    return true;
+}
+
+bool GeoHashIndex::getCoverCells(
+    double minLongitude,
+    double minLatitude,
+    double maxLongitude,
+    double maxLatitude,
+    std::size_t precision,
+    std::size_t maxCellNum,
+    std::vector<code_t>& cells)
+{
+    const std::size_t bitNum = precision * 5;
+    const std::size_t lonBitNum = (bitNum + 1) / 2;
+    const std::size_t latBitNum = bitNum / 2;
+
+    const code_t minLonIndex = cellIndex(minLongitude, -180.0, 180.0, lonBitNum);
+    const code_t maxLonIndex = cellIndex(maxLongitude, -180.0, 180.0, lonBitNum);
+    const code_t minLatIndex = cellIndex(minLatitude, -90.0, 90.0, latBitNum);
+    const code_t maxLatIndex = cellIndex(maxLatitude, -90.0, 90.0, latBitNum);
+
+    const code_t cellNum = (maxLonIndex - minLonIndex + 1) *
+                           (maxLatIndex - minLatIndex + 1);
+    if (cellNum > maxCellNum)
+        return false;
+
+    cells.clear();
+    for (code_t lonIndex = minLonIndex; lonIndex <= maxLonIndex; ++lonIndex)
+    {
+        for (code_t latIndex = minLatIndex; latIndex <= maxLatIndex; ++latIndex)
+        {
+            cells.push_back(interleave(lonIndex, latIndex, bitNum));
+        }
+    }
+
+    std::sort(cells.begin(), cells.end());
+    return true;
+}
+
+void GeoHashIndex::insertCell_(docid_t docId, code_t code)
+{
+    if (code == kInvalidCode)
+        return;
+
+    // the docs updated in place are inserted in the middle
+    std::vector<docid_t>& docs = cellDocs_[cellCode_(code, precision_)];
+    docs.insert(std::lower_bound(docs.begin(), docs.end(), docId), docId);
+}
+
+void GeoHashIndex::removeCell_(docid_t docId, code_t code)
+{
+    if (code == kInvalidCode)
+        return;
+
+    CellDocsMap::iterator cellIt = cellDocs_.find(cellCode_(code, precision_));
+    if (cellIt == cellDocs_.end())
+        return;
+
+    std::vector<docid_t>& docs = cellIt->second;
+    std::vector<docid_t>::iterator it =
+        std::lower_bound(docs.begin(), docs.end(), docId);
+
+    if (it != docs.end() && *it == docId)
+    {
+        docs.erase(it);
+    }
+
+    if (docs.empty())
+    {
+        cellDocs_.erase(cellIt);
+    }
+}
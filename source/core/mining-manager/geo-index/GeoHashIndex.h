@@ -0,0 +1,158 @@
+/**
+ * @file GeoHashIndex.h
+ * @brief a spatial index which maps each geohash cell to the docs located
+ *        in it, it is used to get the candidate docs of a radius query.
+ * @date Created 2013-07-30
+ *
+ * The geohash code of each doc is kept in the finest precision, while the
+ * docs are grouped by the cells of the configured precision. A query is
+ * covered by the cells of the finest precision not exceeding the
+ * configured one, under the limit of cell number, as the cells of the
+ * same prefix are continuous in the sorted cell map.
+ */
+
+#ifndef SF1R_GEO_HASH_INDEX_H
+#define SF1R_GEO_HASH_INDEX_H
+
+#include <common/PropSharedLock.h>
+#include <common/inttypes.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+
+namespace sf1r
+{
+
+class GeoHashIndex : public PropSharedLock
+{
+public:
+    /// the geohash code in the finest precision
+    typedef uint64_t code_t;
+
+    /// the code of the doc without valid location
+    static const code_t kInvalidCode;
+
+    /// the max length of geohash string
+    static const std::size_t kMaxPrecision = 12;
+
+    /**
+     * @param dirPath the directory to save index
+     * @param propName the property name of geo location
+     * @param precision the geohash length of the cells
+     */
+    GeoHashIndex(
+        const std::string& dirPath,
+        const std::string& propName,
+        std::size_t precision);
+
+    const std::string& propName() const { return propName_; }
+
+    std::size_t precision() const { return precision_; }
+
+    bool open();
+    bool flush();
+
+    /**
+     * @return the max doc id indexed.
+     */
+    docid_t getLastDocId() const;
+
+    /**
+     * append the codes of docs starting from doc id getLastDocId() + 1.
+     */
+    void append(const std::vector<code_t>& codes);
+
+    /**
+     * @return the code of @p docId, @c kInvalidCode if it is not indexed.
+     */
+    code_t getCode(docid_t docId) const;
+
+    /// the new code of each doc updated in place
+    typedef std::vector<std::pair<docid_t, code_t> > CodeUpdates;
+
+    /**
+     * move the docs updated in place into their new cells.
+     */
+    void update(const CodeUpdates& updates);
+
+    /**
+     * get the geohash code of location.
+     * @return @c kInvalidCode if the location is invalid
+     */
+    static code_t encode(double longitude, double latitude);
+
+    /**
+     * get the docs in the cells covering the circle, the docs out of the
+     * circle might also be included.
+     * @param radius the radius in meters
+     * @param docIds [OUT] the doc ids in ascending order
+     * @return false if the circle is too large to use the index
+     */
+    bool getDocsInRadius(
+        double longitude,
+        double latitude,
+        double radius,
+        std::vector<docid_t>& docIds) const;
+
+    /**
+     * get the docs in the cells covering the bounding box, the docs out of
+     * the box might also be included.
+     * @param docIds [OUT] the doc ids in ascending order
+     * @return false if the box is too large to use the index
+     */
+    bool getDocsInBox(
+        double minLongitude,
+        double minLatitude,
+        double maxLongitude,
+        double maxLatitude,
+        std::vector<docid_t>& docIds) const;
+
+    /**
+     * get the cells of @p precision covering the bounding box.
+     * @param cells [OUT] the cell codes in @p precision
+     * @return false if the cells are more than @p maxCellNum
+     */
+    static bool getCoverCells(
+        double minLongitude,
+        double minLatitude,
+        double maxLongitude,
+        double maxLatitude,
+        std::size_t precision,
+        std::size_t maxCellNum,
+        std::vector<code_t>& cells);
+
+private:
+    docid_t lastDocId_() const
+    {
+        return docCodes_.empty() ? 0 : docCodes_.size() - 1;
+    }
+
+    void insertCell_(docid_t docId, code_t code);
+
+    void removeCell_(docid_t docId, code_t code);
+
+    code_t cellCode_(code_t code, std::size_t precision) const
+    {
+        return code >> ((kMaxPrecision - precision) * 5);
+    }
+
+private:
+    const std::string dirPath_;
+
+    const std::string propName_;
+
+    const std::size_t precision_;
+
+    /// the code of each doc, indexed by doc id
+    std::vector<code_t> docCodes_;
+
+    typedef std::map<code_t, std::vector<docid_t> > CellDocsMap;
+
+    /// the docs in each cell, in ascending order of doc id
+    CellDocsMap cellDocs_;
+};
+
+} // namespace sf1r
+
+#endif // SF1R_GEO_HASH_INDEX_H
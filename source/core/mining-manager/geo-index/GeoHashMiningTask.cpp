@@ -0,0 +1,123 @@
+#include "GeoHashMiningTask.h"
+#include <document-manager/DocumentManager.h>
+#include <search-manager/NumericPropertyTableBuilder.h>
+#include <glog/logging.h>
+#include <cmath>
+
+using namespace sf1r;
+
+GeoHashMiningTask::GeoHashMiningTask(
+    const boost::shared_ptr<DocumentManager>& documentManager,
+    NumericPropertyTableBuilder* numericTableBuilder,
+    GeoHashIndex& geoHashIndex)
+    : documentManager_(documentManager)
+    , numericTableBuilder_(numericTableBuilder)
+    , geoHashIndex_(geoHashIndex)
+{
+}
+
+bool GeoHashMiningTask::buildDocument(docid_t docID, const Document& doc)
+{
+    const docid_t nextDocId = geoHashIndex_.getLastDocId() + codes_.size() + 1;
+
+    // the doc is built for other tasks
+    if (docID < nextDocId)
+        return true;
+
+    codes_.resize(docID - nextDocId, GeoHashIndex::kInvalidCode);
+    codes_.push_back(getCode_(docID));
+
+    return true;
+}
+
+bool GeoHashMiningTask::preProcess(int64_t timestamp)
+{
+    propertyTable_ = numericTableBuilder_->createPropertyTable(
+        geoHashIndex_.propName());
+
+    if (!propertyTable_)
+    {
+        LOG(ERROR) << "no numeric table of geo property "
+                   << geoHashIndex_.propName();
+        return false;
+    }
+
+    updateIndexedDocs_();
+
+    if (geoHashIndex_.getLastDocId() >= documentManager_->getMaxDocId())
+    {
+        propertyTable_.reset();
+        return false;
+    }
+
+    codes_.clear();
+    return true;
+}
+
+bool GeoHashMiningTask::postProcess()
+{
+    geoHashIndex_.append(codes_);
+    std::vector<GeoHashIndex::code_t>().swap(codes_);
+    propertyTable_.reset();
+
+    if (!geoHashIndex_.flush())
+    {
+        LOG(ERROR) << "failed to save geohash index of property "
+                   << geoHashIndex_.propName();
+        return false;
+    }
+
+    return true;
+}
+
+void GeoHashMiningTask::updateIndexedDocs_()
+{
+    const docid_t lastDocId = geoHashIndex_.getLastDocId();
+    GeoHashIndex::CodeUpdates updates;
+
+    for (docid_t docId = 1; docId <= lastDocId; ++docId)
+    {
+        const GeoHashIndex::code_t code = getCode_(docId);
+        if (code != geoHashIndex_.getCode(docId))
+        {
+            updates.push_back(std::make_pair(docId, code));
+        }
+    }
+
+    if (updates.empty())
+        return;
+
+    geoHashIndex_.update(updates);
+
+    LOG(INFO) << "geohash index of property " << geoHashIndex_.propName()
+              << ", updated doc num: " << updates.size();
+
+    if (!geoHashIndex_.flush())
+    {
+        LOG(ERROR) << "failed to save geohash index of property "
+                   << geoHashIndex_.propName();
+    }
+}
+
+GeoHashIndex::code_t GeoHashMiningTask::getCode_(docid_t docId) const
+{
+    std::pair<double, double> location;
+    if (propertyTable_->getDoublePairValue(docId, location) &&
+        std::abs(location.first) <= 180.0 && std::abs(location.second) <= 90.0)
+    {
+        return GeoHashIndex::encode(location.first, location.second);
+    }
+
+    return GeoHashIndex::kInvalidCode;
+}
+
+docid_t GeoHashMiningTask::getLastDocId()
+{
+    return geoHashIndex_.getLastDocId() + 1;
+}
+
+bool GeoHashMiningTask::getNeededProperties(std::vector<std::string>& propNames) const
+{
+    // the locations are read from numeric table
+    return true;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file GeoHashMiningTask.h
+ * @brief the mining task to append the new docs into GeoHashIndex.
+ * @date Created 2013-07-30
+ * @date Updated 2013-08-07 move the docs updated in place
+ *
+ * The location of each doc is read from the numeric property table, which
+ * is built in indexing, so no property is decoded from document storage.
+ * As the location might be updated in place without new docs, each run
+ * also checks the docs indexed, and moves those changed into new cells.
+ */
+
+#ifndef SF1R_GEO_HASH_MINING_TASK_H
+#define SF1R_GEO_HASH_MINING_TASK_H
+
+#include "../MiningTask.h"
+#include "GeoHashIndex.h"
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+namespace sf1r
+{
+class DocumentManager;
+class NumericPropertyTableBase;
+class NumericPropertyTableBuilder;
+
+class GeoHashMiningTask : public MiningTask
+{
+public:
+    GeoHashMiningTask(
+        const boost::shared_ptr<DocumentManager>& documentManager,
+        NumericPropertyTableBuilder* numericTableBuilder,
+        GeoHashIndex& geoHashIndex);
+
+    bool buildDocument(docid_t docID, const Document& doc);
+
+    bool preProcess(int64_t timestamp);
+
+    bool postProcess();
+
+    docid_t getLastDocId();
+
+    bool getNeededProperties(std::vector<std::string>& propNames) const;
+
+private:
+    /**
+     * move the docs indexed into new cells if their locations are changed.
+     */
+    void updateIndexedDocs_();
+
+    GeoHashIndex::code_t getCode_(docid_t docId) const;
+
+private:
+    boost::shared_ptr<DocumentManager> documentManager_;
+
+    NumericPropertyTableBuilder* numericTableBuilder_;
+
+    GeoHashIndex& geoHashIndex_;
+
+    boost::shared_ptr<NumericPropertyTableBase> propertyTable_;
+
+    /// the codes of the new docs
+    std::vector<GeoHashIndex::code_t> codes_;
+};
+
+} // namespace sf1r
+
+#endif // SF1R_GEO_HASH_MINING_TASK_H
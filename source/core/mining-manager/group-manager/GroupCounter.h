@@ -3,6 +3,7 @@
 /// @brief base class to count docs for property values
 /// @author Jun Jiang <jun.jiang@izenesoft.com>
 /// @date Created 2011-09-05
+/// @date Updated 2013-08-02 count the docs in batch, and scale the sampled counts
 ///
 
 #ifndef SF1R_GROUP_COUNTER_H
@@ -22,6 +23,30 @@ public:
 
     virtual void addDoc(docid_t doc) = 0;
 
+    /**
+     * count the @p num docs, which are mostly in ascending order,
+     * the sub class could override it to count them in one pass over
+     * its property table.
+     */
+    virtual void addDocs(const docid_t* docs, std::size_t num)
+    {
+        for (std::size_t i = 0; i < num; ++i)
+        {
+            addDoc(docs[i]);
+        }
+    }
+
+    /**
+     * @return true if the counts could be scaled by @c scaleCounts(),
+     *         then it could count only a sample of the docs.
+     */
+    virtual bool isScalable() const { return false; }
+
+    /**
+     * multiply each doc count by @p ratio, after counting a sample of the docs.
+     */
+    virtual void scaleCounts(double ratio) {}
+
     virtual void getGroupRep(GroupRep& groupRep) = 0;
 
     virtual void getStringRep(GroupRep::StringGroupRep& strRep, int level) {}
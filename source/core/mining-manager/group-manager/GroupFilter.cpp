@@ -12,15 +12,24 @@
 #include "../attr-manager/AttrLabel.h"
 #include <common/PropSharedLockSet.h>
 #include <query-manager/SearchingEnumerator.h>
+#include <search-manager/SearchThreadBudget.h>
 #include <util/ClockTimer.h>
 
 #include <glog/logging.h>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <algorithm>
 
 NS_FACETED_BEGIN
 
+const std::size_t GroupFilter::kMinParallelDocNum;
+
 GroupFilter::GroupFilter(const GroupParam& groupParam)
     : groupParam_(groupParam)
     , attrCounter_(NULL)
+    , threadBudget_(NULL)
+    , minParallelDocNum_(kMinParallelDocNum)
 {
 }
 
@@ -51,8 +60,8 @@ bool GroupFilter::initGroup(
     GroupCounterLabelBuilder& builder,
     PropSharedLockSet& sharedLockSet)
 {
-    // map from prop name to GroupCounter instance
-    typedef std::map<std::string, GroupCounter*> GroupCounterMap;
+    // map from prop name to the index in groupCounters_
+    typedef std::map<std::string, int> GroupCounterMap;
     GroupCounterMap groupCounterMap;
 
     const std::vector<GroupPropParam>& groupProps = groupParam_.groupProps_;
@@ -65,7 +74,7 @@ bool GroupFilter::initGroup(
             GroupCounter* counter = builder.createGroupCounter(*it, sharedLockSet);
             if (counter)
             {
-                groupCounterMap[propName] = counter;
+                groupCounterMap[propName] = groupCounters_.size();
                 groupCounters_.push_back(counter);
             }
             else
@@ -88,13 +97,16 @@ bool GroupFilter::initGroup(
         GroupLabel* label = builder.createGroupLabel(*labelIt, sharedLockSet);
         if (label)
         {
+            int counterIndex = -1;
             GroupCounterMap::iterator counterIt = groupCounterMap.find(propName);
             if (counterIt != groupCounterMap.end())
             {
-                label->setCounter(counterIt->second);
+                counterIndex = counterIt->second;
+                label->setCounter(groupCounters_[counterIndex]);
             }
 
             groupLabels_.push_back(label);
+            labelCounterIndexes_.push_back(counterIndex);
         }
         else
         {
@@ -103,6 +115,7 @@ bool GroupFilter::initGroup(
         }
     }
 
+    failDocs_.resize(groupCounters_.size());
     return true;
 }
 
@@ -181,10 +194,9 @@ bool GroupFilter::test(docid_t doc)
 
     if (result)
     {
-        for (std::vector<GroupCounter*>::iterator it = groupCounters_.begin();
-            it != groupCounters_.end(); ++it)
+        if (!groupCounters_.empty())
         {
-            (*it)->addDoc(doc);
+            passDocs_.push_back(doc);
         }
 
         if (attrCounter_)
@@ -206,10 +218,10 @@ bool GroupFilter::test(docid_t doc)
         else
         {
             // fail in group label
-            GroupCounter* counter = groupLabels_[failIndex]->getCounter();
-            if (counter)
+            const int counterIndex = labelCounterIndexes_[failIndex];
+            if (counterIndex >= 0)
             {
-                counter->addDoc(doc);
+                failDocs_[counterIndex].push_back(doc);
             }
         }
     }
@@ -217,6 +229,14 @@ bool GroupFilter::test(docid_t doc)
     return result;
 }
 
+void GroupFilter::setThreadBudget(
+    SearchThreadBudget* threadBudget,
+    std::size_t minParallelDocNum)
+{
+    threadBudget_ = threadBudget;
+    minParallelDocNum_ = minParallelDocNum;
+}
+
 void GroupFilter::getGroupRep(
     GroupRep& groupRep,
     OntologyRep& attrRep
@@ -224,6 +244,8 @@ void GroupFilter::getGroupRep(
 {
     izenelib::util::ClockTimer timer;
 
+    countDocs_();
+
     for (std::vector<GroupCounter*>::iterator it = groupCounters_.begin();
         it != groupCounters_.end(); ++it)
     {
@@ -249,4 +271,90 @@ void GroupFilter::getGroupRep(
     LOG(INFO) << "GroupFilter::getGroupRep() costs " << timer.elapsed() << " seconds";
 }
 
+void GroupFilter::countDocs_()
+{
+    const std::size_t counterNum = groupCounters_.size();
+
+    // the docs are tested in the order of the caller, such as in score
+    // order or interleaved by the search threads, so they are sorted
+    // here once to access the property tables in doc id order
+    std::sort(passDocs_.begin(), passDocs_.end());
+
+    // the threads are reserved from the same budget of search threads,
+    // so the concurrent queries would not oversubscribe the cpu cores,
+    // and this thread counts the rest when the budget is used up
+    boost::scoped_ptr<SearchThreadLease> threadLease;
+    if (threadBudget_ && counterNum > 1 && passDocs_.size() >= minParallelDocNum_)
+    {
+        threadLease.reset(new SearchThreadLease(*threadBudget_, counterNum - 1));
+    }
+
+    boost::detail::atomic_count nextIndex(0);
+    boost::thread_group threads;
+    const std::size_t threadNum = threadLease ? threadLease->threadNum() : 0;
+    for (std::size_t i = 0; i < threadNum; ++i)
+    {
+        threads.create_thread(
+            boost::bind(&GroupFilter::countCounters_, this, &nextIndex));
+    }
+
+    countCounters_(&nextIndex);
+    threads.join_all();
+
+    // the docs are counted only once
+    std::vector<docid_t>().swap(passDocs_);
+    std::vector<std::vector<docid_t> >(counterNum).swap(failDocs_);
+}
+
+void GroupFilter::countCounters_(boost::detail::atomic_count* nextIndex)
+{
+    const std::size_t counterNum = groupCounters_.size();
+
+    for (std::size_t i = ++(*nextIndex) - 1; i < counterNum;
+         i = ++(*nextIndex) - 1)
+    {
+        countCounterDocs_(i);
+    }
+}
+
+void GroupFilter::countCounterDocs_(std::size_t counterIndex)
+{
+    GroupCounter* counter = groupCounters_[counterIndex];
+    std::vector<docid_t>& failDocs = failDocs_[counterIndex];
+
+    // as passDocs_ has been sorted in countDocs_(), sort the fail docs
+    // of this counter, and merge them to access the table in doc id order
+    std::vector<docid_t> mergeDocs;
+    const std::vector<docid_t>* docs = &passDocs_;
+    if (!failDocs.empty())
+    {
+        std::sort(failDocs.begin(), failDocs.end());
+        mergeDocs.resize(passDocs_.size() + failDocs.size());
+        std::merge(passDocs_.begin(), passDocs_.end(),
+                   failDocs.begin(), failDocs.end(),
+                   mergeDocs.begin());
+        docs = &mergeDocs;
+    }
+
+    const std::size_t docNum = docs->size();
+    if (docNum == 0)
+        return;
+
+    const std::size_t sampleNum = std::max(groupParam_.groupSampleDocNum_, 0);
+    if (sampleNum > 0 && docNum > sampleNum && counter->isScalable())
+    {
+        std::vector<docid_t> sampleDocs(sampleNum);
+        for (std::size_t i = 0; i < sampleNum; ++i)
+        {
+            sampleDocs[i] = (*docs)[i * docNum / sampleNum];
+        }
+
+        counter->addDocs(&sampleDocs[0], sampleNum);
+        counter->scaleCounts(static_cast<double>(docNum) / sampleNum);
+        return;
+    }
+
+    counter->addDocs(&(*docs)[0], docNum);
+}
+
 NS_FACETED_END
@@ -3,14 +3,22 @@
 /// @brief filter docs which do not belong to selected labels
 /// @author Jun Jiang <jun.jiang@izenesoft.com>
 /// @date Created 2011-07-28
+/// @date Updated 2013-08-02 count the group docs in deferred passes
+/// @date Updated 2013-08-07 lease the counting threads from search budget
 ///
 
 #ifndef SF1R_GROUP_FILTER_H
 #define SF1R_GROUP_FILTER_H
 
 #include "faceted_types.h"
+#include <boost/detail/atomic_count.hpp>
+#include <vector>
 
-namespace sf1r { class PropSharedLockSet; }
+namespace sf1r
+{
+class PropSharedLockSet;
+class SearchThreadBudget;
+}
 
 NS_FACETED_BEGIN
 
@@ -56,9 +64,26 @@ public:
      */
     bool test(docid_t doc);
 
+    /**
+     * let the group counters run in parallel on the threads leased from
+     * @p threadBudget, it should only be set when the search runs in one
+     * thread, otherwise the counters run in the search thread one by one.
+     * @param minParallelDocNum the counters run in parallel only if there
+     *        are at least this number of docs to count
+     */
+    void setThreadBudget(
+        SearchThreadBudget* threadBudget,
+        std::size_t minParallelDocNum = kMinParallelDocNum);
+
+    /// the default min number of docs to count in parallel, as it is not
+    /// worth the thread overhead for fewer docs
+    static const std::size_t kMinParallelDocNum = 100000;
+
     /**
      * Get doc counts for property values and attribute values,
      * it counts the param @p doc in previous calls of @c test().
+     * The docs for group counters are buffered in @c test(), and each
+     * counter counts them here in one pass.
      * @param groupRep doc counts for property values
      * @param attrRep doc counts for attribute values
      */
@@ -67,6 +92,24 @@ public:
         OntologyRep& attrRep
     );
 
+private:
+    /**
+     * let each group counter count its buffered docs,
+     * the counters run in parallel if there are many docs.
+     */
+    void countDocs_();
+
+    /**
+     * take the counters from @p nextIndex one by one and count their docs,
+     * until all counters are taken.
+     */
+    void countCounters_(boost::detail::atomic_count* nextIndex);
+
+    /**
+     * let the group counter at @p counterIndex count its buffered docs.
+     */
+    void countCounterDocs_(std::size_t counterIndex);
+
 private:
     const GroupParam& groupParam_;
 
@@ -76,11 +119,29 @@ private:
     /** group counter instances */
     std::vector<GroupCounter*> groupCounters_;
 
+    /** for each group label, the index of its counter in @c groupCounters_,
+     *  -1 for no counter */
+    std::vector<int> labelCounterIndexes_;
+
+    /**
+     * the docs passing all labels, to count by all group counters,
+     * they are in the order of test() calls, and sorted before counting
+     */
+    std::vector<docid_t> passDocs_;
+
+    /** for each group counter, the docs failing only its label */
+    std::vector<std::vector<docid_t> > failDocs_;
+
     /** attr label instances */
     std::vector<AttrLabel*> attrLabels_;
 
     /** attr counter instance */
     AttrCounter* attrCounter_;
+
+    /** if not NULL, the counting threads are leased from it */
+    SearchThreadBudget* threadBudget_;
+
+    std::size_t minParallelDocNum_;
 };
 
 NS_FACETED_END
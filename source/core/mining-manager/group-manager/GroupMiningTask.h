@@ -103,6 +103,12 @@ public:
         return startDocId_;
     }
 
+    bool getNeededProperties(std::vector<std::string>& propNames) const
+    {
+        propNames.push_back(propName_);
+        return true;
+    }
+
 private:
     bool isRebuildProp_(const std::string& propName) const
     {
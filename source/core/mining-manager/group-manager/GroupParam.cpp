@@ -155,6 +155,7 @@ GroupParam::GroupParam()
     : isAttrGroup_(false)
     , attrGroupNum_(0)
     , attrIterDocNum_(0)
+    , groupSampleDocNum_(0)
     , searchMode_(SearchingMode::DefaultSearchingMode)
     , isAttrToken_(false)
 {
@@ -310,6 +311,7 @@ bool operator==(const GroupParam& a, const GroupParam& b)
            a.isAttrGroup_ == b.isAttrGroup_ &&
            a.attrGroupNum_ == b.attrGroupNum_ &&
            a.attrIterDocNum_ == b.attrIterDocNum_ &&
+           a.groupSampleDocNum_ == b.groupSampleDocNum_ &&
            a.attrLabels_ == b.attrLabels_ &&
            a.searchMode_ == b.searchMode_;
 }
@@ -340,6 +342,7 @@ std::ostream& operator<<(std::ostream& out, const GroupParam& groupParam)
     out << "isAttrGroup_: " << groupParam.isAttrGroup_ << std::endl;
     out << "attrGroupNum_: " << groupParam.attrGroupNum_ << std::endl;
     out << "attrIterDocNum_: " << groupParam.attrIterDocNum_ << std::endl;
+    out << "groupSampleDocNum_: " << groupParam.groupSampleDocNum_ << std::endl;
 
     out << "attrLabels_: ";
     for (GroupParam::AttrLabelMap::const_iterator labelIt = groupParam.attrLabels_.begin();
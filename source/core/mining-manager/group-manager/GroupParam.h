@@ -111,6 +111,13 @@ struct GroupParam
     /** to get attributes, the number of docs to iterate */
     int attrIterDocNum_;
 
+    /**
+     * if a property has more docs to count than this number, only this
+     * number of docs are sampled evenly, and the counts are scaled up,
+     * 0 for counting all docs.
+     */
+    int groupSampleDocNum_;
+
     /** a list of attribute values for one attribute name */
     typedef std::vector<std::string> AttrValueVec;
     /** map from attribute name to attribute values */
@@ -3,6 +3,7 @@
 /// @brief count docs for numeric property values
 /// @author August Njam Grong <ran.long@izenesoft.com>
 /// @date Created 2011-09-05
+/// @date Updated 2013-08-02 scale the sampled counts
 ///
 
 #ifndef SF1R_NUMERIC_GROUP_COUNTER_H
@@ -32,6 +33,8 @@ public:
 
     virtual NumericGroupCounter* clone() const;
     virtual void addDoc(docid_t doc);
+    virtual bool isScalable() const;
+    virtual void scaleCounts(double ratio);
     virtual void getGroupRep(GroupRep& groupRep);
     virtual void getStringRep(GroupRep::StringGroupRep& strRep, int level);
 
@@ -96,6 +99,33 @@ void NumericGroupCounter<SubGroupCounter>::addDoc(docid_t doc)
     }
 }
 
+template<typename CounterType>
+bool NumericGroupCounter<CounterType>::isScalable() const
+{
+    return true;
+}
+
+template<>
+bool NumericGroupCounter<SubGroupCounter>::isScalable() const
+{
+    return false;
+}
+
+template<typename CounterType>
+void NumericGroupCounter<CounterType>::scaleCounts(double ratio)
+{
+    for (typename std::map<double, CounterType>::iterator it = countTable_.begin();
+        it != countTable_.end(); ++it)
+    {
+        it->second = static_cast<CounterType>(it->second * ratio + 0.5);
+    }
+}
+
+template<>
+void NumericGroupCounter<SubGroupCounter>::scaleCounts(double ratio)
+{
+}
+
 template<typename CounterType>
 void NumericGroupCounter<CounterType>::getGroupRep(GroupRep &groupRep)
 {
@@ -10,6 +10,7 @@
 
 #include "faceted_types.h"
 #include "../MiningException.hpp"
+#include <common/ChunkedVector.h>
 #include <vector>
 #include <boost/static_assert.hpp>
 #include <boost/lexical_cast.hpp>
@@ -35,18 +36,29 @@ struct PropIdTable
     void getIdList(docid_t docId, PropIdList& propIdList) const;
     size_t getIdCount(docid_t docId) const;
 
+    /**
+     * increment @p countTable[id] for each value id of the @p num docs,
+     * which is a tight pass over the table instead of a @c getIdList()
+     * for each doc.
+     * @return the number of docs having any value id
+     */
+    template <typename CountType>
+    std::size_t countIds(const docid_t* docIds, std::size_t num, CountType* countTable) const;
+
     template <class IdContainer>
     void setIdList(docid_t docId, const IdContainer& idContainer);
 
     /// key: doc id
     /// value: if the most significant bit is 0, it's just the single value id
     ///        for the doc, otherwise, the following bits give the index in @c multiValueTable_.
-    std::vector<index_t> indexTable_;
+    /// as the table is copied by TableSwapper in incremental mining,
+    /// it is chunked to share the chunks not modified.
+    ChunkedVector<index_t> indexTable_;
 
     /// key: index
     /// value: the count of value ids for the doc,
     ///        the following values are each value id for the doc.
-    std::vector<valueid_t> multiValueTable_;
+    ChunkedVector<valueid_t> multiValueTable_;
 
     /// the most significant bit for index type
     static const index_t INDEX_MSB = index_t(1) << (sizeof(index_t)*8 - 1);
@@ -63,7 +75,7 @@ template <typename valueid_t, typename index_t>
 class PropIdTable<valueid_t, index_t>::PropIdList
 {
 public:
-    PropIdList() : size_(0), singleValueId_(0) {}
+    PropIdList() : size_(0), singleValueId_(0), multiValueTable_(NULL), multiValueIndex_(0) {}
 
     std::size_t size() const { return size_; }
 
@@ -74,7 +86,7 @@ public:
         if (i >= size_)
             return 0;
 
-        return (size_ == 1) ? singleValueId_ : multiValueIter_[i];
+        return (size_ == 1) ? singleValueId_ : (*multiValueTable_)[multiValueIndex_ + i];
     }
 
     void clear()
@@ -90,8 +102,11 @@ private:
     /// when there is only one value id
     valueid_t singleValueId_;
 
-    /// when there are multiple value ids, the iterator to the first value id
-    typename std::vector<valueid_t>::const_iterator multiValueIter_;
+    /// when there are multiple value ids, the table of them
+    const ChunkedVector<valueid_t>* multiValueTable_;
+
+    /// the index of the first value id in @c multiValueTable_
+    std::size_t multiValueIndex_;
 
     friend struct PropIdTable<valueid_t, index_t>;
 };
@@ -141,11 +156,10 @@ void PropIdTable<valueid_t, index_t>::getIdList(docid_t docId, PropIdList& propI
     if (index & INDEX_MSB)
     {
         index &= INDEX_MASK;
-        typename std::vector<valueid_t>::const_iterator it =
-            multiValueTable_.begin() + index;
 
-        propIdList.size_ = *it;
-        propIdList.multiValueIter_ = ++it;
+        propIdList.size_ = multiValueTable_[index];
+        propIdList.multiValueTable_ = &multiValueTable_;
+        propIdList.multiValueIndex_ = index + 1;
     }
     else if (index)
     {
@@ -172,6 +186,47 @@ size_t PropIdTable<valueid_t, index_t>::getIdCount(docid_t docId) const
     }
 }
 
+template <typename valueid_t, typename index_t>
+template <typename CountType>
+std::size_t PropIdTable<valueid_t, index_t>::countIds(
+    const docid_t* docIds,
+    std::size_t num,
+    CountType* countTable) const
+{
+    const std::size_t tableSize = indexTable_.size();
+    std::size_t docNum = 0;
+
+    for (std::size_t i = 0; i < num; ++i)
+    {
+        const docid_t docId = docIds[i];
+        if (docId >= tableSize)
+            continue;
+
+        const index_t index = indexTable_[docId];
+
+        // most docs have a single value id
+        if (!(index & INDEX_MSB))
+        {
+            if (index)
+            {
+                ++countTable[index];
+                ++docNum;
+            }
+            continue;
+        }
+
+        std::size_t pos = index & INDEX_MASK;
+        const std::size_t end = pos + 1 + multiValueTable_[pos];
+        for (++pos; pos < end; ++pos)
+        {
+            ++countTable[multiValueTable_[pos]];
+        }
+        ++docNum;
+    }
+
+    return docNum;
+}
+
 template <typename valueid_t, typename index_t>
 template <class IdContainer>
 void PropIdTable<valueid_t, index_t>::setIdList(docid_t docId, const IdContainer& idContainer)
@@ -181,7 +236,7 @@ void PropIdTable<valueid_t, index_t>::setIdList(docid_t docId, const IdContainer
         indexTable_.resize(docId + 1);
     }
 
-    index_t& index = indexTable_[docId];
+    index_t& index = indexTable_.at(docId);
     const std::size_t inputNum = idContainer.size();
 
     switch (inputNum)
@@ -220,8 +275,11 @@ void PropIdTable<valueid_t, index_t>::setIdList(docid_t docId, const IdContainer
 
             index = INDEX_MSB | valueTableSize;
             multiValueTable_.push_back(inputNum);
-            multiValueTable_.insert(multiValueTable_.end(),
-                idContainer.begin(), idContainer.end());
+            for (typename IdContainer::const_iterator it = idContainer.begin();
+                 it != idContainer.end(); ++it)
+            {
+                multiValueTable_.push_back(*it);
+            }
             break;
         }
     }
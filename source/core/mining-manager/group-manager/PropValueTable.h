@@ -127,6 +127,16 @@ public:
         valueIdTable_.getIdList(docId, propIdList);
     }
 
+    /**
+     * increment @p countTable[pvId] for each value id of the @p num docs.
+     * @return the number of docs having any value id
+     */
+    template <typename CountType>
+    std::size_t countPropIds(const docid_t* docIds, std::size_t num, CountType* countTable) const
+    {
+        return valueIdTable_.countIds(docIds, num, countTable);
+    }
+
     const ChildMapTable& childMapTable() const { return childMapTable_; }
 
     const ParentIdTable& parentIdTable() const { return parentIdVec_; }
@@ -3,6 +3,7 @@
 /// @brief count docs for string property values
 /// @author Jun Jiang <jun.jiang@izenesoft.com>
 /// @date Created 2011-07-29
+/// @date Updated 2013-08-02 count the docs in batch
 ///
 
 #ifndef SF1R_STRING_GROUP_COUNTER_H
@@ -28,6 +29,9 @@ public:
 
     virtual StringGroupCounter* clone() const;
     virtual void addDoc(docid_t doc);
+    virtual void addDocs(const docid_t* docs, std::size_t num);
+    virtual bool isScalable() const;
+    virtual void scaleCounts(double ratio);
     virtual void getGroupRep(GroupRep& groupRep);
     virtual void getStringRep(GroupRep::StringGroupRep& strRep, int level);
 
@@ -126,6 +130,56 @@ void StringGroupCounter<SubGroupCounter>::addDoc(docid_t doc)
     ++countTable_[0].count_;
 }
 
+template<typename CounterType>
+void StringGroupCounter<CounterType>::addDocs(const docid_t* docs, std::size_t num)
+{
+    if (countTable_.empty())
+        return;
+
+    const std::size_t docNum =
+        propValueTable_.countPropIds(docs, num, &countTable_[0]);
+
+    // total doc count for this property
+    countTable_[0] += docNum;
+}
+
+template<>
+void StringGroupCounter<SubGroupCounter>::addDocs(const docid_t* docs, std::size_t num)
+{
+    // each doc is also counted by the sub-property counter
+    for (std::size_t i = 0; i < num; ++i)
+    {
+        addDoc(docs[i]);
+    }
+}
+
+template<typename CounterType>
+bool StringGroupCounter<CounterType>::isScalable() const
+{
+    return true;
+}
+
+template<>
+bool StringGroupCounter<SubGroupCounter>::isScalable() const
+{
+    return false;
+}
+
+template<typename CounterType>
+void StringGroupCounter<CounterType>::scaleCounts(double ratio)
+{
+    for (typename std::vector<CounterType>::iterator it = countTable_.begin();
+         it != countTable_.end(); ++it)
+    {
+        *it = static_cast<CounterType>(*it * ratio + 0.5);
+    }
+}
+
+template<>
+void StringGroupCounter<SubGroupCounter>::scaleCounts(double ratio)
+{
+}
+
 template<typename CounterType>
 void StringGroupCounter<CounterType>::appendGroupRep(
     const PropValueTable::ChildMapTable& childMapTable,
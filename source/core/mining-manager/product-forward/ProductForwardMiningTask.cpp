@@ -20,6 +20,11 @@ ProductForwardMiningTask::~ProductForwardMiningTask()
 {
 }
 
+namespace
+{
+const std::string TITLE_PROP_NAME("Title");
+}
+
 bool ProductForwardMiningTask::buildDocument(docid_t docID, const Document& doc)
 {
     bool failed = (doc.getId() == 0);
@@ -27,8 +32,7 @@ bool ProductForwardMiningTask::buildDocument(docid_t docID, const Document& doc)
 
     if (!failed)
     {
-        const std::string pname("Title");
-        doc.getString(pname, src);
+        doc.getString(TITLE_PROP_NAME, src);
         std::string res;
         featureParser_.getFeatureStr(src, res);
         tmp_index_[docID]=res;
@@ -41,6 +45,12 @@ bool ProductForwardMiningTask::buildDocument(docid_t docID, const Document& doc)
 
 
 
+bool ProductForwardMiningTask::getNeededProperties(std::vector<std::string>& propNames) const
+{
+    propNames.push_back(TITLE_PROP_NAME);
+    return true;
+}
+
 docid_t ProductForwardMiningTask::getLastDocId()
 {
     return forward_index_->getLastDocId() + 1;
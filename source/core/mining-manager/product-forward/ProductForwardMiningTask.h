@@ -28,6 +28,8 @@ public:
 
     docid_t getLastDocId();
 
+    bool getNeededProperties(std::vector<std::string>& propNames) const;
+
 private:
     boost::shared_ptr<DocumentManager> document_manager_;
 
@@ -119,7 +119,7 @@ void ProductScoreManager::clearSearchCache_()
         return;
 
     LOG(INFO) << "clearing search cache";
-    searchCache_->clear();
+    searchCache_->nextGeneration();
 }
 
 ProductScorer* ProductScoreManager::createProductScorer(
@@ -16,3 +16,11 @@ score_t ProductScoreReader::score(docid_t docId)
 {
     return productScoreTable_.getScoreNoLock(docId);
 }
+
+void ProductScoreReader::scoreBatch(const docid_t* docIds, std::size_t num, score_t* scores)
+{
+    for (std::size_t i = 0; i < num; ++i)
+    {
+        scores[i] = productScoreTable_.getScoreNoLock(docIds[i]);
+    }
+}
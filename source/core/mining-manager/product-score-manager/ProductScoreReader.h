@@ -24,6 +24,8 @@ public:
 
     virtual score_t score(docid_t docId);
 
+    virtual void scoreBatch(const docid_t* docIds, std::size_t num, score_t* scores);
+
 private:
     const ProductScoreTable& productScoreTable_;
 
@@ -2,6 +2,12 @@
 
 using namespace sf1r;
 
+namespace
+{
+/// the score of category not calculated yet
+const score_t kUnknownScore = -1;
+}
+
 CategoryScorer::CategoryScorer(
     const ProductScoreConfig& config,
     const faceted::PropValueTable& categoryValueTable,
@@ -29,6 +35,39 @@ CategoryScorer::CategoryScorer(
 score_t CategoryScorer::score(docid_t docId)
 {
     category_id_t catId = categoryValueTable_.getFirstValueId(docId);
+    return categoryScore_(catId);
+}
+
+void CategoryScorer::scoreBatch(const docid_t* docIds, std::size_t num, score_t* scores)
+{
+    if (catIdScores_.empty())
+    {
+        catIdScores_.resize(categoryValueTable_.propValueNum(), kUnknownScore);
+    }
+
+    const std::size_t catIdNum = catIdScores_.size();
+
+    for (std::size_t i = 0; i < num; ++i)
+    {
+        category_id_t catId = categoryValueTable_.getFirstValueId(docIds[i]);
+
+        if (catId >= catIdNum)
+        {
+            scores[i] = categoryScore_(catId);
+            continue;
+        }
+
+        score_t& catScore = catIdScores_[catId];
+        if (catScore < 0)
+        {
+            catScore = categoryScore_(catId);
+        }
+        scores[i] = catScore;
+    }
+}
+
+score_t CategoryScorer::categoryScore_(category_id_t catId)
+{
     categoryValueTable_.getParentIds(catId, parentIds_);
     CategoryScores::const_iterator endIt = categoryScores_.end();
 
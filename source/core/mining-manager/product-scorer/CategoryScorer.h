@@ -34,6 +34,15 @@ public:
 
     virtual score_t score(docid_t docId);
 
+    /**
+     * the score of each category is calculated only once for all the
+     * batches, as the docs of the same category share the score.
+     */
+    virtual void scoreBatch(const docid_t* docIds, std::size_t num, score_t* scores);
+
+private:
+    score_t categoryScore_(category_id_t catId);
+
 private:
     const faceted::PropValueTable& categoryValueTable_;
     const faceted::PropValueTable::ParentIdTable& parentIdTable_;
@@ -50,6 +59,9 @@ private:
     CategoryScores categoryScores_;
 
     std::vector<category_id_t> parentIds_;
+
+    /// the score of each category id, negative if not calculated yet
+    std::vector<score_t> catIdScores_;
 };
 
 } // namespace sf1r
@@ -1,6 +1,6 @@
 #include "NumericPropertyScorer.h"
 #include <common/NumericPropertyTableBase.h>
-#include <algorithm> // min, max
+#include <algorithm> // min, max, fill
 #include <glog/logging.h>
 
 using namespace sf1r;
@@ -34,11 +34,32 @@ NumericPropertyScorer::NumericPropertyScorer(
 }
 
 score_t NumericPropertyScorer::score(docid_t docId)
+{
+    return calculate_(docId, true);
+}
+
+void NumericPropertyScorer::scoreBatch(const docid_t* docIds, std::size_t num, score_t* scores)
+{
+    if (minMaxDiff_ == 0)
+    {
+        std::fill(scores, scores + num, 0);
+        return;
+    }
+
+    NumericPropertyTableBase::ScopedReadLock lock(numericTable_->getMutex());
+
+    for (std::size_t i = 0; i < num; ++i)
+    {
+        scores[i] = calculate_(docIds[i], false);
+    }
+}
+
+score_t NumericPropertyScorer::calculate_(docid_t docId, bool isLock) const
 {
     score_t value = 0;
 
     if (minMaxDiff_ == 0 ||
-        !numericTable_->getFloatValue(docId, value) ||
+        !numericTable_->getFloatValue(docId, value, isLock) ||
         !config_.isValidScore(value))
         return 0;
 
@@ -28,6 +28,14 @@ public:
 
     virtual score_t score(docid_t docId);
 
+    /**
+     * the numeric table is locked once for all the docs.
+     */
+    virtual void scoreBatch(const docid_t* docIds, std::size_t num, score_t* scores);
+
+private:
+    score_t calculate_(docid_t docId, bool isLock) const;
+
 private:
     const ProductScoreConfig& config_;
     boost::shared_ptr<NumericPropertyTableBase> numericTable_;
@@ -20,3 +20,17 @@ score_t ProductScoreAverage::score(docid_t docId)
 
     return average;
 }
+
+void ProductScoreAverage::scoreBatch(const docid_t* docIds, std::size_t num, score_t* scores)
+{
+    ProductScoreSum::scoreBatch(docIds, num, scores);
+
+    const std::size_t scorerNum = scorerNum_();
+    if (scorerNum == 0)
+        return;
+
+    for (std::size_t i = 0; i < num; ++i)
+    {
+        scores[i] /= scorerNum;
+    }
+}
@@ -24,6 +24,8 @@ public:
     ProductScoreAverage(const ProductScoreConfig& config);
 
     virtual score_t score(docid_t docId);
+
+    virtual void scoreBatch(const docid_t* docIds, std::size_t num, score_t* scores);
 };
 
 } // namespace sf1r
@@ -1,4 +1,6 @@
 #include "ProductScoreSum.h"
+#include <algorithm>
+
 using namespace sf1r;
 
 ProductScoreSum::ProductScoreSum(const ProductScoreConfig& config)
@@ -18,6 +20,11 @@ ProductScoreSum::~ProductScoreSum()
 void ProductScoreSum::addScorer(ProductScorer* scorer)
 {
     scorers_.push_back(scorer);
+
+    if (scorer->needPrepareDoc())
+    {
+        preparedScorers_.push_back(scorer);
+    }
 }
 
 score_t ProductScoreSum::score(docid_t docId)
@@ -34,6 +41,40 @@ score_t ProductScoreSum::score(docid_t docId)
     return sum;
 }
 
+void ProductScoreSum::scoreBatch(const docid_t* docIds, std::size_t num, score_t* scores)
+{
+    std::fill(scores, scores + num, 0);
+
+    if (num == 0)
+        return;
+
+    batchScores_.resize(num);
+    score_t* batchScores = &batchScores_[0];
+
+    for (Scorers::iterator it = scorers_.begin();
+         it != scorers_.end(); ++it)
+    {
+        ProductScorer* scorer = *it;
+        const score_t weight = scorer->weight();
+
+        scorer->scoreBatch(docIds, num, batchScores);
+
+        for (std::size_t i = 0; i < num; ++i)
+        {
+            scores[i] += batchScores[i] * weight;
+        }
+    }
+}
+
+void ProductScoreSum::prepareDoc(docid_t docId)
+{
+    for (Scorers::iterator it = preparedScorers_.begin();
+         it != preparedScorers_.end(); ++it)
+    {
+        (*it)->prepareDoc(docId);
+    }
+}
+
 std::size_t ProductScoreSum::scorerNum_() const
 {
     return scorers_.size();
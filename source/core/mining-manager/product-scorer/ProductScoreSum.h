@@ -31,12 +31,28 @@ public:
 
     virtual score_t score(docid_t docId);
 
+    /**
+     * sum up the scores column by column, that is, each scorer is called
+     * once for all the docs.
+     */
+    virtual void scoreBatch(const docid_t* docIds, std::size_t num, score_t* scores);
+
+    virtual bool needPrepareDoc() const { return !preparedScorers_.empty(); }
+
+    virtual void prepareDoc(docid_t docId);
+
 protected:
     std::size_t scorerNum_() const;
 
 private:
     typedef std::vector<ProductScorer*> Scorers;
     Scorers scorers_;
+
+    /// the scorers need prepareDoc()
+    Scorers preparedScorers_;
+
+    /// the scores of one scorer in scoreBatch()
+    std::vector<score_t> batchScores_;
 };
 
 } // namespace sf1r
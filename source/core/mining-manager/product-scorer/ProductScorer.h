@@ -3,6 +3,7 @@
  * @brief the interface to calculate score for each product.
  * @author Jun Jiang
  * @date Created 2012-10-24
+ * @date Updated 2013-08-01 score a batch of docs in one call.
  */
 
 #ifndef SF1R_PRODUCT_SCORER_H
@@ -33,6 +34,31 @@ public:
 
     virtual score_t score(docid_t docId) = 0;
 
+    /**
+     * calculate the scores of @p num docs.
+     * @param scores [OUT] the score of each doc in @p docIds
+     */
+    virtual void scoreBatch(const docid_t* docIds, std::size_t num, score_t* scores)
+    {
+        for (std::size_t i = 0; i < num; ++i)
+        {
+            scores[i] = score(docIds[i]);
+        }
+    }
+
+    /**
+     * whether prepareDoc() should be called for each doc before
+     * scoreBatch(), it is true for the scorer depending on the current
+     * position of doc iterator.
+     */
+    virtual bool needPrepareDoc() const { return false; }
+
+    /**
+     * it is called while the doc iterator is on @p docId, in the same
+     * order of the docs passed to the next scoreBatch().
+     */
+    virtual void prepareDoc(docid_t docId) {}
+
 protected:
     score_t weight_;
 };
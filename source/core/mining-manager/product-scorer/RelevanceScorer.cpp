@@ -2,6 +2,7 @@
 #include <search-manager/DocumentIterator.h>
 #include <ranking-manager/RankQueryProperty.h>
 #include <ranking-manager/PropertyRanker.h>
+#include <algorithm>
 #include <cassert>
 
 using namespace sf1r;
@@ -34,3 +35,16 @@ score_t RelevanceScorer::score(docid_t docId)
 
     return scoreDocIterator_.score(rankQueryProps_, propRankers_);
 }
+
+void RelevanceScorer::scoreBatch(const docid_t* docIds, std::size_t num, score_t* scores)
+{
+    assert(preparedScores_.size() == num);
+
+    std::copy(preparedScores_.begin(), preparedScores_.end(), scores);
+    preparedScores_.clear();
+}
+
+void RelevanceScorer::prepareDoc(docid_t docId)
+{
+    preparedScores_.push_back(score(docId));
+}
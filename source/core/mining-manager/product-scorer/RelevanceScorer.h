@@ -32,11 +32,24 @@ public:
 
     virtual score_t score(docid_t docId);
 
+    /**
+     * the scores are those kept by prepareDoc(), as the doc iterator has
+     * moved on.
+     */
+    virtual void scoreBatch(const docid_t* docIds, std::size_t num, score_t* scores);
+
+    virtual bool needPrepareDoc() const { return true; }
+
+    virtual void prepareDoc(docid_t docId);
+
 private:
     DocumentIterator& scoreDocIterator_;
 
     const std::vector<RankQueryProperty>& rankQueryProps_;
     const std::vector<boost::shared_ptr<PropertyRanker> >& propRankers_;
+
+    /// the scores kept by prepareDoc() for next scoreBatch()
+    std::vector<score_t> preparedScores_;
 };
 
 } // namespace sf1r
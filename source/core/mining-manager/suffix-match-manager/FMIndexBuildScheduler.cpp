@@ -0,0 +1,125 @@
+#include "FMIndexBuildScheduler.h"
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <glog/logging.h>
+#include <algorithm>
+
+namespace sf1r
+{
+
+FMIndexBuildScheduler::FMIndexBuildScheduler(std::size_t threadNum, std::size_t memoryLimit)
+    : threadNum_(threadNum)
+    , memoryLimit_(memoryLimit)
+    , startedNum_(0)
+    , runningNum_(0)
+    , usedMemory_(0)
+    , peakMemory_(0)
+    , isFailed_(false)
+{
+    if (threadNum_ == 0)
+    {
+        threadNum_ = std::max(boost::thread::hardware_concurrency(), 1U);
+    }
+}
+
+void FMIndexBuildScheduler::addJob(const std::string& name, std::size_t memoryCost, const JobFunc& func)
+{
+    Job job;
+    job.name = name;
+    job.memoryCost = memoryCost;
+    job.func = func;
+    jobs_.push_back(job);
+}
+
+bool FMIndexBuildScheduler::run()
+{
+    std::stable_sort(jobs_.begin(), jobs_.end());
+    isStarted_.assign(jobs_.size(), false);
+    startedNum_ = runningNum_ = usedMemory_ = peakMemory_ = 0;
+    isFailed_ = false;
+
+    const std::size_t workerNum = std::min(threadNum_, jobs_.size());
+    if (workerNum <= 1)
+    {
+        workerLoop_();
+    }
+    else
+    {
+        boost::thread_group workers;
+        for (std::size_t i = 0; i < workerNum; ++i)
+        {
+            workers.create_thread(boost::bind(&FMIndexBuildScheduler::workerLoop_, this));
+        }
+        workers.join_all();
+    }
+
+    jobs_.clear();
+    return !isFailed_;
+}
+
+std::size_t FMIndexBuildScheduler::pickJob_() const
+{
+    for (std::size_t i = 0; i < jobs_.size(); ++i)
+    {
+        if (isStarted_[i])
+            continue;
+
+        if (memoryLimit_ == 0 || runningNum_ == 0 ||
+            usedMemory_ + jobs_[i].memoryCost <= memoryLimit_)
+        {
+            return i;
+        }
+    }
+    return std::size_t(-1);
+}
+
+void FMIndexBuildScheduler::workerLoop_()
+{
+    boost::mutex::scoped_lock lock(mutex_);
+
+    while (startedNum_ < jobs_.size())
+    {
+        std::size_t index = pickJob_();
+        if (index == std::size_t(-1))
+        {
+            // wait for the running jobs to release memory
+            cond_.wait(lock);
+            continue;
+        }
+
+        Job& job = jobs_[index];
+        isStarted_[index] = true;
+        ++startedNum_;
+        ++runningNum_;
+        usedMemory_ += job.memoryCost;
+        peakMemory_ = std::max(peakMemory_, usedMemory_);
+
+        LOG(INFO) << "start building fm-index job: " << job.name
+                  << ", estimated memory: " << job.memoryCost
+                  << ", running jobs: " << runningNum_;
+
+        bool result = false;
+        lock.unlock();
+        try
+        {
+            result = job.func();
+        }
+        catch (const std::exception& e)
+        {
+            LOG(ERROR) << "exception in building fm-index job: " << job.name
+                       << ", " << e.what();
+        }
+        lock.lock();
+
+        if (!result)
+        {
+            LOG(ERROR) << "failed building fm-index job: " << job.name;
+            isFailed_ = true;
+        }
+        --runningNum_;
+        usedMemory_ -= job.memoryCost;
+        cond_.notify_all();
+    }
+}
+
+} // namespace sf1r
@@ -0,0 +1,79 @@
+/**
+ * @file FMIndexBuildScheduler.h
+ * @brief run the fm-index building jobs of different properties in
+ *        parallel, the sum of their estimated memory is bounded by a budget.
+ * @date Created 2013-07-16
+ */
+
+#ifndef SF1R_MINING_SUFFIX_FMINDEX_BUILD_SCHEDULER_H_
+#define SF1R_MINING_SUFFIX_FMINDEX_BUILD_SCHEDULER_H_
+
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <string>
+#include <vector>
+
+namespace sf1r
+{
+
+class FMIndexBuildScheduler
+{
+public:
+    typedef boost::function<bool()> JobFunc;
+
+    /**
+     * @param threadNum the max number of jobs running at the same time,
+     *        0 means the number of hardware threads
+     * @param memoryLimit the max sum of estimated bytes of the running jobs,
+     *        0 means no limit. A job exceeding the limit runs alone.
+     */
+    FMIndexBuildScheduler(std::size_t threadNum, std::size_t memoryLimit);
+
+    void addJob(const std::string& name, std::size_t memoryCost, const JobFunc& func);
+
+    /**
+     * run all the jobs added, the larger jobs start first.
+     * @return false if any job fails
+     */
+    bool run();
+
+    std::size_t peakMemory() const { return peakMemory_; }
+
+private:
+    struct Job
+    {
+        std::string name;
+        std::size_t memoryCost;
+        JobFunc func;
+
+        bool operator<(const Job& other) const
+        {
+            return memoryCost > other.memoryCost;
+        }
+    };
+
+    void workerLoop_();
+
+    /** @return the index of next job to run, or -1 if none fits now */
+    std::size_t pickJob_() const;
+
+private:
+    std::size_t threadNum_;
+    const std::size_t memoryLimit_;
+
+    std::vector<Job> jobs_;
+    std::vector<bool> isStarted_;
+    std::size_t startedNum_;
+    std::size_t runningNum_;
+    std::size_t usedMemory_;
+    std::size_t peakMemory_;
+    bool isFailed_;
+
+    boost::mutex mutex_;
+    boost::condition_variable cond_;
+};
+
+} // namespace sf1r
+
+#endif // SF1R_MINING_SUFFIX_FMINDEX_BUILD_SCHEDULER_H_
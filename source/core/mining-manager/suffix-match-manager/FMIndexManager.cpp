@@ -1,17 +1,44 @@
 #include "FMIndexManager.h"
 #include <document-manager/DocumentManager.h>
 #include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/bind.hpp>
 #include <glog/logging.h>
 #include <icma/icma.h>
 #include <la-manager/LAPool.h>
 #include <mining-manager/util/split_ustr.h>
 #include <mining-manager/group-manager/DateStrFormat.h>
 #include "FilterManager.h"
+#include "FMIndexBuildScheduler.h"
 #include "../product-tokenizer/FuzzyNormalizer.h"
 
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <set>
+
 using namespace cma;
 using namespace izenelib::util;
 
+namespace
+{
+const std::string kDeltaSegmentsFile = "DeltaSegments.meta";
+
+/**
+ * the estimated peak bytes per text char on building fm-index, including
+ * the text, suffix array, bwt and wavelet tree.
+ */
+const size_t kBuildBytesPerChar = 16;
+
+/// the max number of filters whose docs in delta segments are cached
+const size_t kMaxDeltaFilterCacheNum = 256;
+
+std::string getDeltaFMIndexPath(const std::string& root, const std::string& prop, size_t segment_index)
+{
+    return root + "/" + prop + ".delta" + boost::lexical_cast<std::string>(segment_index) + ".fm_idx";
+}
+}
+
 namespace sf1r
 {
 using namespace faceted;
@@ -25,6 +52,9 @@ FMIndexManager::FMIndexManager(
     , document_manager_(document_manager)
     , filter_manager_(filter_manager)
     , doc_count_(0)
+    , delta_doc_count_(0)
+    , build_thread_num_(1)
+    , build_memory_limit_(0)
     , fuzzyNormalizer_(fuzzyNormalizer)
 {
 }
@@ -38,6 +68,34 @@ bool FMIndexManager::isStartFromLocalFM() const
     return doc_count_ > 0;
 }
 
+void FMIndexManager::setBuildOptions(size_t thread_num, size_t memory_limit)
+{
+    build_thread_num_ = thread_num;
+    build_memory_limit_ = memory_limit;
+}
+
+void FMIndexManager::copyBuildOptions(const FMIndexManager* other)
+{
+    setBuildOptions(other->build_thread_num_, other->build_memory_limit_);
+}
+
+size_t FMIndexManager::estimateBuildMemory_(FMIndexType* fmi)
+{
+    std::vector<uint16_t> orig_text;
+    fmi->swapOrigText(orig_text);
+    size_t text_len = orig_text.size();
+    fmi->swapOrigText(orig_text);
+    return text_len * kBuildBytesPerChar;
+}
+
+bool FMIndexManager::buildFMIndex_(const std::string& prop_name, FMIndexType* fmi)
+{
+    LOG(INFO) << "building fm-index for property: " << prop_name << " ....";
+    fmi->build();
+    LOG(INFO) << "building fm-index for property: " << prop_name << " finished, docCount: " << fmi->docCount();
+    return true;
+}
+
 void FMIndexManager::addProperties(const std::vector<std::string>& properties, PropertyFMType type)
 {
     //property
@@ -74,6 +132,10 @@ void FMIndexManager::clearFMIData()
     }
     docarray_mgr_.clear();
     doc_count_ = 0;
+    delta_segments_.clear();
+    delta_doc_count_ = 0;
+    building_delta_.reset();
+    clearDeltaFilterCache_();
     LOG(INFO) << "fmi data cleared!";
 }
 
@@ -135,6 +197,16 @@ bool FMIndexManager::loadAll()
             doc_count_ = docarray_mgr_.getDocCount();
             LOG(INFO) << data_root_path_ << " loading all doc array : " << doc_count_;
         }
+
+        // the doc count of doc array manager includes the docs in delta segments,
+        // the base doc count is kept in the meta file.
+        size_t base_doc_count = doc_count_;
+        if (!loadDeltaSegments_(base_doc_count))
+        {
+            LOG(WARNING) << "the delta segments are dropped, the docs after " << base_doc_count
+                << " will be appended again.";
+        }
+        doc_count_ = base_doc_count;
     }
     catch (...)
     {
@@ -145,6 +217,84 @@ bool FMIndexManager::loadAll()
     return true;
 }
 
+bool FMIndexManager::loadDeltaSegments_(size_t& base_doc_count)
+{
+    delta_segments_.clear();
+    delta_doc_count_ = 0;
+    clearDeltaFilterCache_();
+
+    std::ifstream ifs((data_root_path_ + "/" + kDeltaSegmentsFile).c_str());
+    if (!ifs)
+        return true;
+
+    size_t segment_num = 0;
+    ifs.read((char*)&base_doc_count, sizeof(base_doc_count));
+    ifs.read((char*)&segment_num, sizeof(segment_num));
+
+    DeltaSegmentListT segment_list;
+    size_t delta_doc_count = 0;
+    for (size_t i = 0; i < segment_num; ++i)
+    {
+        boost::shared_ptr<DeltaSegment> segment(new DeltaSegment);
+        ifs.read((char*)&segment->start_docid, sizeof(segment->start_docid));
+        ifs.read((char*)&segment->doc_count, sizeof(segment->doc_count));
+        if (!ifs)
+        {
+            LOG(ERROR) << "the delta segment meta file is broken.";
+            return false;
+        }
+
+        for (FMIndexConstIter cit = all_fmi_.begin(); cit != all_fmi_.end(); ++cit)
+        {
+            if (cit->second.type != COMMON)
+                continue;
+            std::ifstream fmi_ifs(getDeltaFMIndexPath(data_root_path_, cit->first, i).c_str());
+            if (!fmi_ifs)
+            {
+                LOG(ERROR) << "loading delta fmindex failed for property: " << cit->first;
+                return false;
+            }
+            boost::shared_ptr<FMIndexType>& fmi = segment->fmi[cit->first];
+            fmi.reset(new FMIndexType);
+            fmi->load(fmi_ifs);
+            if (fmi->docCount() != segment->doc_count)
+            {
+                LOG(ERROR) << "docCount is different in delta segment for property: " << cit->first;
+                return false;
+            }
+        }
+        delta_doc_count += segment->doc_count;
+        segment_list.push_back(segment);
+    }
+
+    delta_segments_.swap(segment_list);
+    delta_doc_count_ = delta_doc_count;
+    LOG(INFO) << "loaded " << delta_segments_.size() << " delta segments, doc count: " << delta_doc_count_;
+    return true;
+}
+
+void FMIndexManager::saveDeltaSegments_() const
+{
+    std::ofstream ofs((data_root_path_ + "/" + kDeltaSegmentsFile).c_str());
+    size_t segment_num = delta_segments_.size();
+    ofs.write((const char*)&doc_count_, sizeof(doc_count_));
+    ofs.write((const char*)&segment_num, sizeof(segment_num));
+
+    for (size_t i = 0; i < segment_num; ++i)
+    {
+        const DeltaSegment& segment = *delta_segments_[i];
+        ofs.write((const char*)&segment.start_docid, sizeof(segment.start_docid));
+        ofs.write((const char*)&segment.doc_count, sizeof(segment.doc_count));
+
+        for (std::map<std::string, boost::shared_ptr<FMIndexType> >::const_iterator cit = segment.fmi.begin();
+                cit != segment.fmi.end(); ++cit)
+        {
+            std::ofstream fmi_ofs(getDeltaFMIndexPath(data_root_path_, cit->first, i).c_str());
+            cit->second->save(fmi_ofs);
+        }
+    }
+}
+
 void FMIndexManager::swapUnchangedFilter(FMIndexManager* old_fmi_manager)
 {
     const std::set<std::string>& unchanged_props = filter_manager_->getUnchangedProperties();
@@ -170,6 +320,7 @@ void FMIndexManager::swapUnchangedFilter(FMIndexManager* old_fmi_manager)
         LOG(INFO) << "LESS_DV property doc array swapped: " << *unchanged_cit;
         docarray_mgr_.swapFilterDocArray(prop_id, old_fmi_manager->docarray_mgr_);
     }
+    clearDeltaFilterCache_();
 }
 
 void FMIndexManager::buildExternalFilter()
@@ -185,6 +336,7 @@ void FMIndexManager::buildExternalFilter()
 void FMIndexManager::setFilterList(std::vector<std::vector<FMDocArrayMgrType::FilterItemT> > &filter_list)
 {
     docarray_mgr_.setFilterList(filter_list);
+    clearDeltaFilterCache_();
 }
 
 bool FMIndexManager::getFilterRange(size_t prop_id, const RangeT &filter_id_range, RangeT &match_range) const
@@ -212,7 +364,9 @@ bool FMIndexManager::initAndLoadOldDocs(const FMIndexManager* old_fmi_manager)
     int has_orig_prop = 0;
     if (old_fmi_manager)
     {
-        doc_count_ = old_fmi_manager->docCount();
+        // the orig_txt only holds the docs in base fm-index, the docs in delta
+        // segments are appended again, so that they are merged into the base.
+        doc_count_ = old_fmi_manager->baseDocCount();
     }
     for (FMIndexIter it = all_fmi_.begin(); it != all_fmi_.end(); ++it)
     {
@@ -276,6 +430,9 @@ void FMIndexManager::buildLessDVProperties()
         LOG(INFO) << "filter manager is empty, LESS_DV property will not build.";
         return;
     }
+    // the texts are added in one thread, as the normalizer is not thread safe,
+    // then the fm-indexes are built in parallel.
+    FMIndexBuildScheduler scheduler(build_thread_num_, build_memory_limit_);
     for (FMIndexIter it = all_fmi_.begin(); it != all_fmi_.end(); ++it)
     {
         if (it->second.type != LESS_DV)
@@ -310,9 +467,13 @@ void FMIndexManager::buildLessDVProperties()
             it->second.fmi->addDoc(text.data(), text.length());
         }
         LOG(INFO) << "LESS_DV for property count is: " << max_filterstr_id ;
-        LOG(INFO) << "building fm-index for property: " << it->first << " ....";
-        it->second.fmi->build();
-        LOG(INFO) << "building fm-index for property: " << it->first << " finished, docCount: " << doc_count_;
+        FMIndexType* fmi = it->second.fmi.get();
+        scheduler.addJob(it->first, estimateBuildMemory_(fmi),
+                boost::bind(&FMIndexManager::buildFMIndex_, it->first, fmi));
+    }
+    if (!scheduler.run())
+    {
+        LOG(ERROR) << "building fm-index for LESS_DV properties failed.";
     }
 }
 
@@ -321,6 +482,7 @@ void FMIndexManager::swapCommonProperties(FMIndexManager* old_fmi_manager)
     std::swap(doc_count_, old_fmi_manager->doc_count_);
     LOG(INFO) << "swap common fmindex data, doc count: " << doc_count_;
     docarray_mgr_.swapMainDocArray(old_fmi_manager->docarray_mgr_);
+    docarray_mgr_.setDocCount(docCount());
 
     FMIndexIter it_start = all_fmi_.begin();
     FMIndexIter it_end = all_fmi_.end();
@@ -338,7 +500,96 @@ void FMIndexManager::swapCommonProperties(FMIndexManager* old_fmi_manager)
 void FMIndexManager::useOldDocCount(const FMIndexManager* old_fmi_manager)
 {
     doc_count_ = old_fmi_manager->doc_count_;
-    docarray_mgr_.setDocCount(doc_count_);
+    // the delta segments are never modified after built, so they are shared.
+    delta_segments_ = old_fmi_manager->delta_segments_;
+    delta_doc_count_ = old_fmi_manager->delta_doc_count_;
+    docarray_mgr_.setDocCount(docCount());
+}
+
+void FMIndexManager::startDeltaSegment()
+{
+    building_delta_.reset(new DeltaSegment);
+    building_delta_->start_docid = docCount() + 1;
+    for (FMIndexConstIter cit = all_fmi_.begin(); cit != all_fmi_.end(); ++cit)
+    {
+        if (cit->second.type == COMMON)
+        {
+            building_delta_->fmi[cit->first].reset(new FMIndexType());
+        }
+    }
+    LOG(INFO) << "start delta segment from docid: " << building_delta_->start_docid;
+}
+
+bool FMIndexManager::buildDeltaSegment()
+{
+    if (!building_delta_)
+        return false;
+
+    boost::shared_ptr<DeltaSegment> segment;
+    segment.swap(building_delta_);
+
+    FMIndexBuildScheduler scheduler(build_thread_num_, build_memory_limit_);
+    for (std::map<std::string, boost::shared_ptr<FMIndexType> >::iterator it = segment->fmi.begin();
+            it != segment->fmi.end(); ++it)
+    {
+        FMIndexType* fmi = it->second.get();
+        scheduler.addJob(it->first, estimateBuildMemory_(fmi),
+                boost::bind(&FMIndexManager::buildFMIndex_, it->first, fmi));
+    }
+    if (!scheduler.run())
+        return false;
+
+    size_t new_doc_cnt = 0;
+    for (std::map<std::string, boost::shared_ptr<FMIndexType> >::iterator it = segment->fmi.begin();
+            it != segment->fmi.end(); ++it)
+    {
+        new_doc_cnt = it->second->docCount();
+        if (segment->doc_count == 0)
+        {
+            segment->doc_count = new_doc_cnt;
+        }
+        else if (new_doc_cnt != segment->doc_count)
+        {
+            LOG(ERROR) << "docCount is different in delta segment for property: " << it->first;
+            return false;
+        }
+    }
+
+    if (segment->doc_count == 0)
+    {
+        LOG(INFO) << "no doc in the delta segment.";
+        return true;
+    }
+
+    delta_segments_.push_back(segment);
+    delta_doc_count_ += segment->doc_count;
+    clearDeltaFilterCache_();
+    docarray_mgr_.setDocCount(docCount());
+    LOG(INFO) << "building delta segment finished, docCount: " << segment->doc_count
+        << ", delta segments: " << delta_segments_.size();
+    return true;
+}
+
+const FMIndexManager::DeltaSegment* FMIndexManager::findDeltaSegment_(uint32_t docid) const
+{
+    for (DeltaSegmentListT::const_iterator it = delta_segments_.begin();
+            it != delta_segments_.end(); ++it)
+    {
+        const DeltaSegment& segment = **it;
+        if (docid >= segment.start_docid && docid < segment.start_docid + segment.doc_count)
+            return &segment;
+    }
+    return NULL;
+}
+
+FMIndexManager::FMIndexType* FMIndexManager::getDeltaFMIndex_(
+        const DeltaSegment& segment,
+        const std::string& property) const
+{
+    std::map<std::string, boost::shared_ptr<FMIndexType> >::const_iterator cit = segment.fmi.find(property);
+    if (cit == segment.fmi.end())
+        return NULL;
+    return cit->second.get();
 }
 
 bool FMIndexManager::buildCommonProperties(const FMIndexManager* old_fmi_manager)
@@ -377,9 +628,11 @@ void FMIndexManager::appendDocsAfter(bool failed, const Document& doc)
     {
         if (it->second.type == COMMON)
         {
+            FMIndexType* fmi = building_delta_ ?
+                building_delta_->fmi[it->first].get() : it->second.fmi.get();
             if (failed)
             {
-                it->second.fmi->addDoc(NULL, 0);
+                fmi->addDoc(NULL, 0);
             }
             else
             {
@@ -387,7 +640,7 @@ void FMIndexManager::appendDocsAfter(bool failed, const Document& doc)
                 Document::property_const_iterator dit = doc.findProperty(prop_name);
                 if (prop_name != virtualProperty_.virtualName && dit == doc.propertyEnd() ) 
                 {
-                    it->second.fmi->addDoc(NULL, 0);
+                    fmi->addDoc(NULL, 0);
                 }
                 else
                 {
@@ -422,7 +675,7 @@ void FMIndexManager::appendDocsAfter(bool failed, const Document& doc)
                         }
                     }
 
-                    it->second.fmi->addDoc(totalText.data(), totalText.length());
+                    fmi->addDoc(totalText.data(), totalText.length());
                 }
             }
         }
@@ -435,6 +688,7 @@ bool FMIndexManager::buildCollectionAfter()
     size_t new_doc_cnt = 0;
     doc_count_ = 0;
     docarray_mgr_.clearMainDocArray();
+    FMIndexBuildScheduler scheduler(build_thread_num_, build_memory_limit_);
     for (FMIndexIter it = all_fmi_.begin(); it != all_fmi_.end(); ++it)
     {
         if (it->second.type != COMMON)
@@ -442,8 +696,22 @@ bool FMIndexManager::buildCollectionAfter()
         std::ofstream ofs((data_root_path_ + "/" + it->first + ".orig_txt").c_str());
         it->second.fmi->saveOriginalText(ofs);
         ofs.close();
-        LOG(INFO) << "building fm-index for property: " << it->first << " ....";
-        it->second.fmi->build();
+        FMIndexType* fmi = it->second.fmi.get();
+        scheduler.addJob(it->first, estimateBuildMemory_(fmi),
+                boost::bind(&FMIndexManager::buildFMIndex_, it->first, fmi));
+    }
+    if (!scheduler.run())
+    {
+        LOG(ERROR) << "building fm-index for common properties failed.";
+        clearFMIData();
+        return false;
+    }
+
+    // the doc arrays are added to manager in the order of properties
+    for (FMIndexIter it = all_fmi_.begin(); it != all_fmi_.end(); ++it)
+    {
+        if (it->second.type != COMMON)
+            continue;
         new_doc_cnt = it->second.fmi->docCount();
         if (doc_count_ == 0)
         {
@@ -457,7 +725,7 @@ bool FMIndexManager::buildCollectionAfter()
             return false;
         }
         it->second.docarray_mgr_index = putFMIndexToDocArrayMgr(it->second.fmi.get());
-        LOG(INFO) << "building fm-index for property : " << it->first << " finished, docCount:" << doc_count_;
+        LOG(INFO) << "add doc array for property : " << it->first << ", docCount:" << doc_count_;
     }
     return true;
 }
@@ -749,10 +1017,273 @@ void FMIndexManager::getTopKDocIdListByFilter(
     }
 }
 
+void FMIndexManager::getTopKDocIdListInDelta(
+        const std::string& property,
+        const std::vector<size_t> &prop_id_list,
+        const std::vector<RangeListT> &filter_ranges,
+        const std::vector<std::vector<std::pair<UString, double> > >& pattern_groups,
+        size_t thres,
+        size_t max_docs,
+        std::vector<std::pair<double, uint32_t> > &res_list) const
+{
+    if (delta_segments_.empty() || pattern_groups.empty())
+        return;
+
+    FMIndexConstIter cit = all_fmi_.find(property);
+    if (cit == all_fmi_.end() || cit->second.type != COMMON)
+        return;
+
+    std::vector<std::pair<double, uint32_t> > delta_res_list;
+    std::vector<uint32_t> docid_list;
+    std::vector<size_t> doclen_list;
+    RangeT match_range;
+
+    // (local docid, score) of each pattern matched
+    std::vector<std::pair<uint32_t, double> > doc_scores;
+    // the local docids matching any pattern in one group
+    std::vector<uint32_t> group_docs;
+    // the local docids of all groups, each doc appears once per group matched
+    std::vector<uint32_t> matched_docs;
+
+    for (DeltaSegmentListT::const_iterator sit = delta_segments_.begin();
+            sit != delta_segments_.end(); ++sit)
+    {
+        const DeltaSegment& segment = **sit;
+        FMIndexType* fmi = getDeltaFMIndex_(segment, property);
+        if (!fmi)
+            continue;
+
+        doc_scores.clear();
+        matched_docs.clear();
+
+        for (size_t i = 0; i < pattern_groups.size(); ++i)
+        {
+            group_docs.clear();
+            const std::vector<std::pair<UString, double> >& patterns = pattern_groups[i];
+            for (size_t j = 0; j < patterns.size(); ++j)
+            {
+                const UString& pattern = patterns[j].first;
+                if (pattern.empty() ||
+                        fmi->backwardSearch(pattern.data(), pattern.length(), match_range) != pattern.length())
+                    continue;
+
+                fmi->getMatchedDocIdList(match_range, segment.doc_count, docid_list, doclen_list);
+                std::sort(docid_list.begin(), docid_list.end());
+                docid_list.erase(std::unique(docid_list.begin(), docid_list.end()), docid_list.end());
+
+                for (size_t k = 0; k < docid_list.size(); ++k)
+                {
+                    doc_scores.push_back(std::make_pair(docid_list[k], patterns[j].second));
+                }
+                group_docs.insert(group_docs.end(), docid_list.begin(), docid_list.end());
+                docid_list.clear();
+                doclen_list.clear();
+            }
+
+            std::sort(group_docs.begin(), group_docs.end());
+            group_docs.erase(std::unique(group_docs.begin(), group_docs.end()), group_docs.end());
+            matched_docs.insert(matched_docs.end(), group_docs.begin(), group_docs.end());
+        }
+
+        // both are ordered by local docid, and contain the same docs
+        std::sort(doc_scores.begin(), doc_scores.end());
+        std::sort(matched_docs.begin(), matched_docs.end());
+
+        std::vector<uint32_t>::const_iterator mit = matched_docs.begin();
+        for (size_t j = 0; j < doc_scores.size(); )
+        {
+            const uint32_t docid = doc_scores[j].first;
+            double score = 0;
+            for (; j < doc_scores.size() && doc_scores[j].first == docid; ++j)
+            {
+                score += doc_scores[j].second;
+            }
+
+            size_t group_num = 0;
+            for (; mit != matched_docs.end() && *mit == docid; ++mit)
+            {
+                ++group_num;
+            }
+
+            if (group_num < thres)
+                continue;
+            delta_res_list.push_back(std::make_pair(score, segment.start_docid + docid - 1));
+        }
+    }
+
+    filterDeltaDocs_(prop_id_list, filter_ranges, delta_res_list);
+
+    std::sort(delta_res_list.begin(), delta_res_list.end(), std::greater<std::pair<double, uint32_t> >());
+    if (delta_res_list.size() > max_docs)
+        delta_res_list.resize(max_docs);
+    VLOG(1) << "get topk in delta segments for property : " << property << ", docs: " << delta_res_list.size();
+
+    res_list.insert(res_list.end(), delta_res_list.begin(), delta_res_list.end());
+}
+
+size_t FMIndexManager::longestSuffixMatchInDelta(
+        const std::string& property,
+        const UString& pattern,
+        size_t max_docs,
+        std::vector<std::pair<double, uint32_t> >& res_list) const
+{
+    if (delta_segments_.empty() || pattern.empty())
+        return 0;
+
+    FMIndexConstIter cit = all_fmi_.find(property);
+    if (cit == all_fmi_.end() || cit->second.type != COMMON)
+        return 0;
+
+    size_t total_match = 0;
+    RangeListT match_ranges;
+    std::vector<uint32_t> docid_list;
+    std::vector<size_t> doclen_list;
+
+    for (DeltaSegmentListT::const_iterator sit = delta_segments_.begin();
+            sit != delta_segments_.end(); ++sit)
+    {
+        const DeltaSegment& segment = **sit;
+        FMIndexType* fmi = getDeltaFMIndex_(segment, property);
+        if (!fmi)
+            continue;
+
+        match_ranges.clear();
+        size_t max_match = fmi->longestSuffixMatch(pattern.data(), pattern.length(), match_ranges);
+        if (max_match == 0)
+            continue;
+
+        for (size_t i = 0; i < match_ranges.size(); ++i)
+        {
+            total_match += match_ranges[i].second - match_ranges[i].first;
+            fmi->getMatchedDocIdList(match_ranges[i], max_docs, docid_list, doclen_list);
+        }
+        for (size_t i = 0; i < docid_list.size(); ++i)
+        {
+            if (doclen_list[i] == 0)
+                continue;
+            res_list.push_back(std::make_pair(double(max_match) / double(doclen_list[i]),
+                        segment.start_docid + docid_list[i] - 1));
+        }
+        docid_list.clear();
+        doclen_list.clear();
+    }
+    return total_match;
+}
+
+void FMIndexManager::filterDeltaDocs_(
+        const std::vector<size_t> &prop_id_list,
+        const std::vector<RangeListT> &filter_ranges,
+        std::vector<std::pair<double, uint32_t> > &res_list) const
+{
+    if (prop_id_list.empty() || res_list.empty())
+        return;
+
+    // the filter doc arrays are rebuilt for all the docs, including the ones
+    // in delta segments, so the docs must be in the ranges of each filter
+    // property.
+    for (size_t i = 0; i < prop_id_list.size() && i < filter_ranges.size(); ++i)
+    {
+        DocIdListPtr docid_list = getDeltaFilterDocs_(prop_id_list[i], filter_ranges[i]);
+
+        size_t kept = 0;
+        for (size_t j = 0; j < res_list.size(); ++j)
+        {
+            if (std::binary_search(docid_list->begin(), docid_list->end(), res_list[j].second))
+                res_list[kept++] = res_list[j];
+        }
+        res_list.resize(kept);
+
+        if (res_list.empty())
+            break;
+    }
+}
+
+FMIndexManager::DocIdListPtr FMIndexManager::getDeltaFilterDocs_(
+        size_t prop_id,
+        const RangeListT &filter_range) const
+{
+    const DeltaFilterCacheT::key_type key(prop_id, filter_range);
+    {
+        boost::mutex::scoped_lock lock(delta_filter_mutex_);
+        DeltaFilterCacheT::const_iterator cit = delta_filter_cache_.find(key);
+        if (cit != delta_filter_cache_.end())
+            return cit->second;
+    }
+
+    std::vector<uint32_t> docid_list;
+    std::vector<size_t> doclen_list;
+    docarray_mgr_.getMatchedDocIdList(prop_id, true, filter_range,
+            docCount(), docid_list, doclen_list);
+
+    // only the docs in delta segments are kept
+    const uint32_t delta_start = doc_count_ + 1;
+    docid_list.erase(std::remove_if(docid_list.begin(), docid_list.end(),
+                std::bind2nd(std::less<uint32_t>(), delta_start)), docid_list.end());
+    std::sort(docid_list.begin(), docid_list.end());
+
+    boost::shared_ptr<std::vector<uint32_t> > delta_docs(new std::vector<uint32_t>);
+    delta_docs->swap(docid_list);
+
+    boost::mutex::scoped_lock lock(delta_filter_mutex_);
+    if (delta_filter_cache_.size() >= kMaxDeltaFilterCacheNum)
+    {
+        delta_filter_cache_.clear();
+    }
+    delta_filter_cache_[key] = delta_docs;
+    return delta_docs;
+}
+
+void FMIndexManager::clearDeltaFilterCache_()
+{
+    boost::mutex::scoped_lock lock(delta_filter_mutex_);
+    delta_filter_cache_.clear();
+}
+
 void FMIndexManager::getDocLenList(const std::vector<uint32_t>& docid_list, std::vector<size_t>& doclen_list) const
 {
     // the doclen is total length for common property only.
-    docarray_mgr_.getDocLenList(docid_list, doclen_list);
+    if (delta_segments_.empty())
+    {
+        docarray_mgr_.getDocLenList(docid_list, doclen_list);
+        return;
+    }
+
+    doclen_list.resize(docid_list.size(), 0);
+    std::vector<uint32_t> base_docid_list;
+    std::vector<size_t> base_pos_list;
+    std::vector<uint32_t> local_docid_list(1);
+    std::vector<size_t> local_doclen_list(1);
+
+    for (size_t i = 0; i < docid_list.size(); ++i)
+    {
+        if (docid_list[i] <= doc_count_)
+        {
+            base_docid_list.push_back(docid_list[i]);
+            base_pos_list.push_back(i);
+            continue;
+        }
+
+        doclen_list[i] = 0;
+        const DeltaSegment* segment = findDeltaSegment_(docid_list[i]);
+        if (!segment)
+            continue;
+
+        local_docid_list[0] = docid_list[i] - segment->start_docid + 1;
+        for (std::map<std::string, boost::shared_ptr<FMIndexType> >::const_iterator cit = segment->fmi.begin();
+                cit != segment->fmi.end(); ++cit)
+        {
+            local_doclen_list[0] = 0;
+            cit->second->getDocLenList(local_docid_list, local_doclen_list);
+            doclen_list[i] += local_doclen_list[0];
+        }
+    }
+
+    std::vector<size_t> base_doclen_list(base_docid_list.size(), 0);
+    docarray_mgr_.getDocLenList(base_docid_list, base_doclen_list);
+    for (size_t i = 0; i < base_pos_list.size(); ++i)
+    {
+        doclen_list[base_pos_list[i]] = base_doclen_list[i];
+    }
 }
 
 void FMIndexManager::getLessDVStrLenList(const std::string& property, const std::vector<uint32_t>& dvid_list, std::vector<size_t>& dvlen_list) const
@@ -793,6 +1324,7 @@ void FMIndexManager::saveAll()
         std::ofstream ofs;
         ofs.open((data_root_path_ + "/" + "AllDocArray.doc_array").c_str());
         docarray_mgr_.save(ofs);
+        saveDeltaSegments_();
     }
     catch (...)
     {
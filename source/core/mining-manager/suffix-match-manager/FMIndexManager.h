@@ -7,6 +7,7 @@
 #include <am/succinct/fm-index/fm_doc_array_manager.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/mutex.hpp>
 #include <configuration-manager/SuffixMatchConfig.h>
 
 namespace sf1r
@@ -57,13 +58,28 @@ public:
 
     ~FMIndexManager();
 
-    inline size_t docCount() const { return doc_count_; }
+    /// the docs in the base fm-index and all the delta segments.
+    inline size_t docCount() const { return doc_count_ + delta_doc_count_; }
+    /// the docs in the base fm-index only.
+    inline size_t baseDocCount() const { return doc_count_; }
+    inline size_t deltaDocCount() const { return delta_doc_count_; }
+    inline size_t deltaSegmentNum() const { return delta_segments_.size(); }
+
+    /**
+     * @param thread_num the max number of fm-indexes built in parallel,
+     *        0 means the number of hardware threads
+     * @param memory_limit the max bytes of building fm-indexes in parallel,
+     *        0 means no limit
+     */
+    void setBuildOptions(size_t thread_num, size_t memory_limit);
+    void copyBuildOptions(const FMIndexManager* other);
 
     void addProperties(const std::vector<std::string>& properties, PropertyFMType type);
     void getProperties(std::vector<std::string>& properties, PropertyFMType type) const;
 
     bool isStartFromLocalFM() const;
     void clearFMIData();
+    /// use the doc count and share the delta segments of @p old_fmi_manager.
     void useOldDocCount(const FMIndexManager* old_fmi_manager);
 
     bool buildCommonProperties(const FMIndexManager* old_fmi_manager);
@@ -75,6 +91,14 @@ public:
     bool buildCollectionAfter();
     void swapUnchangedFilter(FMIndexManager* old_fmi_manager);
 
+    /**
+     * start a new delta segment for the docs after docCount(), the following
+     * appendDocsAfter() calls add docs to the new segment instead of the base
+     * fm-index, until buildDeltaSegment() is called.
+     */
+    void startDeltaSegment();
+    bool buildDeltaSegment();
+
     void setFilterList(std::vector<std::vector<FMDocArrayMgrType::FilterItemT> > &filter_list);
     bool getFilterRange(size_t prop_id, const RangeT &filter_id_range, RangeT &match_range) const;
 
@@ -117,6 +141,34 @@ public:
         size_t max_docs,
         std::vector<std::pair<double, uint32_t> > &res_list) const;
         
+    /**
+     * search @p pattern_groups in the delta segments of the COMMON @p property,
+     * the docs are scored as getTopKDocIdListByFilter() does in the base
+     * fm-index: the score is the sum of the scores of all the patterns
+     * matched, and a doc must match at least @p thres groups, where a doc
+     * matches a group if it contains any pattern in the group. The docs are
+     * also filtered by @p filter_ranges.
+     */
+    void getTopKDocIdListInDelta(
+            const std::string& property,
+            const std::vector<size_t> &prop_id_list,
+            const std::vector<RangeListT> &filter_ranges,
+            const std::vector<std::vector<std::pair<izenelib::util::UString, double> > >& pattern_groups,
+            size_t thres,
+            size_t max_docs,
+            std::vector<std::pair<double, uint32_t> > &res_list) const;
+
+    /**
+     * do longestSuffixMatch() in the delta segments of the COMMON @p property,
+     * the score of each doc is the match length divided by the doc length.
+     * @return the total number of matches
+     */
+    size_t longestSuffixMatchInDelta(
+            const std::string& property,
+            const izenelib::util::UString& pattern,
+            size_t max_docs,
+            std::vector<std::pair<double, uint32_t> >& res_list) const;
+
     void getDocLenList(const std::vector<uint32_t>& docid_list, std::vector<size_t>& doclen_list) const;
     void getLessDVStrLenList(const std::string& property, const std::vector<uint32_t>& dvid_list, std::vector<size_t>& dvlen_list) const;
 
@@ -142,11 +194,53 @@ private:
 
     size_t putFMIndexToDocArrayMgr(FMIndexType* fmi);
 
+    static size_t estimateBuildMemory_(FMIndexType* fmi);
+    static bool buildFMIndex_(const std::string& prop_name, FMIndexType* fmi);
+
     void reconstructText(
             const std::string& prop_name,
             const std::vector<uint32_t>& del_docid_list,
             std::vector<uint16_t>& orig_text) const;
 
+    /**
+     * the fm-index over the docs appended after the base fm-index, each
+     * COMMON property fm-index holds its own doc array, and its docid starts
+     * from 1 in the segment.
+     */
+    struct DeltaSegment
+    {
+        DeltaSegment()
+            : start_docid(0), doc_count(0)
+        {
+        }
+
+        uint32_t start_docid;
+        size_t doc_count;
+        std::map<std::string, boost::shared_ptr<FMIndexType> > fmi;
+    };
+    typedef std::vector<boost::shared_ptr<const DeltaSegment> > DeltaSegmentListT;
+
+    const DeltaSegment* findDeltaSegment_(uint32_t docid) const;
+    FMIndexType* getDeltaFMIndex_(const DeltaSegment& segment, const std::string& property) const;
+
+    void filterDeltaDocs_(
+            const std::vector<size_t> &prop_id_list,
+            const std::vector<RangeListT> &filter_ranges,
+            std::vector<std::pair<double, uint32_t> > &res_list) const;
+
+    typedef boost::shared_ptr<const std::vector<uint32_t> > DocIdListPtr;
+
+    /**
+     * get the sorted docids in delta segments, which are in @p filter_range
+     * of filter property @p prop_id.
+     */
+    DocIdListPtr getDeltaFilterDocs_(size_t prop_id, const RangeListT &filter_range) const;
+
+    void clearDeltaFilterCache_();
+
+    void saveDeltaSegments_() const;
+    bool loadDeltaSegments_(size_t& base_doc_count);
+
     struct PropertyFMIndex
     {
         PropertyFMIndex()
@@ -164,6 +258,21 @@ private:
     boost::shared_ptr<FilterManager> filter_manager_;
     size_t doc_count_;
 
+    DeltaSegmentListT delta_segments_;
+    size_t delta_doc_count_;
+    // the segment receiving the docs from appendDocsAfter()
+    boost::shared_ptr<DeltaSegment> building_delta_;
+
+    // filter property id and range => the docs in delta segments matched,
+    // the doc array has no docid bound on matching, so the docs are only
+    // collected once for each filter.
+    typedef std::map<std::pair<size_t, RangeListT>, DocIdListPtr> DeltaFilterCacheT;
+    mutable DeltaFilterCacheT delta_filter_cache_;
+    mutable boost::mutex delta_filter_mutex_;
+
+    size_t build_thread_num_;
+    size_t build_memory_limit_;
+
     VirtualConfig virtualProperty_;
     std::map<std::string, PropertyFMIndex> all_fmi_;
     typedef std::map<std::string, PropertyFMIndex>::iterator FMIndexIter;
@@ -16,6 +16,8 @@
 #include <util/ustring/algo.hpp>
 #include <glog/logging.h>
 #include <math.h>
+#include <cmath>
+#include <limits>
 
 using namespace cma;
 using namespace izenelib::util;
@@ -24,6 +26,55 @@ namespace sf1r
 {
 using namespace faceted;
 
+namespace
+{
+/**
+ * the deleted docs are kept in fm-index until it is rebuilt, so the number
+ * of docs fetched from fm-index is enlarged by the ratio of the deleted
+ * docs, to fill @p max_docs after the deleted ones are removed.
+ */
+size_t getFetchDocNum(DocumentManager& document_manager, size_t max_docs)
+{
+    const size_t all_num = document_manager.getMaxDocId();
+    const size_t valid_num = document_manager.getNumDocs();
+    if (valid_num >= all_num)
+        return max_docs;
+
+    // no more than all the deleted docs could be skipped
+    const size_t deleted_num = all_num - valid_num;
+    const double ratio = valid_num ? double(all_num) / valid_num : all_num;
+    const size_t extra_num = size_t(std::ceil(max_docs * (ratio - 1)));
+
+    return max_docs + std::min(extra_num, deleted_num);
+}
+
+/**
+ * sort the docs by score, and keep the top @p max_docs docs, which are not
+ * deleted and have the score greater than @p rank_boundary.
+ */
+void getTopKDocs(
+        const DocumentManager& document_manager,
+        const btree::btree_map<uint32_t, double>& res_list_map,
+        size_t max_docs,
+        double rank_boundary,
+        std::vector<std::pair<double, uint32_t> >& res_list)
+{
+    res_list.reserve(res_list_map.size());
+    for (btree::btree_map<uint32_t, double>::const_iterator cit = res_list_map.begin();
+            cit != res_list_map.end(); ++cit)
+    {
+        if (cit->second > rank_boundary && !document_manager.isDeleted(cit->first))
+        {
+            res_list.push_back(std::make_pair(cit->second, cit->first));
+        }
+    }
+
+    std::sort(res_list.begin(), res_list.end(), std::greater<std::pair<double, uint32_t> >());
+    if (res_list.size() > max_docs)
+        res_list.erase(res_list.begin() + max_docs, res_list.end());
+}
+}
+
 SuffixMatchManager::SuffixMatchManager(
         const std::string& homePath,
         boost::shared_ptr<DocumentManager>& document_manager,
@@ -70,6 +121,11 @@ void SuffixMatchManager::addFMIndexProperties(const std::vector<std::string>& pr
     }
 }
 
+void SuffixMatchManager::setBuildOptions(size_t thread_num, size_t memory_limit)
+{
+    fmi_manager_->setBuildOptions(thread_num, memory_limit);
+}
+
 bool SuffixMatchManager::isStartFromLocalFM() const
 {
     return fmi_manager_ && fmi_manager_->isStartFromLocalFM();
@@ -88,8 +144,10 @@ size_t SuffixMatchManager::longestSuffixMatch(
     btree::btree_map<uint32_t, double> res_list_map;
     std::vector<uint32_t> docid_list;
     std::vector<size_t> doclen_list;
+    std::vector<std::pair<double, uint32_t> > delta_res_list;
     size_t max_match;
     size_t total_match = 0;
+    const size_t fetch_docs = getFetchDocNum(*document_manager_, max_docs);
 
     {
         ReadLock lock(mutex_);
@@ -98,6 +156,14 @@ size_t SuffixMatchManager::longestSuffixMatch(
             const std::string& property = search_in_properties[i];
             FMIndexManager::RangeListT match_ranges;
             max_match = 0;
+
+            total_match += fmi_manager_->longestSuffixMatchInDelta(property, pattern, fetch_docs, delta_res_list);
+            for (size_t j = 0; j < delta_res_list.size(); ++j)
+            {
+                res_list_map[delta_res_list[j].second] += delta_res_list[j].first;
+            }
+            delta_res_list.clear();
+
             {
                 max_match = fmi_manager_->longestSuffixMatch(property, pattern, match_ranges);
                 if (max_match == 0)
@@ -109,8 +175,8 @@ size_t SuffixMatchManager::longestSuffixMatch(
                     LOG(INFO) << "range " << i << ": " << match_ranges[i].first << "-" << match_ranges[i].second;
                 }
                 std::vector<double> max_match_list(match_ranges.size(), max_match);
-                fmi_manager_->convertMatchRanges(property, max_docs, match_ranges, max_match_list);
-                fmi_manager_->getMatchedDocIdList(property, match_ranges, max_docs, docid_list, doclen_list);
+                fmi_manager_->convertMatchRanges(property, fetch_docs, match_ranges, max_match_list);
+                fmi_manager_->getMatchedDocIdList(property, match_ranges, fetch_docs, docid_list, doclen_list);
             }
 
             for (size_t j = 0; j < docid_list.size(); ++j)
@@ -128,15 +194,8 @@ size_t SuffixMatchManager::longestSuffixMatch(
         }
     }
 
-    res_list.reserve(res_list_map.size());
-    for (btree::btree_map<uint32_t, double>::const_iterator cit = res_list_map.begin();
-            cit != res_list_map.end(); ++cit)
-    {
-        res_list.push_back(std::make_pair(cit->second, cit->first));
-    }
-    std::sort(res_list.begin(), res_list.end(), std::greater<std::pair<double, uint32_t> >());
-    if (res_list.size() > max_docs)
-        res_list.erase(res_list.begin() + max_docs, res_list.end());
+    getTopKDocs(*document_manager_, res_list_map, max_docs,
+                -std::numeric_limits<double>::infinity(), res_list);
     return total_match;
 }
 
@@ -265,6 +324,7 @@ size_t SuffixMatchManager::AllPossibleSuffixMatch(
     }
 
     size_t total_match = 0;
+    const size_t fetch_docs = getFetchDocNum(*document_manager_, max_docs);
 
     {
         ReadLock lock(mutex_);
@@ -295,6 +355,8 @@ size_t SuffixMatchManager::AllPossibleSuffixMatch(
             range_list.reserve(major_tokens.size() + minor_tokens.size());
             score_list.reserve(range_list.size());
             std::vector<std::vector<boost::tuple<size_t, size_t, double> > > synonym_range_list;             
+            // the normalized tokens to search in the delta segments of fm-index
+            std::vector<std::vector<std::pair<UString, double> > > delta_pattern_groups;
             if (use_synonym)
             {            
 
@@ -319,6 +381,7 @@ size_t SuffixMatchManager::AllPossibleSuffixMatch(
                         synonym_range_list.push_back(synonym_match_range);
                     }
                 }
+                delta_pattern_groups = synonym_tokens;
 
             }
             else
@@ -331,6 +394,8 @@ size_t SuffixMatchManager::AllPossibleSuffixMatch(
                     UString token(pit->first);
                     Algorithm<UString>::to_lower(token);
                     fuzzyNormalizer_->normalizeToken(token);
+                    delta_pattern_groups.push_back(std::vector<std::pair<UString, double> >(
+                                1, std::make_pair(token, pit->second)));
                     if (fmi_manager_->backwardSearch(search_property, token, sub_match_range) == token.length())
                     {
                         range_list.push_back(sub_match_range);
@@ -348,19 +413,21 @@ size_t SuffixMatchManager::AllPossibleSuffixMatch(
                     UString token(pit->first);
                     Algorithm<UString>::to_lower(token);
                     fuzzyNormalizer_->normalizeToken(token);
+                    delta_pattern_groups.push_back(std::vector<std::pair<UString, double> >(
+                                1, std::make_pair(token, pit->second)));
                     if (fmi_manager_->backwardSearch(search_property, token, sub_match_range) == token.length())
                     {
                         range_list.push_back(sub_match_range);
                         score_list.push_back(pit->second);
                     }
                 }
-                fmi_manager_->convertMatchRanges(search_property, max_docs, range_list, score_list);
+                fmi_manager_->convertMatchRanges(search_property, fetch_docs, range_list, score_list);
             }
             if (filter_mode == SearchingMode::OR_Filter)
             {
                 if (use_synonym)
                 {
-                    fmi_manager_->getTopKDocIdListByFilter(search_property, prop_id_list, filter_range_list, synonym_range_list, thres,max_docs, single_res_list);                        
+                    fmi_manager_->getTopKDocIdListByFilter(search_property, prop_id_list, filter_range_list, synonym_range_list, thres,fetch_docs, single_res_list);                        
                 }    
                 else
                 {
@@ -371,9 +438,17 @@ size_t SuffixMatchManager::AllPossibleSuffixMatch(
                             range_list,
                             score_list,
                             thres,
-                            max_docs,
+                            fetch_docs,
                             single_res_list);
                 }                             
+                fmi_manager_->getTopKDocIdListInDelta(
+                        search_property,
+                        prop_id_list,
+                        filter_range_list,
+                        delta_pattern_groups,
+                        thres,
+                        fetch_docs,
+                        single_res_list);
             }
             else if (filter_mode == SearchingMode::AND_Filter)
             {
@@ -410,22 +485,10 @@ size_t SuffixMatchManager::AllPossibleSuffixMatch(
         }
     }
 
-    res_list.reserve(res_list_map.size());
-    for (btree::btree_map<uint32_t, double>::const_iterator cit = res_list_map.begin();
-            cit != res_list_map.end(); ++cit)
-    {
-        if (cit->second > rank_boundary)
-        {
-            res_list.push_back(std::make_pair(cit->second, cit->first));
-        }
-    }
+    getTopKDocs(*document_manager_, res_list_map, max_docs, rank_boundary, res_list);
     if (res_list.empty())
         return total_match;
-    
-    std::sort(res_list.begin(), res_list.end(), std::greater<std::pair<double, uint32_t> >());
-    if (res_list.size() > max_docs)
-        res_list.erase(res_list.begin() + max_docs, res_list.end());
-        
+
     LOG(INFO) << "all property fuzzy search finished, answer is: "<<res_list.size();
 
     return total_match;
@@ -48,6 +48,12 @@ public:
 
     bool isStartFromLocalFM() const;
 
+    /**
+     * @param thread_num the max number of fm-indexes built in parallel
+     * @param memory_limit the max bytes of building fm-indexes in parallel
+     */
+    void setBuildOptions(size_t thread_num, size_t memory_limit);
+
     size_t longestSuffixMatch(
             const std::string& pattern,
             std::vector<std::string> search_in_properties,
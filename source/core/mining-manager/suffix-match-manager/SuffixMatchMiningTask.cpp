@@ -11,6 +11,17 @@
 #include "FMIndexManager.h"
 #include <fstream>
 #include <boost/lexical_cast.hpp>
+
+namespace
+{
+/// merge the delta segments into base fm-index when there would be more segments than this
+const size_t kMaxDeltaSegmentNum = 8;
+/// merge the delta segments into base fm-index when their docs exceed this ratio of base docs
+const double kMaxDeltaDocRatio = 0.2;
+/// rebuild when the deleted docs still in the fm-index exceed this ratio of all docs
+const double kMaxDeletedDocRatio = 0.1;
+}
+
 namespace sf1r
 {
 
@@ -26,6 +37,8 @@ SuffixMatchMiningTask::SuffixMatchMiningTask(
     , filter_manager_(filter_manager)
     , data_root_path_(data_root_path)
     , is_incrememtalTask_(false)
+    , need_rebuild(false)
+    , need_delta_(false)
     , mutex_(mutex)
 {
 }
@@ -49,6 +62,8 @@ bool SuffixMatchMiningTask::preProcess(int64_t timestamp)
                                                  new_filter_manager,
                                                  fmi_manager_->getFuzzyNormalizer()));
 
+        new_fmi_manager->copyBuildOptions(fmi_manager_.get());
+
         std::vector<std::string> properties;
         VirtualConfig virtulProperty;
         for (int i = 0; i < FMIndexManager::FM_TYPE_COUNT; ++i)
@@ -61,24 +76,30 @@ bool SuffixMatchMiningTask::preProcess(int64_t timestamp)
         }
 
         size_t last_docid = fmi_manager_ ? fmi_manager_->docCount() : 0;
+        size_t max_docid = document_manager_->getMaxDocId();
         need_rebuild = false;
+        need_delta_ = false;
 
-        std::vector<uint32_t> del_docid_list;
-        document_manager_->getDeletedDocIdList(del_docid_list);
-
-        if (last_docid == document_manager_->getMaxDocId()) 
+        // the deleted docs still in the fm-index are masked on searching,
+        // until there are too many of them.
+        size_t indexed_deleted_num = 0;
+        if (last_docid > 0)
         {
-            // check if there is any new deleted doc.
+            std::vector<uint32_t> del_docid_list;
+            document_manager_->getDeletedDocIdList(del_docid_list);
             std::vector<size_t> doclen_list(del_docid_list.size(), 0);
             fmi_manager_->getDocLenList(del_docid_list, doclen_list);
             for (size_t i = 0; i < doclen_list.size(); ++i)
             {
                 if (doclen_list[i] > 0)
-                {
-                    need_rebuild = true;
-                    break;
-                }
+                    ++indexed_deleted_num;
             }
+        }
+        bool too_many_deleted = indexed_deleted_num > kMaxDeletedDocRatio * last_docid;
+
+        if (last_docid == max_docid) 
+        {
+            need_rebuild = too_many_deleted;
 
             if (!need_rebuild)
             {
@@ -112,19 +133,31 @@ bool SuffixMatchMiningTask::preProcess(int64_t timestamp)
         }
         else
         {
-            LOG(INFO) << "old fmi docCount is : " << last_docid << ", document_manager count:" << document_manager_->getMaxDocId();
-            need_rebuild = true;
+            LOG(INFO) << "old fmi docCount is : " << last_docid << ", document_manager count:" << max_docid;
+            size_t base_doc_count = fmi_manager_->baseDocCount();
+            size_t delta_doc_count = fmi_manager_->deltaDocCount() + max_docid - last_docid;
+            need_delta_ = last_docid < max_docid && base_doc_count > 0 && !too_many_deleted &&
+                fmi_manager_->deltaSegmentNum() < kMaxDeltaSegmentNum &&
+                delta_doc_count <= kMaxDeltaDocRatio * base_doc_count;
+            need_rebuild = !need_delta_;
         }
 
         if (need_rebuild)
         {
-            LOG(INFO) << "rebuilding in fm-index is needed.";
+            LOG(INFO) << "rebuilding in fm-index is needed, the delta segments are merged: "
+                << fmi_manager_->deltaSegmentNum() << ", deleted docs in fm-index: " << indexed_deleted_num;
         }
         else
         {
             new_fmi_manager->useOldDocCount(fmi_manager_.get());
         }
 
+        if (need_delta_)
+        {
+            LOG(INFO) << "building delta segment in fm-index for new docs.";
+            new_fmi_manager->startDeltaSegment();
+        }
+
         bool isInitAndLoad = true;
         if (!need_rebuild) return true;
 
@@ -145,6 +178,11 @@ bool SuffixMatchMiningTask::postProcess()
     {   
         if (need_rebuild && !new_fmi_manager->buildCollectionAfter())
             return false;
+        if (need_delta_ && !new_fmi_manager->buildDeltaSegment())
+        {
+            LOG(ERROR) << "building delta segment in fm-index failed.";
+            return false;
+        }
         new_filter_manager->setRebuildFlag(filter_manager_.get());
         size_t last_docid = fmi_manager_ ? fmi_manager_->docCount() : 0;
 
@@ -162,7 +200,8 @@ bool SuffixMatchMiningTask::postProcess()
             WriteLock lock(mutex_);
             if (!need_rebuild)
             {
-                // no rebuilding, so just take the owner of old data.
+                // no rebuilding, so just take the owner of old data,
+                // the delta segments are already shared.
                 LOG(INFO) << "no rebuild need, just swap data for common properties.";
                 new_fmi_manager->swapCommonProperties(fmi_manager_.get());
                 new_fmi_manager->swapUnchangedFilter(fmi_manager_.get());
@@ -203,6 +242,9 @@ bool SuffixMatchMiningTask::buildDocument(docid_t docID, const Document& doc)
 
 docid_t SuffixMatchMiningTask::getLastDocId()
 {
+    // on rebuilding, the docs after the base fm-index are appended again.
+    if (need_rebuild && new_fmi_manager)
+        return new_fmi_manager->baseDocCount() + 1;
     return fmi_manager_ ? fmi_manager_->docCount() + 1 : 1;
 }
 
@@ -70,6 +70,8 @@ private:
     boost::shared_ptr<FMIndexManager> new_fmi_manager;
     boost::shared_ptr<FilterManager> new_filter_manager;
     bool need_rebuild;
+    // append the new docs to a delta segment instead of rebuilding
+    bool need_delta_;
 
     typedef boost::shared_mutex MutexType;
     MutexType& mutex_;
@@ -11,6 +11,8 @@
 #include <3rdparty/febird/io/DataIO.h>
 #include <3rdparty/febird/io/StreamBuffer.h>
 #include <3rdparty/febird/io/FileStream.h>
+#include <3rdparty/febird/io/var_int.h>
+#include <common/ChunkedVector.h>
 #include <boost/filesystem/path.hpp>
 
 #include <glog/logging.h>
@@ -18,6 +20,58 @@
 namespace sf1r
 {
 
+namespace detail
+{
+
+template<class DataIO, class T>
+void save_febird(DataIO& ar, const T& container)
+{
+    ar & container;
+}
+
+template<class DataIO, class T>
+void load_febird(DataIO& ar, T& container)
+{
+    ar & container;
+}
+
+/**
+ * ChunkedVector is saved in the same format as std::vector,
+ * so that the files could be loaded by either of them.
+ */
+template<class DataIO, class T, std::size_t ChunkBits>
+void save_febird(DataIO& ar, const ChunkedVector<T, ChunkBits>& container)
+{
+    ar << febird::var_size_t(container.size());
+
+    for (std::size_t i = 0; i < container.chunkNum(); ++i)
+    {
+        const std::vector<T>& chunk = container.chunk(i);
+        for (typename std::vector<T>::const_iterator it = chunk.begin();
+             it != chunk.end(); ++it)
+        {
+            ar << *it;
+        }
+    }
+}
+
+template<class DataIO, class T, std::size_t ChunkBits>
+void load_febird(DataIO& ar, ChunkedVector<T, ChunkBits>& container)
+{
+    febird::var_size_t size;
+    ar >> size;
+
+    container.clear();
+    container.resize(size.t);
+
+    for (std::size_t i = 0; i < container.size(); ++i)
+    {
+        ar >> container.at(i);
+    }
+}
+
+} // namespace detail
+
 /**
  * Save @p container into file.
  * @param dirPath directory path
@@ -48,7 +102,7 @@ template<class T> bool save_container_febird(
     {
         febird::NativeDataOutput<febird::OutputBuffer> ar;
         ar.attach(&ofs);
-        ar & container;
+        detail::save_febird(ar, container);
     }
     catch(const std::exception& e)
     {
@@ -113,7 +167,7 @@ template<class T> bool load_container_febird(
     {
         febird::NativeDataInput<febird::InputBuffer> ar;
         ar.attach(&ifs);
-        ar & container;
+        detail::load_febird(ar, container);
     }
     catch(const std::exception& e)
     {
@@ -55,24 +55,33 @@ void BM25Ranker::calculateTermUBs(const RankQueryProperty& queryProperty, ID_FRE
 
     for (std::size_t i = 0; i != queryProperty.size(); ++i)
     {
-        float maxtf = queryProperty.maxTermFreqAt(i);
-        float tfInQuery = queryProperty.termFreqAt(i);
+        ub[i] = calculateTermUB(queryProperty, i, queryProperty.maxTermFreqAt(i));
+    }
+}
 
-        // If the term exists
-        if(tfInQuery > 0.0F && maxtf > 0.0F)
-        {
-            float avgPropLength = queryProperty.getAveragePropertyLength();
-            float denominatorTF_LN = k1_ * (b_ * maxtf / avgPropLength + (1 - b_)) + maxtf;
+float BM25Ranker::calculateTermUB(
+        const RankQueryProperty& queryProperty,
+        unsigned int termIndex,
+        float maxtf) const
+{
+    if (termIndex >= idfParts_.size())
+        return 0.0F;
 
-            float tf_LNPart = (k1_ + 1) * maxtf / denominatorTF_LN;
-            float qtfPart = (k3_ + 1) * tfInQuery / (k3_ + tfInQuery);
-            ub[i] = idfParts_[i] * qtfPart * tf_LNPart;
-        }
-        else //ub = 0 make contribution also.
-        {
-            ub[i] = 0.0;
-        }
+    float tfInQuery = queryProperty.termFreqAt(termIndex);
+
+    // If the term exists
+    if(tfInQuery > 0.0F && maxtf > 0.0F)
+    {
+        float avgPropLength = queryProperty.getAveragePropertyLength();
+        float denominatorTF_LN = k1_ * (b_ * maxtf / avgPropLength + (1 - b_)) + maxtf;
+
+        float tf_LNPart = (k1_ + 1) * maxtf / denominatorTF_LN;
+        float qtfPart = (k3_ + 1) * tfInQuery / (k3_ + tfInQuery);
+        return idfParts_[termIndex] * qtfPart * tf_LNPart;
     }
+
+    //ub = 0 make contribution also.
+    return 0.0F;
 }
 
 float BM25Ranker::getScore(
@@ -45,6 +45,11 @@ public:
 
     void calculateTermUBs(const RankQueryProperty& queryProperty, ID_FREQ_MAP_T& ub);
 
+    float calculateTermUB(
+        const RankQueryProperty& queryProperty,
+        unsigned int termIndex,
+        float maxtf) const;
+
     float getScore(
         const RankQueryProperty& queryProperty,
         const RankDocumentProperty& documentProperty
@@ -10,6 +10,9 @@
 #include "RankDocumentProperty.h"
 #include "common/type_defs.h"
 
+#include <map>
+#include <string>
+
 namespace sf1r {
 class PropertyRanker
 {
@@ -26,6 +29,19 @@ public:
 
     virtual void calculateTermUBs(const RankQueryProperty& queryProperty, ID_FREQ_MAP_T& ub) {}
 
+    /**
+     * @brief the upper bound of the term at @p termIndex in the docs whose
+     * term frequency is at most @p maxtf, it is used to get the upper bound
+     * of each posting block, default is 0 as @c calculateTermUBs().
+     */
+    virtual float calculateTermUB(
+        const RankQueryProperty& queryProperty,
+        unsigned int termIndex,
+        float maxtf) const
+    {
+        return 0;
+    }
+
     virtual float getTermUB(unsigned int termIndex) const
     {
         return 0;
@@ -42,6 +58,40 @@ public:
 
     virtual PropertyRanker* clone() const = 0;
 };
+
+/**
+ * @brief binds the query property to its ranker, so that the term
+ * iterators could calculate the upper bound of each posting block.
+ */
+class TermUBCalculator
+{
+public:
+    TermUBCalculator()
+        : queryProperty_(NULL)
+        , propertyRanker_(NULL)
+    {}
+
+    TermUBCalculator(
+        const RankQueryProperty& queryProperty,
+        const PropertyRanker& propertyRanker)
+        : queryProperty_(&queryProperty)
+        , propertyRanker_(&propertyRanker)
+    {}
+
+    float operator()(unsigned int termIndex, float maxtf) const
+    {
+        if (!propertyRanker_)
+            return 0;
+
+        return propertyRanker_->calculateTermUB(*queryProperty_, termIndex, maxtf);
+    }
+
+private:
+    const RankQueryProperty* queryProperty_;
+    const PropertyRanker* propertyRanker_;
+};
+
+typedef std::map<std::string, TermUBCalculator> TermUBCalculatorInProperties;
 } // namespace sf1r
 
 #endif // SF1V5_RANKING_MANAGER_PROPERTY_RANKER_H
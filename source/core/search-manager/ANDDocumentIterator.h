@@ -91,6 +91,8 @@ public:
     
     float getUB();
 
+    void setBlockUB(const TermUBCalculatorInProperties& ubCalculators);
+
     const char* getProperty()
     {
         if (docIterList_.begin() == docIterList_.end())
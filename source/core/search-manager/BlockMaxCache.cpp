@@ -0,0 +1,95 @@
+#include "BlockMaxCache.h"
+#include <glog/logging.h>
+
+using namespace sf1r;
+
+BlockMaxCache::BlockMaxCache(unsigned cacheSize, std::size_t maxPendingNum)
+    : cache_(cacheSize)
+    , maxPendingNum_(maxPendingNum)
+    , generation_(0)
+    , isClosed_(false)
+{
+    buildThread_ = boost::thread(&BlockMaxCache::runBuild_, this);
+}
+
+BlockMaxCache::~BlockMaxCache()
+{
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        isClosed_ = true;
+        pendingTasks_.clear();
+    }
+    cond_.notify_all();
+    buildThread_.join();
+
+    cache_.clear();
+}
+
+void BlockMaxCache::buildLater(const key_type& key, const builder_type& builder)
+{
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+
+        if (isClosed_ || pendingTasks_.size() >= maxPendingNum_ ||
+            !pendingKeys_.insert(key).second)
+            return;
+
+        pendingTasks_.push_back(BuildTask(key, builder));
+    }
+    cond_.notify_one();
+}
+
+void BlockMaxCache::clear()
+{
+    boost::mutex::scoped_lock lock(mutex_);
+
+    ++generation_;
+    pendingTasks_.clear();
+    pendingKeys_.clear();
+    cache_.clear();
+}
+
+void BlockMaxCache::runBuild_()
+{
+    while (true)
+    {
+        BuildTask task;
+        std::size_t generation = 0;
+        {
+            boost::mutex::scoped_lock lock(mutex_);
+            while (!isClosed_ && pendingTasks_.empty())
+            {
+                cond_.wait(lock);
+            }
+
+            if (isClosed_)
+                return;
+
+            task = pendingTasks_.front();
+            pendingTasks_.pop_front();
+            generation = generation_;
+        }
+
+        value_type value;
+        try
+        {
+            value = task.second();
+        }
+        catch (const std::exception& e)
+        {
+            LOG(ERROR) << "failed to build block max posting " << task.first
+                       << ", exception: " << e.what();
+        }
+
+        boost::mutex::scoped_lock lock(mutex_);
+        if (generation == generation_)
+        {
+            pendingKeys_.erase(task.first);
+
+            if (value)
+            {
+                cache_.insertValue(task.first, value);
+            }
+        }
+    }
+}
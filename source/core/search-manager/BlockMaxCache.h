@@ -0,0 +1,113 @@
+#ifndef CORE_SEARCH_MANAGER_BLOCK_MAX_CACHE_H
+#define CORE_SEARCH_MANAGER_BLOCK_MAX_CACHE_H
+/**
+ * @file core/search-manager/BlockMaxCache.h
+ * @brief cache the block max postings of the terms in recent queries,
+ *        as they are built by scanning the whole posting.
+ * @date Created 2013-07-02
+ * @date Updated 2013-08-05 build the postings in a background thread
+ *
+ * The query never waits for a posting to build, on cache miss, the term
+ * is queued to build in background, and the query goes on with the term
+ * upper bound.
+ */
+
+#include "BlockMaxPosting.h"
+#include <cache/IzeneCache.h>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+#include <deque>
+#include <set>
+#include <string>
+#include <utility>
+
+namespace sf1r
+{
+class BlockMaxCache
+{
+public:
+    typedef std::string key_type;
+    typedef BlockMaxPostingPtr value_type;
+
+    /// build the value in the background thread
+    typedef boost::function<value_type()> builder_type;
+
+public:
+    /**
+     * @param cacheSize the max number of postings cached
+     * @param maxPendingNum the max number of postings waiting to build,
+     *        the requests beyond it are ignored
+     */
+    BlockMaxCache(unsigned cacheSize, std::size_t maxPendingNum);
+
+    ~BlockMaxCache();
+
+    /**
+     * @param maxDocId the max doc id in the index, so that the postings
+     *        built before the index is modified are not used any more
+     */
+    static key_type makeKey(
+        const std::string& property,
+        termid_t termId,
+        docid_t maxDocId)
+    {
+        return property + ":" + boost::lexical_cast<std::string>(termId)
+            + ":" + boost::lexical_cast<std::string>(maxDocId);
+    }
+
+    bool get(const key_type& key, value_type& value)
+    {
+        return cache_.getValueNoInsert(key, value);
+    }
+
+    /**
+     * queue @p key to build by @p builder in the background thread,
+     * it does nothing if @p key is already queued.
+     */
+    void buildLater(const key_type& key, const builder_type& builder);
+
+    /**
+     * clear the cached postings, and those waiting to build.
+     */
+    void clear();
+
+private:
+    void runBuild_();
+
+private:
+    typedef izenelib::cache::IzeneCache<
+        key_type,
+        value_type,
+        izenelib::util::ReadWriteLock,
+        izenelib::cache::RDE_HASH,
+        izenelib::cache::LRLFU
+    > cache_type;
+
+    cache_type cache_;
+
+    const std::size_t maxPendingNum_;
+
+    typedef std::pair<key_type, builder_type> BuildTask;
+    std::deque<BuildTask> pendingTasks_;
+
+    /// the keys in @c pendingTasks_, or being built
+    std::set<key_type> pendingKeys_;
+
+    /// increased in @c clear(), so that the posting being built
+    /// meanwhile is not cached
+    std::size_t generation_;
+
+    bool isClosed_;
+
+    boost::mutex mutex_;
+
+    boost::condition_variable cond_;
+
+    boost::thread buildThread_;
+};
+
+} // namespace sf1r
+
+#endif // CORE_SEARCH_MANAGER_BLOCK_MAX_CACHE_H
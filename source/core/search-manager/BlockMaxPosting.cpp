@@ -0,0 +1,51 @@
+#include "BlockMaxPosting.h"
+
+#include <ir/index_manager/index/TermDocFreqs.h>
+
+#include <algorithm>
+
+using namespace sf1r;
+
+void BlockMaxPosting::build(izenelib::ir::indexmanager::TermDocFreqs* termDocFreqs)
+{
+    lastDocs_.clear();
+    maxTFs_.clear();
+
+    if (!termDocFreqs)
+        return;
+
+    std::size_t postingNum = 0;
+    count_t maxTF = 0;
+    docid_t lastDoc = 0;
+
+    while (termDocFreqs->next())
+    {
+        lastDoc = termDocFreqs->doc();
+        maxTF = std::max<count_t>(maxTF, termDocFreqs->freq());
+
+        if (++postingNum == kBlockSize)
+        {
+            lastDocs_.push_back(lastDoc);
+            maxTFs_.push_back(maxTF);
+            postingNum = 0;
+            maxTF = 0;
+        }
+    }
+
+    if (postingNum > 0)
+    {
+        lastDocs_.push_back(lastDoc);
+        maxTFs_.push_back(maxTF);
+    }
+}
+
+std::size_t BlockMaxPosting::findBlock(docid_t target, std::size_t fromBlock) const
+{
+    if (fromBlock >= lastDocs_.size())
+        return lastDocs_.size();
+
+    std::vector<docid_t>::const_iterator it =
+        std::lower_bound(lastDocs_.begin() + fromBlock, lastDocs_.end(), target);
+
+    return it - lastDocs_.begin();
+}
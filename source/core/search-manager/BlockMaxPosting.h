@@ -0,0 +1,58 @@
+/**
+ * @file BlockMaxPosting.h
+ * @brief the max term frequency of each fixed-size block in one posting,
+ *        it is used by block-max WAND to skip the whole block whose local
+ *        upper bound could not reach the threshold.
+ * @date Created 2013-07-02
+ */
+
+#ifndef SF1R_BLOCK_MAX_POSTING_H
+#define SF1R_BLOCK_MAX_POSTING_H
+
+#include <common/inttypes.h>
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+namespace izenelib { namespace ir { namespace indexmanager {
+class TermDocFreqs;
+}}}
+
+namespace sf1r
+{
+
+class BlockMaxPosting
+{
+public:
+    /// the number of postings in each block
+    static const std::size_t kBlockSize = 128;
+
+    /**
+     * scan all postings in @p termDocFreqs to collect the last docid and
+     * the max term frequency of each block.
+     */
+    void build(izenelib::ir::indexmanager::TermDocFreqs* termDocFreqs);
+
+    std::size_t blockNum() const { return lastDocs_.size(); }
+
+    docid_t lastDoc(std::size_t block) const { return lastDocs_[block]; }
+
+    count_t maxTF(std::size_t block) const { return maxTFs_[block]; }
+
+    /**
+     * @return the index of the first block whose last docid is not less
+     *         than @p target, searching from @p fromBlock,
+     *         or @c blockNum() if no such block exists.
+     */
+    std::size_t findBlock(docid_t target, std::size_t fromBlock = 0) const;
+
+private:
+    std::vector<docid_t> lastDocs_;
+
+    std::vector<count_t> maxTFs_;
+};
+
+typedef boost::shared_ptr<const BlockMaxPosting> BlockMaxPostingPtr;
+
+} // namespace sf1r
+
+#endif // SF1R_BLOCK_MAX_POSTING_H
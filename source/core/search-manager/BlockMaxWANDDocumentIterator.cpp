@@ -0,0 +1,95 @@
+#include "BlockMaxWANDDocumentIterator.h"
+
+#include <algorithm>
+
+namespace sf1r
+{
+
+bool BlockMaxWANDDocumentIterator::next()
+{
+    do
+    {
+        if(docIteratorSorter_.size() == 0)
+        {
+            initDocIteratorSorter();
+        }
+        if(docIteratorSorter_.size() == 0)
+            return false;
+
+        if (moveCurrentIterators() == false)
+            return false;
+
+        if (findPivot() == false)
+            return false;
+
+        if (pivotDoc_ <= currDoc_)
+        {
+            if(processPrePostings(currDoc_ + 1) == false)
+                return false;
+            continue;
+        }
+
+        docid_t skipTarget = MAX_DOC_ID;
+        if (checkBlockMax_(skipTarget) == false)
+        {
+            countPrunedPostings(skipTarget);
+
+            if(processPrePostings(skipTarget) == false)
+                return false;
+            continue;
+        }
+
+        DocumentIterator* front = docIteratorSorter_.begin()->second;
+        if(front->doc() == pivotDoc_)
+        {
+            currDoc_ = pivotDoc_;
+
+            processPrePostings(currDoc_);
+
+            markCurrentIterators();
+            return true;
+        }
+
+        countPrunedPostings(pivotDoc_);
+
+        if(processPrePostings(pivotDoc_) == false)
+            return false;
+    }
+    while(true);
+}
+
+bool BlockMaxWANDDocumentIterator::checkBlockMax_(docid_t& skipTarget)
+{
+    typedef std::multimap<docid_t, DocumentIterator*>::const_iterator const_map_iter;
+
+    float sumBlockUB = 0.0F;
+    docid_t minBlockLastDoc = MAX_DOC_ID;
+
+    const_map_iter iter = docIteratorSorter_.begin();
+    for (; iter != docIteratorSorter_.end() && iter->first <= pivotDoc_; ++iter)
+    {
+        DocumentIterator* pDocIterator = iter->second;
+        sumBlockUB += pDocIterator->getBlockUB(pivotDoc_);
+        minBlockLastDoc = std::min(minBlockLastDoc,
+                                   pDocIterator->getBlockLastDoc(pivotDoc_));
+    }
+
+    if (sumBlockUB > currThreshold_)
+        return true;
+
+    // no doc before the end of the shallowest block, or before the next
+    // iterator beyond the pivot, could reach the threshold
+    skipTarget = minBlockLastDoc;
+    if (skipTarget != MAX_DOC_ID)
+        ++skipTarget;
+
+    if (iter != docIteratorSorter_.end() && iter->first < skipTarget)
+        skipTarget = iter->first;
+
+    if (skipTarget <= pivotDoc_)
+        skipTarget = pivotDoc_ + 1;
+
+    return false;
+}
+
+} // namespace sf1r
@@ -0,0 +1,35 @@
+/**
+ * @file BlockMaxWANDDocumentIterator.h
+ * @brief the Block-Max WAND iterator, besides the pivot selection by the
+ *        global term upper bounds in WANDDocumentIterator, it also checks
+ *        the upper bounds of the posting blocks around the pivot doc,
+ *        and skips those blocks which could not reach the threshold.
+ * @date Created 2013-07-02
+ */
+
+#ifndef SF1R_BLOCK_MAX_WAND_DOCUMENT_ITERATOR_H
+#define SF1R_BLOCK_MAX_WAND_DOCUMENT_ITERATOR_H
+
+#include "WANDDocumentIterator.h"
+
+namespace sf1r
+{
+
+class BlockMaxWANDDocumentIterator : public WANDDocumentIterator
+{
+public:
+    bool next();
+
+private:
+    /**
+     * check the block upper bounds of the iterators up to the pivot doc.
+     * @param skipTarget if the sum of block upper bounds could not reach
+     *        the threshold, it is set to the next docid worth visiting.
+     * @return true if the pivot doc could reach the threshold
+     */
+    bool checkBlockMax_(docid_t& skipTarget);
+};
+
+} // namespace sf1r
+
+#endif // SF1R_BLOCK_MAX_WAND_DOCUMENT_ITERATOR_H
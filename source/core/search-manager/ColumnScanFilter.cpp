@@ -0,0 +1,306 @@
+#include "ColumnScanFilter.h"
+#include <document-manager/DocumentManager.h>
+#include <common/NumericPropertyTableBase.h>
+
+#include <glog/logging.h>
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/type_traits/is_arithmetic.hpp>
+#include <boost/variant/apply_visitor.hpp>
+#include <boost/variant/static_visitor.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace
+{
+/// the number of values read to estimate the selectivity
+const std::size_t kSampleNum = 1024;
+
+/**
+ * cast the filter value converted for BTree index to the type @c T, which
+ * is the type of the property values inserted into BTree index, so that
+ * the bound is rounded in the same way as BTree index compares it.
+ */
+template <typename T>
+class IndexValueCaster : public boost::static_visitor<bool>
+{
+public:
+    explicit IndexValueCaster(double& out) : out_(out) {}
+
+    template <typename V>
+    bool operator()(const V& value) const
+    {
+        return cast_(value, boost::is_arithmetic<V>());
+    }
+
+private:
+    template <typename V>
+    bool cast_(const V& value, boost::true_type) const
+    {
+        if (!isInRange_(static_cast<double>(value)))
+            return false;
+
+        out_ = static_cast<double>(static_cast<T>(value));
+        return true;
+    }
+
+    template <typename V>
+    bool cast_(const V&, boost::false_type) const
+    {
+        return false;
+    }
+
+    /// the values out of the range of @c T are left to BTree index
+    static bool isInRange_(double x)
+    {
+        if (std::numeric_limits<T>::is_integer)
+        {
+            // it is 2^(bits-1), which is exact in double
+            const double bound = -static_cast<double>(std::numeric_limits<T>::min());
+            return x >= -bound && x < bound;
+        }
+
+        const double bound = static_cast<double>(std::numeric_limits<T>::max());
+        return x >= -bound && x <= bound;
+    }
+
+private:
+    double& out_;
+};
+
+bool convertBound(
+    const std::string& property,
+    sf1r::PropertyDataType type,
+    const sf1r::PropertyValue& value,
+    double& bound)
+{
+    izenelib::ir::indexmanager::PropertyType indexValue;
+    sf1r::InvertedIndexManager::convertData(boost::to_upper_copy(property),
+                                            value, indexValue);
+
+    switch (type)
+    {
+    case sf1r::INT8_PROPERTY_TYPE:
+    case sf1r::INT16_PROPERTY_TYPE:
+    case sf1r::INT32_PROPERTY_TYPE:
+    {
+        IndexValueCaster<int32_t> caster(bound);
+        return boost::apply_visitor(caster, indexValue);
+    }
+    case sf1r::INT64_PROPERTY_TYPE:
+    {
+        IndexValueCaster<int64_t> caster(bound);
+        return boost::apply_visitor(caster, indexValue);
+    }
+    case sf1r::FLOAT_PROPERTY_TYPE:
+    {
+        IndexValueCaster<float> caster(bound);
+        return boost::apply_visitor(caster, indexValue);
+    }
+    case sf1r::DOUBLE_PROPERTY_TYPE:
+    {
+        IndexValueCaster<double> caster(bound);
+        return boost::apply_visitor(caster, indexValue);
+    }
+    default:
+        return false;
+    }
+}
+}
+
+namespace sf1r
+{
+
+ColumnScanFilter::ColumnScanFilter(const boost::shared_ptr<DocumentManager>& documentManager)
+    : documentManager_(documentManager)
+{
+}
+
+boost::shared_ptr<NumericPropertyTableBase> ColumnScanFilter::getTable_(
+    const QueryFiltering::FilteringType& condition) const
+{
+    boost::shared_ptr<NumericPropertyTableBase> table;
+    if (!documentManager_)
+        return table;
+
+    table = documentManager_->getNumericPropertyTable(condition.property_);
+    if (!table)
+        return table;
+
+    switch (table->getType())
+    {
+    case INT8_PROPERTY_TYPE:
+    case INT16_PROPERTY_TYPE:
+    case INT32_PROPERTY_TYPE:
+    case INT64_PROPERTY_TYPE:
+    case FLOAT_PROPERTY_TYPE:
+    case DOUBLE_PROPERTY_TYPE:
+        break;
+    default:
+        // the filter values on datetime need special conversion,
+        // they are left to the BTree index
+        table.reset();
+        break;
+    }
+    return table;
+}
+
+bool ColumnScanFilter::getRange_(
+    const QueryFiltering::FilteringType& condition,
+    PropertyDataType type,
+    Range& range) const
+{
+    const std::vector<PropertyValue>& values = condition.values_;
+    const std::string& property = condition.property_;
+    range.lower = -std::numeric_limits<double>::infinity();
+    range.upper = std::numeric_limits<double>::infinity();
+    range.includeLower = true;
+    range.includeUpper = true;
+
+    // the bounds are converted and used as in BTree index, so that the
+    // docs matched do not depend on which way is chosen
+    try
+    {
+        switch (condition.operation_)
+        {
+        case QueryFiltering::GREATER_THAN:
+        case QueryFiltering::GREATER_THAN_EQUAL:
+            if (values.empty())
+                return false;
+            range.includeLower = (condition.operation_ == QueryFiltering::GREATER_THAN_EQUAL);
+            return convertBound(property, type, values[0], range.lower);
+
+        case QueryFiltering::LESS_THAN:
+        case QueryFiltering::LESS_THAN_EQUAL:
+            if (values.empty())
+                return false;
+            range.includeUpper = (condition.operation_ == QueryFiltering::LESS_THAN_EQUAL);
+            return convertBound(property, type, values[0], range.upper);
+
+        case QueryFiltering::RANGE:
+            if (values.size() < 2)
+                return false;
+            // the bounds are not swapped, so a reversed range matches nothing
+            return convertBound(property, type, values[0], range.lower) &&
+                   convertBound(property, type, values[1], range.upper);
+
+        default:
+            return false;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        LOG(WARNING) << "non-numeric filter value on property " << property
+                     << ", exception: " << e.what();
+    }
+
+    return false;
+}
+
+bool ColumnScanFilter::estimateSelectivity(
+    const QueryFiltering::FilteringType& condition,
+    double& selectivity) const
+{
+    boost::shared_ptr<NumericPropertyTableBase> table = getTable_(condition);
+    if (!table)
+        return false;
+
+    Range range;
+    if (!getRange_(condition, table->getType(), range))
+        return false;
+
+    NumericPropertyTableBase::ScopedReadLock lock(table->getMutex());
+    const std::size_t size = table->size(false);
+    if (size == 0)
+    {
+        selectivity = 0;
+        return true;
+    }
+
+    const std::size_t sampleNum = std::min(size, kSampleNum);
+    std::size_t matchNum = 0;
+    double value = 0;
+
+    for (std::size_t i = 0; i < sampleNum; ++i)
+    {
+        const std::size_t pos = i * size / sampleNum;
+        if (!table->getDoubleValue(pos, value, false))
+            continue;
+
+        bool isMatch = (range.includeLower ? value >= range.lower : value > range.lower) &&
+                       (range.includeUpper ? value <= range.upper : value < range.upper);
+        if (isMatch)
+        {
+            ++matchNum;
+        }
+    }
+
+    selectivity = static_cast<double>(matchNum) / sampleNum;
+    return true;
+}
+
+bool ColumnScanFilter::makeRangeQuery(
+    const QueryFiltering::FilteringType& condition,
+    FilterBitmapT& bitmap) const
+{
+    boost::shared_ptr<NumericPropertyTableBase> table = getTable_(condition);
+    if (!table)
+        return false;
+
+    Range range;
+    if (!getRange_(condition, table->getType(), range))
+        return false;
+
+    std::vector<uint64_t> words;
+    std::size_t matchNum = 0;
+    if (!table->scanRange(range.lower, range.includeLower,
+                          range.upper, range.includeUpper,
+                          words, matchNum))
+    {
+        return false;
+    }
+
+    const std::size_t wordBitNum = sizeof(InvertedIndexManager::FilterWordT) << 3;
+
+    // the removed docs are only marked in the delete filter, while their
+    // values are still in the column
+    std::vector<docid_t> deletedDocs;
+    documentManager_->getDeletedDocIdList(deletedDocs);
+    for (std::vector<docid_t>::const_iterator it = deletedDocs.begin();
+         it != deletedDocs.end(); ++it)
+    {
+        const std::size_t i = *it / wordBitNum;
+        if (i < words.size())
+        {
+            words[i] &= ~(InvertedIndexManager::FilterWordT(1) << (*it % wordBitNum));
+        }
+    }
+
+    // the bitmap has the same size as the one built from BTree index
+    const std::size_t bitsNum = documentManager_->getMaxDocId() + 1;
+    const std::size_t wordsNum = (bitsNum - 1) / wordBitNum + 1;
+
+    FilterBitmapT result;
+    for (std::size_t i = 0; i < wordsNum; ++i)
+    {
+        InvertedIndexManager::FilterWordT word = i < words.size() ? words[i] : 0;
+        std::size_t validBitNum = wordBitNum;
+
+        if (i + 1 == wordsNum)
+        {
+            validBitNum = bitsNum - i * wordBitNum;
+            if (validBitNum < wordBitNum)
+            {
+                word &= (InvertedIndexManager::FilterWordT(1) << validBitNum) - 1;
+            }
+        }
+        result.add(word, validBitNum);
+    }
+
+    bitmap.swap(result);
+    return true;
+}
+
+} // namespace sf1r
@@ -0,0 +1,70 @@
+/**
+ * @file ColumnScanFilter.h
+ * @brief evaluate the range filters on numeric property by scanning
+ *        the NumericPropertyTable column, instead of the BTree index.
+ * @date Created 2013-07-10
+ */
+
+#ifndef SF1R_COLUMN_SCAN_FILTER_H
+#define SF1R_COLUMN_SCAN_FILTER_H
+
+#include <query-manager/QueryTypeDef.h>
+#include <index-manager/InvertedIndexManager.h>
+
+#include <boost/shared_ptr.hpp>
+
+namespace sf1r
+{
+class DocumentManager;
+class NumericPropertyTableBase;
+
+class ColumnScanFilter
+{
+public:
+    typedef InvertedIndexManager::FilterBitmapT FilterBitmapT;
+
+    explicit ColumnScanFilter(const boost::shared_ptr<DocumentManager>& documentManager);
+
+    /**
+     * if @p condition is a range on a numeric property, estimate the ratio
+     * of the docs it matches by sampling the column.
+     * @return false if @p condition could not be evaluated by column scan
+     */
+    bool estimateSelectivity(
+        const QueryFiltering::FilteringType& condition,
+        double& selectivity) const;
+
+    /**
+     * evaluate @p condition by scanning the column, the docs removed
+     * are excluded, @p bitmap is only modified when true is returned.
+     * the bounds are converted and ordered as in
+     * InvertedIndexManager::makeRangeQuery(), so both give the same docs.
+     */
+    bool makeRangeQuery(
+        const QueryFiltering::FilteringType& condition,
+        FilterBitmapT& bitmap) const;
+
+private:
+    struct Range
+    {
+        double lower;
+        bool includeLower;
+        double upper;
+        bool includeUpper;
+    };
+
+    boost::shared_ptr<NumericPropertyTableBase> getTable_(
+        const QueryFiltering::FilteringType& condition) const;
+
+    bool getRange_(
+        const QueryFiltering::FilteringType& condition,
+        PropertyDataType type,
+        Range& range) const;
+
+private:
+    boost::shared_ptr<DocumentManager> documentManager_;
+};
+
+} // namespace sf1r
+
+#endif // SF1R_COLUMN_SCAN_FILTER_H
@@ -0,0 +1,314 @@
+#include "CustomRankProgram.h"
+#include "CustomRankTreeParser.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace sf1r;
+
+namespace
+{
+/// the max number of registers evaluating one doc on stack
+const std::size_t MAX_STACK_REGISTER_NUM = 32;
+}
+
+const std::size_t CustomRankProgram::kBatchSize;
+
+CustomRankProgram::CustomRankProgram()
+    : registerNum_(0)
+    , resultRegister_(0)
+{
+}
+
+void CustomRankProgram::clear()
+{
+    code_.clear();
+    columns_.clear();
+    columnRegisters_.clear();
+    registerNum_ = 0;
+    resultRegister_ = 0;
+}
+
+bool CustomRankProgram::compile(const ExpSyntaxTree& estree)
+{
+    clear();
+
+    Operand result;
+    if (!compileNode_(estree, result))
+    {
+        clear();
+        return false;
+    }
+
+    resultRegister_ = toRegister_(result);
+    return true;
+}
+
+bool CustomRankProgram::compileNode_(const ExpSyntaxTree& node, Operand& result)
+{
+    const std::size_t childNum = node.children_.size();
+    result.isConstant = false;
+    result.value = 0;
+    result.reg = 0;
+
+    switch (node.type_)
+    {
+    case ExpSyntaxTree::ROOT:
+        return childNum == 1 && compileNode_(*node.children_[0], result);
+
+    case ExpSyntaxTree::CONSTANT:
+        result.isConstant = true;
+        result.value = node.value_;
+        return true;
+
+    case ExpSyntaxTree::PARAMETER:
+    {
+        if (!node.propertyData_)
+        {
+            result.isConstant = true;
+            result.value = node.value_;
+            return true;
+        }
+
+        std::vector<ColumnPtr>::const_iterator it =
+            std::find(columns_.begin(), columns_.end(), node.propertyData_);
+        if (it != columns_.end())
+        {
+            result.reg = columnRegisters_[it - columns_.begin()];
+            return true;
+        }
+
+        result.reg = registerNum_++;
+        emit_(OP_COLUMN, result.reg, columns_.size(), 0);
+        columns_.push_back(node.propertyData_);
+        columnRegisters_.push_back(result.reg);
+        return true;
+    }
+
+    case ExpSyntaxTree::SQRT:
+    case ExpSyntaxTree::LOG:
+    {
+        Operand arg;
+        if (childNum != 1 || !compileNode_(*node.children_[0], arg))
+            return false;
+
+        const bool isSqrt = node.type_ == ExpSyntaxTree::SQRT;
+        if (arg.isConstant)
+        {
+            result.isConstant = true;
+            result.value = isSqrt ? std::sqrt(arg.value) : std::log(arg.value);
+            return true;
+        }
+
+        result.reg = registerNum_++;
+        emit_(isSqrt ? OP_SQRT : OP_LOG, result.reg, arg.reg, 0);
+        return true;
+    }
+
+    case ExpSyntaxTree::SUM:
+    case ExpSyntaxTree::SUB:
+    case ExpSyntaxTree::PRODUCT:
+    case ExpSyntaxTree::DIV:
+    case ExpSyntaxTree::POW:
+    {
+        Operand lhs, rhs;
+        if (childNum != 2 ||
+            !compileNode_(*node.children_[0], lhs) ||
+            !compileNode_(*node.children_[1], rhs))
+            return false;
+
+        OpCode op = OP_ADD;
+        switch (node.type_)
+        {
+        case ExpSyntaxTree::SUB:
+            op = OP_SUB;
+            break;
+        case ExpSyntaxTree::PRODUCT:
+            op = OP_MUL;
+            break;
+        case ExpSyntaxTree::DIV:
+            op = OP_DIV;
+            break;
+        case ExpSyntaxTree::POW:
+            op = OP_POW;
+            break;
+        default:
+            break;
+        }
+
+        if (lhs.isConstant && rhs.isConstant)
+        {
+            double value = 0;
+            switch (op)
+            {
+            case OP_SUB:
+                value = lhs.value - rhs.value;
+                break;
+            case OP_MUL:
+                value = lhs.value * rhs.value;
+                break;
+            case OP_DIV:
+                value = lhs.value / rhs.value;
+                break;
+            case OP_POW:
+                value = std::pow(lhs.value, rhs.value);
+                break;
+            default:
+                value = lhs.value + rhs.value;
+                break;
+            }
+
+            result.isConstant = true;
+            result.value = value;
+            return true;
+        }
+
+        const std::size_t src1 = toRegister_(lhs);
+        const std::size_t src2 = toRegister_(rhs);
+        result.reg = registerNum_++;
+        emit_(op, result.reg, src1, src2);
+        return true;
+    }
+
+    default:
+        return false;
+    }
+}
+
+std::size_t CustomRankProgram::toRegister_(const Operand& operand)
+{
+    if (!operand.isConstant)
+        return operand.reg;
+
+    const std::size_t reg = registerNum_++;
+    emit_(OP_CONSTANT, reg, 0, 0, operand.value);
+    return reg;
+}
+
+void CustomRankProgram::emit_(
+    OpCode op,
+    std::size_t dst,
+    std::size_t src1,
+    std::size_t src2,
+    double constant)
+{
+    Instruction instruction;
+    instruction.op = op;
+    instruction.dst = dst;
+    instruction.src1 = src1;
+    instruction.src2 = src2;
+    instruction.constant = constant;
+
+    code_.push_back(instruction);
+}
+
+double CustomRankProgram::evaluate(docid_t docId) const
+{
+    if (!isCompiled())
+        return 0;
+
+    if (registerNum_ <= MAX_STACK_REGISTER_NUM)
+    {
+        double registers[MAX_STACK_REGISTER_NUM];
+        run_(&docId, 1, registers);
+        return registers[resultRegister_];
+    }
+
+    std::vector<double> registers(registerNum_);
+    run_(&docId, 1, &registers[0]);
+    return registers[resultRegister_];
+}
+
+void CustomRankProgram::evaluate(
+    const docid_t* docIds,
+    std::size_t num,
+    double* scores) const
+{
+    if (!isCompiled())
+    {
+        std::fill(scores, scores + num, 0);
+        return;
+    }
+
+    const std::size_t batchSize = std::min(num, kBatchSize);
+    std::vector<double> registers(registerNum_ * batchSize);
+
+    for (std::size_t begin = 0; begin < num; begin += batchSize)
+    {
+        const std::size_t batchNum = std::min(batchSize, num - begin);
+        run_(docIds + begin, batchNum, &registers[0]);
+
+        const double* result = &registers[resultRegister_ * batchNum];
+        std::copy(result, result + batchNum, scores + begin);
+    }
+}
+
+void CustomRankProgram::run_(
+    const docid_t* docIds,
+    std::size_t num,
+    double* registers) const
+{
+    for (std::vector<Instruction>::const_iterator it = code_.begin();
+         it != code_.end(); ++it)
+    {
+        double* dst = registers + it->dst * num;
+        const double* src1 = registers + it->src1 * num;
+        const double* src2 = registers + it->src2 * num;
+
+        switch (it->op)
+        {
+        case OP_CONSTANT:
+            std::fill(dst, dst + num, it->constant);
+            break;
+
+        case OP_COLUMN:
+        {
+            const NumericPropertyTableBase& column = *columns_[it->src1];
+            NumericPropertyTableBase::ScopedReadLock lock(column.getMutex());
+
+            for (std::size_t i = 0; i < num; ++i)
+            {
+                if (!column.getDoubleValue(docIds[i], dst[i], false))
+                {
+                    dst[i] = 0;
+                }
+            }
+            break;
+        }
+
+        case OP_ADD:
+            for (std::size_t i = 0; i < num; ++i)
+                dst[i] = src1[i] + src2[i];
+            break;
+
+        case OP_SUB:
+            for (std::size_t i = 0; i < num; ++i)
+                dst[i] = src1[i] - src2[i];
+            break;
+
+        case OP_MUL:
+            for (std::size_t i = 0; i < num; ++i)
+                dst[i] = src1[i] * src2[i];
+            break;
+
+        case OP_DIV:
+            for (std::size_t i = 0; i < num; ++i)
+                dst[i] = src1[i] / src2[i];
+            break;
+
+        case OP_SQRT:
+            for (std::size_t i = 0; i < num; ++i)
+                dst[i] = std::sqrt(src1[i]);
+            break;
+
+        case OP_LOG:
+            for (std::size_t i = 0; i < num; ++i)
+                dst[i] = std::log(src1[i]);
+            break;
+
+        case OP_POW:
+            for (std::size_t i = 0; i < num; ++i)
+                dst[i] = std::pow(src1[i], src2[i]);
+            break;
+        }
+    }
+}
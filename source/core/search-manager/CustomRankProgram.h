@@ -0,0 +1,121 @@
+/**
+ * @file CustomRankProgram.h
+ * @brief the custom ranking expression compiled into a flat program,
+ *        which is evaluated over a batch of docs at a time.
+ * @date Created 2013-07-31
+ *
+ * Each instruction writes one register, which holds the values of all the
+ * docs in a batch, so that each operator runs as a tight loop over the
+ * batch instead of a recursive tree walk per doc. The property tables are
+ * bound at compile time, each table is read once for each batch under one
+ * read lock, and the sub-expressions of only constants are folded.
+ *
+ * The program is immutable after compile(), so it could be evaluated by
+ * multiple threads at the same time.
+ */
+
+#ifndef SF1R_CUSTOM_RANK_PROGRAM_H
+#define SF1R_CUSTOM_RANK_PROGRAM_H
+
+#include <common/inttypes.h>
+#include <common/NumericPropertyTableBase.h>
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+namespace sf1r
+{
+class ExpSyntaxTree;
+
+class CustomRankProgram
+{
+public:
+    /// the max number of docs evaluated in one batch
+    static const std::size_t kBatchSize = 128;
+
+    CustomRankProgram();
+
+    /**
+     * compile the expression tree, whose property tables should be set.
+     * @return false if the tree is not a valid expression
+     */
+    bool compile(const ExpSyntaxTree& estree);
+
+    bool isCompiled() const { return !code_.empty(); }
+
+    void clear();
+
+    /**
+     * evaluate the score of one doc.
+     */
+    double evaluate(docid_t docId) const;
+
+    /**
+     * evaluate the scores of @p num docs.
+     * @param scores [OUT] the score of each doc in @p docIds
+     */
+    void evaluate(const docid_t* docIds, std::size_t num, double* scores) const;
+
+private:
+    enum OpCode
+    {
+        OP_CONSTANT, // dst = constant
+        OP_COLUMN,   // dst = columns_[src1][docId], 0 if no value
+        OP_ADD,      // dst = src1 + src2
+        OP_SUB,      // dst = src1 - src2
+        OP_MUL,      // dst = src1 * src2
+        OP_DIV,      // dst = src1 / src2
+        OP_SQRT,     // dst = sqrt(src1)
+        OP_LOG,      // dst = log(src1)
+        OP_POW       // dst = pow(src1, src2)
+    };
+
+    struct Instruction
+    {
+        OpCode op;
+        std::size_t dst;
+        std::size_t src1;
+        std::size_t src2;
+        double constant;
+    };
+
+    /**
+     * the operand of an instruction, it is either a constant folded in
+     * compile time, or a register.
+     */
+    struct Operand
+    {
+        bool isConstant;
+        double value;
+        std::size_t reg;
+    };
+
+    bool compileNode_(const ExpSyntaxTree& node, Operand& result);
+
+    std::size_t toRegister_(const Operand& operand);
+
+    void emit_(OpCode op, std::size_t dst, std::size_t src1,
+               std::size_t src2, double constant = 0);
+
+    /**
+     * run the program over @p num docs, each register takes @p num
+     * continuous values in @p registers.
+     */
+    void run_(const docid_t* docIds, std::size_t num, double* registers) const;
+
+private:
+    std::vector<Instruction> code_;
+
+    typedef boost::shared_ptr<NumericPropertyTableBase> ColumnPtr;
+    std::vector<ColumnPtr> columns_;
+
+    /// the register loading each column
+    std::vector<std::size_t> columnRegisters_;
+
+    std::size_t registerNum_;
+
+    std::size_t resultRegister_;
+};
+
+} // namespace sf1r
+
+#endif // SF1R_CUSTOM_RANK_PROGRAM_H
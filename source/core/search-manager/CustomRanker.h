@@ -9,8 +9,10 @@
 
 #include <boost/shared_ptr.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include <search-manager/CustomRankTreeParser.h>
+#include <search-manager/CustomRankProgram.h>
 
 #include <common/inttypes.h>
 #include <util/ustring/UString.h>
@@ -46,6 +48,11 @@ private:
     CustomRankTreeParser customRankTreeParser_;
     ExpSyntaxTreePtr ESTree_;
 
+    // the expression compiled with property data, it is shared by the
+    // search threads, so it is compiled only once
+    CustomRankProgram program_;
+    boost::mutex programMutex_;
+
     // error info
     std::string errorInfo_;
 
@@ -167,20 +174,28 @@ public:
     bool parse(izenelib::util::UString& ustrExp);
 
     /**
-     * @brief Build expression syntax tree with sort property data.
+     * @brief Build expression syntax tree with sort property data,
+     * and compile it for evaluation.
      */
     bool setPropertyData(NumericPropertyTableBuilder* numericTableBuilder);
 
     /**
      * @brief Evaluate the custom ranking score for a document
      * @param docid the id of document to be evaluated
-     * @return score
+     * @return score, a property without value in the document is taken as 0
      */
-    double evaluate(docid_t& docid)
+    double evaluate(docid_t& docid) const
     {
-        sub_evaluate(ESTree_, docid);
-        //cout << "CustomRanker::evaluate(" << docid << ") = " <<  ESTree_->value_ <<endl; //test
-        return ESTree_->value_;
+        return program_.evaluate(docid);
+    }
+
+    /**
+     * @brief Evaluate the custom ranking scores for a batch of documents
+     * @param scores [OUT] the score of each document in @p docids
+     */
+    void evaluate(const docid_t* docids, std::size_t num, double* scores) const
+    {
+        program_.evaluate(docids, num, scores);
     }
 
 private:
@@ -196,12 +211,6 @@ private:
         ExpSyntaxTreePtr& estree,
         NumericPropertyTableBuilder& numericTableBuilder);
 
-    /**
-     * @brief evaluate custom ranking score recursively from EST
-     * the return value may be meaningless currently.
-     */
-    bool sub_evaluate(ExpSyntaxTreePtr& estree, docid_t& docid);
-
     /**
      * @brief remove front and trailing space
      */
@@ -0,0 +1,138 @@
+#include "DocIdRangeScheduler.h"
+
+#include <algorithm>
+
+using namespace sf1r;
+
+namespace
+{
+/// the expected number of chunks for each thread
+const std::size_t kChunkNumPerThread = 16;
+
+const std::size_t kMinChunkSize = 1024;
+}
+
+DocIdRangeScheduler::DocIdRangeScheduler(
+    docid_t docIdEnd,
+    std::size_t threadNum,
+    std::size_t chunkSize)
+    : chunkSize_(chunkSize)
+    , stealCount_(0)
+{
+    if (threadNum == 0)
+    {
+        threadNum = 1;
+    }
+
+    if (chunkSize_ == 0)
+    {
+        chunkSize_ = std::max(kMinChunkSize,
+                              docIdEnd / (threadNum * kChunkNumPerThread) + 1);
+    }
+
+    // the same split as the fixed slices, [i*avg, (i+1)*avg)
+    const std::size_t averageDocNum = docIdEnd / threadNum + 1;
+
+    ranges_.resize(threadNum);
+    for (std::size_t i = 0; i < threadNum; ++i)
+    {
+        ranges_[i].reset(new ThreadRange);
+        ranges_[i]->begin = std::min<std::size_t>(i * averageDocNum, docIdEnd);
+        ranges_[i]->end = std::min<std::size_t>((i+1) * averageDocNum, docIdEnd);
+    }
+}
+
+bool DocIdRangeScheduler::next(std::size_t threadId, docid_t& begin, docid_t& end)
+{
+    if (threadId >= ranges_.size())
+        return false;
+
+    ThreadRange& range = *ranges_[threadId];
+
+    do
+    {
+        {
+            boost::mutex::scoped_lock lock(range.mutex);
+            if (range.begin < range.end)
+            {
+                begin = range.begin;
+                end = std::min<std::size_t>(range.end, begin + chunkSize_);
+                range.begin = end;
+                range.lastEnd = end;
+                return true;
+            }
+        }
+    }
+    while (steal_(threadId));
+
+    return false;
+}
+
+std::size_t DocIdRangeScheduler::stealableSize_(
+    const ThreadRange& victim,
+    docid_t lastEnd) const
+{
+    docid_t from = std::max(victim.begin, lastEnd);
+    if (from >= victim.end)
+        return 0;
+
+    std::size_t size = victim.end - from;
+
+    // leave at least one chunk to the victim
+    if (size < 2 * chunkSize_)
+        return 0;
+
+    return size / 2;
+}
+
+bool DocIdRangeScheduler::steal_(std::size_t threadId)
+{
+    ThreadRange& thief = *ranges_[threadId];
+    const std::size_t threadNum = ranges_.size();
+
+    while (true)
+    {
+        std::size_t victimId = threadNum;
+        std::size_t maxSize = 0;
+
+        for (std::size_t i = 0; i < threadNum; ++i)
+        {
+            if (i == threadId)
+                continue;
+
+            ThreadRange& victim = *ranges_[i];
+            boost::mutex::scoped_lock lock(victim.mutex);
+            std::size_t size = stealableSize_(victim, thief.lastEnd);
+            if (size > maxSize)
+            {
+                maxSize = size;
+                victimId = i;
+            }
+        }
+
+        if (victimId == threadNum)
+            return false;
+
+        docid_t stolenBegin = 0;
+        docid_t stolenEnd = 0;
+        {
+            ThreadRange& victim = *ranges_[victimId];
+            boost::mutex::scoped_lock lock(victim.mutex);
+
+            // the victim might have moved on since it was chosen
+            std::size_t size = stealableSize_(victim, thief.lastEnd);
+            if (size == 0)
+                continue;
+
+            stolenEnd = victim.end;
+            stolenBegin = stolenEnd - size;
+            victim.end = stolenBegin;
+        }
+
+        boost::mutex::scoped_lock lock(thief.mutex);
+        thief.begin = stolenBegin;
+        thief.end = stolenEnd;
+        ++stealCount_;
+        return true;
+    }
+}
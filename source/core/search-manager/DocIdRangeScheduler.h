@@ -0,0 +1,84 @@
+/**
+ * @file DocIdRangeScheduler.h
+ * @brief schedule the docid range [0, docIdEnd) to multiple search threads.
+ *
+ * Each thread owns a slice of the docid range, and takes small chunks from
+ * the front of its slice. When its slice is exhausted, it steals the upper
+ * half of the remaining range from the thread with the most work left.
+ *
+ * As DocumentIterator could only move forward, a thread would only steal
+ * the range beginning after all the chunks it has already processed, so
+ * that the chunks taken by one thread are always in ascending order.
+ *
+ * @date Created 2013-07-08
+ */
+
+#ifndef SF1R_DOCID_RANGE_SCHEDULER_H
+#define SF1R_DOCID_RANGE_SCHEDULER_H
+
+#include <common/inttypes.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/detail/atomic_count.hpp>
+#include <vector>
+
+namespace sf1r
+{
+
+class DocIdRangeScheduler
+{
+public:
+    /**
+     * @param docIdEnd the end of docid range to schedule
+     * @param threadNum the number of search threads
+     * @param chunkSize the number of docids taken each time,
+     *        if it is 0, the chunk size would be decided by @p docIdEnd.
+     */
+    DocIdRangeScheduler(
+        docid_t docIdEnd,
+        std::size_t threadNum,
+        std::size_t chunkSize = 0);
+
+    /**
+     * get the next docid range for thread @p threadId.
+     * @return false if there is no range left for this thread.
+     */
+    bool next(std::size_t threadId, docid_t& begin, docid_t& end);
+
+    std::size_t chunkSize() const { return chunkSize_; }
+
+    /// the total number of successful steals
+    long stealCount() const { return stealCount_; }
+
+private:
+    struct ThreadRange
+    {
+        boost::mutex mutex;
+
+        /// the remaining range owned by this thread
+        docid_t begin;
+        docid_t end;
+
+        /// the end of the last chunk taken by this thread,
+        /// only accessed by the owner thread
+        docid_t lastEnd;
+
+        ThreadRange() : begin(0), end(0), lastEnd(0) {}
+    };
+
+    bool steal_(std::size_t threadId);
+
+    /// the size of range stealable by a thread whose last end is @p lastEnd
+    std::size_t stealableSize_(const ThreadRange& victim, docid_t lastEnd) const;
+
+private:
+    std::size_t chunkSize_;
+
+    std::vector<boost::shared_ptr<ThreadRange> > ranges_;
+
+    boost::detail::atomic_count stealCount_;
+};
+
+} // namespace sf1r
+
+#endif // SF1R_DOCID_RANGE_SCHEDULER_H
@@ -12,6 +12,7 @@
 #include <ranking-manager/RankingManager.h>
 #include <ranking-manager/RankQueryProperty.h>
 #include <ranking-manager/RankDocumentProperty.h>
+#include <ranking-manager/PropertyRanker.h>
 
 #define MAX_DOC_ID      0xFFFFFFFF
 #define MAX_COUNT       0xFFFFFFFF // max value of count_t type
@@ -100,6 +101,24 @@ public:
         return 0.0;
     }
 
+    ///calculate the upper bound of each posting block, used by block-max WAND
+    virtual void setBlockUB(const TermUBCalculatorInProperties& ubCalculators)
+    {
+        return;
+    }
+
+    ///the upper bound of the posting block which might contain @p target
+    virtual float getBlockUB(docid_t target)
+    {
+        return getUB();
+    }
+
+    ///the last docid of the posting block which might contain @p target
+    virtual docid_t getBlockLastDoc(docid_t target)
+    {
+        return MAX_DOC_ID;
+    }
+
     virtual const char* getProperty()
     {
         return NULL;
@@ -110,6 +129,12 @@ public:
         return;
     }
 
+    ///the number of postings skipped by dynamic pruning without being scored
+    virtual count_t getPrunedCount()
+    {
+        return 0;
+    }
+
     void setMissRate(float missRate)
     {
         missRate_ = missRate;
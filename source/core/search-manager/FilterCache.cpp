@@ -0,0 +1,67 @@
+#include "FilterCache.h"
+
+#include <3rdparty/msgpack/msgpack.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+/**
+ * append @p key with its length, so that the concatenated keys are not
+ * ambiguous.
+ */
+void appendKey(const std::string& key, std::string& output)
+{
+    const uint32_t len = key.size();
+    output.append(reinterpret_cast<const char*>(&len), sizeof(len));
+    output.append(key);
+}
+}
+
+namespace sf1r
+{
+
+FilterCache::key_type FilterCache::makeKey(const QueryFiltering::FilteringType& filteringItem)
+{
+    msgpack::sbuffer buffer;
+    msgpack::pack(buffer, filteringItem);
+
+    key_type key(1, 'L');
+    key.append(buffer.data(), buffer.size());
+    return key;
+}
+
+FilterCache::key_type FilterCache::makeKey(const ConditionsNode& conditionsNode)
+{
+    std::vector<key_type> childKeys;
+    childKeys.reserve(conditionsNode.conditionLeafList_.size() +
+                      conditionsNode.conditionsNodeList_.size());
+
+    for (std::size_t i = 0; i < conditionsNode.conditionLeafList_.size(); ++i)
+    {
+        childKeys.push_back(makeKey(conditionsNode.conditionLeafList_[i]));
+    }
+
+    for (std::size_t j = 0; j < conditionsNode.conditionsNodeList_.size(); ++j)
+    {
+        childKeys.push_back(makeKey(conditionsNode.conditionsNodeList_[j]));
+    }
+
+    // the relation does not matter for only one child
+    if (childKeys.size() == 1)
+        return childKeys[0];
+
+    std::sort(childKeys.begin(), childKeys.end());
+
+    key_type key(1, 'N');
+    appendKey(conditionsNode.relation_, key);
+    for (std::vector<key_type>::const_iterator it = childKeys.begin();
+            it != childKeys.end(); ++it)
+    {
+        appendKey(*it, key);
+    }
+    return key;
+}
+
+} // namespace sf1r
@@ -4,25 +4,45 @@
  * @file core/search-manager/FilterCache.h
  * @author Yingfeng
  * @date Created <2010-04-09 16:12:00>
+ * @date Updated <2013-07-12> cache the filter subtrees, with cost-aware
+ *       admission and invalidation by generation.
+ * @date Updated <2013-07-17> cache the decompressed bitsets of filters.
  */
 
 #include <query-manager/ActionItem.h>
 #include <index-manager/InvertedIndexManager.h>
+#include <common/parsers/ConditionsTree.h>
 #include <cache/IzeneCache.h>
+#include <ir/index_manager/utility/Bitset.h>
 
 #include <boost/shared_ptr.hpp>
+#include <boost/atomic.hpp>
+#include <algorithm>
+#include <string>
+#include <utility>
 
 namespace sf1r
 {
 class FilterCache
 {
 public:
-    typedef QueryFiltering::FilteringType key_type;
+    typedef std::string key_type;
     typedef boost::shared_ptr<InvertedIndexManager::FilterBitmapT> value_type;
+    typedef boost::shared_ptr<izenelib::ir::indexmanager::Bitset> bitset_type;
 
 public:
-    explicit FilterCache(unsigned cacheSize)
+    /**
+     * @param minCost the bitmaps which cost less than @p minCost seconds to
+     *        build are not cached, as rebuilding them is cheap enough.
+     * @param bitsetCacheSize the number of decompressed bitsets cached, each
+     *        one takes (max docid / 8) bytes.
+     */
+    FilterCache(unsigned cacheSize, double minCost = 0, unsigned bitsetCacheSize = 0)
         : cache_(cacheSize)
+        , bitsetCache_(std::max(bitsetCacheSize, 1U))
+        , isBitsetCached_(bitsetCacheSize > 0)
+        , minCost_(minCost)
+        , generation_(0)
     {}
 
     ~FilterCache()
@@ -30,31 +50,115 @@ public:
         clear();
     }
 
+    /**
+     * the key of a single filter condition.
+     */
+    static key_type makeKey(const QueryFiltering::FilteringType& filteringItem);
+
+    /**
+     * the canonical key of a filter subtree, the children of AND/OR nodes
+     * are sorted by their keys, so that the subtrees only differing in the
+     * order of children have the same key.
+     */
+    static key_type makeKey(const ConditionsNode& conditionsNode);
+
     bool get(const key_type& key, value_type& value)
     {
-        return cache_.getValueNoInsert(key, value);
+        entry_type entry;
+        if (!cache_.getValueNoInsert(key, entry))
+            return false;
+
+        // the entries of old generations are stale
+        if (entry.first != generation_.load())
+            return false;
+
+        value = entry.second;
+        return true;
+    }
+
+    /**
+     * @param cost the seconds spent on building @p value
+     */
+    void set(const key_type& key, value_type value, double cost)
+    {
+        if (cost < minCost_)
+            return;
+
+        cache_.insertValue(key, entry_type(generation_.load(), value));
+    }
+
+    /**
+     * the cached bitset is shared by requests, it must not be modified.
+     */
+    bool getBitset(const key_type& key, bitset_type& value)
+    {
+        if (!isBitsetCached_)
+            return false;
+
+        bitset_entry_type entry;
+        if (!bitsetCache_.getValueNoInsert(key, entry))
+            return false;
+
+        if (entry.first != generation_.load())
+            return false;
+
+        value = entry.second;
+        return true;
+    }
+
+    void setBitset(const key_type& key, bitset_type value)
+    {
+        if (!isBitsetCached_)
+            return;
+
+        bitsetCache_.insertValue(key, bitset_entry_type(generation_.load(), value));
     }
 
-    void set(const key_type& key, value_type value)
+    /**
+     * invalidate all the cached bitmaps, it is called when the index is
+     * updated, the stale entries would be evicted by the new ones.
+     */
+    void nextGeneration()
     {
-        cache_.insertValue(key, value);
+        ++generation_;
     }
 
     void clear()
     {
         cache_.clear();
+        bitsetCache_.clear();
     }
 
 private:
+    typedef std::pair<uint64_t, value_type> entry_type;
+
     typedef izenelib::cache::IzeneCache<
         key_type,
-        value_type,
+        entry_type,
         izenelib::util::ReadWriteLock,
         izenelib::cache::RDE_HASH,
         izenelib::cache::LRLFU
     > cache_type;
 
+    typedef std::pair<uint64_t, bitset_type> bitset_entry_type;
+
+    typedef izenelib::cache::IzeneCache<
+        key_type,
+        bitset_entry_type,
+        izenelib::util::ReadWriteLock,
+        izenelib::cache::RDE_HASH,
+        izenelib::cache::LRLFU
+    > bitset_cache_type;
+
     cache_type cache_;
+
+    bitset_cache_type bitsetCache_;
+
+    const bool isBitsetCached_;
+
+    const double minCost_;
+
+    boost::atomic<uint64_t> generation_;
 };
 
 } // namespace sf1r
@@ -178,6 +178,13 @@ void FuzzySearchRanker::rankByPropValue(
         scoreItemQueue.reset(new ScoreSortedHitQueue(count));
     }
 
+    std::vector<double> customScores;
+    if (customRanker)
+    {
+        customScores.resize(count);
+        customRanker->evaluate(&docid_list[0], count, &customScores[0]);
+    }
+
     ScoreDoc tmpdoc;
     for (size_t i = 0; i < count; ++i)
     {
@@ -186,7 +193,7 @@ void FuzzySearchRanker::rankByPropValue(
 
         if (customRanker)
         {
-            tmpdoc.custom_score = customRanker->evaluate(tmpdoc.docId);
+            tmpdoc.custom_score = customScores[i];
         }
 
         if (geoLocationRanker)
@@ -203,5 +203,6 @@ GeoHashNeighbors GeoHashEncoder::GetNeighborsGridsByScope(double longitude,
 	assert(length >= 1 && length <= 9);
 	//calculate neighbor grids by the given latitude and longitude
 	neighbor_grids = GetNeighborsGrids(longitude, latitude, length);
+	return neighbor_grids;
 }
 }
@@ -0,0 +1,171 @@
+#include "HitQueue.h"
+#include "LoserTree.h"
+
+#include <algorithm>
+
+namespace
+{
+using namespace sf1r;
+
+/**
+ * pop all docs from @p queue into @p docs, from the best to the worst.
+ */
+template <typename QueueT>
+void popAll(QueueT& queue, std::vector<ScoreDoc>& docs)
+{
+    const std::size_t count = queue.size();
+    docs.resize(count);
+
+    // PriorityQueue::pop() always gets the current worst doc
+    for (std::size_t i = count; i > 0; --i)
+    {
+        docs[i-1] = queue.pop();
+    }
+}
+
+struct RunCursor
+{
+    const SortedHitRun* run;
+    std::size_t pos;
+};
+
+class ScoreBefore
+{
+public:
+    explicit ScoreBefore(const std::vector<RunCursor>& cursors)
+        : cursors_(cursors)
+    {}
+
+    bool operator()(std::size_t i, std::size_t j) const
+    {
+        const RunCursor& ci = cursors_[i];
+        const RunCursor& cj = cursors_[j];
+
+        return ScoreSortedHitQueue::lessThan(cj.run->docs[cj.pos],
+                                             ci.run->docs[ci.pos]);
+    }
+
+private:
+    const std::vector<RunCursor>& cursors_;
+};
+
+class PropertyBefore
+{
+public:
+    PropertyBefore(const std::vector<RunCursor>& cursors, const Sorter& sorter)
+        : cursors_(cursors)
+        , sorter_(sorter)
+        , keyNum_(sorter.getSortKeyNum())
+    {}
+
+    bool operator()(std::size_t i, std::size_t j) const
+    {
+        const RunCursor& ci = cursors_[i];
+        const RunCursor& cj = cursors_[j];
+
+        return sorter_.lessThan(cj.run->docs[cj.pos], &cj.run->keys[cj.pos * keyNum_],
+                                ci.run->docs[ci.pos], &ci.run->keys[ci.pos * keyNum_]);
+    }
+
+private:
+    const std::vector<RunCursor>& cursors_;
+    const Sorter& sorter_;
+    const std::size_t keyNum_;
+};
+
+template <typename Before>
+void mergeRuns(
+    std::vector<RunCursor>& cursors,
+    const Before& before,
+    std::size_t limit,
+    std::vector<ScoreDoc>& result)
+{
+    LoserTree<Before> loserTree(cursors.size(), before);
+    std::size_t total = 0;
+
+    for (std::size_t i = 0; i < cursors.size(); ++i)
+    {
+        const std::size_t runSize = cursors[i].run->docs.size();
+        if (runSize == 0)
+        {
+            loserTree.setExhausted(i);
+        }
+        total += runSize;
+    }
+    loserTree.build();
+
+    result.clear();
+    result.reserve(std::min(total, limit));
+
+    const std::size_t runNum = cursors.size();
+    for (std::size_t w = loserTree.winner();
+         w != runNum && result.size() < limit;
+         w = loserTree.winner())
+    {
+        RunCursor& cursor = cursors[w];
+        result.push_back(cursor.run->docs[cursor.pos]);
+
+        ++cursor.pos;
+        loserTree.replay(cursor.pos == cursor.run->docs.size());
+    }
+}
+
+void initCursors(
+    const std::vector<SortedHitRun>& runs,
+    std::vector<RunCursor>& cursors)
+{
+    cursors.resize(runs.size());
+    for (std::size_t i = 0; i < runs.size(); ++i)
+    {
+        cursors[i].run = &runs[i];
+        cursors[i].pos = 0;
+    }
+}
+
+}
+
+namespace sf1r
+{
+
+void ScoreSortedHitQueue::getSortedRun(SortedHitRun& run)
+{
+    popAll(queue_, run.docs);
+    run.keys.clear();
+}
+
+void ScoreSortedHitQueue::mergeSortedRuns(
+    const std::vector<SortedHitRun>& runs,
+    std::size_t limit,
+    std::vector<ScoreDoc>& result)
+{
+    std::vector<RunCursor> cursors;
+    initCursors(runs, cursors);
+
+    mergeRuns(cursors, ScoreBefore(cursors), limit, result);
+}
+
+void PropertySortedHitQueue::getSortedRun(SortedHitRun& run)
+{
+    popAll(queue_, run.docs);
+
+    const std::size_t keyNum = pSorter_->getSortKeyNum();
+    run.keys.resize(run.docs.size() * keyNum);
+
+    for (std::size_t i = 0; i < run.docs.size(); ++i)
+    {
+        pSorter_->getSortKeys(run.docs[i], &run.keys[i * keyNum]);
+    }
+}
+
+void PropertySortedHitQueue::mergeSortedRuns(
+    const std::vector<SortedHitRun>& runs,
+    std::size_t limit,
+    std::vector<ScoreDoc>& result)
+{
+    std::vector<RunCursor> cursors;
+    initCursors(runs, cursors);
+
+    mergeRuns(cursors, PropertyBefore(cursors, *pSorter_), limit, result);
+}
+
+}
@@ -13,14 +13,44 @@
 #include "Sorter.h"
 #include <util/PriorityQueue.h>
 
+#include <vector>
+
 
 namespace sf1r
 {
 
+/**
+ * the docs popped from one HitQueue, sorted from the best one to the worst one.
+ */
+struct SortedHitRun
+{
+    std::vector<ScoreDoc> docs;
+
+    /// the precomputed sort keys, Sorter::getSortKeyNum() keys for each doc,
+    /// it is only used by PropertySortedHitQueue.
+    std::vector<double> keys;
+};
+
 class HitQueue
 {
 public:
     virtual ~HitQueue() {}
+
+    /**
+     * pop all the docs into @p run, the queue would be empty after this call.
+     */
+    virtual void getSortedRun(SortedHitRun& run) = 0;
+
+    /**
+     * merge the runs got from @c getSortedRun() of the queues with the
+     * same sort order into @p result, from the best doc to the worst one.
+     * @param limit the merge stops after @p limit docs are output
+     */
+    virtual void mergeSortedRuns(
+        const std::vector<SortedHitRun>& runs,
+        std::size_t limit,
+        std::vector<ScoreDoc>& result) = 0;
+
     virtual bool insert(ScoreDoc doc) = 0;
     virtual ScoreDoc pop() = 0;
     virtual ScoreDoc top() = 0;
@@ -42,11 +72,7 @@ class ScoreSortedHitQueue : public HitQueue
     protected:
         bool lessThan(const ScoreDoc& o1, const ScoreDoc& o2) const
         {
-            if (std::fabs(o1.score - o2.score) < std::numeric_limits<score_t>::epsilon())
-            {
-                return o1.docId < o2.docId;
-            }
-            return (o1.score < o2.score);
+            return ScoreSortedHitQueue::lessThan(o1, o2);
         }
     };
 
@@ -57,6 +83,22 @@ public:
 
     ~ScoreSortedHitQueue() {}
 
+    static bool lessThan(const ScoreDoc& o1, const ScoreDoc& o2)
+    {
+        if (std::fabs(o1.score - o2.score) < std::numeric_limits<score_t>::epsilon())
+        {
+            return o1.docId < o2.docId;
+        }
+        return (o1.score < o2.score);
+    }
+
+    void getSortedRun(SortedHitRun& run);
+
+    void mergeSortedRuns(
+        const std::vector<SortedHitRun>& runs,
+        std::size_t limit,
+        std::vector<ScoreDoc>& result);
+
     bool insert(ScoreDoc doc)
     {
         return queue_.insert(doc);
@@ -120,11 +162,23 @@ public:
         size_t size,
         PropSharedLockSet& propSharedLockSet)
         : queue_(pSorter, size, propSharedLockSet)
+        , pSorter_(pSorter)
     {
     }
 
     ~PropertySortedHitQueue() {}
 
+    /**
+     * besides the docs, the sort keys of each doc are also precomputed into
+     * @p run, so that the property tables are read only once for each doc.
+     */
+    void getSortedRun(SortedHitRun& run);
+
+    void mergeSortedRuns(
+        const std::vector<SortedHitRun>& runs,
+        std::size_t limit,
+        std::vector<ScoreDoc>& result);
+
     bool insert(ScoreDoc doc)
     {
         return queue_.insert(doc);
@@ -154,6 +208,8 @@ public:
 
 private:
     Queue_ queue_;
+
+    boost::shared_ptr<Sorter> pSorter_;
 };
 
 }
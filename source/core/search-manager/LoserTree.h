@@ -0,0 +1,139 @@
+/**
+ * @file LoserTree.h
+ * @brief a loser tree (tournament tree) used to merge k sorted runs.
+ * @date Created 2013-07-02
+ *
+ * Each leaf is the current head of one run, each internal node keeps the
+ * loser of the match played there, and the overall winner is kept at
+ * node 0. After the winner's run moves to its next element, only the
+ * log(k) matches on the path from its leaf to the root are replayed.
+ */
+
+#ifndef SF1R_LOSER_TREE_H
+#define SF1R_LOSER_TREE_H
+
+#include <vector>
+#include <algorithm> // std::swap
+#include <cstddef>
+
+namespace sf1r
+{
+
+/**
+ * @p Before is a functor, @c before(i, j) returns true if the current head
+ * of run i should be output before the current head of run j.
+ */
+template <typename Before>
+class LoserTree
+{
+public:
+    LoserTree(std::size_t runNum, const Before& before)
+        : runNum_(runNum)
+        , before_(before)
+        , tree_(runNum > 0 ? runNum : 1, runNum)
+        , exhausted_(runNum, false)
+    {}
+
+    /**
+     * mark run @p i as having no element, it should be called before
+     * @c build() for the runs which are empty from the beginning.
+     */
+    void setExhausted(std::size_t i)
+    {
+        exhausted_[i] = true;
+    }
+
+    /**
+     * play all the matches, it should be called once before @c winner().
+     */
+    void build()
+    {
+        if (runNum_ > 0)
+        {
+            tree_[0] = build_(1);
+        }
+    }
+
+    /**
+     * @return the run whose head should be output next,
+     *         or the run count if all runs are exhausted.
+     */
+    std::size_t winner() const
+    {
+        std::size_t w = tree_[0];
+        if (w >= runNum_ || exhausted_[w])
+            return runNum_;
+
+        return w;
+    }
+
+    /**
+     * after the head of the winner run is consumed, replay its matches.
+     * @param isExhausted true if the winner run has no more elements
+     */
+    void replay(bool isExhausted)
+    {
+        std::size_t w = tree_[0];
+        if (w >= runNum_)
+            return;
+
+        exhausted_[w] = isExhausted;
+
+        for (std::size_t node = (w + runNum_) / 2; node > 0; node /= 2)
+        {
+            if (wins_(tree_[node], w))
+            {
+                std::swap(tree_[node], w);
+            }
+        }
+        tree_[0] = w;
+    }
+
+private:
+    /**
+     * the nodes are numbered as a complete binary tree, internal nodes
+     * are [1, runNum_), leaves are [runNum_, 2*runNum_).
+     * @return the winner of the subtree rooted at @p node
+     */
+    std::size_t build_(std::size_t node)
+    {
+        if (node >= runNum_)
+            return node - runNum_;
+
+        std::size_t left = build_(2 * node);
+        std::size_t right = build_(2 * node + 1);
+
+        if (wins_(left, right))
+        {
+            tree_[node] = right;
+            return left;
+        }
+
+        tree_[node] = left;
+        return right;
+    }
+
+    bool wins_(std::size_t i, std::size_t j)
+    {
+        if (exhausted_[i])
+            return false;
+
+        if (exhausted_[j])
+            return true;
+
+        return before_(i, j);
+    }
+
+private:
+    const std::size_t runNum_;
+
+    Before before_;
+
+    std::vector<std::size_t> tree_;
+
+    std::vector<bool> exhausted_;
+};
+
+} // namespace sf1r
+
+#endif // SF1R_LOSER_TREE_H
@@ -96,3 +96,30 @@ void MultiPropertyScorer::initThreshold(float threshold)
     }
 
 }
+
+void MultiPropertyScorer::setThreshold(float threshold)
+{
+    const size_t numProperties = docIteratorList_.size();
+    float sumUB = 0.0F;
+    for (size_t i = 0; i < numProperties; ++i)
+    {
+        if (docIteratorList_[i])
+        {
+            sumUB += propertyWeightList_[i] * docIteratorList_[i]->getUB();
+        }
+    }
+
+    for (size_t i = 0; i < numProperties; ++i)
+    {
+        DocumentIterator* pEntry = docIteratorList_[i];
+        double weight = propertyWeightList_[i];
+        if (!pEntry || weight <= 0.0F)
+            continue;
+
+        float residual = threshold - (sumUB - weight * pEntry->getUB());
+        if (residual > 0.0F)
+        {
+            pEntry->setThreshold(residual / weight);
+        }
+    }
+}
@@ -84,6 +84,13 @@ public:
 
     void initThreshold(float threshold);
 
+    /**
+     * feed the minimum score of a full top-K heap back into each property,
+     * a property iterator could skip the docs whose weighted upper bound
+     * plus the upper bounds of all other properties is below @p threshold.
+     */
+    void setThreshold(float threshold);
+
     /**
      * @warn not thread-safe, use multiple instances in multiple threads.
      */
@@ -317,6 +317,16 @@ void ORDocumentIterator:: setUB(bool useOriginalQuery, UpperBoundInProperties& u
     //LOG(INFO)<<"====OR::getUB===>>"<<getUB();
 }
 
+void ORDocumentIterator::setBlockUB(const TermUBCalculatorInProperties& ubCalculators)
+{
+    std::vector<DocumentIterator*>::iterator it = docIteratorList_.begin();
+    for (; it != docIteratorList_.end(); it++)
+    {
+        if (*it)
+            (*it)->setBlockUB(ubCalculators);
+    }
+}
+
 float ORDocumentIterator::getUB()
 {
     float minUB = std::numeric_limits<float>::max();
@@ -332,6 +342,40 @@ float ORDocumentIterator::getUB()
     return minUB / (1 - missRate_);
 }
 
+void ORDocumentIterator::setThreshold(float threshold)
+{
+    float sumUB = 0.0F;
+    std::vector<DocumentIterator*>::iterator it = docIteratorList_.begin();
+    for (; it != docIteratorList_.end(); ++it)
+    {
+        if (*it)
+            sumUB += (*it)->getUB();
+    }
+
+    for (it = docIteratorList_.begin(); it != docIteratorList_.end(); ++it)
+    {
+        DocumentIterator* pEntry = (*it);
+        if (!pEntry)
+            continue;
+
+        float residual = threshold - (sumUB - pEntry->getUB());
+        if (residual > 0.0F)
+            pEntry->setThreshold(residual);
+    }
+}
+
+count_t ORDocumentIterator::getPrunedCount()
+{
+    count_t prunedCount = 0;
+    std::vector<DocumentIterator*>::iterator it = docIteratorList_.begin();
+    for (; it != docIteratorList_.end(); ++it)
+    {
+        if (*it)
+            prunedCount += (*it)->getPrunedCount();
+    }
+    return prunedCount;
+}
+
 count_t ORDocumentIterator::tf()
 {
     DocumentIterator* pEntry;
@@ -84,6 +84,16 @@ public:
     
     float getUB();
 
+    void setBlockUB(const TermUBCalculatorInProperties& ubCalculators);
+
+    /**
+     * for each child, pass down the part of @p threshold which could not
+     * be covered by the upper bounds of all the other children.
+     */
+    void setThreshold(float threshold);
+
+    count_t getPrunedCount();
+
     const char* getProperty()
     {
         if (docIteratorList_.begin() == docIteratorList_.end())
@@ -13,12 +13,16 @@
 #include "PersonalSearchDocumentIterator.h"
 #include "VirtualTermDocumentIterator.h"
 #include "FilterCache.h"
+#include "BlockMaxCache.h"
+#include "BlockMaxWANDDocumentIterator.h"
+#include "ColumnScanFilter.h"
 
 #include <common/TermTypeDetector.h>
 
 #include <ir/index_manager/utility/Bitset.h>
 
 #include <util/get.h>
+#include <util/ClockTimer.h>
 
 #include <vector>
 #include <string>
@@ -26,6 +30,7 @@
 #include <algorithm>
 
 #include <boost/token_iterator.hpp>
+#include <boost/bind.hpp>
 #include <boost/scoped_ptr.hpp>
 
 //#define VERBOSE_SERACH_MANAGER 1
@@ -35,6 +40,25 @@ using namespace std;
 using izenelib::ir::indexmanager::TermDocFreqs;
 using izenelib::ir::indexmanager::TermReader;
 
+namespace
+{
+/// the number of terms whose block max postings are cached
+const unsigned kBlockMaxCacheNum = 10000;
+
+/// the max number of terms waiting to build their block max postings
+const std::size_t kBlockMaxPendingNum = 1000;
+
+/// a numeric range filter matching at least this ratio of docs is
+/// evaluated by column scan, as the BTree path would visit too many docs
+const double kColumnScanMinSelectivity = 0.01;
+
+/// the filter bitmaps built within this seconds are not cached
+const double kFilterCacheMinCost = 0.0002;
+
+/// the number of decompressed filter bitsets cached
+const unsigned kFilterBitsetCacheNum = 16;
+}
+
 namespace sf1r
 {
 
@@ -42,114 +66,288 @@ QueryBuilder::QueryBuilder(
     const boost::shared_ptr<DocumentManager> documentManager,
     const boost::shared_ptr<InvertedIndexManager> indexManager,
     const schema_map& schemaMap,
-    size_t filterCacheNum
+    size_t filterCacheNum,
+    bool enableBlockMaxWAND
 )
     :documentManagerPtr_(documentManager)
     ,indexManagerPtr_(indexManager)
     ,schemaMap_(schemaMap)
-    ,filterCache_(new FilterCache(filterCacheNum))
+    ,filterCache_(new FilterCache(filterCacheNum, kFilterCacheMinCost, kFilterBitsetCacheNum))
+    ,columnScanFilter_(new ColumnScanFilter(documentManager))
 {
     if (indexManager)
         pIndexReader_ = (indexManager->pIndexReader_);
+
+    if (enableBlockMaxWAND)
+        blockMaxCache_.reset(new BlockMaxCache(kBlockMaxCacheNum, kBlockMaxPendingNum));
 }
 
 QueryBuilder::~QueryBuilder()
 {
+    // stop building the postings, which reads the index
+    blockMaxCache_.reset();
 }
 
 void QueryBuilder::reset_cache()
 {
-    filterCache_->clear();
+    filterCache_->nextGeneration();
+
+    if (blockMaxCache_)
+        blockMaxCache_->clear();
 }
 
-bool QueryBuilder::do_process_filtertree(
-    const ConditionsNode& conditionsTree_,
-    boost::shared_ptr<InvertedIndexManager::FilterBitmapT>& pFilterBitmap)
+void QueryBuilder::prepare_block_max_(
+    WANDDocumentIterator* pWandIterator,
+    collectionid_t colID,
+    const std::string& property)
 {
-    if (conditionsTree_.conditionLeafList_.size() == 1 
-            && conditionsTree_.conditionsNodeList_.size() == 0)
+    const docid_t maxDocId = pIndexReader_->maxDoc();
+
+    const std::vector<DocumentIterator*>& docIterList = pWandIterator->getDocIteratorList();
+    for (std::vector<DocumentIterator*>::const_iterator it = docIterList.begin();
+            it != docIterList.end(); ++it)
     {
-        if (!filterCache_->get(conditionsTree_.conditionLeafList_[0], pFilterBitmap))
+        TermDocumentIterator* pTermIterator = dynamic_cast<TermDocumentIterator*>(*it);
+        if (!pTermIterator)
+            continue;
+
+        termid_t termId = pTermIterator->termId();
+        const BlockMaxCache::key_type key = BlockMaxCache::makeKey(property, termId, maxDocId);
+        BlockMaxCache::value_type blockMaxPosting;
+
+        if (blockMaxCache_->get(key, blockMaxPosting))
+        {
+            pTermIterator->setBlockMaxPosting(blockMaxPosting);
+        }
+        else
         {
-            pFilterBitmap.reset(new InvertedIndexManager::FilterBitmapT);
+            // the term is traversed with its upper bound in this query
+            blockMaxCache_->buildLater(key,
+                boost::bind(&QueryBuilder::build_block_max_, this, colID, property, termId));
+        }
+    }
+}
+
+BlockMaxPostingPtr QueryBuilder::build_block_max_(
+    collectionid_t colID,
+    const std::string& property,
+    termid_t termId)
+{
+    boost::shared_ptr<BlockMaxPosting> pPosting(new BlockMaxPosting);
 
-            QueryFiltering::FilteringOperation filterOperation = conditionsTree_.conditionLeafList_[0].operation_;
-            const std::string& property = conditionsTree_.conditionLeafList_[0].property_;
-            const std::vector<PropertyValue>& filterParam = conditionsTree_.conditionLeafList_[0].values_;
+    boost::scoped_ptr<TermReader> pTermReader(pIndexReader_->getTermReader(colID));
+    if (!pTermReader)
+        return pPosting;
 
-            indexManagerPtr_->makeRangeQuery(filterOperation, property, filterParam, pFilterBitmap);
+    Term term(property.c_str(), termId);
+    if (!pTermReader->seek(&term))
+        return pPosting;
 
-            filterCache_->set(conditionsTree_.conditionLeafList_[0], pFilterBitmap);
-        }
-        return true;
+    boost::scoped_ptr<TermDocFreqs> pTermDocReader(pTermReader->termDocFreqs());
+    if (pTermDocReader)
+    {
+        pPosting->build(pTermDocReader.get());
     }
-    /// not leaf node;
-    std::string relation = conditionsTree_.relation_;
-    std::vector<boost::shared_ptr<InvertedIndexManager::FilterBitmapT> > filterBitmapTList1;
-    filterBitmapTList1.resize(conditionsTree_.conditionLeafList_.size());
-    for (unsigned int i = 0; i < conditionsTree_.conditionLeafList_.size(); ++i)
+
+    return pPosting;
+}
+
+void QueryBuilder::do_process_filter_leaf_(
+    const QueryFiltering::FilteringType& filteringItem,
+    boost::shared_ptr<InvertedIndexManager::FilterBitmapT>& pFilterBitmap)
+{
+    const FilterCache::key_type key = FilterCache::makeKey(filteringItem);
+    if (filterCache_->get(key, pFilterBitmap))
+        return;
+
+    izenelib::util::ClockTimer timer;
+    pFilterBitmap.reset(new InvertedIndexManager::FilterBitmapT);
+
+    // the BTree path costs in proportion to the docs matched, while the
+    // column scan costs in proportion to the docs in the column
+    double selectivity = 0;
+    bool isColumnScan = columnScanFilter_->estimateSelectivity(filteringItem, selectivity) &&
+                        selectivity >= kColumnScanMinSelectivity &&
+                        columnScanFilter_->makeRangeQuery(filteringItem, *pFilterBitmap);
+
+    if (!isColumnScan)
     {
-        if (!filterCache_->get(conditionsTree_.conditionLeafList_[i], filterBitmapTList1[i]))
-        {
-            filterBitmapTList1[i].reset(new InvertedIndexManager::FilterBitmapT);
+        indexManagerPtr_->makeRangeQuery(filteringItem.operation_,
+                                         filteringItem.property_,
+                                         filteringItem.values_,
+                                         pFilterBitmap);
+    }
 
-            QueryFiltering::FilteringOperation filterOperation = conditionsTree_.conditionLeafList_[i].operation_;
-            const std::string& property = conditionsTree_.conditionLeafList_[i].property_;
-            const std::vector<PropertyValue>& filterParam = conditionsTree_.conditionLeafList_[i].values_;
+    filterCache_->set(key, pFilterBitmap, timer.elapsed());
+}
 
-            indexManagerPtr_->makeRangeQuery(filterOperation, property, filterParam, filterBitmapTList1[i]);
+struct QueryBuilder::FilterChild_
+{
+    /// either leaf or node is not NULL
+    const QueryFiltering::FilteringType* leaf;
+    const ConditionsNode* node;
 
-            filterCache_->set(conditionsTree_.conditionLeafList_[i], filterBitmapTList1[i]);
-        }
+    /// the estimated number of docs matched
+    double cardinality;
+
+    boost::shared_ptr<InvertedIndexManager::FilterBitmapT> bitmap;
+
+    FilterChild_() : leaf(NULL), node(NULL), cardinality(0) {}
+
+    bool operator<(const FilterChild_& other) const
+    {
+        return cardinality < other.cardinality;
     }
+};
+
+double QueryBuilder::estimate_filter_leaf_(
+    const QueryFiltering::FilteringType& filteringItem,
+    double docNum,
+    boost::shared_ptr<InvertedIndexManager::FilterBitmapT>& pFilterBitmap)
+{
+    if (filterCache_->get(FilterCache::makeKey(filteringItem), pFilterBitmap))
+        return pFilterBitmap->numberOfOnes();
+
+    double selectivity = 0;
+    if (columnScanFilter_->estimateSelectivity(filteringItem, selectivity))
+        return selectivity * docNum;
+
+    // unknown, it is evaluated after the others in AND node
+    return docNum;
+}
+
+double QueryBuilder::estimate_filter_node_(
+    const ConditionsNode& conditionsTree_,
+    double docNum)
+{
+    boost::shared_ptr<InvertedIndexManager::FilterBitmapT> pBitmap;
+    if (filterCache_->get(FilterCache::makeKey(conditionsTree_), pBitmap))
+        return pBitmap->numberOfOnes();
+
+    const bool isAnd = (conditionsTree_.relation_ == "and");
+    double result = isAnd ? docNum : 0;
 
-    std::vector<boost::shared_ptr<InvertedIndexManager::FilterBitmapT> > filterBitmapTList2;
-    filterBitmapTList2.resize(conditionsTree_.conditionsNodeList_.size());
-    for (unsigned int j = 0; j < conditionsTree_.conditionsNodeList_.size(); ++j)
+    for (std::size_t i = 0; i < conditionsTree_.conditionLeafList_.size(); ++i)
     {
-        if (!do_process_filtertree(conditionsTree_.conditionsNodeList_[j], filterBitmapTList2[j]))
-            return false;
+        double c = estimate_filter_leaf_(conditionsTree_.conditionLeafList_[i], docNum, pBitmap);
+        result = isAnd ? std::min(result, c) : result + c;
+    }
+
+    for (std::size_t j = 0; j < conditionsTree_.conditionsNodeList_.size(); ++j)
+    {
+        double c = estimate_filter_node_(conditionsTree_.conditionsNodeList_[j], docNum);
+        result = isAnd ? std::min(result, c) : result + c;
     }
 
+    return std::min(result, docNum);
+}
+
+bool QueryBuilder::do_process_filtertree(
+    const ConditionsNode& conditionsTree_,
+    boost::shared_ptr<InvertedIndexManager::FilterBitmapT>& pFilterBitmap)
+{
+    if (conditionsTree_.conditionLeafList_.size() == 1 
+            && conditionsTree_.conditionsNodeList_.size() == 0)
+    {
+        do_process_filter_leaf_(conditionsTree_.conditionLeafList_[0], pFilterBitmap);
+        return true;
+    }
+    /// not leaf node;
+    const std::string& relation = conditionsTree_.relation_;
+    if (relation != "and" && relation != "or")
+    {
+        pFilterBitmap.reset(new InvertedIndexManager::FilterBitmapT);
+        return true;
+    }
+
+    // the whole subtree is cached, as the same combination of filters
+    // is often repeated in faceted navigation
+    const FilterCache::key_type key = FilterCache::makeKey(conditionsTree_);
+    if (filterCache_->get(key, pFilterBitmap))
+        return true;
+
+    izenelib::util::ClockTimer timer;
+    const bool isAnd = (relation == "and");
     const unsigned int bitsNum = documentManagerPtr_->getMaxDocId() + 1;
     const unsigned int wordBitNum = sizeof(InvertedIndexManager::FilterWordT) << 3;
     const unsigned int wordsNum = (bitsNum - 1) / wordBitNum + 1;
 
-    pFilterBitmap.reset(new InvertedIndexManager::FilterBitmapT);
-    
-    boost::shared_ptr<InvertedIndexManager::FilterBitmapT> dest;
-    if (relation == "and")
+    std::vector<FilterChild_> children(conditionsTree_.conditionLeafList_.size() +
+                                       conditionsTree_.conditionsNodeList_.size());
+    std::size_t childId = 0;
+    for (unsigned int i = 0; i < conditionsTree_.conditionLeafList_.size(); ++i, ++childId)
+    {
+        FilterChild_& child = children[childId];
+        child.leaf = &conditionsTree_.conditionLeafList_[i];
+        child.cardinality = estimate_filter_leaf_(*child.leaf, bitsNum, child.bitmap);
+    }
+    for (unsigned int j = 0; j < conditionsTree_.conditionsNodeList_.size(); ++j, ++childId)
+    {
+        FilterChild_& child = children[childId];
+        child.node = &conditionsTree_.conditionsNodeList_[j];
+        child.cardinality = estimate_filter_node_(*child.node, bitsNum);
+    }
+
+    if (children.empty())
+    {
+        pFilterBitmap.reset(new InvertedIndexManager::FilterBitmapT);
+        pFilterBitmap->addStreamOfEmptyWords(isAnd, wordsNum);
+        return true;
+    }
+
+    // for AND, the smallest child is intersected first, so that the
+    // intermediate result is kept small and it could be empty earlier.
+    std::stable_sort(children.begin(), children.end());
+
+    // the intermediate results are written to two buffers in turn,
+    // instead of allocating a new bitmap for each child
+    boost::shared_ptr<InvertedIndexManager::FilterBitmapT> result;
+    boost::shared_ptr<InvertedIndexManager::FilterBitmapT> buffer1(new InvertedIndexManager::FilterBitmapT);
+    boost::shared_ptr<InvertedIndexManager::FilterBitmapT> buffer2(new InvertedIndexManager::FilterBitmapT);
+
+    for (std::size_t k = 0; k < children.size(); ++k)
     {
-        pFilterBitmap->addStreamOfEmptyWords(true, wordsNum);
-        for (unsigned int k = 0; k < filterBitmapTList1.size(); ++k)
+        FilterChild_& child = children[k];
+        if (!child.bitmap)
         {
-            dest.reset(new InvertedIndexManager::FilterBitmapT);
-            pFilterBitmap->logicaland(*(filterBitmapTList1[k]), *dest);
-            (*pFilterBitmap).swap(*dest);
+            if (child.leaf)
+            {
+                do_process_filter_leaf_(*child.leaf, child.bitmap);
+            }
+            else if (!do_process_filtertree(*child.node, child.bitmap))
+            {
+                return false;
+            }
         }
-        for (unsigned int k = 0; k < filterBitmapTList2.size(); ++k)
+
+        if (!result)
         {
-            dest.reset(new InvertedIndexManager::FilterBitmapT);
-            pFilterBitmap->logicaland(*(filterBitmapTList2[k]), *dest);
-            (*pFilterBitmap).swap(*dest);
+            // the child bitmap is shared, it would not be modified
+            result = child.bitmap;
         }
-    }
-    else if (relation == "or")
-    {
-        pFilterBitmap->addStreamOfEmptyWords(false, wordsNum);
-        for (unsigned int k = 0; k < filterBitmapTList1.size(); ++k)
+        else
         {
-            dest.reset(new InvertedIndexManager::FilterBitmapT);
-            pFilterBitmap->logicalor(*(filterBitmapTList1[k]), *dest);
-            (*pFilterBitmap).swap(*dest);
+            boost::shared_ptr<InvertedIndexManager::FilterBitmapT>& dest =
+                (result == buffer1) ? buffer2 : buffer1;
+            dest->reset();
+
+            if (isAnd)
+                result->logicaland(*child.bitmap, *dest);
+            else
+                result->logicalor(*child.bitmap, *dest);
+
+            result = dest;
         }
-        for (unsigned int k = 0; k < filterBitmapTList2.size(); ++k)
+
+        if (isAnd && k + 1 < children.size() && result->numberOfOnes() == 0)
         {
-            dest.reset(new InvertedIndexManager::FilterBitmapT);
-            pFilterBitmap->logicalor(*(filterBitmapTList2[k]), *dest);
-            (*pFilterBitmap).swap(*dest);
+            // the remaining children are not evaluated at all
+            break;
         }
     }
+
+    pFilterBitmap = result;
+    filterCache_->set(key, pFilterBitmap, timer.elapsed());
     return true;
 }
 
@@ -159,6 +357,27 @@ bool QueryBuilder::prepare_filter(
 {
     return do_process_filtertree(conditionsTree_, pFilterBitmapx);
 }
+
+bool QueryBuilder::prepare_filter_bitset(
+        const ConditionsNode& conditionsTree,
+        boost::shared_ptr<izenelib::ir::indexmanager::Bitset>& pFilterBitset)
+{
+    const FilterCache::key_type key = FilterCache::makeKey(conditionsTree);
+    if (filterCache_->getBitset(key, pFilterBitset))
+        return true;
+
+    boost::shared_ptr<InvertedIndexManager::FilterBitmapT> pFilterBitmap;
+    if (!do_process_filtertree(conditionsTree, pFilterBitmap) || !pFilterBitmap)
+        return false;
+
+    boost::shared_ptr<izenelib::ir::indexmanager::Bitset> pBitset(
+        new izenelib::ir::indexmanager::Bitset);
+    pBitset->decompress(*pFilterBitmap);
+    filterCache_->setBitset(key, pBitset);
+
+    pFilterBitset = pBitset;
+    return true;
+}
 /*
 void QueryBuilder::do_process_node(
     QueryFiltering::FilteringTreeValue &filteringTreeRules
@@ -479,14 +698,16 @@ void QueryBuilder::prefetch_term_doc_readers_(
                 std::vector<PropertyValue> filterParam;
                 filterParam.push_back(TermTypeDetector::propertyValue_);
                 filteringRule.values_ = filterParam;
-                if(!filterCache_->get(filteringRule, pFilterBitmap))
+                const FilterCache::key_type key = FilterCache::makeKey(filteringRule);
+                if(!filterCache_->get(key, pFilterBitmap))
                 {
+                    izenelib::util::ClockTimer timer;
                     pFilterBitmap.reset(new InvertedIndexManager::FilterBitmapT);
                     pBitset.reset(new Bitset(pIndexReader_->maxDoc() + 1));
 
                     indexManagerPtr_->getDocsByNumericValue(colID, property, value, *pBitset);
                     pBitset->compress(*pFilterBitmap);
-                    filterCache_->set(filteringRule, pFilterBitmap);
+                    filterCache_->set(key, pFilterBitmap, timer.elapsed());
                 }
                 TermDocFreqs* pTermDocReader = new InvertedIndexManager::FilterTermDocFreqsT(pFilterBitmap);
                 termDocReaders[termId].push_back(pTermDocReader);
@@ -1449,7 +1670,12 @@ bool QueryBuilder::do_prepare_for_property_(
 #ifdef VERBOSE_SERACH_MANAGER
         cout<<"WAND query "<<property<<endl;
 #endif
-        DocumentIterator* pIterator = new WANDDocumentIterator();
+        WANDDocumentIterator* pWandIterator = NULL;
+        if (blockMaxCache_ && !isNumericFilter)
+            pWandIterator = new BlockMaxWANDDocumentIterator();
+        else
+            pWandIterator = new WANDDocumentIterator();
+        DocumentIterator* pIterator = pWandIterator;
         pIterator->setMissRate(queryTree->children_.size());
         bool ret = false;
         try
@@ -1481,6 +1707,11 @@ bool QueryBuilder::do_prepare_for_property_(
                 return false;
             }
 
+            if (blockMaxCache_ && !isNumericFilter && virtualProperty.empty())
+            {
+                prepare_block_max_(pWandIterator, colID, property);
+            }
+
             if(!virtualProperty.empty())
             {
                 if(!parentAndOrFlag)
@@ -15,7 +15,9 @@
 #include "WANDDocumentIterator.h"
 #include "VirtualPropertyScorer.h"
 #include "VirtualPropertyTermDocumentIterator.h"
+#include "BlockMaxPosting.h"
 #include <index-manager/InvertedIndexManager.h>
+#include <ir/index_manager/utility/Bitset.h>
 #include <document-manager/DocumentManager.h>
 
 #include <boost/shared_ptr.hpp>
@@ -32,6 +34,8 @@ using namespace sf1r::QueryFiltering;
 namespace sf1r
 {
 class FilterCache;
+class BlockMaxCache;
+class ColumnScanFilter;
 typedef DocumentIterator* DocumentIteratorPointer;
 class QueryBuilder
 {
@@ -45,7 +49,8 @@ public:
         const boost::shared_ptr<DocumentManager> documentManager,
         const boost::shared_ptr<InvertedIndexManager> indexManager,
         const schema_map& schemaMap,
-        size_t filterCacheNum
+        size_t filterCacheNum,
+        bool enableBlockMaxWAND = false
     );
 
     ~QueryBuilder();
@@ -90,6 +95,14 @@ public:
         const ConditionsNode& conditionsTree_,
         boost::shared_ptr<InvertedIndexManager::FilterBitmapT>& pFilterBitmapx);
 
+    /**
+     * get the filter as a decompressed bitset, which is cached and shared
+     * by the requests with the same filter, so it must not be modified.
+     */
+    bool prepare_filter_bitset(
+        const ConditionsNode& conditionsTree,
+        boost::shared_ptr<izenelib::ir::indexmanager::Bitset>& pFilterBitset);
+
 
     /*
     *@brief Generate Filter, filter will be released by the user.
@@ -205,6 +218,54 @@ private:
     bool do_process_filtertree(
         const ConditionsNode& conditionsTree_,
         boost::shared_ptr<InvertedIndexManager::FilterBitmapT>& pFilterBitmap);
+
+    struct FilterChild_;
+
+    /**
+     * estimate the number of docs matched by one filter condition,
+     * @p pFilterBitmap is set if the bitmap is already in cache.
+     */
+    double estimate_filter_leaf_(
+        const QueryFiltering::FilteringType& filteringItem,
+        double docNum,
+        boost::shared_ptr<InvertedIndexManager::FilterBitmapT>& pFilterBitmap);
+
+    /**
+     * estimate the number of docs matched by a filter subtree, it is the
+     * minimum of the children for AND, and the sum of them for OR.
+     */
+    double estimate_filter_node_(
+        const ConditionsNode& conditionsTree_,
+        double docNum);
+
+    /**
+     * get the bitmap of one filter condition from cache, if missed, choose
+     * the BTree index or the column scan according to the estimated
+     * selectivity to build the bitmap.
+     */
+    void do_process_filter_leaf_(
+        const QueryFiltering::FilteringType& filteringItem,
+        boost::shared_ptr<InvertedIndexManager::FilterBitmapT>& pFilterBitmap);
+
+    /**
+     * attach the cached block max postings to the term iterators in
+     * @p pWandIterator, the missed ones are built in background for
+     * the later queries.
+     */
+    void prepare_block_max_(
+        WANDDocumentIterator* pWandIterator,
+        collectionid_t colID,
+        const std::string& property);
+
+    /**
+     * scan the posting of @p termId to build its block max posting,
+     * it is called in the background thread of @c blockMaxCache_.
+     * @return an empty block max posting if the term is not found
+     */
+    BlockMaxPostingPtr build_block_max_(
+        collectionid_t colID,
+        const std::string& property,
+        termid_t termId);
 /*
     void do_process_node(
         QueryFiltering::FilteringTreeValue &filteringTreeRules,
@@ -221,6 +282,11 @@ private:
     const schema_map& schemaMap_;
 
     boost::scoped_ptr<FilterCache> filterCache_;
+
+    boost::scoped_ptr<ColumnScanFilter> columnScanFilter_;
+
+    /// NULL if block-max WAND is disabled
+    boost::scoped_ptr<BlockMaxCache> blockMaxCache_;
 };
 
 }
@@ -6,6 +6,9 @@ using namespace sf1r;
 namespace
 {
 const double kDefaultScore = 1.0;
+
+/// the max number of docs evaluated in one batch
+const std::size_t kBatchSize = 128;
 }
 
 ScoreDocEvaluator::ScoreDocEvaluator(
@@ -13,9 +16,11 @@ ScoreDocEvaluator::ScoreDocEvaluator(
         CustomRankerPtr customRanker,
         GeoLocationRankerPtr geoLocationRanker)
     : productScorer_(productScorer)
+    , needPrepareDoc_(productScorer && productScorer->needPrepareDoc())
     , customRanker_(customRanker)
     , geoLocationRanker_(geoLocationRanker)
 {
+    batchDocIds_.reserve(kBatchSize);
 }
 
 void ScoreDocEvaluator::evaluate(ScoreDoc& scoreDoc)
@@ -39,3 +44,57 @@ void ScoreDocEvaluator::evaluate(ScoreDoc& scoreDoc)
         scoreDoc.geo_dist = geoLocationRanker_->evaluate(scoreDoc.docId);
     }
 }
+
+bool ScoreDocEvaluator::addDoc(docid_t docId)
+{
+    if (needPrepareDoc_)
+    {
+        productScorer_->prepareDoc(docId);
+    }
+
+    batchDocIds_.push_back(docId);
+    return batchDocIds_.size() >= kBatchSize;
+}
+
+const std::vector<ScoreDoc>& ScoreDocEvaluator::evaluateBatch()
+{
+    const std::size_t num = batchDocIds_.size();
+    batchDocs_.resize(num);
+
+    if (num == 0)
+        return batchDocs_;
+
+    const docid_t* docIds = &batchDocIds_[0];
+
+    if (productScorer_)
+    {
+        productScores_.resize(num);
+        productScorer_->scoreBatch(docIds, num, &productScores_[0]);
+    }
+
+    if (customRanker_)
+    {
+        customScores_.resize(num);
+        customRanker_->evaluate(docIds, num, &customScores_[0]);
+    }
+
+    for (std::size_t i = 0; i < num; ++i)
+    {
+        ScoreDoc& scoreDoc = batchDocs_[i];
+        scoreDoc = ScoreDoc(docIds[i],
+                            productScorer_ ? productScores_[i] : kDefaultScore);
+
+        if (customRanker_)
+        {
+            scoreDoc.custom_score = customScores_[i];
+        }
+
+        if (geoLocationRanker_)
+        {
+            scoreDoc.geo_dist = geoLocationRanker_->evaluate(scoreDoc.docId);
+        }
+    }
+
+    batchDocIds_.clear();
+    return batchDocs_;
+}
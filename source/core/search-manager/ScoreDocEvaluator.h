@@ -3,6 +3,7 @@
  * @brief evaluate the score values for ScoreDoc.
  * @author Jun Jiang
  * @date Created 2012-10-25
+ * @date Updated 2013-08-01 evaluate the docs in batches.
  */
 
 #ifndef SF1R_SCORE_DOC_EVALUATOR_H
@@ -10,12 +11,13 @@
 
 #include "CustomRanker.h"
 #include "GeoLocationRanker.h"
+#include "ScoreDoc.h"
 #include <mining-manager/product-scorer/ProductScorer.h>
 #include <boost/scoped_ptr.hpp>
+#include <vector>
 
 namespace sf1r
 {
-struct ScoreDoc;
 
 class ScoreDocEvaluator
 {
@@ -27,12 +29,37 @@ public:
 
     void evaluate(ScoreDoc& scoreDoc);
 
+    /**
+     * add @p docId to the batch, it should be called while the doc
+     * iterator is on @p docId.
+     * @return true if the batch is full, then evaluateBatch() should be
+     *         called
+     */
+    bool addDoc(docid_t docId);
+
+    /**
+     * evaluate the docs added since last call, each score is evaluated
+     * for all the docs before the next one.
+     * @return the docs evaluated, in the order of being added
+     */
+    const std::vector<ScoreDoc>& evaluateBatch();
+
 private:
     boost::scoped_ptr<ProductScorer> productScorer_;
 
+    const bool needPrepareDoc_;
+
     CustomRankerPtr customRanker_;
 
     GeoLocationRankerPtr geoLocationRanker_;
+
+    std::vector<docid_t> batchDocIds_;
+
+    std::vector<score_t> productScores_;
+
+    std::vector<double> customScores_;
+
+    std::vector<ScoreDoc> batchDocs_;
 };
 
 } // namespace sf1r
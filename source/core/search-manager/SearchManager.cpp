@@ -46,6 +46,9 @@ void SearchManager::setMiningManager(
     preprocessor_.setRTypeStringPropTableBuilder(
         miningManager->GetRTypeStringPropTableBuilder());
 
+    preprocessor_.setGeoHashIndex(
+        miningManager->GetGeoHashIndex());
+
     topKReranker_.setProductRankerFactory(
         miningManager->GetProductRankerFactory());
 
@@ -9,6 +9,7 @@
 #include <ranking-manager/PropertyRanker.h>
 #include <mining-manager/product-scorer/ProductScorerFactory.h>
 #include <mining-manager/product-scorer/ProductScoreParam.h>
+#include <mining-manager/geo-index/GeoHashIndex.h>
 #include <common/SFLogger.h>
 #include <util/get.h>
 #include <util/ClockTimer.h>
@@ -26,6 +27,7 @@ SearchManagerPreProcessor::SearchManagerPreProcessor(const IndexBundleSchema& in
     : productScorerFactory_(NULL)
     , numericTableBuilder_(NULL)
     , rtypeStringPropTableBuilder_(NULL)
+    , geoHashIndex_(NULL)
 {
     for (IndexBundleSchema::const_iterator iter = indexSchema.begin();
          iter != indexSchema.end(); ++iter)
@@ -384,6 +386,72 @@ bool SearchManagerPreProcessor::isNeedCustomDocIterator(
         isProductRanking_(actionItem);
 }
 
+bool SearchManagerPreProcessor::getGeoScopeDocs(
+    const KeywordSearchActionItem& actionItem,
+    std::vector<docid_t>& docIds) const
+{
+    if (!geoHashIndex_ || actionItem.scope_ <= 0 ||
+        actionItem.geoLocationProperty_ != geoHashIndex_->propName())
+        return false;
+
+    bool isSortByGeo = false;
+    for (KeywordSearchActionItem::SortPriorityList::const_iterator it =
+             actionItem.sortPriorityList_.begin();
+         it != actionItem.sortPriorityList_.end(); ++it)
+    {
+        std::string propName = it->first;
+        boost::to_lower(propName);
+        if (propName == GEO_RANK_PROPERTY)
+        {
+            isSortByGeo = true;
+            break;
+        }
+    }
+
+    if (!isSortByGeo)
+        return false;
+
+    boost::shared_ptr<NumericPropertyTableBase> propertyTable =
+        numericTableBuilder_->createPropertyTable(actionItem.geoLocationProperty_);
+    if (!propertyTable)
+        return false;
+
+    const std::pair<double, double>& location = actionItem.geoLocation_;
+    const docid_t lastIndexDocId = geoHashIndex_->getLastDocId();
+    if (!geoHashIndex_->getDocsInRadius(location.first, location.second,
+                                        actionItem.scope_, docIds))
+        return false;
+
+    // the cells might cover the docs out of scope
+    GeoLocationRanker geoLocationRanker(actionItem.scope_, location, propertyTable);
+    NumericPropertyTableBase::ScopedReadLock lock(propertyTable->getMutex());
+
+    std::vector<docid_t>::iterator outIt = docIds.begin();
+    for (std::vector<docid_t>::iterator it = docIds.begin();
+         it != docIds.end(); ++it)
+    {
+        // the docs appended meanwhile are checked below
+        if (*it <= lastIndexDocId &&
+            geoLocationRanker.checkScope(geoLocationRanker.evaluate(*it)))
+        {
+            *outIt++ = *it;
+        }
+    }
+    docIds.erase(outIt, docIds.end());
+
+    // the docs not mined into index yet are all checked
+    const docid_t docNum = propertyTable->size(false);
+    for (docid_t docId = lastIndexDocId + 1; docId < docNum; ++docId)
+    {
+        if (geoLocationRanker.checkScope(geoLocationRanker.evaluate(docId)))
+        {
+            docIds.push_back(docId);
+        }
+    }
+
+    return true;
+}
+
 bool SearchManagerPreProcessor::isNeedRerank(
     const KeywordSearchActionItem& actionItem) const
 {
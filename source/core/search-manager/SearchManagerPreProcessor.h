@@ -28,6 +28,7 @@ class ProductScorer;
 class PropSharedLockSet;
 class NumericPropertyTableBuilder;
 class RTypeStringPropTableBuilder;
+class GeoHashIndex;
 
 class SearchManagerPreProcessor
 {
@@ -52,6 +53,11 @@ public:
         rtypeStringPropTableBuilder_ = builder;
     }
 
+    void setGeoHashIndex(const GeoHashIndex* geoHashIndex)
+    {
+        geoHashIndex_ = geoHashIndex;
+    }
+
     /**
      * @brief get data list of each sort property for documents referred by docIdList,
      * used in distributed search for merging topk results.
@@ -100,6 +106,21 @@ public:
 
     bool isNeedCustomDocIterator(const KeywordSearchActionItem& actionItem) const;
 
+    /**
+     * get the docs in the scope of geo location by the geohash index, it
+     * is used by ZambeziSearch to score only the docs nearby when sorting
+     * by "geo_rank", as the docs out of scope are removed from its result.
+     * The docs not mined into the index yet are checked one by one, while
+     * a location updated in place is moved in the index by next mining.
+     * @param docIds [OUT] the doc ids in ascending order, the docs out of
+     *        scope are excluded
+     * @return false if the geohash index could not be used for
+     *         @p actionItem, then all docs should be searched
+     */
+    bool getGeoScopeDocs(
+        const KeywordSearchActionItem& actionItem,
+        std::vector<docid_t>& docIds) const;
+
     bool isNeedRerank(const KeywordSearchActionItem& actionItem) const;
 
     /**
@@ -138,6 +159,8 @@ private:
     NumericPropertyTableBuilder* numericTableBuilder_;
 
     RTypeStringPropTableBuilder* rtypeStringPropTableBuilder_;
+
+    const GeoHashIndex* geoHashIndex_;
 };
 
 } // end of sf1r
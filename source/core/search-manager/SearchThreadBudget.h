@@ -0,0 +1,81 @@
+/**
+ * @file SearchThreadBudget.h
+ * @brief limit the total number of search threads used by concurrent
+ *        queries, so that they would not oversubscribe the cpu cores.
+ * @date Created 2013-07-08
+ */
+
+#ifndef SF1R_SEARCH_THREAD_BUDGET_H
+#define SF1R_SEARCH_THREAD_BUDGET_H
+
+#include <boost/thread/mutex.hpp>
+#include <boost/noncopyable.hpp>
+#include <algorithm>
+
+namespace sf1r
+{
+
+class SearchThreadBudget : boost::noncopyable
+{
+public:
+    explicit SearchThreadBudget(std::size_t totalThreadNum)
+        : totalThreadNum_(totalThreadNum)
+        , usedThreadNum_(0)
+    {}
+
+    /**
+     * reserve at most @p threadNum threads, the used threads would never
+     * exceed the budget.
+     * @return the number of reserved threads, 0 if the budget is used up
+     */
+    std::size_t acquire(std::size_t threadNum)
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+
+        const std::size_t idleThreadNum = totalThreadNum_ - usedThreadNum_;
+        const std::size_t reserved = std::min(threadNum, idleThreadNum);
+        usedThreadNum_ += reserved;
+        return reserved;
+    }
+
+    void release(std::size_t threadNum)
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        usedThreadNum_ -= std::min(threadNum, usedThreadNum_);
+    }
+
+private:
+    const std::size_t totalThreadNum_;
+
+    std::size_t usedThreadNum_;
+
+    boost::mutex mutex_;
+};
+
+/**
+ * the threads reserved for one query, which are released on destruction.
+ */
+class SearchThreadLease : boost::noncopyable
+{
+public:
+    SearchThreadLease(SearchThreadBudget& budget, std::size_t threadNum)
+        : budget_(budget)
+        , threadNum_(budget.acquire(threadNum))
+    {}
+
+    ~SearchThreadLease()
+    {
+        budget_.release(threadNum_);
+    }
+
+    std::size_t threadNum() const { return threadNum_; }
+
+private:
+    SearchThreadBudget& budget_;
+
+    const std::size_t threadNum_;
+};
+
+} // namespace sf1r
+
+#endif // SF1R_SEARCH_THREAD_BUDGET_H
@@ -3,6 +3,8 @@
 #include "SearchManagerPreProcessor.h"
 #include "SearchThreadParam.h"
 #include "HitQueue.h"
+#include "DocIdRangeScheduler.h"
+#include "SearchThreadBudget.h"
 
 #include <common/PropSharedLockSet.h>
 #include <query-manager/SearchKeywordOperation.h>
@@ -12,6 +14,7 @@
 
 #include <omp.h>
 #include <util/cpu_topology.h>
+#include <boost/scoped_ptr.hpp>
 
 using namespace sf1r;
 
@@ -20,6 +23,7 @@ using namespace sf1r;
 static izenelib::util::CpuTopologyT s_cpu_topology_info;
 static int s_round = 0;
 static int s_cpunum = 0;
+static boost::scoped_ptr<SearchThreadBudget> s_thread_budget;
 
 SearchThreadMaster::SearchThreadMaster(
     const IndexBundleConfiguration& config,
@@ -40,6 +44,18 @@ SearchThreadMaster::SearchThreadMaster(
             s_cpunum = 1;
         }
     }
+
+    if (!s_thread_budget)
+    {
+        s_thread_budget.reset(new SearchThreadBudget(s_cpunum));
+    }
+
+    if (isParallelEnabled_)
+    {
+        // the pool is kept for all queries instead of resizing it per query,
+        // the running threads are limited by s_thread_budget.
+        threadpool_.size_controller().resize(s_cpunum);
+    }
 }
 
 void SearchThreadMaster::prepareThreadParams(
@@ -50,7 +66,8 @@ void SearchThreadMaster::prepareThreadParams(
 {
     std::size_t threadNum = 0;
     std::size_t runningNode = 0;
-    getThreadInfo_(distSearchInfo, threadNum, runningNode);
+    boost::shared_ptr<SearchThreadLease> threadLease;
+    getThreadInfo_(distSearchInfo, threadNum, runningNode, threadLease);
 
     // in order to split the whole docid range [0, maxDocId+1) to N threads,
     // the average docs num for each thread is round_up((maxDocId+1)/N),
@@ -59,10 +76,26 @@ void SearchThreadMaster::prepareThreadParams(
     docid_t maxDocId = documentManagerPtr_->getMaxDocId();
     std::size_t averageDocNum = maxDocId/threadNum + 1;
 
-    const SearchThreadParam initParam(&actionOperation,
-                                      &distSearchInfo,
-                                      heapSize,
-                                      runningNode);
+    SearchThreadParam initParam(&actionOperation,
+                                &distSearchInfo,
+                                heapSize,
+                                runningNode);
+    initParam.threadLease = threadLease;
+
+    if (threadNum > 1)
+    {
+        // the fixed slices above are just the initial ranges,
+        // the idle threads would steal from the busy ones.
+        initParam.rangeScheduler.reset(
+            new DocIdRangeScheduler(maxDocId + 1, threadNum));
+    }
+    else if (isParallelEnabled_)
+    {
+        // only the group counters of one search thread run in parallel,
+        // instead of nesting them in the threads of one query
+        initParam.groupThreadBudget = s_thread_budget.get();
+    }
+
     threadParams.resize(threadNum, initParam);
 
     for (std::size_t i = 0; i < threadNum; ++i)
@@ -95,10 +128,17 @@ bool SearchThreadMaster::mergeThreadParams(
     std::vector<SearchThreadParam>& threadParams) const
 {
     const std::size_t threadNum = threadParams.size();
+    SearchThreadParam& masterParam = threadParams[0];
+    boost::shared_ptr<HitQueue> masterQueue(masterParam.scoreItemQueue);
+
     if (threadNum == 1)
+    {
+        SortedHitRun run;
+        masterQueue->getSortedRun(run);
+        masterParam.topKDocs.swap(run.docs);
         return true;
+    }
 
-    SearchThreadParam& masterParam = threadParams[0];
     if (!masterParam.isSuccess)
         return false;
 
@@ -108,7 +148,8 @@ bool SearchThreadMaster::mergeThreadParams(
     faceted::GroupRep& masterGroupRep = masterParam.groupRep;
     faceted::OntologyRep& masterAttrRep = masterParam.attrRep;
     std::list<const faceted::OntologyRep*> otherAttrReps;
-    boost::shared_ptr<HitQueue> masterQueue(masterParam.scoreItemQueue);
+    std::vector<SortedHitRun> runs(threadNum);
+    masterQueue->getSortedRun(runs[0]);
 
     for (std::size_t i = 1; i < threadNum; ++i)
     {
@@ -117,10 +158,8 @@ bool SearchThreadMaster::mergeThreadParams(
             return false;
 
         masterTotalCount += param.totalCount;
-        while (param.scoreItemQueue->size() > 0)
-        {
-            masterQueue->insert(param.scoreItemQueue->pop());
-        }
+        masterParam.prunedCount += param.prunedCount;
+        param.scoreItemQueue->getSortedRun(runs[i]);
 
         float lowValue = param.propertyRange.lowValue_;
         float highValue = param.propertyRange.highValue_;
@@ -144,6 +183,9 @@ bool SearchThreadMaster::mergeThreadParams(
         otherAttrReps.push_back(&param.attrRep);
     }
 
+    // only the top heapSize docs are needed, that is offset + limit
+    masterQueue->mergeSortedRuns(runs, masterParam.heapSize, masterParam.topKDocs);
+
     int& attrGroupNum = masterParam.actionOperation->actionItem_.groupParam_.attrGroupNum_;
     std::swap(attrGroupNum, masterParam.originAttrGroupNum);
     masterAttrRep.merge(attrGroupNum, otherAttrReps);
@@ -157,6 +199,7 @@ bool SearchThreadMaster::fetchSearchResult(
     KeywordSearchResult& searchResult)
 {
     std::swap(searchResult.totalCount_, threadParam.totalCount);
+    std::swap(searchResult.prunedCount_, threadParam.prunedCount);
     searchResult.groupRep_.swap(threadParam.groupRep);
     searchResult.attrRep_.swap(threadParam.attrRep);
     searchResult.propertyRange_.swap(threadParam.propertyRange);
@@ -166,14 +209,14 @@ bool SearchThreadMaster::fetchSearchResult(
     std::vector<float>& rankScoreList = searchResult.topKRankScoreList_;
     std::vector<float>& customRankScoreList = searchResult.topKCustomRankScoreList_;
     std::vector<float>& geoDistanceList = searchResult.topKGeoDistanceList_;
-    boost::shared_ptr<HitQueue> scoreItemQueue(threadParam.scoreItemQueue);
+    const std::vector<ScoreDoc>& topKDocs = threadParam.topKDocs;
     CustomRankerPtr customRanker = threadParam.customRanker;
     GeoLocationRankerPtr geoLocationRanker = threadParam.geoLocationRanker;
 
     std::size_t count = 0;
-    if (offset < scoreItemQueue->size())
+    if (offset < topKDocs.size())
     {
-        count = scoreItemQueue->size() - offset;
+        count = topKDocs.size() - offset;
     }
     docIdList.resize(count);
     rankScoreList.resize(count);
@@ -188,12 +231,9 @@ bool SearchThreadMaster::fetchSearchResult(
         geoDistanceList.resize(count);
     }
 
-    // here PriorityQueue is used to get topK elements, as PriorityQueue::pop()
-    // will always get the element with current lowest score, we need to reverse
-    // the output sequence.
-    for (int i = count-1; i >= 0; --i)
+    for (std::size_t i = 0; i < count; ++i)
     {
-        const ScoreDoc& pScoreItem = scoreItemQueue->pop();
+        const ScoreDoc& pScoreItem = topKDocs[offset + i];
         docIdList[i] = pScoreItem.docId;
         rankScoreList[i] = pScoreItem.score;
         if (customRanker)
@@ -234,7 +274,8 @@ bool SearchThreadMaster::fetchSearchResult(
 void SearchThreadMaster::getThreadInfo_(
     const DistKeywordSearchInfo& distSearchInfo,
     std::size_t& threadNum,
-    std::size_t& runningNode)
+    std::size_t& runningNode,
+    boost::shared_ptr<SearchThreadLease>& threadLease)
 {
     docid_t maxDocId = documentManagerPtr_->getMaxDocId();
     threadNum = s_cpunum;
@@ -246,16 +287,23 @@ void SearchThreadMaster::getThreadInfo_(
         threadNum = s_cpu_topology_info.cpu_topology_array[runningNode].size();
     }
 
-    if (isParallelEnabled_ && s_cpu_topology_info.cpu_topology_supported)
-    {
-        threadpool_.size_controller().resize(s_cpunum*4);
-    }
-
     if (!isParallelEnabled_ ||
         maxDocId < PARALLEL_THRESHOLD ||
         distSearchInfo.isOptionGatherInfo())
     {
         threadNum = 1;
+        return;
+    }
+
+    threadLease.reset(new SearchThreadLease(*s_thread_budget, threadNum));
+    threadNum = threadLease->threadNum();
+
+    // when the budget is nearly used up by other queries,
+    // search in the request thread instead of the thread pool
+    if (threadNum < 2)
+    {
+        threadLease.reset();
+        threadNum = 1;
     }
 }
 
@@ -281,26 +329,22 @@ bool SearchThreadMaster::runMultiThreads_(
 {
     const std::size_t threadNum = threadParams.size();
 
-    if (!s_cpu_topology_info.cpu_topology_supported)
+    boost::detail::atomic_count finishedJobs(0);
+    for (std::size_t i = 0; i < threadNum; ++i)
     {
-        boost::detail::atomic_count finishedJobs(0);
-        #pragma omp parallel for schedule(dynamic, 2)
-        for (std::size_t i = 0; i < threadNum; ++i)
-        {
-            runSearchJob_(&threadParams[i], &finishedJobs);
-        }
+        threadpool_.schedule(
+            boost::bind(&SearchThreadMaster::runSearchJob_,
+                        this, &threadParams[i], &finishedJobs));
+
     }
-    else
-    {
-        boost::detail::atomic_count finishedJobs(0);
-        for (std::size_t i = 0; i < threadNum; ++i)
-        {
-            threadpool_.schedule(
-                boost::bind(&SearchThreadMaster::runSearchJob_,
-                            this, &threadParams[i], &finishedJobs));
+    threadpool_.wait(finishedJobs, threadNum);
 
-        }
-        threadpool_.wait(finishedJobs, threadNum);
+    const DocIdRangeScheduler* rangeScheduler = threadParams[0].rangeScheduler.get();
+    if (rangeScheduler)
+    {
+        VLOG(1) << "search threads: " << threadNum
+                  << ", chunk size: " << rangeScheduler->chunkSize()
+                  << ", steal count: " << rangeScheduler->stealCount();
     }
 
     return true;
@@ -23,6 +23,7 @@ class DocumentManager;
 class SearchManagerPreProcessor;
 class SearchThreadWorker;
 struct SearchThreadParam;
+class SearchThreadLease;
 
 class SearchThreadMaster
 {
@@ -51,10 +52,15 @@ public:
         KeywordSearchResult& searchResult);
 
 private:
+    /**
+     * decide the number of threads for one query, if it is more than one,
+     * the threads are reserved in @p threadLease from the global budget.
+     */
     void getThreadInfo_(
         const DistKeywordSearchInfo& distSearchInfo,
         std::size_t& threadNum,
-        std::size_t& runningNode);
+        std::size_t& runningNode,
+        boost::shared_ptr<SearchThreadLease>& threadLease);
 
     bool runSingleThread_(
         SearchThreadParam& threadParam);
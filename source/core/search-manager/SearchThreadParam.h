@@ -10,12 +10,14 @@
 
 #include "CustomRanker.h"
 #include "GeoLocationRanker.h"
+#include "ScoreDoc.h"
 #include <common/ResultType.h>
 #include <mining-manager/group-manager/GroupRep.h>
 #include <mining-manager/group-manager/ontology_rep.h>
 #include <boost/shared_ptr.hpp>
 #include <map>
 #include <string>
+#include <vector>
 
 namespace sf1r
 {
@@ -23,13 +25,20 @@ class SearchKeywordOperation;
 class Sorter;
 class HitQueue;
 class DistKeywordSearchInfo;
+class DocIdRangeScheduler;
+class SearchThreadLease;
+class SearchThreadBudget;
 
 struct SearchThreadParam
 {
     const SearchKeywordOperation* actionOperation;
     DistKeywordSearchInfo* distSearchInfo;
 
+    /// the number of docs visited, when the doc iterator is pruned by
+    /// the top-K threshold, the skipped docs are not counted, so it is
+    /// less than the number of all matched docs
     std::size_t totalCount;
+    std::size_t prunedCount; // postings skipped by dynamic pruning
     sf1r::PropertyRange propertyRange;
     std::map<std::string, unsigned int> counterResults;
 
@@ -44,11 +53,25 @@ struct SearchThreadParam
     std::size_t heapSize;
     boost::shared_ptr<HitQueue> scoreItemQueue;
 
+    /// the top docs merged from all threads, from the best to the worst
+    std::vector<ScoreDoc> topKDocs;
+
     int runningNode;
     std::size_t threadId;
     std::size_t docIdBegin;
     std::size_t docIdEnd;
 
+    /// if not NULL, the docid ranges are taken from it instead of
+    /// [docIdBegin, docIdEnd), it is shared by all threads of one query
+    boost::shared_ptr<DocIdRangeScheduler> rangeScheduler;
+
+    /// the threads reserved for this query
+    boost::shared_ptr<SearchThreadLease> threadLease;
+
+    /// if not NULL, the query runs in only one thread, and the group
+    /// counters could lease the idle threads from it
+    SearchThreadBudget* groupThreadBudget;
+
     bool isSuccess;
 
     SearchThreadParam(
@@ -59,12 +82,14 @@ struct SearchThreadParam
         : actionOperation(_actionOperation)
         , distSearchInfo(_distSearchInfo)
         , totalCount(0)
+        , prunedCount(0)
         , originAttrGroupNum(0)
         , heapSize(_heapSize)
         , runningNode(_runningNode)
         , threadId(0)
         , docIdBegin(0)
         , docIdEnd(0)
+        , groupThreadBudget(NULL)
         , isSuccess(false)
     {}
 };
@@ -8,6 +8,7 @@
 #include "AllDocumentIterator.h"
 #include "CustomRankDocumentIterator.h"
 #include "HitQueue.h"
+#include "DocIdRangeScheduler.h"
 
 #include <common/PropSharedLockSet.h>
 #include <bundles/index/IndexBundleConfiguration.h>
@@ -21,6 +22,7 @@
 
 #include <memory> // auto_ptr
 #include <limits>
+#include <cmath>
 #include <boost/bind.hpp>
 #include <boost/scoped_ptr.hpp>
 
@@ -29,6 +31,18 @@ using namespace sf1r;
 namespace
 {
 const int kStarSearchAttrIterDocNum = 200;
+
+/**
+ * the pruning threshold for @p minScore of the full hit queue.
+ * As ScoreSortedHitQueue compares the scores within epsilon by docid,
+ * the threshold is below them, and at least one ulp below @p minScore,
+ * as epsilon is lost in the subtraction for a score larger than 1.
+ */
+score_t getPruningThreshold(score_t minScore)
+{
+    return std::nextafter(minScore - std::numeric_limits<score_t>::epsilon(),
+                          -std::numeric_limits<score_t>::infinity());
+}
 }
 
 SearchThreadWorker::SearchThreadWorker(
@@ -260,13 +274,17 @@ bool SearchThreadWorker::search(SearchThreadParam& param)
         propertyRankers);
 
     UpperBoundInProperties ubmap;
+    TermUBCalculatorInProperties ubCalculators;
     for (size_t i = 0; i < indexPropertyList.size(); ++i)
     {
         const std::string& currentProperty = indexPropertyList[i];
         ID_FREQ_MAP_T& ub = ubmap[currentProperty];
         propertyRankers[i]->calculateTermUBs(rankQueryProperties[i], ub);
+        ubCalculators[currentProperty] = TermUBCalculator(rankQueryProperties[i],
+                                                          *propertyRankers[i]);
     }
     docIterPtr->setUB(useOriginalQuery, ubmap);
+    docIterPtr->setBlockUB(ubCalculators);
     docIterPtr->initThreshold(actionOperation.actionItem_.searchingMode_.threshold_);
 
     STOP_PROFILER(preparerank)
@@ -282,8 +300,15 @@ bool SearchThreadWorker::search(SearchThreadParam& param)
             groupParam.attrIterDocNum_ = kStarSearchAttrIterDocNum;
         }
 
+        groupParam.groupSampleDocNum_ = config_.groupSampleDocNum_;
+
         groupFilter.reset(
             groupFilterBuilder_->createFilter(groupParam, propSharedLockSet));
+
+        if (groupFilter && param.groupThreadBudget)
+        {
+            groupFilter->setThreadBudget(param.groupThreadBudget);
+        }
     }
 
     ProductScorer* relevanceScorer = NULL;
@@ -299,11 +324,28 @@ bool SearchThreadWorker::search(SearchThreadParam& param)
 
     ScoreDocEvaluator scoreDocEvaluator(productScorer, param.customRanker, param.geoLocationRanker);
 
+    // the top-K threshold could only be fed back into the doc iterators
+    // when the rank score is just the relevance score, and no doc needs
+    // to be visited for group, range or counter results.
+    DocumentIterator* pruningIterator = NULL;
+    if (config_.enable_dynamic_pruning_ &&
+        pMultiPropertyIterator &&
+        pScoreDocIterator == pMultiPropertyIterator &&
+        relevanceScorer && productScorer == relevanceScorer &&
+        !param.pSorter && !param.customRanker && !param.geoLocationRanker &&
+        !groupFilter &&
+        actionOperation.actionItem_.rangePropertyName_.empty() &&
+        actionOperation.actionItem_.counterList_.empty())
+    {
+        pruningIterator = pMultiPropertyIterator;
+    }
+
     try
     {
         time_t start_search = time(NULL);
         bool ret = doSearch_(param,
                              *docIterPtr,
+                             pruningIterator,
                              groupFilter.get(),
                              scoreDocEvaluator,
                              propSharedLockSet);
@@ -354,9 +396,36 @@ DocumentIterator* SearchThreadWorker::combineCustomDocIterator_(
     return originDocIterator;
 }
 
+bool SearchThreadWorker::moveToNextRange_(
+    SearchThreadParam& param,
+    DocumentIterator& docIterator,
+    docid_t& curDocId,
+    docid_t& rangeEnd)
+{
+    DocIdRangeScheduler* rangeScheduler = param.rangeScheduler.get();
+    if (!rangeScheduler)
+        return false;
+
+    docid_t rangeBegin = 0;
+    while (curDocId >= rangeEnd)
+    {
+        if (curDocId == MAX_DOC_ID ||
+            !rangeScheduler->next(param.threadId, rangeBegin, rangeEnd))
+            return false;
+
+        if (curDocId < rangeBegin)
+        {
+            curDocId = docIterator.skipTo(rangeBegin);
+        }
+    }
+
+    return true;
+}
+
 bool SearchThreadWorker::doSearch_(
     SearchThreadParam& param,
     DocumentIterator& docIterator,
+    DocumentIterator* pruningIterator,
     faceted::GroupFilter* groupFilter,
     ScoreDocEvaluator& scoreDocEvaluator,
     PropSharedLockSet& propSharedLockSet)
@@ -394,63 +463,106 @@ bool SearchThreadWorker::doSearch_(
         }
     }
 
-    docIterator.skipTo(param.docIdBegin);
+    score_t pruningThreshold = 0;
 
-    do
+    docid_t rangeBegin = param.docIdBegin;
+    docid_t rangeEnd = param.docIdEnd;
+    if (param.rangeScheduler &&
+        !param.rangeScheduler->next(param.threadId, rangeBegin, rangeEnd))
     {
+        return true;
+    }
 
-        docid_t curDocId = docIterator.doc();
-
-        if (curDocId >= param.docIdEnd)
-            break;
+    docIterator.skipTo(rangeBegin);
 
-        if (groupFilter && !groupFilter->test(curDocId))
-            continue;
+    // the docs are collected into batches, and each batch is scored
+    // column by column
+    bool hasDoc = true;
+    while (hasDoc)
+    {
+        bool isBatchFull = false;
 
-        if (rangePropertyTable)
+        do
         {
-            float docPropertyValue = 0;
-            if (rangePropertyTable->getFloatValue(curDocId, docPropertyValue, false))
+            docid_t curDocId = docIterator.doc();
+
+            if (curDocId >= rangeEnd &&
+                !moveToNextRange_(param, docIterator, curDocId, rangeEnd))
             {
-                if (docPropertyValue < lowValue)
-                {
-                    lowValue = docPropertyValue;
-                }
+                hasDoc = false;
+                break;
+            }
+
+            if (groupFilter && !groupFilter->test(curDocId))
+                continue;
 
-                if (docPropertyValue > highValue)
+            if (rangePropertyTable)
+            {
+                float docPropertyValue = 0;
+                if (rangePropertyTable->getFloatValue(curDocId, docPropertyValue, false))
                 {
-                    highValue = docPropertyValue;
+                    if (docPropertyValue < lowValue)
+                    {
+                        lowValue = docPropertyValue;
+                    }
+
+                    if (docPropertyValue > highValue)
+                    {
+                        highValue = docPropertyValue;
+                    }
                 }
             }
-        }
 
-        /// COUNT(PropertyName)  semantics
-        if (counterSize)
-        {
-            for (ii = 0; ii < counterSize; ++ii)
+            /// COUNT(PropertyName)  semantics
+            if (counterSize)
             {
-                int32_t value;
-                if (counterTables[ii]->getInt32Value(curDocId,value, false))
+                for (ii = 0; ii < counterSize; ++ii)
                 {
-                    counterValues[ii] += value;
+                    int32_t value;
+                    if (counterTables[ii]->getInt32Value(curDocId,value, false))
+                    {
+                        counterValues[ii] += value;
+                    }
                 }
             }
-        }
 
-        ScoreDoc scoreItem(curDocId);
+            ++param.totalCount;
+            isBatchFull = scoreDocEvaluator.addDoc(curDocId);
+        }
+        while (!isBatchFull && (hasDoc = docIterator.next()));
 
         START_PROFILER(computerankscore)
-
-        ++param.totalCount;
-        scoreDocEvaluator.evaluate(scoreItem);
-
+        const std::vector<ScoreDoc>& scoreDocs = scoreDocEvaluator.evaluateBatch();
         STOP_PROFILER(computerankscore)
 
         START_PROFILER(inserttoqueue)
-        param.scoreItemQueue->insert(scoreItem);
+        for (std::vector<ScoreDoc>::const_iterator it = scoreDocs.begin();
+             it != scoreDocs.end(); ++it)
+        {
+            param.scoreItemQueue->insert(*it);
+        }
         STOP_PROFILER(inserttoqueue)
+
+        if (pruningIterator && param.scoreItemQueue->size() >= param.heapSize)
+        {
+            score_t minScore = param.scoreItemQueue->top().score;
+            if (minScore > pruningThreshold)
+            {
+                pruningThreshold = minScore;
+                pruningIterator->setThreshold(getPruningThreshold(minScore));
+            }
+        }
+
+        if (isBatchFull)
+        {
+            hasDoc = docIterator.next();
+        }
+    }
+
+    if (pruningIterator)
+    {
+        param.prunedCount = pruningIterator->getPrunedCount();
     }
-    while (docIterator.next());
 
     if (rangePropertyTable && lowValue <= highValue)
     {
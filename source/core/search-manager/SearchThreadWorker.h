@@ -60,9 +60,26 @@ private:
         const KeywordSearchActionItem& actionItem,
         DocumentIterator* originDocIterator);
 
+    /**
+     * when @p curDocId is beyond @p rangeEnd, get the next docid range
+     * from the range scheduler and move @p docIterator into it.
+     * @return false if there is no range left to search.
+     */
+    bool moveToNextRange_(
+        SearchThreadParam& param,
+        DocumentIterator& docIterator,
+        docid_t& curDocId,
+        docid_t& rangeEnd);
+
+    /**
+     * @param pruningIterator if not NULL, the minimum score of the full
+     *        result queue would be fed back to it by @c setThreshold(),
+     *        so that the docs which could not enter top-K are skipped.
+     */
     bool doSearch_(
         SearchThreadParam& param,
         DocumentIterator& docIterator,
+        DocumentIterator* pruningIterator,
         faceted::GroupFilter* groupFilter,
         ScoreDocEvaluator& scoreDocEvaluator,
         PropSharedLockSet& propSharedLockSet);
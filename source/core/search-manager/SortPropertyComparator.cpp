@@ -1,6 +1,8 @@
 #include "SortPropertyComparator.h"
 #include <common/RTypeStringPropTable.h>
 
+#include <limits>
+
 namespace sf1r
 {
 
@@ -70,6 +72,37 @@ int SortPropertyComparator::compare(const ScoreDoc& doc1, const ScoreDoc& doc2)
     return (this->*comparator_)(doc1, doc2);
 }
 
+bool SortPropertyComparator::hasSortKey() const
+{
+    return comparator_ == &SortPropertyComparator::compareImplNumeric ||
+           comparator_ == &SortPropertyComparator::compareImplUnknown ||
+           comparator_ == &SortPropertyComparator::compareImplCustomRanking ||
+           comparator_ == &SortPropertyComparator::compareImplGeoLocation;
+}
+
+double SortPropertyComparator::getSortKey(const ScoreDoc& doc) const
+{
+    switch (type_)
+    {
+    case UNKNOWN_DATA_PROPERTY_TYPE:
+        return doc.score;
+    case CUSTOM_RANKING_PROPERTY_TYPE:
+        return doc.custom_score;
+    case GEOLOCATION_PROPERTY_TYPE:
+        return doc.geo_dist;
+    default:
+        break;
+    }
+
+    double value = 0;
+    if (!numericPropTable_ || doc.docId >= size_ ||
+        !numericPropTable_->getDoubleValue(doc.docId, value, false))
+    {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return value;
+}
+
 int SortPropertyComparator::compareImplDefault(const ScoreDoc& doc1, const ScoreDoc& doc2) const
 {
     return 0;
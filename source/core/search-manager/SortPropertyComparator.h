@@ -24,6 +24,21 @@ class SortPropertyComparator
 public:
     int compare(const ScoreDoc& doc1, const ScoreDoc& doc2) const;
 
+    /**
+     * whether the value compared for one doc could be precomputed as a
+     * double by @c getSortKey(), it is false for string property.
+     */
+    bool hasSortKey() const;
+
+    /**
+     * get the value compared for @p doc, if the keys of two docs differ,
+     * comparing them gives the same result as @c compare(), otherwise
+     * @c compare() should be called instead.
+     * @return NaN if @p doc has no property value, as @c compare() could
+     *         not be reproduced by a key for it
+     */
+    double getSortKey(const ScoreDoc& doc) const;
+
 private:
     boost::shared_ptr<NumericPropertyTableBase> numericPropTable_;
     boost::shared_ptr<RTypeStringPropTable> RTypePropTable_;
@@ -183,6 +183,17 @@ void Sorter::createComparators(PropSharedLockSet& propSharedLockSet)
     }
 }
 
+void Sorter::getSortKeys(const ScoreDoc& doc, double* keys) const
+{
+    for (std::size_t i = 0; i < nNumProperties_; ++i)
+    {
+        const SortPropertyComparator* pComparator = ppSortProperties_[i]->pComparator_;
+        if (pComparator->hasSortKey())
+        {
+            keys[i] = pComparator->getSortKey(doc);
+        }
+    }
+}
 
 SortPropertyComparator* Sorter::createRTypeStringComparator_(
     const std::string& propName,
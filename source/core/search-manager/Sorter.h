@@ -151,6 +151,48 @@ public:
 //    return c < 0;
     }
 
+    /// the number of sort keys for each doc, see getSortKeys()
+    std::size_t getSortKeyNum() const
+    {
+        return nNumProperties_;
+    }
+
+    ///Precompute the value of each sort property of @p doc into @p keys,
+    /// which has getSortKeyNum() elements. The keys of the properties
+    /// without SortPropertyComparator::hasSortKey() are left untouched.
+    void getSortKeys(const ScoreDoc& doc, double* keys) const;
+
+    ///The same as lessThan(doc1, doc2), except that the precomputed keys
+    /// are compared instead of reading the property tables when they differ.
+    bool lessThan(
+        const ScoreDoc& doc1, const double* keys1,
+        const ScoreDoc& doc2, const double* keys2) const
+    {
+        for (std::size_t i = 0; i < nNumProperties_; ++i)
+        {
+            const SortPropertyComparator* pComparator = ppSortProperties_[i]->pComparator_;
+            int c = 0;
+            if (pComparator->hasSortKey() && keys1[i] < keys2[i])
+            {
+                c = -1;
+            }
+            else if (pComparator->hasSortKey() && keys1[i] > keys2[i])
+            {
+                c = 1;
+            }
+            else
+            {
+                // the equal keys or NaN keys are left to compare()
+                c = pComparator->compare(doc1, doc2);
+            }
+
+            if (c != 0)
+                return c ^ (reverseMul_[i]);
+        }
+
+        return doc1.docId < doc2.docId;
+    }
+
     ///This interface would be called after an instance of Sorter is established,
     /// it will generate SortPropertyComparator for internal usage
     void createComparators(PropSharedLockSet& propSharedLockSet);
@@ -9,6 +9,8 @@
 
 #include <boost/assert.hpp>
 
+#include <algorithm>
+
 using namespace izenelib::ir::indexmanager;
 
 namespace sf1r
@@ -37,6 +39,7 @@ TermDocumentIterator::TermDocumentIterator(
     ,df_(0)
     ,readPositions_(readPositions)
     ,ub_(0)
+    ,blockCursor_(0)
 {
 }
 
@@ -67,6 +70,8 @@ TermDocumentIterator::TermDocumentIterator(
     ,indexManagerPtr_(indexManagerPtr)
     ,df_(0)
     ,readPositions_(readPositions)
+    ,ub_(0)
+    ,blockCursor_(0)
 {
 }
 
@@ -171,6 +176,51 @@ void TermDocumentIterator::doc_item(
     }
 }
 
+void TermDocumentIterator::setBlockUB(const TermUBCalculatorInProperties& ubCalculators)
+{
+    blockUBs_.clear();
+
+    TermUBCalculatorInProperties::const_iterator found = ubCalculators.find(property_);
+    if (!blockMaxPosting_ || found == ubCalculators.end())
+        return;
+
+    const TermUBCalculator& ubCalculator = found->second;
+    const std::size_t blockNum = blockMaxPosting_->blockNum();
+    blockUBs_.resize(blockNum);
+
+    for (std::size_t i = 0; i < blockNum; ++i)
+    {
+        float blockUB = ubCalculator(termIndex_, blockMaxPosting_->maxTF(i));
+        blockUBs_[i] = std::min(blockUB, ub_);
+    }
+}
+
+float TermDocumentIterator::getBlockUB(docid_t target)
+{
+    if (blockUBs_.empty())
+        return ub_;
+
+    blockCursor_ = blockMaxPosting_->findBlock(target, blockCursor_);
+
+    // the docs indexed after the block max posting was built
+    if (blockCursor_ >= blockUBs_.size())
+        return ub_;
+
+    return blockUBs_[blockCursor_];
+}
+
+docid_t TermDocumentIterator::getBlockLastDoc(docid_t target)
+{
+    if (blockUBs_.empty())
+        return MAX_DOC_ID;
+
+    blockCursor_ = blockMaxPosting_->findBlock(target, blockCursor_);
+    if (blockCursor_ >= blockUBs_.size())
+        return MAX_DOC_ID;
+
+    return blockMaxPosting_->lastDoc(blockCursor_);
+}
+
 void TermDocumentIterator::ensureTermDocReader_()
 {
     if (pTermDocReader_ == 0)
@@ -8,6 +8,7 @@
 #define TERM_DOCUMENT_ITERATOR_H
 
 #include "DocumentIterator.h"
+#include "BlockMaxPosting.h"
 #include <common/TermTypeDetector.h>
 
 #include <ir/index_manager/index/AbsTermReader.h>
@@ -120,6 +121,18 @@ public:
     {
         return ub_;
     }
+
+    void setBlockMaxPosting(const BlockMaxPostingPtr& blockMaxPosting)
+    {
+        blockMaxPosting_ = blockMaxPosting;
+        blockCursor_ = 0;
+    }
+
+    void setBlockUB(const TermUBCalculatorInProperties& ubCalculators);
+
+    float getBlockUB(docid_t target);
+
+    docid_t getBlockLastDoc(docid_t target);
     
     const char* getProperty()
     {
@@ -182,6 +195,14 @@ protected:
 
     float ub_;
 
+    BlockMaxPostingPtr blockMaxPosting_;
+
+    /// the upper bound of each block in @c blockMaxPosting_
+    std::vector<float> blockUBs_;
+
+    /// the block index to search from, as target docid never decreases
+    std::size_t blockCursor_;
+
     friend class WANDDocumentIterator;
     friend class VirtualPropertyTermDocumentIterator;
 };
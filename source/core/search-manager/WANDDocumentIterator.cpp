@@ -22,6 +22,7 @@ WANDDocumentIterator::WANDDocumentIterator()
     currThreshold_ = 0.0;
     currDoc_   = 0;
     pivotDoc_  = 0;
+    prunedCount_ = 0;
 }
 
 WANDDocumentIterator::~WANDDocumentIterator()
@@ -98,7 +99,8 @@ void WANDDocumentIterator::initThreshold(float threshold)
 
 void WANDDocumentIterator::setThreshold(float realThreshold)
 {
-    currThreshold_ = realThreshold;
+    if (realThreshold > currThreshold_)
+        currThreshold_ = realThreshold;
     //LOG(INFO)<<"the updated threshold :"<<currThreshold_;
 }
 
@@ -184,6 +186,67 @@ bool WANDDocumentIterator::processPrePostings(docid_t target)//multimap sorter a
     return true;
 }
 
+bool WANDDocumentIterator::moveCurrentIterators()
+{
+    DocumentIterator* front = docIteratorSorter_.begin()->second;
+    while(front != NULL && front->isCurrent())
+    {
+        front->setCurrent(false);
+        if(front->next())
+        {
+            docIteratorSorter_.erase(docIteratorSorter_.begin());
+            docIteratorSorter_.insert(make_pair(front->doc(), front));
+        }
+        else
+        {
+            docIteratorSorter_.erase(docIteratorSorter_.begin());
+            if(docIteratorSorter_.size() == 0)
+                return false;
+        }
+        front = docIteratorSorter_.begin()->second;
+    }
+    return true;
+}
+
+void WANDDocumentIterator::markCurrentIterators()
+{
+    std::vector<DocumentIterator*>::iterator iter = docIteratorList_.begin();
+    for ( ; iter != docIteratorList_.end(); ++iter)
+    {
+        DocumentIterator* pEntry = (*iter);
+        if(pEntry)
+        {
+            if (currDoc_ == pEntry->doc())
+                pEntry->setCurrent(true);
+            else
+                pEntry->setCurrent(false);
+        }
+    }
+}
+
+void WANDDocumentIterator::countPrunedPostings(docid_t target)
+{
+    typedef std::multimap<docid_t, DocumentIterator*>::const_iterator const_map_iter;
+    for (const_map_iter iter = docIteratorSorter_.begin();
+         iter != docIteratorSorter_.end() && iter->first < target; ++iter)
+    {
+        ++prunedCount_;
+    }
+}
+
+void WANDDocumentIterator::setBlockUB(const TermUBCalculatorInProperties& ubCalculators)
+{
+    std::vector<DocumentIterator*>::iterator iter = docIteratorList_.begin();
+    for( ; iter != docIteratorList_.end(); ++iter )
+    {
+        DocumentIterator* pEntry = (*iter);
+        if (pEntry)
+        {
+            pEntry->setBlockUB(ubCalculators);
+        }
+    }
+}
+
 bool WANDDocumentIterator::do_next()
 {
     do
@@ -195,24 +258,8 @@ bool WANDDocumentIterator::do_next()
         if(docIteratorSorter_.size() == 0)
             return false;
 
-        //////
-        DocumentIterator* front = docIteratorSorter_.begin()->second;
-        while(front != NULL && front->isCurrent())
-        {
-            front->setCurrent(false);
-            if(front->next())
-            {
-                docIteratorSorter_.erase(docIteratorSorter_.begin());
-                docIteratorSorter_.insert(make_pair(front->doc(), front));
-            }
-            else
-            {
-                docIteratorSorter_.erase(docIteratorSorter_.begin());
-                if(docIteratorSorter_.size() == 0)
-                    return false;
-            }
-            front = docIteratorSorter_.begin()->second;
-        }
+        if (moveCurrentIterators() == false)
+            return false;
 
         if (findPivot() == false)
         {
@@ -231,28 +278,20 @@ bool WANDDocumentIterator::do_next()
         }
         else //pivotTerm_ > currdoc_
         {
+            DocumentIterator* front = docIteratorSorter_.begin()->second;
             if(front->doc() == pivotDoc_)
             {
                 currDoc_ = pivotDoc_;
             
                 processPrePostings(currDoc_ );
 
-                std::vector<DocumentIterator*>::iterator iter = docIteratorList_.begin();
-                for ( ; iter != docIteratorList_.end(); ++iter)
-                {
-                    DocumentIterator* pEntry = (*iter);
-                    if(pEntry)
-                    {
-                        if (currDoc_ == pEntry->doc())
-                            pEntry->setCurrent(true);
-                        else
-                            pEntry->setCurrent(false);
-                    }
-                }
+                markCurrentIterators();
                 return true;
             }
             else
             {
+                countPrunedPostings(pivotDoc_);
+
                 if(processPrePostings(pivotDoc_) == false)
                     return false;
             }
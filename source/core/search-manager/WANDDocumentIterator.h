@@ -50,8 +50,18 @@ public:
 
     void initThreshold(float threshold);
 
+    /**
+     * raise the pivot threshold to @p realThreshold, it is used to feed
+     * the minimum score of a full top-K heap back into the iterator,
+     * so the threshold would never decrease during traversal.
+     */
     void setThreshold (float realThreshold);
 
+    count_t getPrunedCount()
+    {
+        return prunedCount_;
+    }
+
     bool next();
 
     docid_t doc()
@@ -76,9 +86,16 @@ public:
     {
         return docIteratorList_.empty();
     }
+
+    const std::vector<DocumentIterator*>& getDocIteratorList() const
+    {
+        return docIteratorList_;
+    }
     
     void queryBoosting(double& score, double& weight);
 
+    void setBlockUB(const TermUBCalculatorInProperties& ubCalculators);
+
 #if SKIP_ENABLED
     docid_t skipTo(docid_t target);
 
@@ -96,6 +113,15 @@ protected:
 
     bool processPrePostings(docid_t target);
 
+    /// move forward the iterators on current doc, return false if all are exhausted
+    bool moveCurrentIterators();
+
+    /// mark the iterators on current doc to be used in scoring
+    void markCurrentIterators();
+
+    /// count the postings before @p target, which would be skipped
+    void countPrunedPostings(docid_t target);
+
 protected:
 
     std::vector<DocumentIterator*> docIteratorList_;
@@ -108,6 +134,9 @@ protected:
 
     docid_t pivotDoc_;
 
+    /// the number of postings skipped as their docs could not reach the threshold
+    count_t prunedCount_;
+
     boost::mutex mutex_;
 };
 
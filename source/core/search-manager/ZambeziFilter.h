@@ -14,6 +14,10 @@ namespace sf1r
 class ZambeziFilter : public izenelib::ir::Zambezi::FilterBase
 {
 public:
+    /**
+     * @param filterBitset it might be shared by other requests, so it is
+     *        only read here.
+     */
     ZambeziFilter(
             const DocumentManager& documentManager,
             const boost::shared_ptr<faceted::GroupFilter>& groupFilter,
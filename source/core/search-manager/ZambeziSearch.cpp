@@ -37,6 +37,9 @@ namespace
 const std::size_t kAttrTopDocNum = 200;
 const std::size_t kZambeziTopKNum = 5e5;
 
+/// the number of candidates scored in one batch
+const std::size_t kScoreBatchSize = 128;
+
 const std::size_t kMajTerNum = 3;
 const std::string kTopLabelPropName = "Category";
 const size_t kRootCateNum = 10;
@@ -167,15 +170,39 @@ bool ZambeziSearch::search(
     ConditionsNode& filterTree =
         actionOperation.actionItem_.filterTree_;
 
-    boost::shared_ptr<InvertedIndexManager::FilterBitmapT> filterBitmap;
     boost::shared_ptr<izenelib::ir::indexmanager::Bitset> filterBitset;
 
     if (!filterTree.empty())
     {
-        queryBuilder_.prepare_filter(filterTree, filterBitmap);
-        filterBitset.reset(new izenelib::ir::indexmanager::Bitset);
-        filterBitset->decompress(*filterBitmap);
+        // the bitset is shared with the other requests of the same filter
+        if (!queryBuilder_.prepare_filter_bitset(filterTree, filterBitset))
+        {
+            filterBitset.reset(new izenelib::ir::indexmanager::Bitset);
+        }
     }
+
+    std::vector<docid_t> geoScopeDocs;
+    if (preprocessor_.getGeoScopeDocs(actionOperation.actionItem_, geoScopeDocs))
+    {
+        // as filterBitset might be shared, a new one is created to
+        // intersect it with the docs in geo scope, which only removes the
+        // candidates failing the scope check below anyway
+        const docid_t maxDocId = documentManager_.getMaxDocId();
+        boost::shared_ptr<izenelib::ir::indexmanager::Bitset> geoBitset(
+            new izenelib::ir::indexmanager::Bitset(maxDocId + 1));
+
+        for (std::vector<docid_t>::const_iterator it = geoScopeDocs.begin();
+             it != geoScopeDocs.end() && *it <= maxDocId; ++it)
+        {
+            if (!filterBitset || filterBitset->test(*it))
+            {
+                geoBitset->set(*it);
+            }
+        }
+
+        filterBitset = geoBitset;
+    }
+
     //Query Analyzer
     getAnalyzedQuery_(query, searchResult.analyzedQuery_);
 
@@ -270,33 +297,61 @@ bool ZambeziSearch::search(
     std::size_t totalCount = 0;
 
     {
-        for (size_t i = 0; i < candNum; ++i)
+        // the custom scores are evaluated in batches of the candidates
+        // passing the group filter
+        std::vector<std::size_t> batchPos;
+        std::vector<docid_t> batchDocIds;
+        std::vector<double> customScores;
+
+        for (size_t begin = 0; begin < candNum; begin += kScoreBatchSize)
         {
-            docid_t docId = candidates[i];
+            const size_t end = std::min(begin + kScoreBatchSize, candNum);
+            batchPos.clear();
+            batchDocIds.clear();
 
-            if (groupFilter && !groupFilter->test(docId))
-                continue;
+            for (size_t i = begin; i < end; ++i)
+            {
+                if (groupFilter && !groupFilter->test(candidates[i]))
+                    continue;
 
-            ScoreDoc scoreItem(docId, scores[i]);
+                batchPos.push_back(i);
+                batchDocIds.push_back(candidates[i]);
+            }
+
+            const size_t batchNum = batchDocIds.size();
+            if (batchNum == 0)
+                continue;
 
             if (customRanker)
             {
-                scoreItem.custom_score = customRanker->evaluate(docId);
+                customScores.resize(batchNum);
+                customRanker->evaluate(&batchDocIds[0], batchNum, &customScores[0]);
             }
 
-            if (geoLocationRanker)
+            for (size_t j = 0; j < batchNum; ++j)
             {
-                scoreItem.geo_dist = geoLocationRanker->evaluate(docId);
-				//remove docs which out of scope
-				//add by wangbaobao@b5m.com
-				if(false == geoLocationRanker->checkScope(scoreItem.geo_dist)){
-					continue;
-				}
-            }
+                docid_t docId = batchDocIds[j];
+                ScoreDoc scoreItem(docId, scores[batchPos[j]]);
 
-            scoreItemQueue->insert(scoreItem);
+                if (customRanker)
+                {
+                    scoreItem.custom_score = customScores[j];
+                }
+
+                if (geoLocationRanker)
+                {
+                    scoreItem.geo_dist = geoLocationRanker->evaluate(docId);
+                    //remove docs which out of scope
+                    //add by wangbaobao@b5m.com
+                    if(false == geoLocationRanker->checkScope(scoreItem.geo_dist)){
+                        continue;
+                    }
+                }
+
+                scoreItemQueue->insert(scoreItem);
 
-            ++totalCount;
+                ++totalCount;
+            }
         }
     }
 
@@ -5,7 +5,9 @@
 #include <common/ResourceManager.h>
 
 #include <log-manager/LogServerConnection.h>
+#include <log-manager/QueryLogWriter.h>
 #include <la-manager/LAPool.h>
+#include <la-manager/QueryAnalysisCache.h>
 #include <aggregator-manager/CollectionDataReceiver.h>
 #include <node-manager/ZooKeeperManager.h>
 #include <node-manager/SuperNodeManager.h>
@@ -104,6 +106,7 @@ bool CobraProcess::initLogManager()
         std::cerr << "Init LogManager with " << log_conn << " failed!" << std::endl;
         return false;
     }
+    QueryLogWriter::instance().start(SF1Config::get()->getQueryLogWriterConfig());
     const LogServerConnectionConfig& logServerConfig = SF1Config::get()->getLogServerConfig();
     if (!LogServerConnection::instance().init(logServerConfig))
     {
@@ -140,6 +143,10 @@ bool CobraProcess::initLAManager()
     if (! LAPool::getInstance()->init(laConfig))
         return false;
 
+    // the LA dictionaries are reloaded every updateDictInterval_ seconds,
+    // so the cached query analysis results expire in the same interval
+    QueryAnalysisCache::get()->init(laConfig.queryCacheSize_, laConfig.updateDictInterval_);
+
     return true;
 }
 
@@ -400,6 +407,8 @@ int CobraProcess::run()
 
         stopCollections();
 
+        QueryLogWriter::instance().stop();
+
         LOG(INFO) << "CobraProcess has exited";
         waitSignalThread();
     }
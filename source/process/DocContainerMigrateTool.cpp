@@ -0,0 +1,169 @@
+/**
+ * @file DocContainerMigrateTool.cpp
+ * @brief convert the document property table of a collection from the
+ *        whole document layout to the columnar layout.
+ *
+ * Usage: DocContainerMigrateTool <dm path> [property groups]
+ *
+ * The converted data is written to "<dm path>_columnar", the other files in
+ * the dm directory are copied there, after converting, stop the sf1r process
+ * and replace the dm directory with the new one.
+ * The property groups are separated by semicolon, and the properties in each
+ * group are separated by comma, such as "Title,Price;Content".
+ */
+
+#include <document-manager/DocContainer.h>
+#include <document-manager/Document.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/algorithm/string.hpp>
+
+#include <vector>
+#include <string>
+#include <iostream>
+
+using namespace std;
+namespace bf = boost::filesystem;
+
+namespace
+{
+const std::string OLD_TABLE_PREFIX = "DocumentPropertyTable";
+
+void parseGroups(const std::string& str, sf1r::DocContainer::PropertyGroups& groups)
+{
+    std::vector<std::string> groupStrList;
+    boost::split(groupStrList, str, boost::is_any_of(";"));
+
+    for (std::size_t i = 0; i < groupStrList.size(); ++i)
+    {
+        std::vector<std::string> properties;
+        boost::split(properties, groupStrList[i], boost::is_any_of(","),
+                     boost::token_compress_on);
+
+        std::vector<std::string> group;
+        for (std::size_t j = 0; j < properties.size(); ++j)
+        {
+            boost::trim(properties[j]);
+            if (!properties[j].empty())
+                group.push_back(properties[j]);
+        }
+
+        if (!group.empty())
+            groups.push_back(group);
+    }
+}
+
+/**
+ * copy the files not belonging to the document property table, including
+ * "MaxDocID.xml", so that the max doc id is kept even if the last docs
+ * were removed.
+ */
+void copyOtherFiles(const bf::path& fromDir, const bf::path& toDir)
+{
+    for (bf::directory_iterator it(fromDir), itEnd; it != itEnd; ++it)
+    {
+        const std::string fileName = it->path().filename().string();
+        if (boost::starts_with(fileName, OLD_TABLE_PREFIX))
+            continue;
+
+        if (bf::is_directory(it->path()))
+        {
+            bf::create_directories(toDir / fileName);
+            copyOtherFiles(it->path(), toDir / fileName);
+        }
+        else
+        {
+            bf::copy_file(it->path(), toDir / fileName,
+                          bf::copy_option::overwrite_if_exists);
+        }
+    }
+}
+
+}
+
+int main(int argc, char * argv[])
+{
+    using namespace sf1r;
+    try
+    {
+        if (argc < 2)
+        {
+            std::cerr << "Usage: " << argv[0] << " <dm path> [property groups]" << std::endl;
+            return -1;
+        }
+
+        std::string oldPath = argv[1];
+        boost::trim_right_if(oldPath, boost::is_any_of("/"));
+        const std::string newPath = oldPath + "_columnar/";
+        oldPath += "/";
+
+        DocContainer::PropertyGroups groups;
+        if (argc > 2)
+        {
+            parseGroups(argv[2], groups);
+        }
+
+        DocContainer oldContainer(oldPath);
+        if (oldContainer.isColumnar())
+        {
+            std::cout << "already in columnar layout: " << oldPath << std::endl;
+            return 0;
+        }
+
+        if (!oldContainer.open())
+        {
+            std::cerr << "open old data failed: " << oldPath << std::endl;
+            return -1;
+        }
+
+        if (bf::exists(newPath))
+        {
+            std::cerr << "the output path already exists: " << newPath << std::endl;
+            return -1;
+        }
+        bf::create_directories(newPath);
+        copyOtherFiles(oldPath, newPath);
+
+        DocContainer newContainer(newPath, groups);
+        if (!newContainer.open())
+        {
+            std::cerr << "open new data failed: " << newPath << std::endl;
+            return -1;
+        }
+
+        std::cout << "begin converting: " << oldPath << " => " << newPath << std::endl;
+
+        const docid_t maxDocId = oldContainer.getMaxDocId();
+        std::size_t convertNum = 0;
+        Document doc;
+        for (docid_t docId = 1; docId <= maxDocId; ++docId)
+        {
+            if (oldContainer.get(docId, doc))
+            {
+                if (!newContainer.insert(docId, doc))
+                {
+                    std::cerr << "failed to insert doc: " << docId << std::endl;
+                    return -1;
+                }
+                ++convertNum;
+            }
+
+            if (docId % 100000 == 0)
+            {
+                std::cout << "converted doc: " << docId << "/" << maxDocId << std::endl;
+            }
+        }
+        newContainer.flush();
+
+        std::cout << "convert finished, doc num: " << convertNum
+                  << ", column num: " << newContainer.getColumnNum() << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Exit because of exception: "
+                  << e.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
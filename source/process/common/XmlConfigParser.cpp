@@ -76,6 +76,30 @@ void parseByComma(const string & str, vector<string> & subStrList)
     }
 }
 
+/**
+ * parse the groups separated by semicolon, and the properties in each group
+ * separated by comma, such as "Title,Price;Content".
+ */
+void parseStoredPropertyGroups(const string & str, vector<vector<string> > & groups)
+{
+    groups.clear();
+
+    vector<string> groupStrList;
+    boost::split(groupStrList, str, boost::is_any_of(";"));
+
+    for (vector<string>::const_iterator it = groupStrList.begin();
+            it != groupStrList.end(); ++it)
+    {
+        vector<string> properties;
+        parseByComma(*it, properties);
+
+        if (!properties.empty())
+        {
+            groups.push_back(properties);
+        }
+    }
+}
+
 // ------------------------- HELPER MEMBER FUNCTIONS of XmlConfigParser -------------------------
 
 ticpp::Element * XmlConfigParser::getUniqChildElement(
@@ -288,7 +312,22 @@ void SF1Config::parseSystemSettings(const ticpp::Element * system)
 
     getAttribute(getUniqChildElement(system, "WorkingDir"), "path", working_dir_);
 
-    getAttribute(getUniqChildElement(system, "LogConnection"), "str", log_conn_str_);
+    const ticpp::Element* logConnection = getUniqChildElement(system, "LogConnection");
+    getAttribute(logConnection, "str", log_conn_str_);
+    getAttribute(logConnection, "queuesize", queryLogWriterConfig_.queueSize, false);
+    getAttribute(logConnection, "batchsize", queryLogWriterConfig_.batchSize, false);
+    getAttribute(logConnection, "flushinterval", queryLogWriterConfig_.flushInterval, false);
+
+    std::string fullPolicy;
+    if (getAttribute(logConnection, "fullpolicy", fullPolicy, false))
+    {
+        boost::to_lower(fullPolicy);
+        if (fullPolicy != "drop" && fullPolicy != "block")
+        {
+            throw XmlConfigParserException("LogConnection - \"fullpolicy\" should be \"drop\" or \"block\".");
+        }
+        queryLogWriterConfig_.isBlockOnFull = (fullPolicy == "block");
+    }
 
     getAttribute(getUniqChildElement(system, "LogServerConnection"), "host", logServerConnectionConfig_.host);
     getAttribute(getUniqChildElement(system, "LogServerConnection"), "rpcport", logServerConnectionConfig_.rpcPort);
@@ -400,6 +439,24 @@ void SF1Config::parseLanguageAnalyzer(const ticpp::Element * languageAnalyzer)
     laManagerConfig_.updateDictInterval_ = updateDictInterval;
     std::cout<<"set update LA dictionary interval: "<<updateDictInterval<<std::endl;
 
+    unsigned int searchLAMaxNum = 0;
+    if (getAttribute(languageAnalyzer, "maxsearchlanum", searchLAMaxNum, false))
+    {
+        laManagerConfig_.searchLAMaxNum_ = searchLAMaxNum;
+    }
+
+    unsigned int searchLAWaitTime = 0;
+    if (getAttribute(languageAnalyzer, "searchlawaittime", searchLAWaitTime, false))
+    {
+        laManagerConfig_.searchLAWaitTime_ = searchLAWaitTime;
+    }
+
+    unsigned int queryCacheSize = 0;
+    if (getAttribute(languageAnalyzer, "querycachesize", queryCacheSize, false))
+    {
+        laManagerConfig_.queryCacheSize_ = queryCacheSize;
+    }
+
     // 2. <Method>
 
     // common settings among analyzers
@@ -1173,6 +1230,10 @@ void CollectionConfig::parseIndexBundleParam(const ticpp::Element * index, Colle
     params.Get("CollectionDataDirectory", directories);
     params.Get("IndexStrategy/logcreateddoc", indexBundleConfig.logCreatedDoc_);
     params.Get("IndexStrategy/autorebuild", indexBundleConfig.isAutoRebuild_);
+    params.Get<std::size_t>("IndexStrategy/indexthreadnum", indexBundleConfig.indexThreadNum_);
+    std::string storedPropertyGroups;
+    params.GetString("IndexStrategy/storedpropertygroups", storedPropertyGroups, "");
+    parseStoredPropertyGroups(storedPropertyGroups, indexBundleConfig.storedPropertyGroups_);
     params.Get("IndexStrategy/indexdoclength", indexmanager_config.indexStrategy_.indexDocLength_);
 
     if (!directories.empty())
@@ -1183,11 +1244,26 @@ void CollectionConfig::parseIndexBundleParam(const ticpp::Element * index, Colle
 
     params.Get("Sia/triggerqa", indexBundleConfig.bTriggerQA_);
     params.Get("Sia/enable_parallel_searching", indexBundleConfig.enable_parallel_searching_);
+    params.Get("Sia/enable_dynamic_pruning", indexBundleConfig.enable_dynamic_pruning_);
+    params.Get("Sia/enable_block_max_wand", indexBundleConfig.enable_block_max_wand_);
     params.Get("Sia/enable_forceget_doc", indexBundleConfig.enable_forceget_doc_);
     params.Get<std::size_t>("Sia/doccachenum", indexBundleConfig.documentCacheNum_);
     params.Get<std::size_t>("Sia/searchcachenum", indexBundleConfig.searchCacheNum_);
     params.Get("Sia/refreshsearchcache", indexBundleConfig.refreshSearchCache_);
     params.Get<time_t>("Sia/refreshcacheinterval", indexBundleConfig.refreshCacheInterval_);
+    params.Get<time_t>("Sia/stalecacheinterval", indexBundleConfig.staleCacheInterval_);
+    params.Get<int>("Sia/groupsampledocnum", indexBundleConfig.groupSampleDocNum_);
+
+    std::string cacheMemory;
+    if (params.GetString("Sia/searchcachememory", cacheMemory))
+    {
+        indexBundleConfig.searchCacheMemory_ = ByteSizeParser::get()->parse<std::size_t>(cacheMemory);
+    }
+    if (params.GetString("Sia/mastersearchcachememory", cacheMemory))
+    {
+        indexBundleConfig.masterSearchCacheMemory_ = ByteSizeParser::get()->parse<std::size_t>(cacheMemory);
+    }
+
     params.Get<std::size_t>("Sia/filtercachenum", indexBundleConfig.filterCacheNum_);
     params.Get<std::size_t>("Sia/mastersearchcachenum", indexBundleConfig.masterSearchCacheNum_);
     params.Get<std::size_t>("Sia/topknum", indexBundleConfig.topKNum_);
@@ -1661,6 +1737,13 @@ void CollectionConfig::parseMiningBundleSchema(const ticpp::Element * mining_sch
             mining_schema.suffixmatch_schema.suffix_groupcounter_topk = topk;
         }
 
+        ticpp::Element* subNodeBuild = getUniqChildElement(task_node, "IndexBuild", false);
+        if (subNodeBuild)
+        {
+            getAttribute(subNodeBuild, "threadnum", mining_schema.suffixmatch_schema.build_thread_num, false);
+            getAttribute_ByteSize(subNodeBuild, "memorylimit", mining_schema.suffixmatch_schema.build_memory_limit, false);
+        }
+
         Iterator<Element> filterit("FilterProperty");
         const IndexBundleSchema& indexSchema = collectionMeta.indexBundleConfig_->indexSchema_;
         for (filterit = filterit.begin(task_node); filterit != filterit.end(); ++filterit)
@@ -1766,6 +1849,9 @@ void CollectionConfig::parseMiningBundleSchema(const ticpp::Element * mining_sch
 
     task_node = getUniqChildElement(mining_schema_node, "AdIndex", false);
     parseAdIndexNode(task_node, collectionMeta);
+
+    task_node = getUniqChildElement(mining_schema_node, "GeoIndex", false);
+    parseGeoIndexNode(task_node, collectionMeta);
 }
 
 void CollectionConfig::parseFuzzyNormalizerNode(
@@ -1809,6 +1895,46 @@ void CollectionConfig::parseAdIndexNode(
     miningSchema.ad_index_config.isEnable = true;
 }
 
+void CollectionConfig::parseGeoIndexNode(
+    const ticpp::Element* geoIndexNode,
+    CollectionMeta& collectionMeta) const
+{
+    if (!geoIndexNode)
+        return;
+
+    GeoIndexConfig& geoIndexConfig =
+        collectionMeta.miningBundleConfig_->mining_schema_.geo_index_config;
+
+    getAttribute(geoIndexNode, "property", geoIndexConfig.property);
+
+    PropertyConfig propConfig;
+    propConfig.setName(geoIndexConfig.property);
+    const IndexBundleSchema& indexSchema = collectionMeta.indexBundleConfig_->indexSchema_;
+    IndexBundleSchema::const_iterator propIt = indexSchema.find(propConfig);
+
+    if (propIt == indexSchema.end() ||
+        propIt->getType() != DOUBLE_PROPERTY_TYPE ||
+        !propIt->isIndex() || !propIt->getIsFilter() || !propIt->getIsRange())
+    {
+        throw XmlConfigParserException("Property [" + geoIndexConfig.property +
+            "] in <GeoIndex> needs to be configured as a double range filter property like below:\n"
+            "<IndexBundle> <Schema> <Property name=\"Location\" type=\"double\"> "
+            "<Indexing filter=\"yes\" range=\"yes\" ...");
+    }
+
+    int precision = 0;
+    if (getAttribute_IntType(geoIndexNode, "precision", precision, false))
+    {
+        if (precision < 1 || precision > 12)
+        {
+            throw XmlConfigParserException("<GeoIndex> precision should be in [1, 12].");
+        }
+        geoIndexConfig.precision = precision;
+    }
+
+    geoIndexConfig.isEnable = true;
+}
+
 void CollectionConfig::parseZambeziNode(
     const ticpp::Element* zambeziNode,
     CollectionMeta& collectionMeta) const
@@ -18,6 +18,7 @@
 #include <configuration-manager/FirewallConfig.h>
 #include <configuration-manager/CollectionParameterConfig.h>
 #include <configuration-manager/LogServerConnectionConfig.h>
+#include <configuration-manager/QueryLogWriterConfig.h>
 #include <configuration-manager/GroupConfig.h>
 #include <mining-manager/group-manager/ontology_rep_item.h>
 #include <core/common/TermTypeDetector.h>
@@ -411,6 +412,11 @@ public:
         return log_conn_str_;
     }
 
+    const QueryLogWriterConfig& getQueryLogWriterConfig() const
+    {
+        return queryLogWriterConfig_;
+    }
+
     const LogServerConnectionConfig& getLogServerConfig() const
     {
         return logServerConnectionConfig_;
@@ -698,6 +704,8 @@ public:
 
     std::string log_conn_str_;
 
+    QueryLogWriterConfig queryLogWriterConfig_;
+
     /// @brief Log server network address
     LogServerConnectionConfig logServerConnectionConfig_;
 
@@ -826,6 +834,13 @@ private:
             const ticpp::Element* adIndexNode,
             CollectionMeta& collectionMeta) const;
 
+    /// @brief Parse <MiningBundle> <Schema> <GeoIndex>
+    /// @param geoIndexNode Pointer to the Element <GeoIndex>
+    /// @param collectionMeta the config instance to update
+    void parseGeoIndexNode(
+        const ticpp::Element* geoIndexNode,
+        CollectionMeta& collectionMeta) const;
+
     /// @brief                  Parse <Collection> settings
     /// @param system           Pointer to the Element
     void parseCollectionSettings(const ticpp::Element * collection, CollectionMeta & collectionMeta);
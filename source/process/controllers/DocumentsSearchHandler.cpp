@@ -33,6 +33,7 @@
 #include <mining-manager/MiningManager.h>
 
 #include <log-manager/UserQuery.h>
+#include <log-manager/QueryLogWriter.h>
 
 #include <util/swap.h>
 
@@ -846,7 +847,7 @@ void DocumentsSearchKeywordsLogger::log(
     queryLog.setSessionId(session);
     queryLog.setTimeStamp(start_);
     queryLog.setDuration(duration);
-    queryLog.save();
+    QueryLogWriter::instance().write(queryLog);
 }
 } // namespace detail
 
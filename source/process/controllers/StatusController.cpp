@@ -9,6 +9,11 @@
 #include <node-manager/NodeManagerBase.h>
 #include <node-manager/MasterManagerBase.h>
 #include <bundles/index/IndexTaskService.h>
+#include <log-manager/QueryLogWriter.h>
+#include <la-manager/LAPool.h>
+#include <la-manager/QueryAnalysisCache.h>
+
+#include <boost/lexical_cast.hpp>
 
 #include <common/Status.h>
 #include <common/Keys.h>
@@ -135,6 +140,23 @@ void StatusController::get_distribute_status()
         memStatus["IsAnyShardingNodeBusy"] = MasterManagerBase::get()->isShardingNodeOK(shard_list)?"no":"yes";
     }
     memStatus["PrimaryShardingNodeList"] = shardliststr;
+
+    const QueryLogWriter& queryLogWriter = QueryLogWriter::instance();
+    memStatus["QueryLogQueueDepth"] = boost::lexical_cast<std::string>(queryLogWriter.queueDepth());
+    memStatus["QueryLogDroppedCount"] = boost::lexical_cast<std::string>(queryLogWriter.droppedCount());
+    memStatus["QueryLogWrittenCount"] = boost::lexical_cast<std::string>(queryLogWriter.writtenCount());
+
+    SearchLAPoolStats laStats;
+    LAPool::getInstance()->getSearchLAStats(laStats);
+    memStatus["SearchLAHitCount"] = boost::lexical_cast<std::string>(laStats.hitNum);
+    memStatus["SearchLAMissCount"] = boost::lexical_cast<std::string>(laStats.missNum);
+    memStatus["SearchLACreateCount"] = boost::lexical_cast<std::string>(laStats.createNum);
+    memStatus["SearchLAWaitCount"] = boost::lexical_cast<std::string>(laStats.waitNum);
+    memStatus["SearchLATempCount"] = boost::lexical_cast<std::string>(laStats.tempNum);
+
+    const QueryAnalysisCache* queryAnalysisCache = QueryAnalysisCache::get();
+    memStatus["QueryAnalysisCacheHitCount"] = boost::lexical_cast<std::string>(queryAnalysisCache->hitCount());
+    memStatus["QueryAnalysisCacheMissCount"] = boost::lexical_cast<std::string>(queryAnalysisCache->missCount());
     //if (indexSearchService_)
     //{
     //    // something info for read only aggregator
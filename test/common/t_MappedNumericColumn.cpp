@@ -0,0 +1,211 @@
+/**
+ * @file t_MappedNumericColumn.cpp
+ * @brief test the values mapped from file and the values appended are
+ *        saved and loaded back correctly.
+ */
+
+#include <common/MappedNumericColumn.h>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <vector>
+#include <fstream>
+
+using namespace sf1r;
+
+namespace bfs = boost::filesystem;
+
+namespace
+{
+const char* TEST_DIR_STR = "mapped_numeric_column_test";
+const char* COLUMN_FILE_NAME = "column.rtype_data";
+const int INVALID_VALUE = -1;
+
+typedef MappedNumericColumn<int> ColumnType;
+
+void checkColumn(const ColumnType& column, const std::vector<int>& gold)
+{
+    BOOST_REQUIRE_EQUAL(column.size(), gold.size());
+    for (std::size_t i = 0; i < gold.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(column[i], gold[i]);
+    }
+}
+
+void setValue(ColumnType& column, std::vector<int>& gold, std::size_t pos, int value)
+{
+    if (pos >= column.size())
+    {
+        column.resize(pos + 1, INVALID_VALUE);
+        gold.resize(pos + 1, INVALID_VALUE);
+    }
+    column.set(pos, value);
+    gold[pos] = value;
+}
+
+std::string prepareDir()
+{
+    bfs::path dir(TEST_DIR_STR);
+    bfs::remove_all(dir);
+    bfs::create_directory(dir);
+    return (dir / COLUMN_FILE_NAME).string();
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(MappedNumericColumn_test)
+
+BOOST_AUTO_TEST_CASE(testSaveAndOpen)
+{
+    const std::string path = prepareDir();
+    std::vector<int> gold(1, INVALID_VALUE);
+
+    {
+        ColumnType column(1, INVALID_VALUE);
+        BOOST_CHECK(!column.open(path));
+
+        for (int i = 1; i <= 1000; ++i)
+        {
+            setValue(column, gold, i, i * 3);
+        }
+        checkColumn(column, gold);
+        BOOST_CHECK(column.save(path));
+
+        BOOST_CHECK_EQUAL(column.baseSize(), gold.size());
+        BOOST_CHECK_EQUAL(column.deltaSize(), 0U);
+        checkColumn(column, gold);
+    }
+
+    {
+        ColumnType column(1, INVALID_VALUE);
+        BOOST_CHECK(column.open(path));
+        checkColumn(column, gold);
+        BOOST_CHECK(column.isContiguous());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testAppendAndUpdate)
+{
+    const std::string path = prepareDir();
+    std::vector<int> gold(1, INVALID_VALUE);
+
+    {
+        ColumnType column(1, INVALID_VALUE);
+        for (int i = 1; i <= 100; ++i)
+        {
+            setValue(column, gold, i, i);
+        }
+        BOOST_CHECK(column.save(path));
+    }
+
+    for (int round = 0; round < 3; ++round)
+    {
+        ColumnType column(1, INVALID_VALUE);
+        BOOST_CHECK(column.open(path));
+        checkColumn(column, gold);
+
+        // append new values
+        const std::size_t oldSize = gold.size();
+        for (std::size_t i = oldSize; i < oldSize + 50; ++i)
+        {
+            setValue(column, gold, i, i * 2);
+        }
+        BOOST_CHECK(!column.isContiguous());
+        BOOST_CHECK(column.data() == NULL);
+
+        // update the values mapped
+        setValue(column, gold, round + 1, -100 - round);
+        checkColumn(column, gold);
+
+        BOOST_CHECK(column.save(path));
+        BOOST_CHECK(column.isContiguous());
+        checkColumn(column, gold);
+    }
+
+    ColumnType column(1, INVALID_VALUE);
+    BOOST_CHECK(column.open(path));
+    checkColumn(column, gold);
+}
+
+BOOST_AUTO_TEST_CASE(testUpdateChunks)
+{
+    const std::string path = prepareDir();
+    const std::size_t chunkSize = ColumnType::kChunkSize;
+    const std::size_t valueNum = chunkSize * 5 + 10;
+    std::vector<int> gold(1, INVALID_VALUE);
+
+    {
+        ColumnType column(1, INVALID_VALUE);
+        for (std::size_t i = 1; i < valueNum; ++i)
+        {
+            setValue(column, gold, i, i);
+        }
+        BOOST_CHECK(column.save(path));
+    }
+
+    {
+        ColumnType column(1, INVALID_VALUE);
+        BOOST_CHECK(column.open(path));
+
+        // the adjacent chunks, a separate chunk and the last partial chunk
+        setValue(column, gold, 0, 100);
+        setValue(column, gold, chunkSize - 1, 200);
+        setValue(column, gold, chunkSize, 300);
+        setValue(column, gold, chunkSize * 3 + 1, 400);
+        setValue(column, gold, valueNum - 1, 500);
+        setValue(column, gold, valueNum + 1, 600);
+        checkColumn(column, gold);
+
+        BOOST_CHECK(column.save(path));
+        checkColumn(column, gold);
+    }
+
+    ColumnType column(1, INVALID_VALUE);
+    BOOST_CHECK(column.open(path));
+    checkColumn(column, gold);
+}
+
+BOOST_AUTO_TEST_CASE(testShrink)
+{
+    const std::string path = prepareDir();
+    std::vector<int> gold(1, INVALID_VALUE);
+
+    ColumnType column(1, INVALID_VALUE);
+    for (int i = 1; i <= 100; ++i)
+    {
+        setValue(column, gold, i, i);
+    }
+    BOOST_CHECK(column.save(path));
+
+    column.resize(40, INVALID_VALUE);
+    gold.resize(40);
+    setValue(column, gold, 45, 45);
+    checkColumn(column, gold);
+    BOOST_CHECK(column.save(path));
+
+    ColumnType loaded(1, INVALID_VALUE);
+    BOOST_CHECK(loaded.open(path));
+    checkColumn(loaded, gold);
+    BOOST_CHECK_EQUAL(bfs::file_size(path),
+                      ColumnType::kHeaderSize + gold.size() * sizeof(int));
+}
+
+BOOST_AUTO_TEST_CASE(testInvalidFile)
+{
+    const std::string path = prepareDir();
+    {
+        std::ofstream ofs(path.c_str(), std::ios::binary);
+        std::size_t len = 100;
+        ofs.write(reinterpret_cast<const char*>(&len), sizeof(len));
+        int value = 1;
+        ofs.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    std::vector<int> gold(1, INVALID_VALUE);
+    ColumnType column(1, INVALID_VALUE);
+    BOOST_CHECK(!column.open(path));
+    checkColumn(column, gold);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
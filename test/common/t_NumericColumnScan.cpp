@@ -0,0 +1,129 @@
+/**
+ * @file t_NumericColumnScan.cpp
+ * @brief test the range scan kernels give the same result as comparing
+ *        each value, and the invalid value is excluded.
+ */
+
+#include <common/NumericColumnScan.h>
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <limits>
+#include <cstdlib>
+
+using namespace sf1r::column_scan;
+
+namespace
+{
+
+template <typename T>
+bool isInRange(T value, double lower, bool includeLower, double upper, bool includeUpper)
+{
+    return (includeLower ? value >= lower : value > lower) &&
+           (includeUpper ? value <= upper : value < upper);
+}
+
+template <typename T>
+void checkScan(
+    const std::vector<T>& data,
+    double lower, bool includeLower,
+    double upper, bool includeUpper)
+{
+    const T invalidValue = std::numeric_limits<T>::max();
+    T lowerValue, upperValue;
+    BOOST_REQUIRE(toInclusiveRange(lower, includeLower, upper, includeUpper,
+                                   invalidValue, lowerValue, upperValue));
+
+    const std::size_t num = data.size();
+    std::vector<WordT> words((num + kWordBitNum - 1) / kWordBitNum + 1, 0);
+    std::size_t matchNum = 0;
+    if (num > 0)
+    {
+        matchNum = scanRange(&data[0], num, lowerValue, upperValue, &words[0]);
+    }
+
+    std::size_t goldNum = 0;
+    for (std::size_t i = 0; i < num; ++i)
+    {
+        bool gold = data[i] != invalidValue &&
+                    isInRange(data[i], lower, includeLower, upper, includeUpper);
+        bool actual = (words[i / kWordBitNum] >> (i % kWordBitNum)) & 1;
+
+        BOOST_CHECK_EQUAL(actual, gold);
+        if (gold)
+        {
+            ++goldNum;
+        }
+    }
+    BOOST_CHECK_EQUAL(matchNum, goldNum);
+}
+
+template <typename T>
+void checkRandomScan()
+{
+    const double kInf = std::numeric_limits<double>::infinity();
+    std::srand(0);
+
+    for (int round = 0; round < 100; ++round)
+    {
+        std::vector<T> data(std::rand() % 500);
+        for (std::size_t i = 0; i < data.size(); ++i)
+        {
+            data[i] = (std::rand() % 8 == 0) ? std::numeric_limits<T>::max() :
+                      static_cast<T>(std::rand() % 100 - 50);
+        }
+
+        double lower = std::rand() % 110 - 55;
+        double upper = std::rand() % 110 - 55 + 0.5;
+
+        checkScan(data, lower, true, upper, true);
+        checkScan(data, lower, false, upper, false);
+        checkScan(data, lower, false, kInf, true);
+        checkScan(data, -kInf, true, upper, false);
+    }
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(NumericColumnScan_test)
+
+BOOST_AUTO_TEST_CASE(testScanInt32)
+{
+    checkRandomScan<int32_t>();
+}
+
+BOOST_AUTO_TEST_CASE(testScanInt64)
+{
+    checkRandomScan<int64_t>();
+}
+
+BOOST_AUTO_TEST_CASE(testScanFloat)
+{
+    checkRandomScan<float>();
+}
+
+BOOST_AUTO_TEST_CASE(testScanDouble)
+{
+    checkRandomScan<double>();
+}
+
+BOOST_AUTO_TEST_CASE(testScanInt16)
+{
+    checkRandomScan<int16_t>();
+}
+
+BOOST_AUTO_TEST_CASE(testEmptyRange)
+{
+    int32_t lower, upper;
+    BOOST_CHECK(toInclusiveRange<int32_t>(5, false, 6, false,
+                                          std::numeric_limits<int32_t>::max(),
+                                          lower, upper));
+    BOOST_CHECK_LT(upper, lower);
+
+    BOOST_CHECK(toInclusiveRange<int32_t>(1e20, true, 1e30, true,
+                                          std::numeric_limits<int32_t>::max(),
+                                          lower, upper));
+    BOOST_CHECK_LT(upper, lower);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
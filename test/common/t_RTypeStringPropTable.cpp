@@ -0,0 +1,258 @@
+/**
+ * @file t_RTypeStringPropTable.cpp
+ * @brief test the docs are compared in the order of their rtype string
+ *        values, after the values are inserted, updated and loaded.
+ * @date 2013-08-07
+ */
+
+#include <common/RTypeStringPropTable.h>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <map>
+#include <string>
+#include <cstdio>
+
+using namespace sf1r;
+
+namespace bfs = boost::filesystem;
+
+namespace
+{
+const char* TEST_DIR_STR = "rtype_string_prop_table_test";
+const char* TABLE_FILE_NAME = "rtype.data";
+
+typedef std::map<unsigned int, std::string> GoldValues;
+
+class TableFixture
+{
+public:
+    TableFixture()
+        : path_((bfs::path(TEST_DIR_STR) / TABLE_FILE_NAME).string())
+    {
+        bfs::remove_all(TEST_DIR_STR);
+        bfs::create_directories(TEST_DIR_STR);
+        reopen();
+    }
+
+    ~TableFixture()
+    {
+        table_.reset();
+        bfs::remove_all(TEST_DIR_STR);
+    }
+
+    void reopen()
+    {
+        if (table_)
+        {
+            table_->flush();
+        }
+        table_.reset(new RTypeStringPropTable(STRING_PROPERTY_TYPE));
+        table_->init(path_);
+    }
+
+    void update(unsigned int docId, const std::string& value)
+    {
+        BOOST_REQUIRE(table_->updateRTypeString(docId, value));
+        gold_[docId] = value;
+    }
+
+    void remove(unsigned int docId)
+    {
+        table_->delRTypeString(docId);
+        gold_.erase(docId);
+    }
+
+    /**
+     * check each doc with value is compared to the others as its value,
+     * and the docs without value are less than the others.
+     */
+    void checkOrder(unsigned int maxDocId)
+    {
+        std::vector<unsigned int> docs;
+        for (unsigned int docId = 1; docId <= maxDocId; ++docId)
+        {
+            docs.push_back(docId);
+        }
+
+        // compare the neighbours in the order of values
+        std::sort(docs.begin(), docs.end(), GoldLess(gold_));
+        for (std::size_t i = 1; i < docs.size(); ++i)
+        {
+            const int expect = goldCompare(docs[i-1], docs[i]);
+            const int actual = table_->compareValues(docs[i-1], docs[i], true);
+
+            BOOST_REQUIRE_MESSAGE(expect == actual,
+                                  "doc " << docs[i-1] << " vs doc " << docs[i]
+                                  << ", expect: " << expect
+                                  << ", actual: " << actual);
+
+            if (expect != 0 && gold_.count(docs[i-1]))
+            {
+                BOOST_REQUIRE_EQUAL(table_->compareValues(docs[i], docs[i-1], true),
+                                    -expect);
+            }
+        }
+    }
+
+    int goldCompare(unsigned int lhs, unsigned int rhs) const
+    {
+        GoldValues::const_iterator lit = gold_.find(lhs);
+        GoldValues::const_iterator rit = gold_.find(rhs);
+        if (lit == gold_.end()) return -1;
+        if (rit == gold_.end()) return 1;
+        return lit->second < rit->second ? -1 : (rit->second < lit->second ? 1 : 0);
+    }
+
+private:
+    struct GoldLess
+    {
+        const GoldValues& gold_;
+
+        GoldLess(const GoldValues& gold) : gold_(gold) {}
+
+        bool operator()(unsigned int lhs, unsigned int rhs) const
+        {
+            GoldValues::const_iterator lit = gold_.find(lhs);
+            GoldValues::const_iterator rit = gold_.find(rhs);
+            if (rit == gold_.end()) return false;
+            if (lit == gold_.end()) return true;
+            return lit->second < rit->second;
+        }
+    };
+
+public:
+    std::string path_;
+    boost::shared_ptr<RTypeStringPropTable> table_;
+    GoldValues gold_;
+};
+
+std::string makeValue(const char* prefix, int num)
+{
+    char buffer[32];
+    std::sprintf(buffer, "%s%08d", prefix, num);
+    return buffer;
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(RTypeStringPropTableTest, TableFixture)
+
+BOOST_AUTO_TEST_CASE(testOrdinalAssignment)
+{
+    table_->enableSort();
+
+    // appended in order, inserted in the middle and at the front
+    update(1, "b");
+    update(2, "d");
+    update(3, "c");
+    update(4, "a");
+    update(5, "c");
+    update(7, "e");
+
+    BOOST_CHECK_EQUAL(table_->dictSize(), 5U);
+    BOOST_CHECK_EQUAL(table_->compareValues(3, 5, true), 0);
+    BOOST_CHECK_EQUAL(table_->compareValues(4, 1, true), -1);
+    BOOST_CHECK_EQUAL(table_->compareValues(7, 2, true), 1);
+
+    // doc 6 has no value
+    BOOST_CHECK_EQUAL(table_->compareValues(6, 4, true), -1);
+    BOOST_CHECK_EQUAL(table_->compareValues(4, 6, true), 1);
+
+    checkOrder(7);
+}
+
+BOOST_AUTO_TEST_CASE(testGapExhaustion)
+{
+    table_->enableSort();
+
+    update(1, "a");
+    update(2, "b");
+
+    // each value is inserted right after "a", so that the gap is halved
+    // each time, and the ordinals are reassigned many times
+    const int clusterNum = 5000;
+    for (int i = 0; i < clusterNum; ++i)
+    {
+        update(3 + i, makeValue("a", clusterNum - i));
+    }
+
+    // then right before "b"
+    for (int i = 0; i < clusterNum; ++i)
+    {
+        update(3 + clusterNum + i, makeValue("az", i));
+    }
+
+    const unsigned int maxDocId = 2 + 2 * clusterNum;
+    BOOST_CHECK_EQUAL(table_->dictSize(), maxDocId);
+    checkOrder(maxDocId);
+}
+
+BOOST_AUTO_TEST_CASE(testUpdateAndRemove)
+{
+    table_->enableSort();
+
+    const int docNum = 1000;
+    for (int i = 1; i <= docNum; ++i)
+    {
+        update(i, makeValue("v", i % 100));
+    }
+    BOOST_CHECK_EQUAL(table_->dictSize(), 100U);
+    checkOrder(docNum);
+
+    // the values not used any more are removed
+    for (int i = 1; i <= docNum; ++i)
+    {
+        update(i, makeValue("v", i % 10));
+    }
+    BOOST_CHECK_EQUAL(table_->dictSize(), 10U);
+    checkOrder(docNum);
+
+    // reuse the ordinals released, in the clustered order
+    for (int i = 1; i <= docNum; i += 2)
+    {
+        update(i, makeValue("v00000000", docNum - i));
+    }
+    BOOST_CHECK_EQUAL(table_->dictSize(), 5U + docNum / 2);
+    checkOrder(docNum);
+
+    for (int i = 2; i <= docNum; i += 2)
+    {
+        remove(i);
+    }
+    BOOST_CHECK_EQUAL(table_->dictSize(), docNum / 2U);
+    checkOrder(docNum);
+}
+
+BOOST_AUTO_TEST_CASE(testLoad)
+{
+    const int docNum = 500;
+    for (int i = 1; i <= docNum; ++i)
+    {
+        update(i, makeValue("v", (i * 7) % 50));
+    }
+
+    // the values written before sort is enabled are loaded
+    table_->enableSort();
+    BOOST_CHECK_EQUAL(table_->dictSize(), 50U);
+    checkOrder(docNum);
+
+    for (int i = 1; i <= docNum; i += 3)
+    {
+        update(i, makeValue("w", i));
+    }
+    checkOrder(docNum);
+
+    // the values are loaded back from file
+    reopen();
+    table_->enableSort();
+    BOOST_CHECK_EQUAL(table_->size(), docNum + 1U);
+    checkOrder(docNum);
+
+    update(docNum + 1, "a");
+    checkOrder(docNum + 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,182 @@
+/**
+ * @file t_DocContainer.cpp
+ * @brief test the properties are stored in columns, and could be read
+ *        separately, while the collections in legacy layout are kept.
+ */
+
+#include <document-manager/DocContainer.h>
+#include <document-manager/Document.h>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+
+using namespace sf1r;
+namespace bfs = boost::filesystem;
+
+namespace
+{
+const std::string TEST_DIR = "./doc_container_test/";
+
+Document makeDoc(docid_t docId, const std::string& title, const std::string& content)
+{
+    Document doc;
+    doc.setId(docId);
+    doc.property("DOCID") = str_to_propstr(boost::lexical_cast<std::string>(docId));
+    doc.property("Title") = str_to_propstr(title);
+    doc.property("Content") = str_to_propstr(content);
+    doc.property("Price") = str_to_propstr("100");
+    return doc;
+}
+
+std::string getProp(Document& doc, const std::string& name)
+{
+    Document::doc_prop_value_strtype value;
+    if (!doc.getProperty(name, value))
+        return "";
+    return propstr_to_str(value);
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(DocContainer_test)
+
+BOOST_AUTO_TEST_CASE(testColumnar)
+{
+    bfs::remove_all(TEST_DIR);
+    bfs::create_directories(TEST_DIR);
+
+    DocContainer::PropertyGroups groups(1);
+    groups[0].push_back("Title");
+    groups[0].push_back("Price");
+
+    {
+        DocContainer container(TEST_DIR, groups);
+        BOOST_CHECK(container.open());
+        BOOST_CHECK(container.isColumnar());
+
+        BOOST_CHECK(container.insert(1, makeDoc(1, "title1", "content1")));
+        BOOST_CHECK(container.insert(2, makeDoc(2, "title2", "content2")));
+
+        // the base column, "Title, Price" and "Content"
+        BOOST_CHECK_EQUAL(container.getColumnNum(), 3U);
+
+        Document doc;
+        BOOST_CHECK(container.get(2, doc));
+        BOOST_CHECK_EQUAL(doc.getId(), 2U);
+        BOOST_CHECK_EQUAL(getProp(doc, "Title"), "title2");
+        BOOST_CHECK_EQUAL(getProp(doc, "Content"), "content2");
+        BOOST_CHECK_EQUAL(getProp(doc, "Price"), "100");
+
+        // only the column of title is read
+        std::vector<std::string> props(1, "Title");
+        BOOST_CHECK(container.get(1, props, doc));
+        BOOST_CHECK_EQUAL(getProp(doc, "Title"), "title1");
+        BOOST_CHECK_EQUAL(getProp(doc, "Price"), "100");
+        BOOST_CHECK_EQUAL(getProp(doc, "Content"), "");
+
+        // the doc exists without the property
+        props.assign(1, "NotExist");
+        BOOST_CHECK(container.get(1, props, doc));
+        BOOST_CHECK(!container.get(3, props, doc));
+
+        // the removed property of previous version is not returned
+        Document newDoc;
+        newDoc.setId(1);
+        newDoc.property("Title") = str_to_propstr("new title1");
+        BOOST_CHECK(container.update(1, newDoc));
+        BOOST_CHECK(container.get(1, doc));
+        BOOST_CHECK_EQUAL(getProp(doc, "Title"), "new title1");
+        BOOST_CHECK_EQUAL(getProp(doc, "Content"), "");
+
+        BOOST_CHECK(container.del(2));
+        BOOST_CHECK(!container.exist(2));
+        BOOST_CHECK(!container.get(2, doc));
+
+        container.flush();
+    }
+
+    {
+        // the columns are restored
+        DocContainer container(TEST_DIR);
+        BOOST_CHECK(container.open());
+        BOOST_CHECK_EQUAL(container.getColumnNum(), 3U);
+        BOOST_CHECK_EQUAL(container.getMaxDocId(), 2U);
+
+        Document doc;
+        std::vector<std::string> props(1, "Title");
+        BOOST_CHECK(container.get(1, props, doc));
+        BOOST_CHECK_EQUAL(getProp(doc, "Title"), "new title1");
+    }
+
+    bfs::remove_all(TEST_DIR);
+}
+
+BOOST_AUTO_TEST_CASE(testSentenceBlocks)
+{
+    bfs::remove_all(TEST_DIR);
+    bfs::create_directories(TEST_DIR);
+
+    {
+        DocContainer container(TEST_DIR);
+        BOOST_CHECK(container.open());
+
+        Document doc = makeDoc(1, "title1", "content1");
+        std::vector<uint32_t> blocks(2, 1);
+        doc.property("Content.blocks") = blocks;
+        BOOST_CHECK(container.insert(1, doc));
+
+        // the blocks are stored with "Content"
+        BOOST_CHECK_EQUAL(container.getColumnNum(), 4U);
+
+        Document result;
+        std::vector<std::string> props(1, "Content");
+        BOOST_CHECK(container.get(1, props, result));
+        BOOST_CHECK_EQUAL(getProp(result, "Content"), "content1");
+        BOOST_CHECK(result.findProperty("Content.blocks") != result.propertyEnd());
+    }
+
+    bfs::remove_all(TEST_DIR);
+}
+
+BOOST_AUTO_TEST_CASE(testLegacyLayout)
+{
+    bfs::remove_all(TEST_DIR);
+    bfs::create_directories(TEST_DIR);
+
+    {
+        // the document table created before the columnar layout,
+        // Lux creates its files with suffixes
+        Lux::IO::Array table(Lux::IO::NONCLUSTER);
+        table.set_noncluster_params(Lux::IO::Linked);
+        table.open((TEST_DIR + "DocumentPropertyTable").c_str(), Lux::IO::DB_CREAT);
+        table.close();
+    }
+
+    {
+        DocContainer container(TEST_DIR);
+        BOOST_CHECK(!container.isColumnar());
+        BOOST_CHECK(container.open());
+        BOOST_CHECK_EQUAL(container.getColumnNum(), 0U);
+
+        BOOST_CHECK(container.insert(1, makeDoc(1, "title1", "content1")));
+        container.flush();
+    }
+
+    {
+        // the legacy layout is kept on reopen
+        DocContainer container(TEST_DIR);
+        BOOST_CHECK(!container.isColumnar());
+        BOOST_CHECK(container.open());
+        BOOST_CHECK_EQUAL(container.getMaxDocId(), 1U);
+
+        Document doc;
+        BOOST_CHECK(container.get(1, doc));
+        BOOST_CHECK_EQUAL(getProp(doc, "Title"), "title1");
+        BOOST_CHECK(!bfs::exists(TEST_DIR + "DocumentPropertyColumns.xml"));
+    }
+
+    bfs::remove_all(TEST_DIR);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
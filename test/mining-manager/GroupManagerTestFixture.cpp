@@ -9,6 +9,7 @@
 #include <mining-manager/group-manager/GroupFilter.h>
 #include <aggregator-manager/SearchMerger.h>
 #include <common/PropSharedLockSet.h>
+#include <search-manager/SearchThreadBudget.h>
 
 #include <util/ustring/UString.h>
 
@@ -218,6 +219,31 @@ void create_ThreeLabel_FourProperty(faceted::GroupParam::GroupLabelMap& labels)
     labels[PROP_NAME_GROUP_DATETIME].push_back(path4);
 }
 
+typedef std::map<std::string, int> CountMap; // key: property/value
+
+void getCountMap(const faceted::GroupRep& groupRep, CountMap& countMap)
+{
+    typedef list<faceted::OntologyRepItem> RepItemList;
+    const RepItemList& itemList = groupRep.stringGroupRep_;
+
+    string propName, convertBuffer;
+    for (RepItemList::const_iterator it = itemList.begin();
+        it != itemList.end(); ++it)
+    {
+        it->text.convertString(convertBuffer, ENCODING_TYPE);
+
+        if (it->level == 0)
+        {
+            propName = convertBuffer;
+            countMap[propName] = it->doc_count;
+        }
+        else
+        {
+            countMap[propName + "/" + convertBuffer] = it->doc_count;
+        }
+    }
+}
+
 bool isDocBelongToStrLabel(
     const GroupManagerTestFixture::DocInput& docInput,
     const faceted::GroupParam::GroupLabelMap& labels
@@ -466,6 +492,53 @@ void GroupManagerTestFixture::checkGetGroupRep()
     createAndCheckGroupRep_(labels);
 }
 
+void GroupManagerTestFixture::checkCountDocs()
+{
+    faceted::GroupParam::GroupLabelMap labels;
+    create_OneLabel_PropStr(labels);
+
+    PropertyMap propMap;
+    createPropertyMap_(labels, propMap);
+
+    faceted::GroupRep exactRep;
+    createGroupRep_(labels, exactRep);
+    checkGroupRep_(exactRep, propMap);
+
+    // the budget is less than the counters, so this thread also counts
+    const std::size_t budgetThreadNum = 2;
+    SearchThreadBudget threadBudget(budgetThreadNum);
+
+    BOOST_TEST_MESSAGE("check the counters in parallel");
+    faceted::GroupRep parallelRep;
+    createGroupRep_(labels, parallelRep, 0, &threadBudget);
+    checkGroupRep_(parallelRep, propMap);
+
+    // the leased threads are released
+    BOOST_CHECK_EQUAL(threadBudget.acquire(budgetThreadNum), budgetThreadNum);
+    threadBudget.release(budgetThreadNum);
+
+    BOOST_TEST_MESSAGE("check the sampled counts");
+    const int sampleDocNum = docIdList_.size() / 3;
+    faceted::GroupRep sampleRep;
+    createGroupRep_(labels, sampleRep, sampleDocNum, &threadBudget);
+
+    CountMap exactCounts;
+    CountMap sampleCounts;
+    getCountMap(exactRep, exactCounts);
+    getCountMap(sampleRep, sampleCounts);
+
+    BOOST_CHECK_EQUAL(sampleCounts.size(), exactCounts.size());
+    for (CountMap::const_iterator it = exactCounts.begin();
+        it != exactCounts.end(); ++it)
+    {
+        BOOST_TEST_MESSAGE("sample count of " << it->first << ": "
+                           << sampleCounts[it->first]
+                           << ", exact count: " << it->second);
+        BOOST_CHECK_CLOSE(static_cast<double>(sampleCounts[it->first]),
+                          static_cast<double>(it->second), 10.0);
+    }
+}
+
 void GroupManagerTestFixture::checkScoreGroupLabelMerge()
 {
     using faceted::GroupParam;
@@ -689,7 +762,9 @@ void GroupManagerTestFixture::createAndCheckGroupRep_(const faceted::GroupParam:
 
 void GroupManagerTestFixture::createGroupRep_(
     const faceted::GroupParam::GroupLabelMap& labels,
-    faceted::GroupRep& groupRep
+    faceted::GroupRep& groupRep,
+    int sampleDocNum,
+    SearchThreadBudget* threadBudget
 )
 {
     faceted::GroupFilterBuilder filterBuilder(
@@ -710,11 +785,18 @@ void GroupManagerTestFixture::createGroupRep_(
         groupParam.groupProps_.push_back(propParam);
     }
     groupParam.groupLabels_ = labels;
+    groupParam.groupSampleDocNum_ = sampleDocNum;
 
     PropSharedLockSet propSharedLockSet;
     faceted::GroupFilter* filter =
         filterBuilder.createFilter(groupParam, propSharedLockSet);
 
+    if (threadBudget)
+    {
+        // count in parallel even for a few docs
+        filter->setThreadBudget(threadBudget, 1);
+    }
+
     for (vector<unsigned int>::const_iterator it = docIdList_.begin();
         it != docIdList_.end(); ++it)
     {
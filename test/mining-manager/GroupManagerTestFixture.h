@@ -23,6 +23,7 @@ namespace sf1r
 class NumericPropertyTableBuilderStub;
 class DocumentManager;
 class MiningTaskBuilder;
+class SearchThreadBudget;
 
 namespace faceted
 {
@@ -65,6 +66,12 @@ public:
 
     void checkGetGroupRep();
 
+    /**
+     * check the group counters running in parallel get the exact counts,
+     * and the sampled counts are close to them.
+     */
+    void checkCountDocs();
+
     static void checkGroupRepMerge();
     static void checkScoreGroupLabelMerge();
 
@@ -77,7 +84,9 @@ private:
 
     void createGroupRep_(
         const faceted::GroupParam::GroupLabelMap& labels,
-        faceted::GroupRep& groupRep
+        faceted::GroupRep& groupRep,
+        int sampleDocNum = 0,
+        SearchThreadBudget* threadBudget = NULL
     );
 
     typedef std::vector<unsigned int> DocIdList;
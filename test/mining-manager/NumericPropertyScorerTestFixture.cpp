@@ -50,4 +50,9 @@ void NumericPropertyScorerTestFixture::checkScore(docid_t docId, score_t gold)
     score_t result = numericScorer_->score(docId);
 
     BOOST_CHECK_CLOSE(result, gold, FLOAT_TOLERANCE);
+
+    score_t batchResult = 0;
+    numericScorer_->scoreBatch(&docId, 1, &batchResult);
+
+    BOOST_CHECK_CLOSE(batchResult, gold, FLOAT_TOLERANCE);
 }
@@ -0,0 +1,130 @@
+/**
+ * @file t_FMIndexBuildScheduler.cpp
+ * @brief test the jobs are all run, and the memory of running jobs is bounded.
+ */
+
+#include <mining-manager/suffix-match-manager/FMIndexBuildScheduler.h>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <algorithm>
+
+using namespace sf1r;
+
+namespace
+{
+
+class JobMonitor
+{
+public:
+    JobMonitor()
+        : finishedNum_(0), usedMemory_(0), peakMemory_(0)
+        , runningNum_(0), peakRunningNum_(0)
+    {}
+
+    bool run(std::size_t memory, bool result)
+    {
+        {
+            boost::mutex::scoped_lock lock(mutex_);
+            usedMemory_ += memory;
+            peakMemory_ = std::max(peakMemory_, usedMemory_);
+            ++runningNum_;
+            peakRunningNum_ = std::max(peakRunningNum_, runningNum_);
+        }
+
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+
+        boost::mutex::scoped_lock lock(mutex_);
+        usedMemory_ -= memory;
+        --runningNum_;
+        ++finishedNum_;
+        return result;
+    }
+
+    std::size_t finishedNum_;
+    std::size_t usedMemory_;
+    std::size_t peakMemory_;
+    std::size_t runningNum_;
+    std::size_t peakRunningNum_;
+
+private:
+    boost::mutex mutex_;
+};
+
+void addJob(FMIndexBuildScheduler& scheduler, JobMonitor& monitor,
+            std::size_t memory, bool result = true)
+{
+    scheduler.addJob("job", memory,
+                     boost::bind(&JobMonitor::run, &monitor, memory, result));
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(FMIndexBuildScheduler_test)
+
+BOOST_AUTO_TEST_CASE(testMemoryLimit)
+{
+    const std::size_t memoryLimit = 100;
+    FMIndexBuildScheduler scheduler(4, memoryLimit);
+    JobMonitor monitor;
+
+    const std::size_t memories[] = {60, 50, 40, 30, 20, 10, 10, 10};
+    const std::size_t jobNum = sizeof(memories) / sizeof(memories[0]);
+    for (std::size_t i = 0; i < jobNum; ++i)
+    {
+        addJob(scheduler, monitor, memories[i]);
+    }
+
+    BOOST_CHECK(scheduler.run());
+    BOOST_CHECK_EQUAL(monitor.finishedNum_, jobNum);
+    BOOST_CHECK_LE(monitor.peakMemory_, memoryLimit);
+    BOOST_CHECK_LE(scheduler.peakMemory(), memoryLimit);
+    BOOST_CHECK_LE(monitor.peakRunningNum_, 4U);
+    BOOST_CHECK_GT(monitor.peakRunningNum_, 1U);
+}
+
+BOOST_AUTO_TEST_CASE(testJobExceedLimit)
+{
+    FMIndexBuildScheduler scheduler(4, 100);
+    JobMonitor monitor;
+
+    addJob(scheduler, monitor, 500);
+    addJob(scheduler, monitor, 10);
+    addJob(scheduler, monitor, 10);
+
+    BOOST_CHECK(scheduler.run());
+    BOOST_CHECK_EQUAL(monitor.finishedNum_, 3U);
+    // the large job runs alone
+    BOOST_CHECK_EQUAL(scheduler.peakMemory(), 500U);
+}
+
+BOOST_AUTO_TEST_CASE(testNoLimit)
+{
+    FMIndexBuildScheduler scheduler(3, 0);
+    JobMonitor monitor;
+
+    for (int i = 0; i < 6; ++i)
+    {
+        addJob(scheduler, monitor, 1000);
+    }
+
+    BOOST_CHECK(scheduler.run());
+    BOOST_CHECK_EQUAL(monitor.finishedNum_, 6U);
+    BOOST_CHECK_LE(monitor.peakRunningNum_, 3U);
+}
+
+BOOST_AUTO_TEST_CASE(testJobFail)
+{
+    FMIndexBuildScheduler scheduler(2, 0);
+    JobMonitor monitor;
+
+    addJob(scheduler, monitor, 10);
+    addJob(scheduler, monitor, 10, false);
+    addJob(scheduler, monitor, 10);
+
+    BOOST_CHECK(!scheduler.run());
+    BOOST_CHECK_EQUAL(monitor.finishedNum_, 3U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
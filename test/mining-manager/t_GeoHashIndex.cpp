@@ -0,0 +1,276 @@
+/**
+ * @file t_GeoHashIndex.cpp
+ * @brief test GeoHashIndex gets the docs covering the radius queries, the
+ *        docs updated in place are moved, and it is saved and loaded back
+ *        correctly.
+ * @date 2013-07-30
+ */
+
+#include <mining-manager/geo-index/GeoHashIndex.h>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+using namespace sf1r;
+
+namespace bfs = boost::filesystem;
+
+namespace
+{
+const char* TEST_DIR_STR = "geohash_index_test";
+const char* GEO_PROP_NAME = "Location";
+const std::size_t PRECISION = 6;
+
+typedef std::pair<double, double> Location; // longitude, latitude
+
+double geodist(const Location& a, const Location& b)
+{
+    const double earthRadius = 6378137.0;
+    const double radLat1 = a.second * M_PI / 180.0;
+    const double radLat2 = b.second * M_PI / 180.0;
+    const double latDiff = radLat1 - radLat2;
+    const double lonDiff = (a.first - b.first) * M_PI / 180.0;
+
+    const double s = 2 * asin(sqrt(pow(sin(latDiff / 2), 2) +
+        cos(radLat1) * cos(radLat2) * pow(sin(lonDiff / 2), 2)));
+    return s * earthRadius;
+}
+
+/**
+ * the docs located around @p center in a square of 2 * @p delta degrees,
+ * and the same number of docs scattered around the world.
+ */
+void createLocations(
+    const Location& center,
+    double delta,
+    int num,
+    std::vector<Location>& locations)
+{
+    std::srand(1);
+    locations.resize(1);
+
+    for (int i = 0; i < num; ++i)
+    {
+        const double lonRatio = std::rand() / (RAND_MAX + 1.0) * 2 - 1;
+        const double latRatio = std::rand() / (RAND_MAX + 1.0) * 2 - 1;
+        locations.push_back(Location(center.first + delta * lonRatio,
+                                     center.second + delta * latRatio));
+    }
+
+    for (int i = 0; i < num; ++i)
+    {
+        locations.push_back(Location(std::rand() / (RAND_MAX + 1.0) * 360 - 180,
+                                     std::rand() / (RAND_MAX + 1.0) * 180 - 90));
+    }
+}
+
+void appendLocations(
+    GeoHashIndex& index,
+    const std::vector<Location>& locations)
+{
+    std::vector<GeoHashIndex::code_t> codes;
+    for (std::size_t i = index.getLastDocId() + 1; i < locations.size(); ++i)
+    {
+        codes.push_back(GeoHashIndex::encode(locations[i].first, locations[i].second));
+    }
+    index.append(codes);
+}
+
+void checkRadius(
+    const GeoHashIndex& index,
+    const std::vector<Location>& locations,
+    const Location& center,
+    double radius)
+{
+    std::vector<docid_t> docIds;
+    BOOST_REQUIRE(index.getDocsInRadius(center.first, center.second, radius, docIds));
+
+    BOOST_CHECK(std::adjacent_find(docIds.begin(), docIds.end(),
+                                   std::greater_equal<docid_t>()) == docIds.end());
+
+    std::size_t inRadiusNum = 0;
+    for (docid_t docId = 1; docId < locations.size(); ++docId)
+    {
+        if (geodist(center, locations[docId]) <= radius)
+        {
+            ++inRadiusNum;
+            BOOST_CHECK(std::binary_search(docIds.begin(), docIds.end(), docId));
+        }
+    }
+
+    BOOST_TEST_MESSAGE("radius: " << radius << ", candidates: " << docIds.size()
+                       << ", in radius: " << inRadiusNum);
+    BOOST_CHECK_GT(inRadiusNum, 0U);
+    BOOST_CHECK_LT(docIds.size(), locations.size() / 2);
+}
+
+std::string prepareDir()
+{
+    bfs::path dir(TEST_DIR_STR);
+    bfs::remove_all(dir);
+    bfs::create_directory(dir);
+    return dir.string();
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(GeoHashIndex_test)
+
+BOOST_AUTO_TEST_CASE(testCoverCells)
+{
+    std::srand(2);
+    for (int i = 0; i < 1000; ++i)
+    {
+        const double lon = std::rand() / (RAND_MAX + 1.0) * 360 - 180;
+        const double lat = std::rand() / (RAND_MAX + 1.0) * 180 - 90;
+        const GeoHashIndex::code_t code = GeoHashIndex::encode(lon, lat);
+
+        for (std::size_t precision = 1; precision <= GeoHashIndex::kMaxPrecision; ++precision)
+        {
+            std::vector<GeoHashIndex::code_t> cells;
+            BOOST_REQUIRE(GeoHashIndex::getCoverCells(lon, lat, lon, lat,
+                                                      precision, 1, cells));
+            BOOST_REQUIRE_EQUAL(cells.size(), 1U);
+
+            const std::size_t shift = (GeoHashIndex::kMaxPrecision - precision) * 5;
+            BOOST_CHECK_EQUAL(cells[0], code >> shift);
+        }
+    }
+
+    std::vector<GeoHashIndex::code_t> cells;
+    BOOST_CHECK(!GeoHashIndex::getCoverCells(-180, -90, 180, 90, 2, 256, cells));
+    BOOST_CHECK(GeoHashIndex::getCoverCells(-180, -90, 180, 90, 1, 256, cells));
+    BOOST_CHECK_EQUAL(cells.size(), 32U);
+
+    BOOST_CHECK_EQUAL(GeoHashIndex::encode(181, 0), GeoHashIndex::kInvalidCode);
+}
+
+BOOST_AUTO_TEST_CASE(testRadius)
+{
+    const Location center(121.47, 31.23);
+    std::vector<Location> locations;
+    createLocations(center, 1, 10000, locations);
+
+    GeoHashIndex index(prepareDir(), GEO_PROP_NAME, PRECISION);
+    BOOST_CHECK(index.open());
+    appendLocations(index, locations);
+    BOOST_CHECK_EQUAL(index.getLastDocId(), locations.size() - 1);
+
+    checkRadius(index, locations, center, 500);
+    checkRadius(index, locations, center, 3000);
+    checkRadius(index, locations, center, 20000);
+    checkRadius(index, locations, Location(121.8, 30.9), 5000);
+
+    // too many docs
+    std::vector<docid_t> docIds;
+    BOOST_CHECK(!index.getDocsInRadius(center.first, center.second, 1e7, docIds));
+}
+
+BOOST_AUTO_TEST_CASE(testCross180Meridian)
+{
+    const Location center(179.99, -16.5);
+    std::vector<Location> locations;
+    createLocations(center, 0.2, 5000, locations);
+
+    for (std::size_t i = 0; i < locations.size(); ++i)
+    {
+        if (locations[i].first > 180)
+            locations[i].first -= 360;
+    }
+
+    GeoHashIndex index(prepareDir(), GEO_PROP_NAME, PRECISION);
+    appendLocations(index, locations);
+
+    checkRadius(index, locations, center, 10000);
+}
+
+BOOST_AUTO_TEST_CASE(testUpdate)
+{
+    const Location center(116.40, 39.90);
+    std::vector<Location> locations;
+    createLocations(center, 1, 10000, locations);
+
+    GeoHashIndex index(prepareDir(), GEO_PROP_NAME, PRECISION);
+    appendLocations(index, locations);
+
+    // move the docs scattered into the center, and the others out
+    GeoHashIndex::CodeUpdates updates;
+    const std::size_t halfNum = locations.size() / 2;
+    for (std::size_t i = 1; i <= halfNum; i += 7)
+    {
+        const std::size_t j = i + halfNum;
+        std::swap(locations[i], locations[j]);
+
+        updates.push_back(std::make_pair(i, GeoHashIndex::encode(
+            locations[i].first, locations[i].second)));
+        updates.push_back(std::make_pair(j, GeoHashIndex::encode(
+            locations[j].first, locations[j].second)));
+    }
+    index.update(updates);
+
+    for (std::size_t i = 1; i < locations.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(index.getCode(i), GeoHashIndex::encode(
+            locations[i].first, locations[i].second));
+    }
+
+    checkRadius(index, locations, center, 5000);
+    checkRadius(index, locations, center, 20000);
+
+    // the docs moved out are not candidates any more
+    std::vector<docid_t> docIds;
+    BOOST_REQUIRE(index.getDocsInRadius(center.first, center.second, 20000, docIds));
+    for (std::vector<docid_t>::const_iterator it = docIds.begin();
+         it != docIds.end(); ++it)
+    {
+        BOOST_CHECK_LT(geodist(center, locations[*it]), 100000);
+    }
+
+    // an invalid location is removed from the cells
+    updates.assign(1, std::make_pair(docIds.front(), GeoHashIndex::kInvalidCode));
+    index.update(updates);
+    locations[docIds.front()] = Location(181, 0);
+
+    std::vector<docid_t> newDocIds;
+    BOOST_REQUIRE(index.getDocsInRadius(center.first, center.second, 20000, newDocIds));
+    BOOST_CHECK_EQUAL(newDocIds.size() + 1, docIds.size());
+    BOOST_CHECK(!std::binary_search(newDocIds.begin(), newDocIds.end(), docIds.front()));
+}
+
+BOOST_AUTO_TEST_CASE(testFlushAndOpen)
+{
+    const Location center(-73.98, 40.75);
+    std::vector<Location> locations;
+    createLocations(center, 1, 2000, locations);
+
+    const std::string dirPath = prepareDir();
+    std::vector<Location> firstLocations(locations.begin(),
+                                         locations.begin() + locations.size() / 2);
+    {
+        GeoHashIndex index(dirPath, GEO_PROP_NAME, PRECISION);
+        appendLocations(index, firstLocations);
+        BOOST_CHECK(index.flush());
+    }
+
+    {
+        GeoHashIndex index(dirPath, GEO_PROP_NAME, PRECISION);
+        BOOST_CHECK(index.open());
+        BOOST_CHECK_EQUAL(index.getLastDocId(), firstLocations.size() - 1);
+
+        appendLocations(index, locations);
+        BOOST_CHECK(index.flush());
+    }
+
+    // the cells are grouped in another precision
+    GeoHashIndex index(dirPath, GEO_PROP_NAME, PRECISION - 1);
+    BOOST_CHECK(index.open());
+    BOOST_CHECK_EQUAL(index.getLastDocId(), locations.size() - 1);
+    checkRadius(index, locations, center, 10000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -57,6 +57,12 @@ BOOST_FIXTURE_TEST_CASE(rebuildGroupData, sf1r::GroupManagerTestFixture)
     checkGetGroupRep();
 }
 
+BOOST_FIXTURE_TEST_CASE(countGroupDocs, sf1r::GroupManagerTestFixture)
+{
+    createDocument(1300);
+    checkCountDocs();
+}
+
 BOOST_AUTO_TEST_CASE(mergeGroupRep)
 {
     sf1r::GroupManagerTestFixture::checkGroupRepMerge();
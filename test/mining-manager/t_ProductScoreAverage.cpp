@@ -59,4 +59,22 @@ BOOST_AUTO_TEST_CASE(multiScorer)
     BOOST_CHECK_CLOSE(result, gold, FLOAT_TOLERANCE);
 }
 
+BOOST_AUTO_TEST_CASE(multiScorerBatch)
+{
+    BOOST_TEST_MESSAGE("check multiple scorers in batch");
+
+    addScorers("0.4 0.3 0.7", "0.2 0.6 0.3");
+
+    const std::size_t num = 5;
+    docid_t docIds[num] = {1, 3, 5, 7, 9};
+    score_t results[num];
+    averageScorer_->scoreBatch(docIds, num, results);
+
+    score_t gold = (0.4*0.2 + 0.3*0.6 + 0.7*0.3) / 3;
+    for (std::size_t i = 0; i < num; ++i)
+    {
+        BOOST_CHECK_CLOSE(results[i], gold, FLOAT_TOLERANCE);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
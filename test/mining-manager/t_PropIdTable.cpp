@@ -57,4 +57,101 @@ BOOST_FIXTURE_TEST_CASE(checkAttrId, AttrIdTestFixture)
     checkIdList();
 }
 
+BOOST_AUTO_TEST_CASE(checkCopyOnWrite)
+{
+    typedef sf1r::faceted::PropIdTable<uint32_t, uint32_t> IdTable;
+    typedef std::vector<uint32_t> IdList;
+
+    // span several chunks
+    const docid_t docNum = 200000;
+
+    IdTable reader;
+    for (docid_t docId = 1; docId < docNum; ++docId)
+    {
+        IdList idList(docId % 3, docId);
+        reader.setIdList(docId, idList);
+    }
+
+    IdTable writer(reader);
+    writer.resize(docNum + 100);
+    writer.setIdList(10, IdList(2, 7));
+    writer.setIdList(docNum + 50, IdList(3, 8));
+
+    IdTable::PropIdList propIdList;
+    for (docid_t docId = 1; docId < docNum; ++docId)
+    {
+        reader.getIdList(docId, propIdList);
+        BOOST_REQUIRE_EQUAL(propIdList.size(), docId % 3);
+        for (std::size_t i = 0; i < propIdList.size(); ++i)
+        {
+            BOOST_REQUIRE_EQUAL(propIdList[i], docId);
+        }
+    }
+    BOOST_CHECK_EQUAL(reader.size(), docNum);
+
+    writer.getIdList(10, propIdList);
+    BOOST_REQUIRE_EQUAL(propIdList.size(), 2U);
+    BOOST_CHECK_EQUAL(propIdList[1], 7U);
+
+    writer.getIdList(docNum + 50, propIdList);
+    BOOST_REQUIRE_EQUAL(propIdList.size(), 3U);
+    BOOST_CHECK_EQUAL(propIdList[2], 8U);
+
+    writer.getIdList(docNum - 1, propIdList);
+    BOOST_REQUIRE_EQUAL(propIdList.size(), (docNum - 1) % 3);
+    BOOST_CHECK_EQUAL(propIdList[0], docNum - 1);
+}
+
+BOOST_AUTO_TEST_CASE(checkCountIds)
+{
+    typedef sf1r::faceted::PropIdTable<uint32_t, uint32_t> IdTable;
+    typedef std::vector<uint32_t> IdList;
+
+    const docid_t docNum = 100000;
+    const uint32_t valueNum = 100;
+
+    // docs have 0, 1 or 2 value ids
+    IdTable table;
+    for (docid_t docId = 1; docId < docNum; ++docId)
+    {
+        IdList idList;
+        for (docid_t i = 0; i < docId % 3; ++i)
+        {
+            idList.push_back((docId + i) % (valueNum - 1) + 1);
+        }
+        table.setIdList(docId, idList);
+    }
+
+    // some docs are out of the table range
+    std::vector<docid_t> docIds;
+    for (docid_t docId = 1; docId < docNum + 10; docId += 2)
+    {
+        docIds.push_back(docId);
+    }
+
+    std::vector<unsigned int> countTable(valueNum);
+    const std::size_t countDocNum =
+        table.countIds(&docIds[0], docIds.size(), &countTable[0]);
+
+    std::vector<unsigned int> goldCountTable(valueNum);
+    std::size_t goldDocNum = 0;
+    IdTable::PropIdList propIdList;
+    for (std::size_t i = 0; i < docIds.size(); ++i)
+    {
+        table.getIdList(docIds[i], propIdList);
+        if (propIdList.empty())
+            continue;
+
+        ++goldDocNum;
+        for (std::size_t j = 0; j < propIdList.size(); ++j)
+        {
+            ++goldCountTable[propIdList[j]];
+        }
+    }
+
+    BOOST_CHECK_EQUAL(countDocNum, goldDocNum);
+    BOOST_CHECK_EQUAL_COLLECTIONS(countTable.begin(), countTable.end(),
+                                  goldCountTable.begin(), goldCountTable.end());
+}
+
 BOOST_AUTO_TEST_SUITE_END() 
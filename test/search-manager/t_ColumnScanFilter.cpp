@@ -0,0 +1,362 @@
+/**
+ * @file t_ColumnScanFilter.cpp
+ * @brief test ColumnScanFilter matches the range on the numeric column,
+ *        skips the docs removed from DocumentManager, and matches the
+ *        same docs as the BTree index.
+ * @date 2013-08-06
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <search-manager/ColumnScanFilter.h>
+#include <document-manager/DocumentManager.h>
+#include <index-manager/InvertedIndexManager.h>
+#include <index/IndexBundleConfiguration.h>
+#include <common/NumericPropertyTableBase.h>
+#include <common/Utilities.h>
+#include <common/ValueConverter.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+#include <set>
+
+using namespace sf1r;
+
+namespace bfs = boost::filesystem;
+namespace iii = izenelib::ir::indexmanager;
+
+namespace
+{
+const std::string kTestDir = "./column_scan_filter_test/";
+const std::string kCollectionName = "column_scan";
+const std::string kPriceProperty = "Price";
+const std::string kScoreProperty = "Score";
+const docid_t kMaxDocId = 200;
+
+void insertPropertyConfig(
+    IndexBundleSchema& indexSchema,
+    const std::string& name,
+    PropertyDataType type,
+    bool isFilter)
+{
+    PropertyConfig config;
+    config.setName(name);
+    config.setType(type);
+    config.setIsIndex(isFilter);
+    config.setIsFilter(isFilter);
+    indexSchema.insert(config);
+}
+
+void createSchema(IndexBundleConfiguration& config)
+{
+    IndexBundleSchema& indexSchema = config.indexSchema_;
+    insertPropertyConfig(indexSchema, "DOCID", STRING_PROPERTY_TYPE, false);
+    insertPropertyConfig(indexSchema, "DATE", DATETIME_PROPERTY_TYPE, false);
+    insertPropertyConfig(indexSchema, kPriceProperty, INT32_PROPERTY_TYPE, true);
+    insertPropertyConfig(indexSchema, kScoreProperty, FLOAT_PROPERTY_TYPE, true);
+    config.numberProperty();
+}
+
+/// the price of doc i is i, and its score is i / 4
+float getScore(docid_t docId)
+{
+    return docId / 4.0f;
+}
+
+boost::shared_ptr<DocumentManager> createDocumentManager()
+{
+    bfs::remove_all(kTestDir);
+    bfs::create_directories(kTestDir);
+
+    IndexBundleConfiguration config(kCollectionName);
+    createSchema(config);
+
+    boost::shared_ptr<DocumentManager> documentManager(
+        new DocumentManager(kTestDir, config.indexSchema_,
+                            izenelib::util::UString::UTF_8, 100));
+
+    boost::shared_ptr<NumericPropertyTableBase>& priceTable =
+        documentManager->getNumericPropertyTable(kPriceProperty);
+    BOOST_REQUIRE(priceTable);
+
+    boost::shared_ptr<NumericPropertyTableBase>& scoreTable =
+        documentManager->getNumericPropertyTable(kScoreProperty);
+    BOOST_REQUIRE(scoreTable);
+
+    for (docid_t docId = 1; docId <= kMaxDocId; ++docId)
+    {
+        Document document;
+        document.setId(docId);
+        document.property("DOCID") = str_to_propstr(boost::lexical_cast<std::string>(docId));
+        BOOST_REQUIRE(documentManager->insertDocument(document));
+
+        priceTable->setInt32Value(docId, docId);
+        scoreTable->setFloatValue(docId, getScore(docId));
+    }
+
+    return documentManager;
+}
+
+/**
+ * build the BTree index of the same values as createDocumentManager(),
+ * the numeric filter properties are inserted as in
+ * InvertedIndexManager::prepareIndexRTypeProperties_().
+ */
+boost::shared_ptr<InvertedIndexManager> createIndexManager(
+    IndexBundleConfiguration& config)
+{
+    createSchema(config);
+    const std::string indexDir = kTestDir + "index/";
+    bfs::create_directories(indexDir);
+
+    boost::shared_ptr<InvertedIndexManager> indexManager(
+        new InvertedIndexManager(&config));
+
+    iii::IndexManagerConfig indexManagerConfig;
+    indexManagerConfig.indexStrategy_.indexLocation_ = indexDir;
+    indexManagerConfig.indexStrategy_.indexMode_ = "default";
+    indexManagerConfig.indexStrategy_.memory_ = 30000000;
+    indexManagerConfig.indexStrategy_.indexDocLength_ = false;
+    indexManagerConfig.indexStrategy_.isIndexBTree_ = true;
+    indexManagerConfig.indexStrategy_.skipInterval_ = 8;
+    indexManagerConfig.indexStrategy_.maxSkipLevel_ = 3;
+    indexManagerConfig.indexStrategy_.indexLevel_ = iii::DOCLEVEL;
+    indexManagerConfig.mergeStrategy_.requireIntermediateFileForMerging_ = false;
+    indexManagerConfig.mergeStrategy_.param_ = "dbt";
+    indexManagerConfig.storeStrategy_.param_ = "file";
+
+    iii::IndexerCollectionMeta indexCollectionMeta;
+    indexCollectionMeta.setName(kCollectionName);
+
+    const IndexBundleSchema& indexSchema = config.indexSchema_;
+    for (IndexBundleSchema::const_iterator it = indexSchema.begin();
+         it != indexSchema.end(); ++it)
+    {
+        iii::IndexerPropertyConfig propertyConfig(
+            it->getPropertyId(), it->getName(), it->isIndex(), it->isAnalyzed());
+        propertyConfig.setIsFilter(it->getIsFilter());
+
+        iii::PropertyType type;
+        if (Utilities::convertPropertyDataType(it->getName(), it->getType(), type))
+        {
+            propertyConfig.setType(type);
+        }
+        indexCollectionMeta.addPropertyConfig(propertyConfig);
+    }
+    indexManagerConfig.addCollectionMeta(indexCollectionMeta);
+
+    std::map<std::string, uint32_t> collectionIdMapping;
+    collectionIdMapping[kCollectionName] = 1;
+    indexManager->setIndexManagerConfig(indexManagerConfig, collectionIdMapping);
+
+    PropertyConfig priceConfig;
+    PropertyConfig scoreConfig;
+    BOOST_REQUIRE(config.getPropertyConfig(kPriceProperty, priceConfig));
+    BOOST_REQUIRE(config.getPropertyConfig(kScoreProperty, scoreConfig));
+
+    iii::IndexerPropertyConfig priceIndexConfig(
+        priceConfig.getPropertyId(), kPriceProperty, true, false);
+    priceIndexConfig.setIsFilter(true);
+
+    iii::IndexerPropertyConfig scoreIndexConfig(
+        scoreConfig.getPropertyId(), kScoreProperty, true, false);
+    scoreIndexConfig.setIsFilter(true);
+
+    for (docid_t docId = 1; docId <= kMaxDocId; ++docId)
+    {
+        iii::IndexerDocument indexDocument;
+        indexDocument.setDocId(docId, 1);
+        indexDocument.insertProperty(priceIndexConfig, static_cast<int32_t>(docId));
+        indexDocument.insertProperty(scoreIndexConfig, getScore(docId));
+        BOOST_REQUIRE(indexManager->iii::Indexer::insertDocument(indexDocument));
+    }
+    indexManager->flush();
+
+    return indexManager;
+}
+
+QueryFiltering::FilteringType makeCondition(
+    const std::string& property,
+    QueryFiltering::FilteringOperation operation,
+    const PropertyValue& value1,
+    const PropertyValue& value2 = PropertyValue())
+{
+    QueryFiltering::FilteringType condition;
+    condition.operation_ = operation;
+    condition.property_ = property;
+    condition.values_.push_back(value1);
+    if (operation == QueryFiltering::RANGE)
+    {
+        condition.values_.push_back(value2);
+    }
+    return condition;
+}
+
+QueryFiltering::FilteringType makeRange(int64_t lower, int64_t upper)
+{
+    return makeCondition(kPriceProperty, QueryFiltering::RANGE,
+                         PropertyValue(lower), PropertyValue(upper));
+}
+
+std::set<docid_t> getBitmapDocs(
+    const boost::shared_ptr<InvertedIndexManager::FilterBitmapT>& bitmap)
+{
+    std::set<docid_t> docs;
+    InvertedIndexManager::FilterTermDocFreqsT termDocFreqs(bitmap);
+    while (termDocFreqs.next())
+    {
+        docs.insert(termDocFreqs.doc());
+    }
+    return docs;
+}
+
+std::set<docid_t> getDocs(
+    const ColumnScanFilter& filter,
+    const QueryFiltering::FilteringType& condition)
+{
+    boost::shared_ptr<InvertedIndexManager::FilterBitmapT> bitmap(
+        new InvertedIndexManager::FilterBitmapT);
+    BOOST_REQUIRE(filter.makeRangeQuery(condition, *bitmap));
+
+    return getBitmapDocs(bitmap);
+}
+
+std::set<docid_t> getDocs(const ColumnScanFilter& filter, int64_t lower, int64_t upper)
+{
+    return getDocs(filter, makeRange(lower, upper));
+}
+
+std::set<docid_t> getBTreeDocs(
+    InvertedIndexManager& indexManager,
+    const QueryFiltering::FilteringType& condition)
+{
+    boost::shared_ptr<InvertedIndexManager::FilterBitmapT> bitmap(
+        new InvertedIndexManager::FilterBitmapT);
+    indexManager.makeRangeQuery(condition.operation_, condition.property_,
+                                condition.values_, bitmap);
+
+    return getBitmapDocs(bitmap);
+}
+
+std::set<docid_t> makeDocs(docid_t first, docid_t last)
+{
+    std::set<docid_t> docs;
+    for (docid_t docId = first; docId <= last; ++docId)
+    {
+        docs.insert(docId);
+    }
+    return docs;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(ColumnScanFilterTest)
+
+BOOST_AUTO_TEST_CASE(testRange)
+{
+    boost::shared_ptr<DocumentManager> documentManager = createDocumentManager();
+    ColumnScanFilter filter(documentManager);
+
+    std::set<docid_t> expectDocs = makeDocs(10, 150);
+    std::set<docid_t> actualDocs = getDocs(filter, 10, 150);
+    BOOST_CHECK_EQUAL_COLLECTIONS(actualDocs.begin(), actualDocs.end(),
+                                  expectDocs.begin(), expectDocs.end());
+
+    double selectivity = 0;
+    BOOST_CHECK(filter.estimateSelectivity(makeRange(1, kMaxDocId), selectivity));
+    BOOST_CHECK_GT(selectivity, 0.9);
+
+    documentManager.reset();
+    bfs::remove_all(kTestDir);
+}
+
+BOOST_AUTO_TEST_CASE(testRemovedDocs)
+{
+    boost::shared_ptr<DocumentManager> documentManager = createDocumentManager();
+    ColumnScanFilter filter(documentManager);
+
+    const docid_t removedDocs[] = {10, 63, 64, 65, 100, 150};
+    const std::size_t removedNum = sizeof(removedDocs) / sizeof(removedDocs[0]);
+
+    std::set<docid_t> expectDocs = makeDocs(10, 150);
+    for (std::size_t i = 0; i < removedNum; ++i)
+    {
+        BOOST_REQUIRE(documentManager->removeDocument(removedDocs[i]));
+        expectDocs.erase(removedDocs[i]);
+    }
+
+    std::set<docid_t> actualDocs = getDocs(filter, 10, 150);
+    BOOST_CHECK_EQUAL_COLLECTIONS(actualDocs.begin(), actualDocs.end(),
+                                  expectDocs.begin(), expectDocs.end());
+
+    documentManager.reset();
+    bfs::remove_all(kTestDir);
+}
+
+BOOST_AUTO_TEST_CASE(testSameAsBTree)
+{
+    boost::shared_ptr<DocumentManager> documentManager = createDocumentManager();
+    ColumnScanFilter filter(documentManager);
+
+    IndexBundleConfiguration config(kCollectionName);
+    boost::shared_ptr<InvertedIndexManager> indexManager = createIndexManager(config);
+
+    std::vector<QueryFiltering::FilteringType> conditions;
+    const std::string properties[] = {kPriceProperty, kScoreProperty};
+    const PropertyDataType types[] = {INT32_PROPERTY_TYPE, FLOAT_PROPERTY_TYPE};
+
+    // the bounds in integer, in fraction, and out of the values
+    const double bounds[] = {-1, 0, 10, 10.5, 12.25, 49.9, 150, 1000};
+    const std::size_t boundNum = sizeof(bounds) / sizeof(bounds[0]);
+
+    const QueryFiltering::FilteringOperation operations[] = {
+        QueryFiltering::GREATER_THAN, QueryFiltering::GREATER_THAN_EQUAL,
+        QueryFiltering::LESS_THAN, QueryFiltering::LESS_THAN_EQUAL};
+    const std::size_t operationNum = sizeof(operations) / sizeof(operations[0]);
+
+    for (std::size_t i = 0; i < sizeof(properties) / sizeof(properties[0]); ++i)
+    {
+        // the values are converted to the property type as in FilteringParser
+        std::vector<PropertyValue> values(boundNum);
+        for (std::size_t j = 0; j < boundNum; ++j)
+        {
+            ValueConverter::driverValue2PropertyValue(
+                types[i], izenelib::driver::Value(bounds[j]), values[j]);
+        }
+
+        for (std::size_t j = 0; j < boundNum; ++j)
+        {
+            for (std::size_t k = 0; k < operationNum; ++k)
+            {
+                conditions.push_back(makeCondition(properties[i], operations[k], values[j]));
+            }
+
+            // both in the given and in the reversed order
+            for (std::size_t k = 0; k < boundNum; ++k)
+            {
+                conditions.push_back(makeCondition(properties[i], QueryFiltering::RANGE,
+                                                   values[j], values[k]));
+            }
+        }
+    }
+
+    for (std::size_t i = 0; i < conditions.size(); ++i)
+    {
+        const QueryFiltering::FilteringType& condition = conditions[i];
+        BOOST_TEST_MESSAGE("condition " << i << " on " << condition.property_);
+
+        std::set<docid_t> scanDocs = getDocs(filter, condition);
+        std::set<docid_t> btreeDocs = getBTreeDocs(*indexManager, condition);
+        BOOST_CHECK_EQUAL_COLLECTIONS(scanDocs.begin(), scanDocs.end(),
+                                      btreeDocs.begin(), btreeDocs.end());
+    }
+
+    // a reversed range matches nothing
+    BOOST_CHECK(getDocs(filter, 150, 10).empty());
+
+    indexManager.reset();
+    documentManager.reset();
+    bfs::remove_all(kTestDir);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,12 +1,99 @@
 #include <boost/test/unit_test.hpp>
 
 #include <search-manager/CustomRanker.h>
+#include <search-manager/NumericPropertyTableBuilder.h>
+#include <common/NumericPropertyTable.h>
+
+#include <cmath>
+#include <map>
+#include <vector>
 
 using namespace sf1r;
- 
+
+namespace
+{
+const docid_t MAX_DOCID = 1000;
+
+class TableBuilder : public NumericPropertyTableBuilder
+{
+public:
+    TableBuilder()
+    {
+        NumericPropertyTable<int32_t>* priceTable =
+            new NumericPropertyTable<int32_t>(INT32_PROPERTY_TYPE);
+        NumericPropertyTable<float>* xTable =
+            new NumericPropertyTable<float>(FLOAT_PROPERTY_TYPE);
+
+        priceTable->resize(MAX_DOCID + 1);
+        xTable->resize(MAX_DOCID + 1);
+
+        for (docid_t docId = 1; docId <= MAX_DOCID; ++docId)
+        {
+            // some docs have no price
+            if (docId % 7 != 0)
+            {
+                priceTable->setInt32Value(docId, docId % 100 + 1);
+            }
+            xTable->setFloatValue(docId, docId * 0.5f);
+        }
+
+        tables_["price"].reset(priceTable);
+        tables_["x"].reset(xTable);
+    }
+
+    boost::shared_ptr<NumericPropertyTableBase>& createPropertyTable(
+        const std::string& propertyName)
+    {
+        return tables_[propertyName];
+    }
+
+private:
+    std::map<std::string, boost::shared_ptr<NumericPropertyTableBase> > tables_;
+};
+
+double price(docid_t docId)
+{
+    return docId % 7 != 0 ? docId % 100 + 1 : 0;
+}
+
+double x(docid_t docId)
+{
+    return docId * 0.5;
+}
+
+void checkBatch(CustomRanker& customRanker, double (*expect)(docid_t))
+{
+    std::vector<docid_t> docIds;
+    for (docid_t docId = 1; docId <= MAX_DOCID; docId += 3)
+    {
+        docIds.push_back(docId);
+    }
+
+    std::vector<double> scores(docIds.size());
+    customRanker.evaluate(&docIds[0], docIds.size(), &scores[0]);
+
+    for (std::size_t i = 0; i < docIds.size(); ++i)
+    {
+        BOOST_CHECK_CLOSE(scores[i], expect(docIds[i]), 1e-9);
+        BOOST_CHECK_CLOSE(customRanker.evaluate(docIds[i]), scores[i], 1e-9);
+    }
+}
+
+double expect1(docid_t docId)
+{
+    return 2 + 3 * price(docId) + std::log(x(docId));
+}
+
+double expect2(docid_t docId)
+{
+    return 10 - (price(docId) + 1) / 4 * std::pow(x(docId), 2) + std::sqrt(price(docId) * price(docId));
+}
+
+}
+
 BOOST_AUTO_TEST_SUITE( CustomRanker_Suite )
 
- 
+
 BOOST_AUTO_TEST_CASE(customranker_test)
 {
     {
@@ -23,5 +110,36 @@ BOOST_AUTO_TEST_CASE(customranker_test)
     }
 }
 
-BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_CASE(customranker_evaluate_test)
+{
+    TableBuilder tableBuilder;
+    {
+        std::string exp("param1 + param2 * price + log(x)");
+        CustomRanker customRanker(exp);
+        double param1 = 2;
+        double param2 = 3;
+        customRanker.addConstantParam("param1", param1);
+        customRanker.addConstantParam("param2", param2);
+
+        BOOST_REQUIRE(customRanker.parse());
+        BOOST_REQUIRE(customRanker.setPropertyData(&tableBuilder));
+        checkBatch(customRanker, expect1);
+    }
+    {
+        std::string exp("(4 + 6) - (price + 1) / (2 * 2) * pow(x, 2) + sqrt(price * price)");
+        CustomRanker customRanker(exp);
+
+        BOOST_REQUIRE(customRanker.parse());
+        BOOST_REQUIRE(customRanker.setPropertyData(&tableBuilder));
+        checkBatch(customRanker, expect2);
+    }
+    {
+        std::string exp("unknown + 1");
+        CustomRanker customRanker(exp);
 
+        BOOST_REQUIRE(customRanker.parse());
+        BOOST_CHECK(!customRanker.setPropertyData(&tableBuilder));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
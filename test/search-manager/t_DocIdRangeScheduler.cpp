@@ -0,0 +1,136 @@
+/**
+ * @file t_DocIdRangeScheduler.cpp
+ * @brief test DocIdRangeScheduler covers each docid exactly once,
+ *        and the ranges taken by each thread are in ascending order.
+ * @date 2013-07-08
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <search-manager/DocIdRangeScheduler.h>
+
+#include <vector>
+
+using namespace sf1r;
+
+namespace
+{
+
+void checkSchedule(
+    docid_t docIdEnd,
+    std::size_t threadNum,
+    std::size_t chunkSize,
+    const std::vector<std::size_t>& threadOrder)
+{
+    DocIdRangeScheduler scheduler(docIdEnd, threadNum, chunkSize);
+    std::vector<int> visitCount(docIdEnd, 0);
+    std::vector<docid_t> lastEnds(threadNum, 0);
+    std::vector<bool> isFinished(threadNum, false);
+    std::size_t finishedNum = 0;
+
+    // simulate the threads taking ranges in the given order
+    for (std::size_t i = 0; finishedNum < threadNum; ++i)
+    {
+        std::size_t threadId = threadOrder[i % threadOrder.size()];
+        if (isFinished[threadId])
+        {
+            // make sure the unfinished threads are still scheduled
+            for (threadId = 0; isFinished[threadId]; ++threadId);
+        }
+
+        docid_t begin = 0;
+        docid_t end = 0;
+        if (!scheduler.next(threadId, begin, end))
+        {
+            isFinished[threadId] = true;
+            ++finishedNum;
+            continue;
+        }
+
+        BOOST_CHECK_LT(begin, end);
+        BOOST_CHECK_LE(end, docIdEnd);
+        BOOST_CHECK_GE(begin, lastEnds[threadId]);
+        lastEnds[threadId] = end;
+
+        for (docid_t docId = begin; docId < end; ++docId)
+        {
+            ++visitCount[docId];
+        }
+    }
+
+    for (docid_t docId = 0; docId < docIdEnd; ++docId)
+    {
+        BOOST_CHECK_EQUAL(visitCount[docId], 1);
+    }
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(DocIdRangeScheduler_test)
+
+BOOST_AUTO_TEST_CASE(testEvenSchedule)
+{
+    std::vector<std::size_t> threadOrder;
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+        threadOrder.push_back(i);
+    }
+
+    checkSchedule(10000, 4, 100, threadOrder);
+}
+
+BOOST_AUTO_TEST_CASE(testSteal)
+{
+    // thread 0 runs much faster than the others,
+    // so it would steal from the others after its own slice is exhausted
+    std::vector<std::size_t> threadOrder(8, 0);
+    threadOrder.push_back(1);
+    threadOrder.push_back(2);
+
+    checkSchedule(12000, 3, 100, threadOrder);
+}
+
+BOOST_AUTO_TEST_CASE(testSmallRange)
+{
+    std::vector<std::size_t> threadOrder(1, 2);
+    checkSchedule(10, 4, 0, threadOrder);
+}
+
+BOOST_AUTO_TEST_CASE(testStealCount)
+{
+    // the initial slices are [0, 5001) and [5001, 10000)
+    DocIdRangeScheduler scheduler(10000, 2, 100);
+    docid_t begin = 0;
+    docid_t end = 0;
+
+    // thread 1 could not steal the range before its own slice
+    while (scheduler.next(1, begin, end));
+    BOOST_CHECK_EQUAL(scheduler.stealCount(), 0);
+
+    BOOST_CHECK(scheduler.next(0, begin, end));
+    BOOST_CHECK_EQUAL(begin, 0U);
+    BOOST_CHECK_EQUAL(end, 100U);
+}
+
+BOOST_AUTO_TEST_CASE(testStealUpperHalf)
+{
+    DocIdRangeScheduler scheduler(10000, 2, 100);
+    docid_t begin = 0;
+    docid_t end = 0;
+
+    // thread 0 exhausts its own slice, then steals from thread 1
+    do
+    {
+        BOOST_CHECK(scheduler.next(0, begin, end));
+    }
+    while (end < 5001);
+
+    BOOST_CHECK(scheduler.next(0, begin, end));
+    BOOST_CHECK_EQUAL(scheduler.stealCount(), 1);
+    BOOST_CHECK_EQUAL(begin, 7501U);
+
+    BOOST_CHECK(scheduler.next(1, begin, end));
+    BOOST_CHECK_EQUAL(begin, 5001U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
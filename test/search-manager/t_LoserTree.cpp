@@ -0,0 +1,134 @@
+/**
+ * @file t_LoserTree.cpp
+ * @brief test LoserTree merges the sorted runs in order,
+ *        including the empty runs and the runs exhausted during merge.
+ * @date 2013-07-02
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <search-manager/LoserTree.h>
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+using namespace sf1r;
+
+namespace
+{
+
+typedef std::vector<int> Run;
+
+/**
+ * the runs are sorted in descending order, the larger one is output first.
+ */
+class Before
+{
+public:
+    Before(const std::vector<Run>& runs, const std::vector<std::size_t>& pos)
+        : runs_(runs), pos_(pos)
+    {}
+
+    bool operator()(std::size_t i, std::size_t j) const
+    {
+        return runs_[i][pos_[i]] > runs_[j][pos_[j]];
+    }
+
+private:
+    const std::vector<Run>& runs_;
+    const std::vector<std::size_t>& pos_;
+};
+
+Run mergeRuns(const std::vector<Run>& runs, std::size_t limit)
+{
+    std::vector<std::size_t> pos(runs.size(), 0);
+    LoserTree<Before> loserTree(runs.size(), Before(runs, pos));
+
+    for (std::size_t i = 0; i < runs.size(); ++i)
+    {
+        if (runs[i].empty())
+            loserTree.setExhausted(i);
+    }
+    loserTree.build();
+
+    Run result;
+    for (std::size_t w = loserTree.winner();
+         w != runs.size() && result.size() < limit;
+         w = loserTree.winner())
+    {
+        result.push_back(runs[w][pos[w]]);
+        ++pos[w];
+        loserTree.replay(pos[w] == runs[w].size());
+    }
+    return result;
+}
+
+void checkMerge(const std::vector<Run>& runs, std::size_t limit)
+{
+    Run gold;
+    for (std::size_t i = 0; i < runs.size(); ++i)
+    {
+        gold.insert(gold.end(), runs[i].begin(), runs[i].end());
+    }
+    std::sort(gold.begin(), gold.end(), std::greater<int>());
+    if (gold.size() > limit)
+    {
+        gold.resize(limit);
+    }
+
+    Run result = mergeRuns(runs, limit);
+    BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(),
+                                  gold.begin(), gold.end());
+}
+
+Run createRun(int start, int step, std::size_t num)
+{
+    Run run;
+    for (std::size_t i = 0; i < num; ++i)
+    {
+        run.push_back(start - step * i);
+    }
+    return run;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(LoserTree_test)
+
+BOOST_AUTO_TEST_CASE(testSingleRun)
+{
+    std::vector<Run> runs;
+    runs.push_back(createRun(100, 3, 20));
+
+    checkMerge(runs, 100);
+    checkMerge(runs, 5);
+}
+
+BOOST_AUTO_TEST_CASE(testMultiRuns)
+{
+    // not a power of 2
+    for (std::size_t runNum = 2; runNum <= 9; ++runNum)
+    {
+        std::vector<Run> runs;
+        for (std::size_t i = 0; i < runNum; ++i)
+        {
+            runs.push_back(createRun(1000 - i, runNum + i, 10 + 7 * i));
+        }
+
+        checkMerge(runs, 1000);
+        checkMerge(runs, 17);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testEmptyRuns)
+{
+    std::vector<Run> runs(5);
+    checkMerge(runs, 10);
+
+    runs[1] = createRun(50, 2, 8);
+    runs[4] = createRun(51, 1, 3);
+    checkMerge(runs, 10);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
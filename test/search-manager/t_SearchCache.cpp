@@ -0,0 +1,199 @@
+/**
+ * @file t_SearchCache.cpp
+ * @brief test SearchCache coalesces the concurrent misses, returns the
+ *        stale entries while refreshing them, and is bounded by bytes.
+ * @date 2013-07-29
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <common/SearchCache.h>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/atomic.hpp>
+#include <boost/lexical_cast.hpp>
+
+using namespace sf1r;
+
+namespace
+{
+const std::size_t TOPK_NUM = 10;
+
+class ResultLoader
+{
+public:
+    ResultLoader() : loadCount_(0) {}
+
+    bool load(docid_t docId, int sleepMs, KeywordSearchResult& result)
+    {
+        ++loadCount_;
+        boost::this_thread::sleep(boost::posix_time::milliseconds(sleepMs));
+
+        result.topKDocs_.assign(TOPK_NUM, docId);
+        result.fullTextOfDocumentInPage_.resize(1);
+        return true;
+    }
+
+    SearchCache::loader_type loader(docid_t docId, int sleepMs = 0)
+    {
+        return boost::bind(&ResultLoader::load, this, docId, sleepMs, _1);
+    }
+
+    int loadCount() const { return loadCount_.load(); }
+
+private:
+    boost::atomic<int> loadCount_;
+};
+
+QueryIdentity makeIdentity(const std::string& query)
+{
+    QueryIdentity identity;
+    identity.query = query;
+    return identity;
+}
+
+void searchInThread(
+    SearchCache* cache,
+    const QueryIdentity& identity,
+    const SearchCache::loader_type& loader,
+    boost::atomic<int>* cachedCount)
+{
+    KeywordSearchResult result;
+    bool isCached = false;
+
+    BOOST_CHECK(cache->get(identity, result, loader, isCached));
+    BOOST_CHECK_EQUAL(result.topKDocs_.size(), TOPK_NUM);
+
+    if (isCached)
+    {
+        // the summary texts are not cached
+        BOOST_CHECK(result.fullTextOfDocumentInPage_.empty());
+        ++*cachedCount;
+    }
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(SearchCache_test)
+
+BOOST_AUTO_TEST_CASE(testCoalesceMiss)
+{
+    SearchCache cache(100);
+    ResultLoader loader;
+    const QueryIdentity identity = makeIdentity("apple");
+    const int threadNum = 10;
+    boost::atomic<int> cachedCount(0);
+
+    boost::thread_group threads;
+    for (int i = 0; i < threadNum; ++i)
+    {
+        threads.create_thread(boost::bind(searchInThread, &cache, identity,
+                                          loader.loader(1, 200), &cachedCount));
+    }
+    threads.join_all();
+
+    BOOST_CHECK_EQUAL(loader.loadCount(), 1);
+    BOOST_CHECK_EQUAL(cachedCount.load(), threadNum - 1);
+}
+
+BOOST_AUTO_TEST_CASE(testNextGeneration)
+{
+    SearchCache cache(100);
+    ResultLoader loader;
+    const QueryIdentity identity = makeIdentity("apple");
+    KeywordSearchResult result;
+    bool isCached = false;
+
+    BOOST_CHECK(cache.get(identity, result, loader.loader(1), isCached));
+    BOOST_CHECK(!isCached);
+    BOOST_CHECK(cache.get(identity, result));
+
+    cache.nextGeneration();
+    BOOST_CHECK(!cache.get(identity, result));
+
+    BOOST_CHECK(cache.get(identity, result, loader.loader(2), isCached));
+    BOOST_CHECK(!isCached);
+    BOOST_CHECK_EQUAL(result.topKDocs_[0], 2U);
+    BOOST_CHECK_EQUAL(loader.loadCount(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(testStaleWhileRefresh)
+{
+    SearchCache cache(100, 0, 3600, false, 60);
+    ResultLoader loader;
+    const QueryIdentity identity = makeIdentity("apple");
+    KeywordSearchResult result;
+    bool isCached = false;
+
+    BOOST_CHECK(cache.get(identity, result, loader.loader(1), isCached));
+    cache.nextGeneration();
+
+    // the stale result is returned, and only one refresh is run
+    for (int i = 0; i < 3; ++i)
+    {
+        BOOST_CHECK(cache.get(identity, result, loader.loader(2, 100), isCached));
+        BOOST_CHECK(isCached);
+        BOOST_CHECK_EQUAL(result.topKDocs_[0], 1U);
+    }
+
+    cache.waitRefresh();
+    BOOST_CHECK_EQUAL(loader.loadCount(), 2);
+    BOOST_CHECK_EQUAL(cache.staleHitCount(), 3U);
+
+    BOOST_CHECK(cache.get(identity, result));
+    BOOST_CHECK_EQUAL(result.topKDocs_[0], 2U);
+}
+
+BOOST_AUTO_TEST_CASE(testMaxBytes)
+{
+    const std::size_t maxBytes = 64 * 1024;
+    SearchCache cache(1000, maxBytes);
+    const int queryNum = 1000;
+
+    for (int i = 0; i < queryNum; ++i)
+    {
+        KeywordSearchResult result;
+        result.topKDocs_.assign(TOPK_NUM * 10, i);
+        cache.set(makeIdentity(boost::lexical_cast<std::string>(i)), result);
+    }
+
+    int cachedNum = 0;
+    for (int i = 0; i < queryNum; ++i)
+    {
+        KeywordSearchResult result;
+        if (cache.get(makeIdentity(boost::lexical_cast<std::string>(i)), result))
+        {
+            ++cachedNum;
+        }
+    }
+
+    // the recent ones are kept
+    KeywordSearchResult last;
+    BOOST_CHECK(cache.get(makeIdentity(boost::lexical_cast<std::string>(queryNum - 1)), last));
+    BOOST_CHECK_GT(cachedNum, 0);
+    BOOST_CHECK_LT(cachedNum, queryNum);
+
+    // the result too large is not cached
+    KeywordSearchResult large;
+    large.topKDocs_.assign(maxBytes, 1);
+    cache.set(makeIdentity("large"), large);
+    BOOST_CHECK(!cache.get(makeIdentity("large"), large));
+}
+
+BOOST_AUTO_TEST_CASE(testZeroHit)
+{
+    SearchCache cache(10, 64 * 1024);
+
+    // the result without any hit is also cached
+    KeywordSearchResult empty;
+    empty.rawQueryString_ = "no hit";
+    cache.set(makeIdentity("no hit"), empty);
+
+    KeywordSearchResult result;
+    BOOST_CHECK(cache.get(makeIdentity("no hit"), result));
+    BOOST_CHECK(result.topKDocs_.empty());
+    BOOST_CHECK_EQUAL(result.rawQueryString_, empty.rawQueryString_);
+}
+
+BOOST_AUTO_TEST_SUITE_END()